@@ -1,4 +1,11 @@
 from .task import Task
 from .cpupool import pin, CPUPool, is_runtime_ext_enabled
 from .multi_stream import MultiStreamModule
-from .runtime_utils import get_core_list_of_node_id
+from .dynamic_batching import DynamicBatchingModule
+from .runtime_utils import get_core_list_of_node_id, get_cpu_topology, \
+    set_numa_weight_replica_enabled, is_numa_weight_replica_enabled, \
+    set_shared_primitive_cache_enabled, is_shared_primitive_cache_enabled, \
+    get_shared_primitive_cache_stats, warm_up_shared_primitive_cache, \
+    set_caching_allocator_enabled, is_caching_allocator_enabled, \
+    set_caching_allocator_huge_pages_enabled, get_caching_allocator_stats, \
+    empty_caching_allocator_cache
@@ -13,13 +13,16 @@ class CPUPool(object):
         core_ids (list): A list of CPU cores' ids used for intra-op parallelism.
         node_id (int): A numa node id with all CPU cores on the numa node.
             ``node_id`` doesn't work if ``core_ids`` is set.
+        bind_memory (bool): A flag indicates whether the threads running on
+            this CPU pool prefer to allocate the memory they first touch on
+            the numa node of their own core. The default value is False.
 
     Returns:
         intel_extension_for_pytorch.cpu.runtime.CPUPool: Generated
         intel_extension_for_pytorch.cpu.runtime.CPUPool object.
     """
 
-    def __init__(self, core_ids: list = None, node_id: int = None):
+    def __init__(self, core_ids: list = None, node_id: int = None, bind_memory: bool = False):
         if core_ids is not None:
             if node_id is not None:
                 warnings.warn("Both of core_ids and node_id are inputed. core_ids will be used with priority.")
@@ -30,7 +33,8 @@ class CPUPool(object):
         else:
             assert node_id is not None, "Neither core_ids or node_id has been implemented"
             self.core_ids = get_core_list_of_node_id(node_id)
-        self.cpu_pool = ipex._C.CPUPool(self.core_ids)
+        self.bind_memory = bind_memory
+        self.cpu_pool = ipex._C.CPUPool(self.core_ids, self.bind_memory)
 
 class pin(object):
     r"""
@@ -55,7 +59,7 @@ class pin(object):
     def __enter__(self):
         assert type(self.cpu_pool) is CPUPool
         self.previous_cpu_pool = ipex._C.get_current_cpu_pool()
-        ipex._C.pin_cpu_cores(self.cpu_pool.core_ids)
+        ipex._C.pin_cpu_cores(self.cpu_pool.core_ids, self.cpu_pool.bind_memory)
 
     def __exit__(self, *args):
         ipex._C.set_cpu_pool(self.previous_cpu_pool)
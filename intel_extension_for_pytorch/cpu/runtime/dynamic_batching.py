@@ -0,0 +1,68 @@
+import torch
+import torch.nn as nn
+import intel_extension_for_pytorch as ipex
+from .cpupool import CPUPool
+
+class DynamicBatchingModule(nn.Module):
+    r"""
+    DynamicBatchingModule supports online inference with dynamic micro-batching.
+
+    Small requests submitted concurrently (e.g. batch size 1 requests from
+    many serving threads) are coalesced into batches of up to
+    ``max_batch_size`` samples. A batch is dispatched to the first free
+    stream once it is full, or once its oldest request has waited
+    ``max_latency_ms``. The outputs are split along the batch dim and
+    returned to each request.
+
+    The cores inside ``cpu_pool`` are allocated to the streams the same way
+    as ``MultiStreamModule``. All the inputs of a request must be tensors
+    with the batch dim at dim 0, and the output must be a tensor, or a
+    tuple/list of tensors with the batch dim at dim 0.
+
+    Args:
+        model (torch.jit.ScriptModule): The input model.
+        num_streams (int): Number of instances.
+        cpu_pool (intel_extension_for_pytorch.cpu.runtime.CPUPool): An
+            intel_extension_for_pytorch.cpu.runtime.CPUPool object, contains
+            all CPU cores used to run the streams.
+        max_batch_size (int): The max number of samples in one batch.
+        max_latency_ms (float): The max time that a request waits for other
+            requests to be batched with.
+
+    Returns:
+        intel_extension_for_pytorch.cpu.runtime.DynamicBatchingModule: Generated
+        intel_extension_for_pytorch.cpu.runtime.DynamicBatchingModule object.
+
+    :meta public:
+    """
+
+    def __init__(self, model, num_streams: int, cpu_pool: CPUPool, max_batch_size: int = 32, max_latency_ms: float = 1.0):
+        super(DynamicBatchingModule, self).__init__()
+        assert type(cpu_pool) is CPUPool
+        assert isinstance(model, torch.jit.ScriptModule), "DynamicBatchingModule only supports torch.jit.ScriptModule"
+        core_list = cpu_pool.core_ids
+        assert num_streams >= 1 and num_streams <= core_list.__len__(), \
+            "num_streams should be in range [1, number of cores inside cpu_pool]"
+        cores_per_instance = core_list.__len__() // num_streams
+        num_stream_allocated_extra_core = core_list.__len__() % num_streams
+        stream_core_lists = []
+        start_core_list_idx = 0
+        end_core_list_idx = 0
+        for j in range(num_streams):
+            if j < num_stream_allocated_extra_core:
+                end_core_list_idx += (cores_per_instance + 1)
+            else:
+                end_core_list_idx += cores_per_instance
+            stream_core_lists.append(core_list[start_core_list_idx:end_core_list_idx])
+            start_core_list_idx = end_core_list_idx
+        ipex._C.init_runtime_ext()
+        self._scheduler = ipex._C.BatchScheduler(model._c, stream_core_lists, max_batch_size, int(max_latency_ms * 1000),
+                                                 cpu_pool.bind_memory)
+
+    def run_async(self, *inputs):
+        # Submit one request and return a FutureTensor of its output.
+        return self._scheduler.run_async(*inputs)
+
+    def forward(self, *inputs):
+        # Submit one request and block until its output is ready.
+        return self._scheduler.run_async(*inputs).get()
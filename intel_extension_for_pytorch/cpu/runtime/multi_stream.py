@@ -24,6 +24,11 @@ class MultiStreamModule(nn.Module):
             stream will be concatenated or not. The default value is True. Note:
             if the output of each stream can't be concatenated, set this flag to
             false to get the raw output (a list of each stream's output).
+        work_stealing (bool): A flag indicates whether an idle stream is
+            allowed to steal the pending inputs of the other busy streams on
+            the same numa node. It helps the tail latency when several threads
+            call the MultiStreamModule concurrently with unbalanced workloads.
+            The default value is False.
 
     Returns:
         intel_extension_for_pytorch.cpu.runtime.MultiStreamModule: Generated
@@ -32,7 +37,7 @@ class MultiStreamModule(nn.Module):
     :meta public:
     """
 
-    def __init__(self, model, num_streams: int, cpu_pool: CPUPool, concat_output: bool = True):
+    def __init__(self, model, num_streams: int, cpu_pool: CPUPool, concat_output: bool = True, work_stealing: bool = False):
         super(MultiStreamModule, self).__init__()
         assert type(cpu_pool) is CPUPool
         self.core_list = cpu_pool.core_ids
@@ -53,7 +58,10 @@ class MultiStreamModule(nn.Module):
                     end_core_list_idx += (self.cores_per_instance + 1)
                 else:
                     end_core_list_idx += self.cores_per_instance
-                self.tasks.append(ipex.cpu.runtime.Task(model, ipex.cpu.runtime.CPUPool(self.core_list[start_core_list_idx:end_core_list_idx])))
+                self.tasks.append(ipex.cpu.runtime.Task(model,
+                                                        ipex.cpu.runtime.CPUPool(self.core_list[start_core_list_idx:end_core_list_idx],
+                                                                                 bind_memory=cpu_pool.bind_memory),
+                                                        work_stealing))
                 start_core_list_idx = end_core_list_idx
         self.concat_output = concat_output
 
@@ -1,10 +1,24 @@
-import subprocess
+import torch
+import intel_extension_for_pytorch as ipex
 
 def get_num_nodes():
-    return int(subprocess.check_output('lscpu | grep Socket | awk \'{print $2}\'', shell=True))
+    return ipex._C.get_numa_node_ids().__len__()
 
 def get_num_cores_per_node():
-    return int(subprocess.check_output('lscpu | grep Core\'.* per socket\' | awk \'{print $4}\'', shell=True))
+    return ipex._C.get_core_list_of_node_id(ipex._C.get_numa_node_ids()[0]).__len__()
+
+def get_cpu_topology():
+    r"""
+    Helper function to get the topology of the online CPUs.
+
+    Returns:
+        list: List of dict for each logical CPU, with keys ``cpu_id``,
+        ``socket_id``, ``numa_node_id``, ``core_id``, ``l3_cache_id`` and
+        ``is_smt_sibling`` (True if the CPU is not the first hardware thread
+        of its physical core).
+    """
+
+    return ipex._C.get_cpu_topology()
 
 def get_core_list_of_node_id(node_id):
     r"""
@@ -14,10 +28,154 @@ def get_core_list_of_node_id(node_id):
         node_id (int): Input numa node id.
 
     Returns:
-        list: List of CPU cores' ids on this numa node.
+        list: List of CPU cores' ids on this numa node. Only the first
+        hardware thread of each physical core is included.
+    """
+
+    node_ids = ipex._C.get_numa_node_ids()
+    assert node_id in node_ids, "input node_id:{0} must be one of the system numa nodes:{1}".format(node_id, node_ids)
+    return ipex._C.get_core_list_of_node_id(node_id)
+
+def set_numa_weight_replica_enabled(enabled):
+    r"""
+    Enable or disable the NUMA-local replicas of the prepacked weights of
+    convolution and linear. When enabled, the first run of such an op on a
+    :class:`CPUPool` whose cores are on a single numa node copies the packed
+    weight to the memory of that numa node, and the later runs on the same
+    numa node read the local copy. This avoids the cross-socket weight traffic
+    of :class:`MultiStreamModule` when its streams span several sockets. The
+    replicas are refreshed automatically after the weights are updated. It's
+    disabled by default, and can also be enabled by the environment variable
+    ``IPEX_NUMA_WEIGHT_REPLICA=1``.
+
+    Args:
+        enabled (bool): Whether to enable the NUMA-local weight replicas.
+    """
+
+    ipex._C.set_numa_weight_replica_enabled(enabled)
+
+def is_numa_weight_replica_enabled():
+    r"""
+    Returns:
+        bool: Whether the NUMA-local weight replicas are enabled.
+    """
+
+    return ipex._C.is_numa_weight_replica_enabled()
+
+def set_shared_primitive_cache_enabled(enabled):
+    r"""
+    Enable or disable the process-wide cache of the oneDNN primitives of
+    convolution, linear and matmul. By default each thread keeps its own
+    cache, so every stream of :class:`MultiStreamModule` or thread of
+    :class:`Task` creates the same primitives again on its first run. When
+    enabled, the primitives created by any thread are reused by all the
+    others. It can also be enabled by the environment variable
+    ``IDEEP_SHARED_COMPUTATION_CACHE=1``, and the capacity of the cache of
+    each op is read from ``LRU_CACHE_CAPACITY`` (1024 by default).
+
+    Args:
+        enabled (bool): Whether to enable the shared primitive cache.
+    """
+
+    ipex._C._set_shared_primitive_cache_enabled(enabled)
+
+def is_shared_primitive_cache_enabled():
+    r"""
+    Returns:
+        bool: Whether the shared primitive cache is enabled.
+    """
+
+    return ipex._C._is_shared_primitive_cache_enabled()
+
+def get_shared_primitive_cache_stats():
+    r"""
+    Returns:
+        dict: For each op with a shared primitive cache, a dict with keys
+        ``hits``, ``misses``, ``evictions`` and ``num_entries``.
+    """
+
+    return ipex._C._get_shared_primitive_cache_stats()
+
+def warm_up_shared_primitive_cache(module, example_inputs, num_threads=None):
+    r"""
+    Enable the shared primitive cache and create the primitives of ``module``
+    for ``example_inputs`` ahead of the first request, by running it once.
+    The primitives depend on the number of OpenMP threads, so ``num_threads``
+    should be the number of cores of each stream which runs ``module``.
+
+    Args:
+        module (torch.nn.Module or torch.jit.ScriptModule): The module to run.
+        example_inputs (tuple): The inputs to run the module with.
+        num_threads (int): The number of OpenMP threads of the warm-up run.
+            Default: the current number of threads.
+    """
+
+    set_shared_primitive_cache_enabled(True)
+    if not isinstance(example_inputs, tuple):
+        example_inputs = (example_inputs,)
+    origin_num_threads = torch.get_num_threads()
+    if num_threads is not None:
+        torch.set_num_threads(num_threads)
+    try:
+        with torch.no_grad():
+            module(*example_inputs)
+    finally:
+        torch.set_num_threads(origin_num_threads)
+
+def set_caching_allocator_enabled(enabled):
+    r"""
+    Enable or disable the caching allocator of the ideep tensors (such as the
+    prepacked weights and the oneDNN buffers) and the outputs of IPEX linear
+    and LLGA fusion groups. The freed blocks are kept in size classes and
+    reused, so the steady state of inference doesn't allocate memory from the
+    OS. The blocks allocated by a thread pinned to a :class:`CPUPool` are
+    bound to the numa node of the pool. It's disabled by default, and can
+    also be enabled by the environment variable ``IPEX_CACHING_ALLOCATOR=1``.
+    It should be set before the model is optimized and run.
+
+    Args:
+        enabled (bool): Whether to enable the caching allocator.
+    """
+
+    ipex._C._set_caching_allocator_enabled(enabled)
+
+def is_caching_allocator_enabled():
+    r"""
+    Returns:
+        bool: Whether the caching allocator is enabled.
+    """
+
+    return ipex._C._is_caching_allocator_enabled()
+
+def set_caching_allocator_huge_pages_enabled(enabled):
+    r"""
+    Enable or disable the transparent huge pages of the blocks from 2MB of
+    the caching allocator. It can also be enabled by the environment
+    variable ``IPEX_CACHING_ALLOCATOR_HUGE_PAGES=1``.
+
+    Args:
+        enabled (bool): Whether to back the large blocks by huge pages.
+    """
+
+    ipex._C._set_caching_allocator_huge_pages_enabled(enabled)
+
+def get_caching_allocator_stats():
+    r"""
+    Returns:
+        dict: The stats of the caching allocator, with keys
+        ``requested_bytes`` and ``allocated_bytes`` (of the live allocations,
+        the difference is the internal fragmentation of the size classes),
+        ``cached_bytes`` (of the free blocks), ``reserved_bytes`` (from the
+        OS), ``peak_allocated_bytes``, ``peak_reserved_bytes``,
+        ``num_os_allocations`` and ``num_os_frees``.
+    """
+
+    return ipex._C._get_caching_allocator_stats()
+
+def empty_caching_allocator_cache():
+    r"""
+    Release the free blocks of the caching allocator to the OS, except the
+    ones cached by the other threads.
     """
 
-    num_of_nodes = get_num_nodes()
-    assert node_id < num_of_nodes, "input node_id:{0} must less than system number of nodes:{1}".format(node_id, num_of_nodes)
-    num_cores_per_node = get_num_cores_per_node()
-    return list(range(num_cores_per_node * node_id, num_cores_per_node * (node_id + 1)))
+    ipex._C._empty_caching_allocator_cache()
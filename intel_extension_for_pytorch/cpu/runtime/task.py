@@ -15,19 +15,23 @@ class Task(object):
         cpu_pool (intel_extension_for_pytorch.cpu.runtime.CPUPool): An
             intel_extension_for_pytorch.cpu.runtime.CPUPool object, contains
             all CPU cores used to run Task asynchronously.
+        work_stealing (bool): A flag indicates whether the idle workers of
+            other Tasks on the same numa node with work_stealing enabled are
+            allowed to steal the pending executions of this Task. The default
+            value is False.
 
     Returns:
         intel_extension_for_pytorch.cpu.runtime.Task: Generated
         intel_extension_for_pytorch.cpu.runtime.Task object.
     """
 
-    def __init__(self, module, cpu_pool: CPUPool):
+    def __init__(self, module, cpu_pool: CPUPool, work_stealing: bool = False):
         self.cpu_pool = cpu_pool
         assert type(self.cpu_pool) is CPUPool
         if isinstance(module, torch.jit.ScriptModule):
-            self._task = ipex._C.TaskModule(module._c, self.cpu_pool.core_ids, True)
+            self._task = ipex._C.TaskModule(module._c, self.cpu_pool.core_ids, True, work_stealing, self.cpu_pool.bind_memory)
         else:
-            self._task = ipex._C.TaskModule(module, self.cpu_pool.core_ids)
+            self._task = ipex._C.TaskModule(module, self.cpu_pool.core_ids, work_stealing, self.cpu_pool.bind_memory)
 
     def __call__(self, *args, **kwargs):
         # async execution
@@ -36,3 +40,7 @@ class Task(object):
     def run_sync(self, *args, **kwargs):
         # sync execution
         return self._task.run_sync(*args, **kwargs)
+
+    def get_num_stolen_tasks(self):
+        # number of the executions of other Tasks stolen by this Task
+        return self._task.get_num_stolen_tasks()
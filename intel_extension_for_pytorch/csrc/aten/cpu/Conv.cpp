@@ -3,6 +3,7 @@
 #include "WeightPack.h"
 #include "csrc/autocast/autocast_mode.h"
 #include "csrc/cpu/ideep/IDeepConversions.h"
+#include "csrc/cpu/runtime/StaticMemoryPlan.h"
 #include "csrc/utils/ipex_op_profile.h"
 #include "utils/utils.h"
 
@@ -122,7 +123,7 @@ at::Tensor convolution_kernel(
 
   at::Tensor output;
   if (input.dim() != 3) {
-    output = at::empty(
+    output = runtime::empty_planned_output(
         output_sizes,
         input.options().memory_format(input.suggest_memory_format()));
   } else {
@@ -130,7 +131,8 @@ at::Tensor convolution_kernel(
     // in PyTorch. We will force to return nwc output.
     std::vector<int64_t> output_strides = {
         (output_sizes[1] * output_sizes[2]), 1, output_sizes[1]};
-    output = at::empty_strided(output_sizes, output_strides, input.options());
+    output = runtime::empty_strided_planned_output(
+        output_sizes, output_strides, input.options());
   }
 
   convolution_kernel_output(
@@ -1,4 +1,5 @@
 #include "EmbeddingBag.h"
+#include "MmapEmbeddingBag.h"
 #include "csrc/autocast/autocast_mode.h"
 #include "csrc/jit/cpu/kernels/Embeddingbag.h"
 #include "csrc/quantization/AutoCast.hpp"
@@ -22,6 +23,7 @@ namespace cpu {
 DEFINE_DISPATCH(embedding_bag_kernel_stub);
 DEFINE_DISPATCH(embedding_bag_backward_kernel_stub);
 DEFINE_DISPATCH(embedding_bag_int8_kernel_stub);
+DEFINE_DISPATCH(embedding_bag_mmap_kernel_stub);
 
 class NewEmbeddingBagOp : public torch::autograd::Function<NewEmbeddingBagOp> {
  public:
@@ -122,6 +124,54 @@ at::Tensor dil_qembeddingbag(
       kCPU, weight, indices, offsets, include_last_offset);
 }
 
+at::Tensor mmap_embedding_bag(
+    const c10::intrusive_ptr<MmapEmbeddingTable>& table,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    int64_t pooling_mode,
+    bool include_last_offset) {
+  IPEX_RECORD_FUNCTION("mmap_embedding_bag", std::vector<c10::IValue>({}));
+
+  TORCH_CHECK(
+      pooling_mode == MODE_SUM || pooling_mode == MODE_MEAN,
+      "mmap_embedding_bag: only support sum and mean pooling");
+  TORCH_CHECK(
+      indices.dim() == 1 && offsets.dim() == 1,
+      "mmap_embedding_bag: expect 1D indices and offsets");
+  auto _indices = indices.to(at::kLong).contiguous();
+  auto _offsets = offsets.to(at::kLong).contiguous();
+  if (!include_last_offset) {
+    _offsets = at::cat(
+        {_offsets, at::full({1}, _indices.numel(), _offsets.options())});
+  }
+  auto num_offsets = _offsets.numel();
+  TORCH_CHECK(num_offsets >= 1, "mmap_embedding_bag: expect the last offset");
+  auto offsets_data = _offsets.data_ptr<int64_t>();
+  TORCH_CHECK(
+      offsets_data[0] >= 0 &&
+          offsets_data[num_offsets - 1] <= _indices.numel() &&
+          (num_offsets == 1 ||
+           at::all(_offsets.slice(0, 1).ge(
+                       _offsets.slice(0, 0, num_offsets - 1)))
+               .item<bool>()),
+      "mmap_embedding_bag: expect non-decreasing offsets into the indices");
+
+  table->update_cache(_indices);
+  // Another thread may update the cache between, the rows are looked up
+  // again under the lock.
+  std::shared_lock<std::shared_timed_mutex> lock(table->mutex());
+  auto output = at::empty(
+      {num_offsets - 1, table->embedding_dim()},
+      at::TensorOptions().dtype(table->dtype()));
+  /*
+  pointer to embedding_bag_mmap_kernel_impl(
+      table, indices, offsets, pooling_mode, output);
+  */
+  embedding_bag_mmap_kernel_stub(
+      kCPU, *table, _indices, _offsets, pooling_mode, output);
+  return output;
+}
+
 } // namespace cpu
 } // namespace torch_ipex
 
@@ -133,6 +183,14 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
           "offsets, bool sparse, bool include_last_offset) -> Tensor",
           c10::AliasAnalysisKind::PURE_FUNCTION),
       torch_ipex::embedding_bag);
+  m.def(
+      "mmap_embedding_bag(__torch__.torch.classes.torch_ipex."
+      "MmapEmbeddingTable table, Tensor indices, Tensor offsets, "
+      "int pooling_mode, bool include_last_offset) -> Tensor");
+  m.impl(
+      "mmap_embedding_bag",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::mmap_embedding_bag);
 }
 } // namespace
 
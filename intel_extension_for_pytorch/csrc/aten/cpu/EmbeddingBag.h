@@ -26,6 +26,17 @@ at::Tensor embedding_bag(
 namespace torch_ipex {
 namespace cpu {
 
+class MmapEmbeddingTable;
+
+// nn.EmbeddingBag (sum or mean) over a memory-mapped table with 1D indices and
+// offsets, it updates the cache of the table first.
+at::Tensor mmap_embedding_bag(
+    const c10::intrusive_ptr<MmapEmbeddingTable>& table,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    int64_t pooling_mode,
+    bool include_last_offset);
+
 namespace {
 
 at::Tensor embedding_bag_kernel_impl(
@@ -47,6 +58,13 @@ at::Tensor embedding_bag_int8_kernel_impl(
     const at::Tensor& offsets,
     bool include_last_offset);
 
+void embedding_bag_mmap_kernel_impl(
+    const MmapEmbeddingTable& table,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    int64_t pooling_mode,
+    at::Tensor& output);
+
 } // namespace
 
 using embedding_bag_kernel_fn = at::Tensor (*)(
@@ -73,5 +91,13 @@ using embedding_bag_int8_kernel_fn = at::Tensor (*)(
     bool);
 DECLARE_DISPATCH(embedding_bag_int8_kernel_fn, embedding_bag_int8_kernel_stub);
 
+using embedding_bag_mmap_kernel_fn = void (*)(
+    const MmapEmbeddingTable&,
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    at::Tensor&);
+DECLARE_DISPATCH(embedding_bag_mmap_kernel_fn, embedding_bag_mmap_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,25 @@
+#include "FlashAttention.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(flash_attention_kernel_stub);
+
+at::Tensor FlashAttention(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& mask,
+    const float& scale,
+    const bool& mask_fill,
+    const float& fill) {
+  /*
+  pointer to flash_attention_kernel_impl(
+      query, key, value, mask, scale, mask_fill, fill);
+  */
+  return flash_attention_kernel_stub(
+      kCPU, query, key, value, mask, scale, mask_fill, fill);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <csrc/dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Compute softmax(query * key^T * scale (+ mask)) * value block by block with
+// an online softmax, the [B, H, M, N] attention scores are never
+// materialized.
+//   query: [B, H, M, D]
+//   key:   [B, H, N, D]
+//   value: [B, H, N, Dv]
+//   mask:  undefined, or broadcastable to [B, H, M, N]. It's added to the
+//          scaled scores, or if mask_fill is true, the scores where mask is
+//          not zero are filled with fill.
+// The output is a contiguous [B, H, M, Dv] tensor of the dtype of query.
+at::Tensor FlashAttention(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& mask,
+    const float& scale,
+    const bool& mask_fill,
+    const float& fill);
+
+namespace {
+
+at::Tensor flash_attention_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& mask,
+    const float& scale,
+    const bool& mask_fill,
+    const float& fill);
+
+}
+
+using flash_attention_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const float&,
+    const bool&,
+    const float&);
+DECLARE_DISPATCH(flash_attention_kernel_fn, flash_attention_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
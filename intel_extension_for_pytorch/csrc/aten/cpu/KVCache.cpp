@@ -0,0 +1,289 @@
+#include "KVCache.h"
+
+#include <torch/library.h>
+
+#include "csrc/utils/ipex_op_profile.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(kv_cache_append_kernel_stub);
+DEFINE_DISPATCH(kv_cache_attention_kernel_stub);
+
+namespace {
+
+at::Tensor optional_to_tensor(const c10::optional<at::Tensor>& t) {
+  return t.has_value() ? t.value() : at::Tensor();
+}
+
+void check_kv_cache(
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& key_scale,
+    const at::Tensor& value_scale,
+    const at::Tensor& block_table) {
+  TORCH_CHECK(
+      key_cache.dim() == 4 && value_cache.dim() == 4,
+      "kv_cache: expect 4D key_cache and value_cache");
+  TORCH_CHECK(
+      key_cache.size(0) == value_cache.size(0) &&
+          key_cache.size(1) == value_cache.size(1) &&
+          key_cache.size(2) == value_cache.size(2),
+      "kv_cache: the blocks of key_cache and value_cache don't match");
+  TORCH_CHECK(
+      key_cache.is_contiguous() && value_cache.is_contiguous(),
+      "kv_cache: expect contiguous key_cache and value_cache");
+  auto cache_type = key_cache.scalar_type();
+  TORCH_CHECK(
+      cache_type == at::kFloat || cache_type == at::kBFloat16 ||
+          cache_type == at::kChar,
+      "kv_cache: only support float, bfloat16 and int8 caches");
+  TORCH_CHECK(
+      value_cache.scalar_type() == cache_type,
+      "kv_cache: expect key_cache and value_cache of the same dtype");
+  if (cache_type == at::kChar) {
+    TORCH_CHECK(
+        key_scale.defined() && value_scale.defined(),
+        "kv_cache: int8 caches need key_scale and value_scale");
+    for (const auto& cache_scale : {key_scale, value_scale}) {
+      TORCH_CHECK(
+          cache_scale.scalar_type() == at::kFloat &&
+              cache_scale.is_contiguous() &&
+              cache_scale.sizes() == key_cache.sizes().slice(0, 3),
+          "kv_cache: expect contiguous float scales of "
+          "[num_blocks, num_heads, block_size]");
+    }
+  }
+  TORCH_CHECK(block_table.dim() == 2, "kv_cache: expect 2D block_table");
+}
+
+// Check that the first num_tokens[b] tokens of each sequence are mapped to
+// the cache blocks.
+void check_block_table(
+    const at::Tensor& block_table,
+    const at::Tensor& num_tokens,
+    int64_t block_size,
+    int64_t num_blocks) {
+  auto table = block_table.accessor<int64_t, 2>();
+  auto lens = num_tokens.accessor<int64_t, 1>();
+  for (int64_t b = 0; b < lens.size(0); b++) {
+    int64_t seq_blocks = (lens[b] + block_size - 1) / block_size;
+    TORCH_CHECK(
+        lens[b] >= 0 && seq_blocks <= table.size(1),
+        "kv_cache: the length of sequence ",
+        b,
+        " exceeds the block_table");
+    for (int64_t i = 0; i < seq_blocks; i++) {
+      TORCH_CHECK(
+          table[b][i] >= 0 && table[b][i] < num_blocks,
+          "kv_cache: block ",
+          i,
+          " of sequence ",
+          b,
+          " is not allocated");
+    }
+  }
+}
+
+at::Tensor to_long(const at::Tensor& t) {
+  return t.to(at::kLong).contiguous();
+}
+
+} // namespace
+
+at::Tensor kv_cache_append_(
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    const c10::optional<at::Tensor>& key_scale,
+    const c10::optional<at::Tensor>& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& seq_lens) {
+  IPEX_RECORD_FUNCTION("kv_cache_append_", std::vector<c10::IValue>({}));
+
+  auto _key_scale = optional_to_tensor(key_scale);
+  auto _value_scale = optional_to_tensor(value_scale);
+  check_kv_cache(key_cache, value_cache, _key_scale, _value_scale, block_table);
+  TORCH_CHECK(
+      key.dim() == 4 && value.dim() == 4 && key.size(2) == 1 &&
+          value.size(2) == 1,
+      "kv_cache_append_: expect key and value of [batch_size, num_heads, 1, "
+      "head_dim]");
+  int64_t batch_size = key.size(0);
+  TORCH_CHECK(
+      value.size(0) == batch_size && key.size(1) == key_cache.size(1) &&
+          value.size(1) == key_cache.size(1) &&
+          key.size(3) == key_cache.size(3) &&
+          value.size(3) == value_cache.size(3),
+      "kv_cache_append_: the shape of key or value doesn't match the caches");
+  TORCH_CHECK(
+      seq_lens.dim() == 1 && seq_lens.size(0) == batch_size &&
+          block_table.size(0) == batch_size,
+      "kv_cache_append_: expect seq_lens and block_table of batch_size rows");
+
+  auto _block_table = to_long(block_table);
+  auto _seq_lens = to_long(seq_lens);
+  auto context_lens = _seq_lens + 1;
+  check_block_table(
+      _block_table, context_lens, key_cache.size(2), key_cache.size(0));
+  /*
+  pointer to kv_cache_append_kernel_impl(
+      key, value, key_cache, value_cache, key_scale, value_scale,
+      block_table, seq_lens);
+  */
+  kv_cache_append_kernel_stub(
+      kCPU,
+      key.contiguous(),
+      value.contiguous(),
+      key_cache,
+      value_cache,
+      _key_scale,
+      _value_scale,
+      _block_table,
+      _seq_lens);
+  return context_lens;
+}
+
+at::Tensor kv_cache_attention(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const c10::optional<at::Tensor>& key_scale,
+    const c10::optional<at::Tensor>& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& context_lens,
+    double scale,
+    const c10::optional<at::Tensor>& attention_mask) {
+  IPEX_RECORD_FUNCTION("kv_cache_attention", std::vector<c10::IValue>({}));
+
+  auto _key_scale = optional_to_tensor(key_scale);
+  auto _value_scale = optional_to_tensor(value_scale);
+  check_kv_cache(key_cache, value_cache, _key_scale, _value_scale, block_table);
+  TORCH_CHECK(
+      query.dim() == 4 && query.size(2) == 1,
+      "kv_cache_attention: expect query of [batch_size, num_heads, 1, "
+      "head_dim]");
+  TORCH_CHECK(
+      query.scalar_type() == at::kFloat || query.scalar_type() == at::kBFloat16,
+      "kv_cache_attention: only support float and bfloat16 query");
+  int64_t batch_size = query.size(0);
+  TORCH_CHECK(
+      query.size(1) == key_cache.size(1) && query.size(3) == key_cache.size(3),
+      "kv_cache_attention: the shape of query doesn't match the caches");
+  TORCH_CHECK(
+      context_lens.dim() == 1 && context_lens.size(0) == batch_size &&
+          block_table.size(0) == batch_size,
+      "kv_cache_attention: expect context_lens and block_table of batch_size "
+      "rows");
+
+  auto _block_table = to_long(block_table);
+  auto _context_lens = to_long(context_lens);
+  check_block_table(
+      _block_table, _context_lens, key_cache.size(2), key_cache.size(0));
+
+  // View the mask as [1 or batch_size, max_context_len].
+  at::Tensor mask;
+  if (attention_mask.has_value()) {
+    const auto& _mask = attention_mask.value();
+    TORCH_CHECK(_mask.dim() >= 1, "kv_cache_attention: invalid mask");
+    int64_t mask_batch = _mask.dim() > 1 ? _mask.size(0) : 1;
+    TORCH_CHECK(
+        (mask_batch == 1 || mask_batch == batch_size) &&
+            _mask.numel() == mask_batch * _mask.size(-1) &&
+            _mask.size(-1) >= _context_lens.max().item<int64_t>(),
+        "kv_cache_attention: expect attention_mask broadcastable to "
+        "[batch_size, 1, 1, max_context_len]");
+    mask = _mask.reshape({mask_batch, _mask.size(-1)})
+               .to(at::kFloat)
+               .contiguous();
+  }
+  /*
+  pointer to kv_cache_attention_kernel_impl(
+      query, key_cache, value_cache, key_scale, value_scale, block_table,
+      context_lens, scale, attention_mask);
+  */
+  return kv_cache_attention_kernel_stub(
+      kCPU,
+      query.contiguous(),
+      key_cache,
+      value_cache,
+      _key_scale,
+      _value_scale,
+      _block_table,
+      _context_lens,
+      static_cast<float>(scale),
+      mask);
+}
+
+at::Tensor kv_cache_decode_attention(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    const c10::optional<at::Tensor>& key_scale,
+    const c10::optional<at::Tensor>& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& seq_lens,
+    double scale,
+    const c10::optional<at::Tensor>& attention_mask) {
+  IPEX_RECORD_FUNCTION(
+      "kv_cache_decode_attention", std::vector<c10::IValue>({}));
+
+  auto context_lens = kv_cache_append_(
+      key,
+      value,
+      key_cache,
+      value_cache,
+      key_scale,
+      value_scale,
+      block_table,
+      seq_lens);
+  return kv_cache_attention(
+      query,
+      key_cache,
+      value_cache,
+      key_scale,
+      value_scale,
+      block_table,
+      context_lens,
+      scale,
+      attention_mask);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "kv_cache_append_(Tensor key, Tensor value, Tensor(a!) key_cache, "
+      "Tensor(b!) value_cache, Tensor(c!)? key_scale, Tensor(d!)? value_scale, "
+      "Tensor block_table, Tensor seq_lens) -> Tensor");
+  m.impl(
+      "kv_cache_append_",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::kv_cache_append_);
+  m.def(
+      "kv_cache_attention(Tensor query, Tensor key_cache, Tensor value_cache, "
+      "Tensor? key_scale, Tensor? value_scale, Tensor block_table, "
+      "Tensor context_lens, float scale, Tensor? attention_mask=None) "
+      "-> Tensor");
+  m.impl(
+      "kv_cache_attention",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::kv_cache_attention);
+  m.def(
+      "kv_cache_decode_attention(Tensor query, Tensor key, Tensor value, "
+      "Tensor(a!) key_cache, Tensor(b!) value_cache, Tensor(c!)? key_scale, "
+      "Tensor(d!)? value_scale, Tensor block_table, Tensor seq_lens, "
+      "float scale, Tensor? attention_mask=None) -> Tensor");
+  m.impl(
+      "kv_cache_decode_attention",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::kv_cache_decode_attention);
+}
+
+} // namespace
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <csrc/dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+/*
+The paged KV cache of the autoregressive decoding. The K/V of the tokens are
+stored in fixed-size blocks:
+  key_cache:   [num_blocks, num_heads, block_size, head_dim]
+  value_cache: [num_blocks, num_heads, block_size, v_head_dim]
+block_table [batch_size, max_blocks_per_seq] maps the i-th block of a sequence
+to the index of a block in the caches, so a sequence grows by taking a free
+block without moving the K/V which are already cached.
+
+The caches are float, BFloat16 or int8. For int8 caches, key_scale and
+value_scale [num_blocks, num_heads, block_size] hold the symmetric scale of
+each token and head.
+*/
+
+// Write the key/value [batch_size, num_heads, 1, head_dim] of the new token
+// of each sequence at the position seq_lens[b] of its blocks. Return
+// seq_lens + 1.
+at::Tensor kv_cache_append_(
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    const c10::optional<at::Tensor>& key_scale,
+    const c10::optional<at::Tensor>& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& seq_lens);
+
+// Attention of the query [batch_size, num_heads, 1, head_dim] over the first
+// context_lens[b] cached tokens of each sequence. attention_mask is added to
+// the scaled scores, its last dim indexes the tokens and it's broadcastable
+// to [batch_size, 1, 1, max_context_len].
+at::Tensor kv_cache_attention(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const c10::optional<at::Tensor>& key_scale,
+    const c10::optional<at::Tensor>& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& context_lens,
+    double scale,
+    const c10::optional<at::Tensor>& attention_mask);
+
+// kv_cache_append_ followed by kv_cache_attention over seq_lens + 1 tokens,
+// i.e. one decoding step of an attention layer.
+at::Tensor kv_cache_decode_attention(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    const c10::optional<at::Tensor>& key_scale,
+    const c10::optional<at::Tensor>& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& seq_lens,
+    double scale,
+    const c10::optional<at::Tensor>& attention_mask);
+
+namespace {
+
+void kv_cache_append_kernel_impl(
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    at::Tensor& key_scale,
+    at::Tensor& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& seq_lens);
+
+at::Tensor kv_cache_attention_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& key_scale,
+    const at::Tensor& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& context_lens,
+    const float& scale,
+    const at::Tensor& attention_mask);
+
+} // namespace
+
+using kv_cache_append_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&);
+DECLARE_DISPATCH(kv_cache_append_kernel_fn, kv_cache_append_kernel_stub);
+
+using kv_cache_attention_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const float&,
+    const at::Tensor&);
+DECLARE_DISPATCH(kv_cache_attention_kernel_fn, kv_cache_attention_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -5,6 +5,7 @@
 #include "WeightPack.h"
 #include "csrc/autocast/autocast_mode.h"
 #include "csrc/cpu/ideep/IDeepConversions.h"
+#include "csrc/cpu/runtime/StaticMemoryPlan.h"
 #include "csrc/utils/ipex_op_profile.h"
 
 namespace torch_ipex {
@@ -79,7 +80,7 @@ at::Tensor linear_kernel(
   auto input_size = self.sizes();
   std::vector<int64_t> output_size(input_size.begin(), input_size.end() - 1);
   output_size.push_back(mkldnn_weight.get_dim(0));
-  auto output = at::empty(output_size, self.options());
+  auto output = runtime::empty_planned_output(output_size, self.options());
   linear_kernel_output(self, mkldnn_weight, bias, output, attr);
   return output;
 }
@@ -21,6 +21,71 @@ struct SGDArgs {
   float lr;
 };
 
+// Adagrad with one state per element, or per row if it's row-wise, whose
+// state of a row is the mean of the squared grads of the row.
+struct AdagradArgs {
+  AdagradArgs(
+      const std::vector<Tensor>& bf16_trail_,
+      const std::vector<Tensor>& state_sum_,
+      float eps_,
+      float weight_decay_,
+      float lr_)
+      : bf16_trail(bf16_trail_),
+        state_sum(state_sum_),
+        eps(eps_),
+        weight_decay(weight_decay_),
+        lr(lr_) {}
+
+  std::vector<Tensor> bf16_trail;
+  std::vector<Tensor> state_sum;
+  float eps;
+  float weight_decay;
+  float lr;
+};
+
+struct RowwiseAdagradArgs : AdagradArgs {
+  using AdagradArgs::AdagradArgs;
+};
+
+// Adam, or LAMB whose trust ratio is the ratio of the norms of the row and of
+// its update.
+struct AdamArgs {
+  AdamArgs(
+      const std::vector<Tensor>& bf16_trail_,
+      const std::vector<Tensor>& exp_avg_,
+      const std::vector<Tensor>& exp_avg_sq_,
+      int64_t step_,
+      float beta1_,
+      float beta2_,
+      float eps_,
+      float weight_decay_,
+      float lr_,
+      bool use_lamb_)
+      : bf16_trail(bf16_trail_),
+        exp_avg(exp_avg_),
+        exp_avg_sq(exp_avg_sq_),
+        step(step_),
+        beta1(beta1_),
+        beta2(beta2_),
+        eps(eps_),
+        weight_decay(weight_decay_),
+        lr(lr_),
+        use_lamb(use_lamb_) {}
+
+  std::vector<Tensor> bf16_trail;
+  std::vector<Tensor> exp_avg;
+  std::vector<Tensor> exp_avg_sq;
+  int64_t step;
+  float beta1;
+  float beta2;
+  float eps;
+  float weight_decay;
+  float lr;
+  bool use_lamb;
+};
+
+// update() accumulates the grads of the row uniq_index_id and updates it, with
+// the buffer of 2 * vector_size values owned by the calling thread.
 template <typename T, typename optimizer_args_t>
 class AccGradUpdate {};
 
@@ -35,9 +100,55 @@ class AccGradUpdate<T, SGDArgs> {
       int64_t weight_offsets,
       int vector_size,
       int table_id,
+      acc_type<T, true>* buffer,
       const SGDArgs& args);
 };
 
+template <typename T>
+class AccGradUpdate<T, AdagradArgs> {
+ public:
+  static void update(
+      T* weight,
+      T* grad,
+      const BatchedHyperCompressedSparseColumn& batched_csc,
+      int64_t uniq_index_id,
+      int64_t weight_offsets,
+      int vector_size,
+      int table_id,
+      acc_type<T, true>* buffer,
+      const AdagradArgs& args);
+};
+
+template <typename T>
+class AccGradUpdate<T, RowwiseAdagradArgs> {
+ public:
+  static void update(
+      T* weight,
+      T* grad,
+      const BatchedHyperCompressedSparseColumn& batched_csc,
+      int64_t uniq_index_id,
+      int64_t weight_offsets,
+      int vector_size,
+      int table_id,
+      acc_type<T, true>* buffer,
+      const RowwiseAdagradArgs& args);
+};
+
+template <typename T>
+class AccGradUpdate<T, AdamArgs> {
+ public:
+  static void update(
+      T* weight,
+      T* grad,
+      const BatchedHyperCompressedSparseColumn& batched_csc,
+      int64_t uniq_index_id,
+      int64_t weight_offsets,
+      int vector_size,
+      int table_id,
+      acc_type<T, true>* buffer,
+      const AdamArgs& args);
+};
+
 std::vector<Tensor> merged_embeddingbag_forward_cpu_kernel_impl(
     const Tensor& indices,
     const Tensor& offsets,
@@ -56,6 +167,40 @@ void merged_embeddingbag_backward_sgd_cpu_kernel_impl(
     double weight_decay,
     double lr);
 
+void merged_embeddingbag_backward_adagrad_cpu_kernel_impl(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& bf16_trail,
+    const std::vector<Tensor>& state_sum,
+    bool rowwise,
+    double eps,
+    double weight_decay,
+    double lr);
+
+void merged_embeddingbag_backward_adam_cpu_kernel_impl(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& bf16_trail,
+    const std::vector<Tensor>& exp_avg,
+    const std::vector<Tensor>& exp_avg_sq,
+    int64_t step,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    double lr,
+    bool use_lamb);
+
 } // namespace
 
 using merged_embeddingbag_forward_cpu_kernel_fn = std::vector<Tensor> (*)(
@@ -82,5 +227,45 @@ DECLARE_DISPATCH(
     merged_embeddingbag_backward_sgd_cpu_kernel_fn,
     merged_embeddingbag_backward_sgd_cpu_kernel_stub);
 
+using merged_embeddingbag_backward_adagrad_cpu_kernel_fn = void (*)(
+    const std::vector<Tensor>&,
+    const Tensor&,
+    const Tensor&,
+    const std::vector<Tensor>&,
+    const Tensor&,
+    const Tensor&,
+    std::vector<int64_t>,
+    const std::vector<Tensor>&,
+    const std::vector<Tensor>&,
+    bool,
+    double,
+    double,
+    double);
+DECLARE_DISPATCH(
+    merged_embeddingbag_backward_adagrad_cpu_kernel_fn,
+    merged_embeddingbag_backward_adagrad_cpu_kernel_stub);
+
+using merged_embeddingbag_backward_adam_cpu_kernel_fn = void (*)(
+    const std::vector<Tensor>&,
+    const Tensor&,
+    const Tensor&,
+    const std::vector<Tensor>&,
+    const Tensor&,
+    const Tensor&,
+    std::vector<int64_t>,
+    const std::vector<Tensor>&,
+    const std::vector<Tensor>&,
+    const std::vector<Tensor>&,
+    int64_t,
+    double,
+    double,
+    double,
+    double,
+    double,
+    bool);
+DECLARE_DISPATCH(
+    merged_embeddingbag_backward_adam_cpu_kernel_fn,
+    merged_embeddingbag_backward_adam_cpu_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
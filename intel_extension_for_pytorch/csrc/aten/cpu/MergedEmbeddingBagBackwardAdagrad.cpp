@@ -0,0 +1,99 @@
+#include <c10/core/CPUAllocator.h>
+#include <omp.h>
+#include "MergedEmbeddingBag.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(merged_embeddingbag_backward_adagrad_cpu_kernel_stub);
+
+void merged_embeddingbag_backward_adagrad_cpu(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& bf16_trail,
+    const std::vector<Tensor>& state_sum,
+    bool rowwise,
+    double eps,
+    double weight_decay,
+    double lr) {
+  TORCH_CHECK(lr >= 0, "Expect lr >= 0.0, got ", lr);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+  TORCH_CHECK(
+      state_sum.size() == weights.size(),
+      "merged_embeddingbag_backward_adagrad: expect a state_sum per table");
+  for (size_t i = 0; i < weights.size(); i++) {
+    // The state of the BFloat16 weights is float.
+    auto state_type = weights[i].scalar_type() == at::kDouble ? at::kDouble
+                                                               : at::kFloat;
+    auto state_sizes = rowwise ? weights[i].sizes().slice(0, 1)
+                               : weights[i].sizes();
+    TORCH_CHECK(
+        state_sum[i].scalar_type() == state_type &&
+            state_sum[i].is_contiguous() &&
+            state_sum[i].sizes() == state_sizes,
+        "merged_embeddingbag_backward_adagrad: expect a contiguous ",
+        state_type,
+        " state_sum of ",
+        state_sizes,
+        " for table ",
+        i);
+  }
+  /*
+  pointer to merged_embeddingbag_backward_adagrad_cpu_kernel_impl(
+      grads_y_,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      bf16_trail,
+      state_sum,
+      rowwise,
+      eps,
+      weight_decay,
+      lr);
+  */
+  return merged_embeddingbag_backward_adagrad_cpu_kernel_stub(
+      kCPU,
+      grads_y_,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      bf16_trail,
+      state_sum,
+      rowwise,
+      eps,
+      weight_decay,
+      lr);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "merged_embeddingbag_backward_adagrad(Tensor[] grad, Tensor indices, "
+      "Tensor offsets, Tensor[] weight, Tensor indices_with_row_offset, "
+      "Tensor row_offsets, int[] pooling_modes, Tensor[] bf16_trail, "
+      "Tensor[] state_sum, bool rowwise, float eps, float weight_decay, "
+      "float lr) -> ()");
+  m.impl(
+      "merged_embeddingbag_backward_adagrad",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_backward_adagrad_cpu);
+}
+
+} // namespace
@@ -0,0 +1,115 @@
+#include <c10/core/CPUAllocator.h>
+#include <omp.h>
+#include "MergedEmbeddingBag.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(merged_embeddingbag_backward_adam_cpu_kernel_stub);
+
+void merged_embeddingbag_backward_adam_cpu(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& bf16_trail,
+    const std::vector<Tensor>& exp_avg,
+    const std::vector<Tensor>& exp_avg_sq,
+    int64_t step,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    double lr,
+    bool use_lamb) {
+  TORCH_CHECK(step >= 1, "Expect step >= 1, got ", step);
+  TORCH_CHECK(
+      beta1 >= 0 && beta1 < 1, "Expect 0.0 <= beta1 < 1.0, got ", beta1);
+  TORCH_CHECK(
+      beta2 >= 0 && beta2 < 1, "Expect 0.0 <= beta2 < 1.0, got ", beta2);
+  TORCH_CHECK(lr >= 0, "Expect lr >= 0.0, got ", lr);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+  TORCH_CHECK(
+      exp_avg.size() == weights.size() && exp_avg_sq.size() == weights.size(),
+      "merged_embeddingbag_backward_adam: expect an exp_avg and an exp_avg_sq "
+      "per table");
+  for (size_t i = 0; i < weights.size(); i++) {
+    // The states of the BFloat16 weights are float.
+    auto state_type = weights[i].scalar_type() == at::kDouble ? at::kDouble
+                                                               : at::kFloat;
+    for (const auto& state : {exp_avg[i], exp_avg_sq[i]}) {
+      TORCH_CHECK(
+          state.scalar_type() == state_type && state.is_contiguous() &&
+              state.sizes() == weights[i].sizes(),
+          "merged_embeddingbag_backward_adam: expect contiguous ",
+          state_type,
+          " states of the shape of table ",
+          i);
+    }
+  }
+  /*
+  pointer to merged_embeddingbag_backward_adam_cpu_kernel_impl(
+      grads_y_,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      bf16_trail,
+      exp_avg,
+      exp_avg_sq,
+      step,
+      beta1,
+      beta2,
+      eps,
+      weight_decay,
+      lr,
+      use_lamb);
+  */
+  return merged_embeddingbag_backward_adam_cpu_kernel_stub(
+      kCPU,
+      grads_y_,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      bf16_trail,
+      exp_avg,
+      exp_avg_sq,
+      step,
+      beta1,
+      beta2,
+      eps,
+      weight_decay,
+      lr,
+      use_lamb);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "merged_embeddingbag_backward_adam(Tensor[] grad, Tensor indices, "
+      "Tensor offsets, Tensor[] weight, Tensor indices_with_row_offset, "
+      "Tensor row_offsets, int[] pooling_modes, Tensor[] bf16_trail, "
+      "Tensor[] exp_avg, Tensor[] exp_avg_sq, int step, float beta1, "
+      "float beta2, float eps, float weight_decay, float lr, bool use_lamb) "
+      "-> ()");
+  m.impl(
+      "merged_embeddingbag_backward_adam",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_backward_adam_cpu);
+}
+
+} // namespace
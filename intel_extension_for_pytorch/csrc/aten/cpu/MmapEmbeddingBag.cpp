@@ -0,0 +1,269 @@
+#include "MmapEmbeddingBag.h"
+
+#include <c10/util/Exception.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <torch/library.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+// A row is admitted to the cache once it's accessed this many times.
+constexpr uint8_t kAdmitFrequency = 2;
+// Number of the slots from the clock hand whose least frequent row may be
+// evicted.
+constexpr int64_t kClockSamples = 8;
+} // namespace
+
+struct MmapEmbeddingTable::Mapping {
+  Mapping(const std::string& path, size_t nbytes) : nbytes(nbytes) {
+    int fd = open(path.c_str(), O_RDONLY);
+    TORCH_CHECK(
+        fd >= 0,
+        "MmapEmbeddingTable: failed to open ",
+        path,
+        ": ",
+        std::strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < nbytes) {
+      close(fd);
+      TORCH_CHECK(
+          false,
+          "MmapEmbeddingTable: expect at least ",
+          nbytes,
+          " bytes in ",
+          path);
+    }
+    // Private, so that the writes through the weight tensor don't reach the
+    // file.
+    void* ptr =
+        mmap(nullptr, nbytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    TORCH_CHECK(
+        ptr != MAP_FAILED,
+        "MmapEmbeddingTable: failed to map ",
+        path,
+        ": ",
+        std::strerror(errno));
+    data = static_cast<char*>(ptr);
+    // The rows are accessed randomly, reading ahead only wastes the DRAM.
+    madvise(data, nbytes, MADV_RANDOM);
+  }
+
+  ~Mapping() {
+    munmap(data, nbytes);
+  }
+
+  char* data;
+  size_t nbytes;
+};
+
+MmapEmbeddingTable::MmapEmbeddingTable(
+    const std::string& path,
+    int64_t num_rows,
+    int64_t embedding_dim,
+    c10::ScalarType dtype,
+    int64_t cache_rows)
+    : num_rows_(num_rows), embedding_dim_(embedding_dim), dtype_(dtype) {
+  TORCH_CHECK(
+      num_rows > 0 && embedding_dim > 0,
+      "MmapEmbeddingTable: expect positive num_rows and embedding_dim");
+  TORCH_CHECK(
+      dtype == at::kFloat || dtype == at::kBFloat16,
+      "MmapEmbeddingTable: only support float and bfloat16 tables");
+  TORCH_CHECK(cache_rows >= 0, "MmapEmbeddingTable: invalid cache_rows");
+  row_bytes_ = embedding_dim * c10::elementSize(dtype);
+  mapping_ = std::make_shared<Mapping>(path, num_rows_ * row_bytes_);
+  cache_rows_ = std::min(cache_rows, num_rows);
+  if (cache_rows_ > 0) {
+    cache_ = at::empty({cache_rows_, row_bytes_}, at::kByte);
+    slot_rows_.reserve(cache_rows_);
+    row_slots_.reserve(cache_rows_);
+    frequencies_.resize(num_rows_, 0);
+  }
+}
+
+MmapEmbeddingTable::~MmapEmbeddingTable() {
+  wait_prefetch();
+}
+
+at::Tensor MmapEmbeddingTable::get_weight() const {
+  auto mapping = mapping_;
+  return at::from_blob(
+      mapping->data,
+      {num_rows_, embedding_dim_},
+      [mapping](void*) {},
+      at::TensorOptions().dtype(dtype_));
+}
+
+void MmapEmbeddingTable::prefetch(const at::Tensor& indices) {
+  // Copied, the caller may reuse indices while the prefetch runs.
+  auto _indices = indices.to(at::kLong, false, true).contiguous();
+  std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+  prefetch_thread_ = std::thread([this, _indices]() {
+    static const int64_t page_size = sysconf(_SC_PAGESIZE);
+    auto indices_data = _indices.data_ptr<int64_t>();
+    // The pages [first, last] of the rows which aren't cached.
+    std::vector<std::pair<int64_t, int64_t>> pages;
+    {
+      std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+      for (int64_t i = 0; i < _indices.numel(); i++) {
+        auto row = indices_data[i];
+        if (row < 0 || row >= num_rows_ || row_slots_.count(row) > 0) {
+          continue;
+        }
+        pages.emplace_back(
+            row * row_bytes_ / page_size,
+            ((row + 1) * row_bytes_ - 1) / page_size);
+      }
+    }
+    std::sort(pages.begin(), pages.end());
+    // One madvise per run of adjacent pages, the kernel reads them
+    // asynchronously.
+    for (size_t i = 0; i < pages.size();) {
+      auto first = pages[i].first;
+      auto last = pages[i].second;
+      for (i++; i < pages.size() && pages[i].first <= last + 1; i++) {
+        last = std::max(last, pages[i].second);
+      }
+      madvise(
+          mapping_->data + first * page_size,
+          (last - first + 1) * page_size,
+          MADV_WILLNEED);
+    }
+  });
+}
+
+void MmapEmbeddingTable::wait_prefetch() {
+  std::lock_guard<std::mutex> prefetch_lock(prefetch_mutex_);
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+}
+
+void MmapEmbeddingTable::admit(int64_t row) {
+  int64_t slot;
+  if (static_cast<int64_t>(slot_rows_.size()) < cache_rows_) {
+    slot = slot_rows_.size();
+    slot_rows_.push_back(row);
+  } else {
+    slot = clock_hand_;
+    for (int64_t k = 1; k < kClockSamples; k++) {
+      auto candidate = (clock_hand_ + k) % cache_rows_;
+      if (frequencies_[slot_rows_[candidate]] <
+          frequencies_[slot_rows_[slot]]) {
+        slot = candidate;
+      }
+    }
+    clock_hand_ = (clock_hand_ + kClockSamples) % cache_rows_;
+    auto victim = slot_rows_[slot];
+    if (frequencies_[victim] >= frequencies_[row]) {
+      return;
+    }
+    row_slots_.erase(victim);
+    slot_rows_[slot] = row;
+    evictions_++;
+  }
+  std::memcpy(
+      cache_.data_ptr<uint8_t>() + slot * row_bytes_,
+      mapping_->data + row * row_bytes_,
+      row_bytes_);
+  row_slots_[row] = slot;
+  admissions_++;
+}
+
+void MmapEmbeddingTable::update_cache(const at::Tensor& indices) {
+  // The prefetch reads the cache under the shared lock, so it never sees a
+  // half updated cache and the lookup doesn't wait for its madvise.
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+  auto indices_data = indices.data_ptr<int64_t>();
+  for (int64_t i = 0; i < indices.numel(); i++) {
+    auto row = indices_data[i];
+    TORCH_CHECK(
+        row >= 0 && row < num_rows_,
+        "MmapEmbeddingTable: index ",
+        row,
+        " is out of the ",
+        num_rows_,
+        " rows");
+    if (cache_rows_ == 0) {
+      continue;
+    }
+    bool cached = row_slots_.count(row) > 0;
+    cached ? hits_++ : misses_++;
+    auto& frequency = frequencies_[row];
+    if (frequency < UINT8_MAX) {
+      frequency++;
+    }
+    if (!cached && frequency >= kAdmitFrequency) {
+      admit(row);
+    }
+    if (++accesses_since_aging_ >= num_rows_) {
+      for (auto& f : frequencies_) {
+        f >>= 1;
+      }
+      accesses_since_aging_ = 0;
+    }
+  }
+  if (cache_rows_ == 0) {
+    misses_ += indices.numel();
+  }
+}
+
+void MmapEmbeddingTable::get_rows(
+    const int64_t* indices,
+    int64_t size,
+    const char** rows) const {
+  const char* cache_data = cache_rows_ > 0
+      ? reinterpret_cast<const char*>(cache_.data_ptr<uint8_t>())
+      : nullptr;
+  for (int64_t i = 0; i < size; i++) {
+    auto row = indices[i];
+    auto it = row_slots_.find(row);
+    rows[i] = it != row_slots_.end() ? cache_data + it->second * row_bytes_
+                                     : mapping_->data + row * row_bytes_;
+  }
+}
+
+c10::Dict<std::string, int64_t> MmapEmbeddingTable::get_stats() const {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  c10::Dict<std::string, int64_t> stats;
+  stats.insert("hits", hits_);
+  stats.insert("misses", misses_);
+  stats.insert("cached_rows", static_cast<int64_t>(slot_rows_.size()));
+  stats.insert("admissions", admissions_);
+  stats.insert("evictions", evictions_);
+  return stats;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+using torch_ipex::cpu::MmapEmbeddingTable;
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.class_<MmapEmbeddingTable>("MmapEmbeddingTable")
+      .def(torch::init<
+           std::string,
+           int64_t,
+           int64_t,
+           c10::ScalarType,
+           int64_t>())
+      .def("get_weight", &MmapEmbeddingTable::get_weight)
+      .def("prefetch", &MmapEmbeddingTable::prefetch)
+      .def("wait_prefetch", &MmapEmbeddingTable::wait_prefetch)
+      .def("get_stats", &MmapEmbeddingTable::get_stats);
+}
+
+} // namespace
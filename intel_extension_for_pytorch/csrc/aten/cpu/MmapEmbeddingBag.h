@@ -0,0 +1,109 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <torch/custom_class.h>
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+/*
+An embedding table larger than the DRAM, backed by a file of
+[num_rows, embedding_dim] float or bfloat16 rows in row-major order (e.g. on a
+local NVMe or pmem) which is memory-mapped.
+
+The rows which are accessed frequently are copied into an in-DRAM cache of
+cache_rows rows. Each access increments a saturating counter of its row, the
+counters are halved each time num_rows accesses are counted, so that they
+follow the recent distribution. A row is admitted once it's accessed twice,
+into a free slot or in place of a less frequent row sampled by a clock hand.
+
+The cache is only updated by mmap_embedding_bag before it pools the bags, so
+the pooling and the asynchronous prefetch only read it.
+*/
+class MmapEmbeddingTable : public torch::jit::CustomClassHolder {
+ public:
+  MmapEmbeddingTable(
+      const std::string& path,
+      int64_t num_rows,
+      int64_t embedding_dim,
+      c10::ScalarType dtype,
+      int64_t cache_rows);
+  ~MmapEmbeddingTable();
+
+  // The whole mapped table, which can be used as the weight of the other
+  // embedding bag ops. It's copy-on-write, the writes are not saved to the
+  // file.
+  at::Tensor get_weight() const;
+
+  // Ask the kernel to read the pages of the rows of indices which aren't
+  // cached, in a background thread, e.g. for the next batch while the current
+  // batch runs.
+  void prefetch(const at::Tensor& indices);
+  void wait_prefetch();
+
+  // Count the accesses of the int64 indices and admit the hot rows.
+  void update_cache(const at::Tensor& indices);
+
+  // The address of each row of indices, the cached copy if any. It may run
+  // in parallel, but not with update_cache.
+  void get_rows(const int64_t* indices, int64_t size, const char** rows) const;
+
+  // hits, misses, cached_rows, admissions and evictions.
+  c10::Dict<std::string, int64_t> get_stats() const;
+
+  int64_t num_rows() const {
+    return num_rows_;
+  }
+  int64_t embedding_dim() const {
+    return embedding_dim_;
+  }
+  c10::ScalarType dtype() const {
+    return dtype_;
+  }
+  // Held shared by the pooling and exclusively by update_cache, so that the
+  // tables shared by multiple inference threads are consistent.
+  std::shared_timed_mutex& mutex() {
+    return mutex_;
+  }
+
+ private:
+  struct Mapping;
+
+  void admit(int64_t row);
+
+  int64_t num_rows_;
+  int64_t embedding_dim_;
+  c10::ScalarType dtype_;
+  int64_t row_bytes_;
+  // Shared with the tensors returned by get_weight.
+  std::shared_ptr<Mapping> mapping_;
+
+  int64_t cache_rows_;
+  // [cache_rows, row_bytes] uint8
+  at::Tensor cache_;
+  std::vector<int64_t> slot_rows_;
+  std::unordered_map<int64_t, int64_t> row_slots_;
+  int64_t clock_hand_ = 0;
+  std::vector<uint8_t> frequencies_;
+  int64_t accesses_since_aging_ = 0;
+
+  std::mutex prefetch_mutex_;
+  std::thread prefetch_thread_;
+  mutable std::shared_timed_mutex mutex_;
+
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+  int64_t admissions_ = 0;
+  int64_t evictions_ = 0;
+};
+
+} // namespace cpu
+} // namespace torch_ipex
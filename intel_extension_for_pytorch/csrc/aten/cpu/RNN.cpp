@@ -91,15 +91,9 @@ struct RNNParams {
   desc weights_layer_desc(int64_t _input_size, dtype dtype) const {
     return {{1, 1, _input_size, num_gates, hidden_size}, dtype, format::ldgoi};
   }
-  desc weights_layer_ldigo_desc(int64_t _input_size, dtype dtype) const {
-    return {{1, 1, _input_size, num_gates, hidden_size}, dtype, format::ldigo};
-  }
   desc weights_iter_desc(dtype dtype) const {
     return {{1, 1, hidden_size, num_gates, hidden_size}, dtype, format::ldgoi};
   }
-  desc weights_iter_ldigo_desc(dtype dtype) const {
-    return {{1, 1, hidden_size, num_gates, hidden_size}, dtype, format::ldigo};
-  }
   desc bias_desc(dtype dtype) const {
     return {{1, 1, num_bias_gates, hidden_size}, dtype, format::ldgo};
   }
@@ -147,16 +141,39 @@ std::vector<int64_t> _output_size(const RNNParams& rnn) {
 //                           +---------+
 //
 at::Tensor _shuffle_weight(const at::Tensor& weight, int64_t fn_mode) {
+  // The packed GRU weight is cached with the original weight as the key, so
+  // the weight itself is always in the PyTorch gates order.
+  if (static_cast<ideep::rnn_kind>(fn_mode) == ideep::rnn_kind::GRU) {
+    std::vector<at::Tensor> gates = weight.contiguous().chunk(3, /*gates*/ 0);
+    return at::cat({gates[1], gates[0], gates[2]}, /*gates*/ 0);
+  }
   if (torch_ipex::cpu::is_packed(weight))
     return weight;
+  return weight.contiguous();
+};
 
-  auto weight_t = weight.contiguous();
+// Map the gradients of the shuffled GRU weights and bias back to the PyTorch
+// gates order. Shuffling the gates of the weight is its own inverse, and the
+// gradients of zt and rt of the fused bias flow into both bias_ih and bias_hh.
+at::Tensor _unshuffle_weight_grad(const at::Tensor& grad, int64_t fn_mode) {
   if (static_cast<ideep::rnn_kind>(fn_mode) == ideep::rnn_kind::GRU) {
-    std::vector<at::Tensor> gates = weight_t.chunk(3, /*gates*/ 0);
+    std::vector<at::Tensor> gates = grad.chunk(3, /*gates*/ 0);
     return at::cat({gates[1], gates[0], gates[2]}, /*gates*/ 0);
   }
-  return weight_t;
-};
+  return grad;
+}
+
+std::tuple<at::Tensor, at::Tensor> _unshuffle_bias_grad(
+    const at::Tensor& grad,
+    int64_t fn_mode) {
+  if (static_cast<ideep::rnn_kind>(fn_mode) == ideep::rnn_kind::GRU) {
+    std::vector<at::Tensor> b = grad.chunk(4, /*output_channels*/ 0);
+    return std::make_tuple(
+        at::cat({b[1], b[0], b[2]}, /*output_channels*/ 0),
+        at::cat({b[1], b[0], b[3]}, /*output_channels*/ 0));
+  }
+  return std::make_tuple(grad, grad);
+}
 
 at::Tensor _shuffle_bias(
     const at::Tensor& bias_ih,
@@ -228,7 +245,8 @@ at::ScalarType get_bias_dtype(
  * \param weight_ih: the input-hidden INT8 aten weight tensor
  * \param weight_hh: the hidden-hidden INT8 aten weight tensor
  * \param input_size: the size of the input
- * \param rnn: the RNNParams struct
+ * \param num_gates: the number of gates of the RNN cell
+ * \param hidden_size: the size of the hidden state
  * \return: a tuple of ideep tensors: (input-hidden INT8 ideep tensor,
  * hidden-hidden INT8 ideep tensor)
  */
@@ -236,20 +254,29 @@ std::tuple<ideep::tensor, ideep::tensor> pack_qlstm_weight(
     const at::Tensor& weight_ih,
     const at::Tensor& weight_hh,
     int64_t input_size,
-    const RNNParams& rnn) {
-  // TODO: weight prepack for INT8
+    int64_t num_gates,
+    int64_t hidden_size) {
+  auto w1_dtype = get_mkldnn_dtype(weight_ih.scalar_type());
+  auto w2_dtype = get_mkldnn_dtype(weight_hh.scalar_type());
   auto w1_ldgoi = itensor_view_from_dense(
       weight_ih,
-      rnn.weights_layer_desc(
-          input_size, get_mkldnn_dtype(weight_ih.scalar_type())));
+      {{1, 1, input_size, num_gates, hidden_size},
+       w1_dtype,
+       ideep::format_tag::ldgoi});
   auto w2_ldgoi = itensor_view_from_dense(
       weight_hh,
-      rnn.weights_iter_desc(get_mkldnn_dtype(weight_hh.scalar_type())));
-
-  ideep::tensor::desc w1_ldigo_desc = rnn.weights_layer_ldigo_desc(
-      input_size, get_mkldnn_dtype(weight_ih.scalar_type()));
-  ideep::tensor::desc w2_ldigo_desc =
-      rnn.weights_iter_ldigo_desc(get_mkldnn_dtype(weight_hh.scalar_type()));
+      {{1, 1, hidden_size, num_gates, hidden_size},
+       w2_dtype,
+       ideep::format_tag::ldgoi});
+
+  ideep::tensor::desc w1_ldigo_desc = {
+      {1, 1, input_size, num_gates, hidden_size},
+      w1_dtype,
+      ideep::format_tag::ldigo};
+  ideep::tensor::desc w2_ldigo_desc = {
+      {1, 1, hidden_size, num_gates, hidden_size},
+      w2_dtype,
+      ideep::format_tag::ldigo};
 
   ideep::tensor w1{w1_ldigo_desc};
   ideep::tensor w2{w2_ldigo_desc};
@@ -316,12 +343,18 @@ std::vector<at::Tensor> lstm_kernel(
       train);
 
   at::ScalarType input_dt = input.scalar_type();
+  // GRU is computed by the linear-before-reset GRU of oneDNN, which has no
+  // cell state, cx_ and cy_ are empty tensors.
+  bool is_gru = rnn.mode == ideep::rnn_kind::GRU;
 
   auto hy_ = at::empty(hx_.sizes(), hx_.options());
   auto cy_ = at::empty(cx_.sizes(), cx_.options());
 
-  auto weight_ih = _shuffle_weight(w0, rnn.mode);
-  auto weight_hh = _shuffle_weight(w1, rnn.mode);
+  // The shuffle of the GRU weights is skipped if their packed weights are in
+  // the cache, see get_gru_packed_weight.
+  bool shuffle_weights = !is_gru || train;
+  auto weight_ih = shuffle_weights ? _shuffle_weight(w0, rnn.mode) : w0;
+  auto weight_hh = shuffle_weights ? _shuffle_weight(w1, rnn.mode) : w1;
 
   auto bias_dtype = get_bias_dtype(input, weight_ih);
   auto bias = has_biases ? _shuffle_bias(w2, w3, rnn.mode)
@@ -335,14 +368,17 @@ std::vector<at::Tensor> lstm_kernel(
       input, rnn.src_layer_desc(input_size, get_mkldnn_dtype(input_dt)));
   auto hx = torch_ipex::cpu::itensor_view_from_dense(
       hx_, rnn.src_iter_desc(get_mkldnn_dtype(hx_.scalar_type())));
-  auto cx = torch_ipex::cpu::itensor_view_from_dense(
-      cx_, rnn.src_iter_c_desc(get_mkldnn_dtype(cx_.scalar_type())));
   auto b = torch_ipex::cpu::itensor_view_from_dense(
       bias, rnn.bias_desc(get_mkldnn_dtype(bias.scalar_type())));
   auto hy = torch_ipex::cpu::itensor_view_from_dense(
       hy_, rnn.dst_iter_desc(get_mkldnn_dtype(hy_.scalar_type())));
-  auto cy = torch_ipex::cpu::itensor_view_from_dense(
-      cy_, rnn.dst_iter_c_desc(get_mkldnn_dtype(cy_.scalar_type())));
+  ideep::tensor cx, cy;
+  if (!is_gru) {
+    cx = torch_ipex::cpu::itensor_view_from_dense(
+        cx_, rnn.src_iter_c_desc(get_mkldnn_dtype(cx_.scalar_type())));
+    cy = torch_ipex::cpu::itensor_view_from_dense(
+        cy_, rnn.dst_iter_c_desc(get_mkldnn_dtype(cy_.scalar_type())));
+  }
 
   auto output_size = _output_size</*is_single_direction*/ true>(rnn);
   at::Tensor output;
@@ -352,9 +388,9 @@ std::vector<at::Tensor> lstm_kernel(
   double scale = -1.;
   int64_t zp = -1;
   if (input_dt == at::ScalarType::QUInt8) {
-    // TODO: weight prepack for INT8
-    std::tie(w1_, w2_) =
-        pack_qlstm_weight(weight_ih, weight_hh, input_size, rnn);
+    TORCH_CHECK(!is_gru, "INT8 GRU is not supported");
+    std::tie(w1_, w2_) = pack_qlstm_weight(
+        weight_ih, weight_hh, input_size, rnn.num_gates, rnn.hidden_size);
     std::tie(scale, zp) = int8::utils::get_mkldnn_input_scale_zp(input);
     weight_scales = get_mkldnn_weight_scales_of_lstm(weight_ih, weight_hh);
 
@@ -367,19 +403,32 @@ std::vector<at::Tensor> lstm_kernel(
             input_dt == at::ScalarType::BFloat16,
         "Expected input to be Float or BFloat16 but got ",
         input_dt);
-    std::tie(w1_, w2_) = torch_ipex::cpu::get_lstm_packed_weight(
-        weight_ih,
-        weight_hh,
-        input_size,
-        rnn.num_gates,
-        rnn.hidden_size,
-        {output_size.cbegin(), output_size.cend()},
-        x,
-        hx,
-        cx,
-        b,
-        reverse,
-        train);
+    if (is_gru && !train) {
+      std::tie(w1_, w2_) = torch_ipex::cpu::get_gru_packed_weight(
+          weight_ih,
+          weight_hh,
+          input_size,
+          rnn.hidden_size,
+          {output_size.cbegin(), output_size.cend()},
+          x,
+          hx,
+          b,
+          reverse);
+    } else {
+      std::tie(w1_, w2_) = torch_ipex::cpu::get_lstm_packed_weight(
+          weight_ih,
+          weight_hh,
+          input_size,
+          rnn.num_gates,
+          rnn.hidden_size,
+          {output_size.cbegin(), output_size.cend()},
+          x,
+          hx,
+          cx,
+          b,
+          reverse,
+          train);
+    }
 
     output = at::empty(output_size, input.options());
   }
@@ -390,20 +439,38 @@ std::vector<at::Tensor> lstm_kernel(
   std::vector<at::Tensor> result;
   if (train) {
     at::Tensor workspace = at::Tensor();
-    auto pd = ideep::lstm_forward_training::prepare(
-        x, hx, cx, w1_, w2_, b, y, hy, cy, reverse);
-    workspace = torch_ipex::cpu::empty_aten_tensor_from_desc(
-        pd.workspace_desc(), input.options().dtype(at::kByte));
     ideep::tensor mkldnn_workspace;
-    mkldnn_workspace.init(
-        pd.workspace_desc(), workspace.template data_ptr<uint8_t>());
-    ideep::lstm_forward_training::compute(
-        pd, x, hx, cx, w1_, w2_, b, mkldnn_workspace, y, hy, cy, reverse);
+    if (is_gru) {
+      auto pd = ideep::lbr_gru_forward_training::prepare(
+          x, hx, w1_, w2_, b, y, hy, reverse);
+      workspace = torch_ipex::cpu::empty_aten_tensor_from_desc(
+          pd.workspace_desc(), input.options().dtype(at::kByte));
+      mkldnn_workspace.init(
+          pd.workspace_desc(), workspace.template data_ptr<uint8_t>());
+      ideep::lbr_gru_forward_training::compute(
+          pd, x, hx, w1_, w2_, b, mkldnn_workspace, y, hy, reverse);
+    } else {
+      auto pd = ideep::lstm_forward_training::prepare(
+          x, hx, cx, w1_, w2_, b, y, hy, cy, reverse);
+      workspace = torch_ipex::cpu::empty_aten_tensor_from_desc(
+          pd.workspace_desc(), input.options().dtype(at::kByte));
+      mkldnn_workspace.init(
+          pd.workspace_desc(), workspace.template data_ptr<uint8_t>());
+      ideep::lstm_forward_training::compute(
+          pd, x, hx, cx, w1_, w2_, b, mkldnn_workspace, y, hy, cy, reverse);
+    }
     result.reserve(4);
     result.push_back(output);
     result.push_back(hy_);
     result.push_back(cy_);
     result.push_back(workspace);
+  } else if (is_gru) {
+    ideep::lbr_gru_forward_inference::compute(
+        x, hx, w1_, w2_, b, y, hy, reverse);
+    result.reserve(3);
+    result.push_back(output);
+    result.push_back(hy_);
+    result.push_back(cy_);
   } else {
     ideep::lstm_forward_inference::compute(
         x,
@@ -429,6 +496,193 @@ std::vector<at::Tensor> lstm_kernel(
   return result;
 }
 
+detail::ContextLSTMLayer lstm_prepack_layer(
+    const at::Tensor& w0,
+    const at::Tensor& w1,
+    const at::Tensor& w2,
+    const at::Tensor& w3,
+    bool has_biases) {
+  int64_t mode = static_cast<int64_t>(ideep::rnn_kind::LSTM);
+  int64_t num_gates = 4;
+  int64_t input_size = w0.size(1);
+  int64_t hidden_size = w1.size(1);
+
+  auto weight_ih = _shuffle_weight(w0, mode);
+  auto weight_hh = _shuffle_weight(w1, mode);
+  // The bias of INT8 LSTM is FP32
+  auto bias_dtype = weight_ih.is_quantized() ? at::ScalarType::Float
+                                             : weight_ih.scalar_type();
+  auto bias = has_biases
+      ? _shuffle_bias(w2, w3, mode)
+      : at::zeros(
+            {num_gates * hidden_size}, weight_ih.options().dtype(bias_dtype));
+
+  // The INT8 weights don't depend on the input, pack them here to save the
+  // reorder and the scales computing of every run.
+  std::shared_ptr<const detail::ContextLSTMPackedWeights> packed;
+  if (weight_ih.is_quantized()) {
+    auto qpacked = std::make_shared<detail::ContextLSTMPackedWeights>();
+    qpacked->input_dtype_ = at::ScalarType::QUInt8;
+    std::tie(qpacked->weight_ih_, qpacked->weight_hh_) = pack_qlstm_weight(
+        weight_ih, weight_hh, input_size, num_gates, hidden_size);
+    qpacked->bias_ = bias;
+    qpacked->weight_scales_ =
+        get_mkldnn_weight_scales_of_lstm(weight_ih, weight_hh);
+    packed = std::move(qpacked);
+  }
+  return detail::ContextLSTMLayer{
+      std::move(weight_ih),
+      std::move(weight_hh),
+      std::move(bias),
+      std::move(packed)};
+}
+
+// Pack the FP32/BF16 weights of a layer to the format queried by the given
+// input.
+std::shared_ptr<const detail::ContextLSTMPackedWeights> lstm_pack_layer_for(
+    const detail::ContextLSTMLayer& layer,
+    const at::Tensor& input,
+    const RNNParams& rnn,
+    const ideep::tensor& x,
+    const ideep::tensor& hx,
+    const ideep::tensor& cx,
+    const ideep::dims& output_sizes,
+    bool reverse) {
+  auto input_dt = input.scalar_type();
+  auto dtype = get_mkldnn_dtype(input_dt);
+  auto packed = std::make_shared<detail::ContextLSTMPackedWeights>();
+  packed->input_sizes_ = input.sizes().vec();
+  packed->input_dtype_ = input_dt;
+  packed->dense_weight_ih_ = layer.weight_ih_.to(input_dt);
+  packed->dense_weight_hh_ = layer.weight_hh_.to(input_dt);
+  packed->bias_ = layer.bias_.to(input_dt);
+
+  auto w1 = itensor_view_from_dense(
+      packed->dense_weight_ih_, rnn.weights_layer_desc(rnn.input_size, dtype));
+  auto w2 = itensor_view_from_dense(
+      packed->dense_weight_hh_, rnn.weights_iter_desc(dtype));
+  auto b = itensor_view_from_dense(packed->bias_, rnn.bias_desc(dtype));
+
+  ideep::tensor::desc packed_desc_ih, packed_desc_hh;
+  std::tie(packed_desc_ih, packed_desc_hh) =
+      ideep::lstm_forward_inference::expected_weights_desc(
+          output_sizes, x, hx, cx, w1, w2, b, reverse);
+  // Same as get_lstm_packed_weight, keep the plain weights when the expected
+  // format is rnn_packed, which depends on the seq_lens of the input.
+  if (packed_desc_ih.is_rnn_packed() || packed_desc_hh.is_rnn_packed()) {
+    packed->weight_ih_ = w1;
+    packed->weight_hh_ = w2;
+  } else {
+    packed->weight_ih_.init(packed_desc_ih);
+    packed->weight_hh_.init(packed_desc_hh);
+    packed->weight_ih_.feed_from(w1);
+    packed->weight_hh_.feed_from(w2);
+  }
+  return packed;
+}
+
+std::vector<at::Tensor> lstm_prepacked_layer_forward(
+    const at::Tensor& input,
+    detail::ContextLSTMLayer& layer,
+    const at::Tensor& hx_,
+    const at::Tensor& cx_,
+    bool reverse,
+    double output_scale,
+    int64_t output_zp,
+    int64_t output_dtype) {
+  RNNParams rnn(
+      input,
+      /*batch_sizes*/ {},
+      static_cast<int64_t>(ideep::rnn_kind::LSTM),
+      layer.weight_hh_.size(1),
+      /*num_layers*/ 1,
+      /*bidirectional*/ false,
+      /*batch_first*/ false,
+      /*train*/ false);
+
+  at::ScalarType input_dt = input.scalar_type();
+
+  auto hy_ = at::empty(hx_.sizes(), hx_.options());
+  auto cy_ = at::empty(cx_.sizes(), cx_.options());
+
+  auto x = torch_ipex::cpu::itensor_view_from_dense(
+      input, rnn.src_layer_desc(rnn.input_size, get_mkldnn_dtype(input_dt)));
+  auto hx = torch_ipex::cpu::itensor_view_from_dense(
+      hx_, rnn.src_iter_desc(get_mkldnn_dtype(hx_.scalar_type())));
+  auto cx = torch_ipex::cpu::itensor_view_from_dense(
+      cx_, rnn.src_iter_c_desc(get_mkldnn_dtype(cx_.scalar_type())));
+  auto hy = torch_ipex::cpu::itensor_view_from_dense(
+      hy_, rnn.dst_iter_desc(get_mkldnn_dtype(hy_.scalar_type())));
+  auto cy = torch_ipex::cpu::itensor_view_from_dense(
+      cy_, rnn.dst_iter_c_desc(get_mkldnn_dtype(cy_.scalar_type())));
+
+  auto output_size = _output_size</*is_single_direction*/ true>(rnn);
+  at::Tensor output;
+
+  auto packed = std::atomic_load(&layer.packed_);
+  double scale = -1.;
+  int64_t zp = -1;
+  if (input_dt == at::ScalarType::QUInt8) {
+    TORCH_CHECK(
+        packed && packed->input_dtype_ == at::ScalarType::QUInt8,
+        "Expected INT8 weights for the INT8 input of LSTM");
+    std::tie(scale, zp) = int8::utils::get_mkldnn_input_scale_zp(input);
+
+    auto quantizer = at::make_per_tensor_affine_quantizer(
+        output_scale, output_zp, static_cast<at::ScalarType>(output_dtype));
+    output = at::new_qtensor(output_size, input.options(), quantizer);
+  } else {
+    TORCH_CHECK(
+        input_dt == at::ScalarType::Float ||
+            input_dt == at::ScalarType::BFloat16,
+        "Expected input to be Float or BFloat16 but got ",
+        input_dt);
+    TORCH_CHECK(
+        !layer.weight_ih_.is_quantized(),
+        "Expected Float or BFloat16 weights for the ",
+        input_dt,
+        " input of LSTM");
+    if (!packed || packed->input_dtype_ != input_dt ||
+        !input.sizes().equals(packed->input_sizes_)) {
+      packed = lstm_pack_layer_for(
+          layer,
+          input,
+          rnn,
+          x,
+          hx,
+          cx,
+          {output_size.cbegin(), output_size.cend()},
+          reverse);
+      std::atomic_store(&layer.packed_, packed);
+    }
+    output = at::empty(output_size, input.options());
+  }
+
+  auto b = torch_ipex::cpu::itensor_view_from_dense(
+      packed->bias_,
+      rnn.bias_desc(get_mkldnn_dtype(packed->bias_.scalar_type())));
+  auto y = torch_ipex::cpu::itensor_view_from_dense(
+      output, rnn.dst_layer_desc(get_mkldnn_dtype(output.scalar_type())));
+
+  ideep::lstm_forward_inference::compute(
+      x,
+      hx,
+      cx,
+      packed->weight_ih_,
+      packed->weight_hh_,
+      b,
+      y,
+      hy,
+      cy,
+      reverse,
+      ideep::prop_kind::forward_inference,
+      scale,
+      zp,
+      weights_scale_mask,
+      packed->weight_scales_);
+  return {output, hy_, cy_};
+}
+
 std::vector<at::Tensor> ipex_lstm_layer_forward(
     const at::Tensor& input,
     const at::Tensor& w0,
@@ -783,6 +1037,7 @@ std::vector<at::Tensor> ipex_lstm_layer_backward(
       batch_first,
       train);
   auto output_size = _output_size</*is_single_direction*/ true>(rnn);
+  bool is_gru = rnn.mode == ideep::rnn_kind::GRU;
 
   auto weight_ih = _shuffle_weight(weight0, rnn.mode);
   auto weight_hh = _shuffle_weight(weight1, rnn.mode);
@@ -791,8 +1046,9 @@ std::vector<at::Tensor> ipex_lstm_layer_backward(
       : at::zeros({rnn.num_bias_gates * rnn.hidden_size}, weight_ih.options());
 
   at::Tensor cx_;
-  if (hx_.storage().unsafeGetStorageImpl() ==
-      cx_tmp.storage().unsafeGetStorageImpl()) {
+  if (!is_gru &&
+      hx_.storage().unsafeGetStorageImpl() ==
+          cx_tmp.storage().unsafeGetStorageImpl()) {
     cx_ = at::clone(cx_tmp);
   } else {
     cx_ = cx_tmp;
@@ -805,8 +1061,6 @@ std::vector<at::Tensor> ipex_lstm_layer_backward(
       rnn.src_layer_desc(input_size, get_mkldnn_dtype(input.scalar_type())));
   auto hx = torch_ipex::cpu::itensor_view_from_dense(
       hx_, rnn.src_iter_desc(get_mkldnn_dtype(hx_.scalar_type())));
-  auto cx = torch_ipex::cpu::itensor_view_from_dense(
-      cx_, rnn.src_iter_c_desc(get_mkldnn_dtype(cx_.scalar_type())));
   auto w1 = torch_ipex::cpu::itensor_view_from_dense(
       weight_ih,
       rnn.weights_layer_desc(
@@ -820,8 +1074,13 @@ std::vector<at::Tensor> ipex_lstm_layer_backward(
       output, rnn.dst_layer_desc(get_mkldnn_dtype(output.scalar_type())));
   auto hy = torch_ipex::cpu::itensor_view_from_dense(
       hy_, rnn.dst_iter_desc(get_mkldnn_dtype(hy_.scalar_type())));
-  auto cy = torch_ipex::cpu::itensor_view_from_dense(
-      cy_, rnn.dst_iter_c_desc(get_mkldnn_dtype(cy_.scalar_type())));
+  ideep::tensor cx, cy;
+  if (!is_gru) {
+    cx = torch_ipex::cpu::itensor_view_from_dense(
+        cx_, rnn.src_iter_c_desc(get_mkldnn_dtype(cx_.scalar_type())));
+    cy = torch_ipex::cpu::itensor_view_from_dense(
+        cy_, rnn.dst_iter_c_desc(get_mkldnn_dtype(cy_.scalar_type())));
+  }
 
   // Create diff_* ATen tensor and corresponding ideep tensor as fp32
   auto diff_x_ =
@@ -841,8 +1100,6 @@ std::vector<at::Tensor> ipex_lstm_layer_backward(
       diff_x_, rnn.src_layer_desc(input_size, ideep::tensor::data_type::f32));
   auto diff_hx = torch_ipex::cpu::itensor_view_from_dense(
       diff_hx_, rnn.src_iter_desc(ideep::tensor::data_type::f32));
-  auto diff_cx = torch_ipex::cpu::itensor_view_from_dense(
-      diff_cx_, rnn.src_iter_c_desc(ideep::tensor::data_type::f32));
   auto diff_w1 = torch_ipex::cpu::itensor_view_from_dense(
       diff_w1_,
       rnn.weights_layer_desc(input_size, ideep::tensor::data_type::f32));
@@ -870,45 +1127,80 @@ std::vector<at::Tensor> ipex_lstm_layer_backward(
         grad_y_, rnn.dst_layer_desc(get_mkldnn_dtype(grad_y_.scalar_type())));
     diff_hy = torch_ipex::cpu::itensor_view_from_dense(
         grad_hy_, rnn.dst_iter_desc(get_mkldnn_dtype(grad_hy_.scalar_type())));
-    diff_cy = torch_ipex::cpu::itensor_view_from_dense(
-        grad_cy_, rnn.dst_iter_desc(get_mkldnn_dtype(grad_cy_.scalar_type())));
   } else {
+    grad_cy_ = grad_cy;
     diff_y = torch_ipex::cpu::itensor_view_from_dense(
         grad_output, rnn.dst_layer_desc(ideep::tensor::data_type::f32));
     diff_hy = torch_ipex::cpu::itensor_view_from_dense(
         grad_hy, rnn.dst_iter_desc(ideep::tensor::data_type::f32));
-    diff_cy = torch_ipex::cpu::itensor_view_from_dense(
-        grad_cy, rnn.dst_iter_desc(ideep::tensor::data_type::f32));
   }
 
-  auto forward_hint = ideep::lstm_forward_training::prepare(
-      x, hx, cx, w1, w2, b, y, hy, cy, reverse);
   ideep::tensor mkldnn_workspace;
-  mkldnn_workspace.init(
-      forward_hint.workspace_desc(), workspace.template data_ptr<uint8_t>());
-  ideep::lstm_backward::compute(
-      forward_hint,
-      x,
-      hx,
-      cx,
-      w1,
-      w2,
-      b,
-      y,
-      hy,
-      cy,
-      diff_y,
-      diff_hy,
-      diff_cy,
-      mkldnn_workspace,
-      diff_x,
-      diff_hx,
-      diff_cx,
-      diff_w1,
-      diff_w2,
-      diff_b,
-      reverse);
-  return {diff_x_, diff_w1_, diff_w2_, diff_b_, diff_b_, diff_hx_, diff_cx_};
+  if (is_gru) {
+    auto forward_hint = ideep::lbr_gru_forward_training::prepare(
+        x, hx, w1, w2, b, y, hy, reverse);
+    mkldnn_workspace.init(
+        forward_hint.workspace_desc(), workspace.template data_ptr<uint8_t>());
+    ideep::lbr_gru_backward::compute(
+        forward_hint,
+        x,
+        hx,
+        w1,
+        w2,
+        b,
+        y,
+        hy,
+        diff_y,
+        diff_hy,
+        mkldnn_workspace,
+        diff_x,
+        diff_hx,
+        diff_w1,
+        diff_w2,
+        diff_b,
+        reverse);
+  } else {
+    auto diff_cx = torch_ipex::cpu::itensor_view_from_dense(
+        diff_cx_, rnn.src_iter_c_desc(ideep::tensor::data_type::f32));
+    diff_cy = torch_ipex::cpu::itensor_view_from_dense(
+        grad_cy_, rnn.dst_iter_desc(ideep::tensor::data_type::f32));
+    auto forward_hint = ideep::lstm_forward_training::prepare(
+        x, hx, cx, w1, w2, b, y, hy, cy, reverse);
+    mkldnn_workspace.init(
+        forward_hint.workspace_desc(), workspace.template data_ptr<uint8_t>());
+    ideep::lstm_backward::compute(
+        forward_hint,
+        x,
+        hx,
+        cx,
+        w1,
+        w2,
+        b,
+        y,
+        hy,
+        cy,
+        diff_y,
+        diff_hy,
+        diff_cy,
+        mkldnn_workspace,
+        diff_x,
+        diff_hx,
+        diff_cx,
+        diff_w1,
+        diff_w2,
+        diff_b,
+        reverse);
+  }
+  at::Tensor diff_b_ih_, diff_b_hh_;
+  std::tie(diff_b_ih_, diff_b_hh_) = _unshuffle_bias_grad(diff_b_, rnn.mode);
+  return {
+      diff_x_,
+      _unshuffle_weight_grad(diff_w1_, rnn.mode),
+      _unshuffle_weight_grad(diff_w2_, rnn.mode),
+      diff_b_ih_,
+      diff_b_hh_,
+      diff_hx_,
+      diff_cx_};
 }
 
 // MKLDNN RNN integration notes:
@@ -952,7 +1244,11 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> mkldnn_rnn(
 #endif
   TORCH_CHECK(
       batch_sizes.size() == 0, "mkldnn_rnn doesn't support packed input");
-  if (static_cast<ideep::rnn_kind>(mode) != ideep::rnn_kind::LSTM) {
+  bool is_lstm = static_cast<ideep::rnn_kind>(mode) == ideep::rnn_kind::LSTM;
+  if (!is_lstm) {
+    TORCH_CHECK(
+        static_cast<ideep::rnn_kind>(mode) == ideep::rnn_kind::GRU,
+        "mkldnn_rnn: only LSTM and GRU are supported");
     TORCH_CHECK(
         !cx_.defined(), "mkldnn_rnn: illegal defined cx for non-LSTM RNN");
   }
@@ -965,7 +1261,8 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> mkldnn_rnn(
   input = input.contiguous();
 
   auto hx = hx_.contiguous();
-  auto cx = cx_.contiguous();
+  // GRU passes an empty cell state to the layers and gets an empty one back
+  auto cx = is_lstm ? cx_.contiguous() : at::empty({0}, hx.options());
 
   at::MatrixRef<at::Tensor> weights{
       weight, static_cast<size_t>(weight_stride0)};
@@ -981,8 +1278,9 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> mkldnn_rnn(
       auto layer_weights = weights[index];
       TORCH_CHECK(layer_weights.size() == 2 || layer_weights.size() == 4);
       auto layer_hx = hx[index];
-      auto layer_cx = cx[index];
+      auto layer_cx = is_lstm ? cx[index] : cx;
       auto reverse = (direction > 0);
+      // LSTM and GRU share the layer op, which dispatches on the mode
       static auto op = torch::Dispatcher::singleton()
                            .findSchemaOrThrow("torch_ipex::ipex_lstm_layer", "")
                            .typed<decltype(ipex_lstm_layer)>();
@@ -1028,7 +1326,7 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> mkldnn_rnn(
   }
   auto output = layer_input;
   auto hy = at::stack(layer_hy, 0);
-  auto cy = at::stack(layer_cy, 0);
+  auto cy = is_lstm ? at::stack(layer_cy, 0) : cx;
   if (batch_first && !is_input_packed) {
     output = output.transpose(0, 1);
   }
@@ -1156,6 +1454,35 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm(
   auto cy = std::get<1>(result.second);
   return std::make_tuple(output, hy, cy);
 }
+
+std::tuple<at::Tensor, at::Tensor> ipex_gru(
+    const at::Tensor& input,
+    const at::Tensor& hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional,
+    bool batch_first) {
+  IPEX_RECORD_FUNCTION("ipex_gru", std::vector<c10::IValue>({}));
+
+#if defined(IPEX_DISP_OP)
+  printf("ipex_gru\n");
+#endif
+  auto result = cpu::mkldnn_impl(
+      input,
+      hx,
+      params,
+      has_biases,
+      ideep::rnn_kind::GRU,
+      num_layers,
+      dropout_p,
+      train,
+      bidirectional,
+      batch_first);
+  return std::make_tuple(result.first, result.second);
+}
 } // namespace torch_ipex
 
 namespace {
@@ -1166,6 +1493,12 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "bidirectional, bool batch_first) -> (Tensor, Tensor, Tensor)",
       torch_ipex::ipex_lstm);
   m.impl("ipex_lstm", c10::DispatchKey::CPU, torch_ipex::ipex_lstm);
+  m.def(
+      "ipex_gru(Tensor input, Tensor hx, Tensor[] params, bool has_biases, "
+      "int num_layers, float dropout_p, bool train, bool bidirectional, bool "
+      "batch_first) -> (Tensor, Tensor)",
+      torch_ipex::ipex_gru);
+  m.impl("ipex_gru", c10::DispatchKey::CPU, torch_ipex::ipex_gru);
   m.def(
       "ipex_lstm_layer(Tensor input, Tensor weight0, Tensor weight1, Tensor "
       "weight2, Tensor weight3, Tensor hx_, Tensor cx_, bool reverse, int[] "
@@ -1,7 +1,10 @@
+#pragma once
+
 #include <ATen/Tensor.h>
 #include <torch/csrc/autograd/custom_function.h>
 
 #include "csrc/cpu/ideep/ideep.hpp"
+#include "csrc/jit/cpu/kernels/ContextLSTM.h"
 
 #include <vector>
 
@@ -18,6 +21,19 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> ipex_lstm(
     bool bidirectional,
     bool batch_first);
 
+// GRU of PyTorch computed by the linear-before-reset GRU of oneDNN, through
+// the same layer ops as ipex_lstm with an empty cell state.
+std::tuple<at::Tensor, at::Tensor> ipex_gru(
+    const at::Tensor& input,
+    const at::Tensor& hx,
+    std::vector<at::Tensor> params,
+    bool has_biases,
+    int64_t num_layers,
+    double dropout_p,
+    bool train,
+    bool bidirectional,
+    bool batch_first);
+
 namespace cpu {
 
 class IPEXLSTMOp : public torch::autograd::Function<IPEXLSTMOp> {
@@ -137,5 +153,31 @@ std::vector<at::Tensor> ipex_lstm_layer_forward(
     double scale,
     int64_t zp,
     int64_t dtype);
+
+// Shuffle the weights and fuse the biases of a layer and direction of LSTM for
+// the prepacked LSTM op context. The INT8 weights are also packed here.
+detail::ContextLSTMLayer lstm_prepack_layer(
+    const at::Tensor& w0,
+    const at::Tensor& w1,
+    const at::Tensor& w2,
+    const at::Tensor& w3,
+    bool has_biases);
+
+// Inference of a layer and direction of LSTM with the weights prepacked by
+// lstm_prepack_layer. The FP32/BF16 weights are packed at the first run and
+// re-packed when the sizes or the dtype of the input change.
+std::vector<at::Tensor> lstm_prepacked_layer_forward(
+    const at::Tensor& input,
+    detail::ContextLSTMLayer& layer,
+    const at::Tensor& hx_,
+    const at::Tensor& cx_,
+    bool reverse,
+    double output_scale,
+    int64_t output_zp,
+    int64_t output_dtype);
+
+// Shuffle the gates of a weight of the fn_mode (an ideep::rnn_kind) from the
+// PyTorch order to the oneDNN order.
+at::Tensor _shuffle_weight(const at::Tensor& weight, int64_t fn_mode);
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,272 @@
+#include "RowwiseQuantizedEmbeddingBag.h"
+
+#include <torch/library.h>
+
+#include "csrc/aten/cpu/utils/csr2csc.h"
+#include "csrc/utils/ipex_op_profile.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(rowwise_quantize_embedding_kernel_stub);
+DEFINE_DISPATCH(rowwise_dequantize_embedding_kernel_stub);
+DEFINE_DISPATCH(rowwise_quantized_embedding_bag_kernel_stub);
+
+namespace {
+
+void check_bit_width(int64_t bit_width) {
+  TORCH_CHECK(
+      bit_width == 8 || bit_width == 4,
+      "rowwise quantized embedding: only support 8 and 4 bits, but got ",
+      bit_width);
+}
+
+void check_qweight(
+    const at::Tensor& qweight,
+    int64_t bit_width,
+    int64_t embedding_dim) {
+  check_bit_width(bit_width);
+  TORCH_CHECK(
+      embedding_dim > 0,
+      "rowwise quantized embedding: expect a positive embedding_dim");
+  TORCH_CHECK(
+      qweight.dim() == 2 && qweight.scalar_type() == at::kByte &&
+          qweight.is_contiguous(),
+      "rowwise quantized embedding: expect a contiguous 2D uint8 qweight");
+  TORCH_CHECK(
+      qweight.size(1) == rowwise_quantized_row_bytes(embedding_dim, bit_width),
+      "rowwise quantized embedding: expect ",
+      rowwise_quantized_row_bytes(embedding_dim, bit_width),
+      " bytes per row of qweight for embedding_dim ",
+      embedding_dim,
+      " and ",
+      bit_width,
+      " bits, but got ",
+      qweight.size(1));
+}
+
+void check_pooling_mode(int64_t pooling_mode) {
+  TORCH_CHECK(
+      pooling_mode == SUM || pooling_mode == MEAN,
+      "rowwise quantized embedding bag: only support sum and mean pooling");
+}
+
+// The offsets are non-decreasing offsets into indices.
+void check_offsets(const at::Tensor& indices, const at::Tensor& offsets) {
+  auto num_offsets = offsets.numel();
+  auto offsets_data = offsets.data_ptr<int64_t>();
+  TORCH_CHECK(
+      offsets_data[0] >= 0 && offsets_data[num_offsets - 1] <= indices.numel(),
+      "rowwise quantized embedding bag: the offsets are out of the indices");
+  TORCH_CHECK(
+      num_offsets == 1 ||
+          at::all(offsets.slice(0, 1).ge(offsets.slice(0, 0, num_offsets - 1)))
+              .item<bool>(),
+      "rowwise quantized embedding bag: expect non-decreasing offsets");
+}
+
+// The indices of the bags [bag_begin, bag_end) are rows of a table of
+// num_rows.
+void check_indices(
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    int64_t bag_begin,
+    int64_t bag_end,
+    int64_t num_rows) {
+  auto offsets_data = offsets.data_ptr<int64_t>();
+  auto idx_begin = offsets_data[bag_begin];
+  auto idx_end = offsets_data[bag_end];
+  if (idx_begin == idx_end) {
+    return;
+  }
+  auto table_indices = indices.slice(0, idx_begin, idx_end);
+  TORCH_CHECK(
+      table_indices.min().item<int64_t>() >= 0 &&
+          table_indices.max().item<int64_t>() < num_rows,
+      "rowwise quantized embedding bag: the indices are out of the ",
+      num_rows,
+      " rows of the table");
+}
+
+} // namespace
+
+int64_t rowwise_quantized_row_bytes(int64_t embedding_dim, int64_t bit_width) {
+  auto data_bytes = bit_width == 4 ? (embedding_dim + 1) / 2 : embedding_dim;
+  return data_bytes + 2 * sizeof(float);
+}
+
+at::Tensor rowwise_quantize_embedding(
+    const at::Tensor& weight,
+    int64_t bit_width) {
+  IPEX_RECORD_FUNCTION(
+      "rowwise_quantize_embedding", std::vector<c10::IValue>({}));
+
+  check_bit_width(bit_width);
+  TORCH_CHECK(
+      weight.dim() == 2 &&
+          (weight.scalar_type() == at::kFloat ||
+           weight.scalar_type() == at::kBFloat16),
+      "rowwise_quantize_embedding: expect a 2D float or bfloat16 weight");
+  auto qweight = at::empty(
+      {weight.size(0), rowwise_quantized_row_bytes(weight.size(1), bit_width)},
+      weight.options().dtype(at::kByte));
+  /*
+  pointer to rowwise_quantize_embedding_kernel_impl(
+      weight, qweight, bit_width);
+  */
+  rowwise_quantize_embedding_kernel_stub(
+      kCPU, weight.contiguous(), qweight, bit_width);
+  return qweight;
+}
+
+at::Tensor rowwise_dequantize_embedding(
+    const at::Tensor& qweight,
+    int64_t bit_width,
+    int64_t embedding_dim) {
+  IPEX_RECORD_FUNCTION(
+      "rowwise_dequantize_embedding", std::vector<c10::IValue>({}));
+
+  check_qweight(qweight, bit_width, embedding_dim);
+  auto weight = at::empty(
+      {qweight.size(0), embedding_dim}, qweight.options().dtype(at::kFloat));
+  /*
+  pointer to rowwise_dequantize_embedding_kernel_impl(
+      qweight, weight, bit_width);
+  */
+  rowwise_dequantize_embedding_kernel_stub(kCPU, qweight, weight, bit_width);
+  return weight;
+}
+
+at::Tensor rowwise_quantized_embedding_bag(
+    const at::Tensor& qweight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    int64_t bit_width,
+    int64_t embedding_dim,
+    int64_t pooling_mode,
+    bool include_last_offset) {
+  IPEX_RECORD_FUNCTION(
+      "rowwise_quantized_embedding_bag", std::vector<c10::IValue>({}));
+
+  check_qweight(qweight, bit_width, embedding_dim);
+  check_pooling_mode(pooling_mode);
+  TORCH_CHECK(
+      indices.dim() == 1 && offsets.dim() == 1,
+      "rowwise_quantized_embedding_bag: expect 1D indices and offsets");
+  auto _indices = indices.to(at::kLong).contiguous();
+  auto _offsets = offsets.to(at::kLong).contiguous();
+  if (!include_last_offset) {
+    _offsets = at::cat(
+        {_offsets, at::full({1}, _indices.numel(), _offsets.options())});
+  }
+  TORCH_CHECK(
+      _offsets.numel() >= 1,
+      "rowwise_quantized_embedding_bag: expect the last offset");
+  int64_t batch_size = _offsets.numel() - 1;
+  check_offsets(_indices, _offsets);
+  check_indices(_indices, _offsets, 0, batch_size, qweight.size(0));
+
+  // One table of batch_size bags.
+  std::vector<at::Tensor> qweights = {qweight};
+  std::vector<int64_t> bit_widths = {bit_width};
+  std::vector<int64_t> pooling_modes = {pooling_mode};
+  std::vector<at::Tensor> outputs = {at::empty(
+      {batch_size, embedding_dim}, qweight.options().dtype(at::kFloat))};
+  /*
+  pointer to rowwise_quantized_embedding_bag_kernel_impl(
+      indices, offsets, qweights, bit_widths, pooling_modes, outputs);
+  */
+  rowwise_quantized_embedding_bag_kernel_stub(
+      kCPU, _indices, _offsets, qweights, bit_widths, pooling_modes, outputs);
+  return outputs[0];
+}
+
+std::vector<at::Tensor> merged_rowwise_quantized_embeddingbag_forward(
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const std::vector<at::Tensor>& qweights,
+    const std::vector<int64_t> bit_widths,
+    const std::vector<int64_t> embedding_dims,
+    const std::vector<int64_t> pooling_modes) {
+  IPEX_RECORD_FUNCTION(
+      "merged_rowwise_quantized_embeddingbag_forward",
+      std::vector<c10::IValue>({}));
+
+  int64_t n_tables = qweights.size();
+  TORCH_CHECK(
+      n_tables > 0 && bit_widths.size() == qweights.size() &&
+          embedding_dims.size() == qweights.size() &&
+          pooling_modes.size() == qweights.size(),
+      "merged_rowwise_quantized_embeddingbag_forward: expect the bit_widths, "
+      "embedding_dims and pooling_modes of each table");
+  TORCH_CHECK(
+      indices.dim() == 1 && offsets.dim() == 1 && offsets.numel() >= 1 &&
+          (offsets.numel() - 1) % n_tables == 0,
+      "merged_rowwise_quantized_embeddingbag_forward: expect 1D indices and "
+      "offsets of [num_tables * batch_size + 1]");
+  auto _indices = indices.to(at::kLong).contiguous();
+  auto _offsets = offsets.to(at::kLong).contiguous();
+  int64_t batch_size = (_offsets.numel() - 1) / n_tables;
+  check_offsets(_indices, _offsets);
+
+  std::vector<at::Tensor> outputs;
+  for (int64_t t = 0; t < n_tables; t++) {
+    check_qweight(qweights[t], bit_widths[t], embedding_dims[t]);
+    check_pooling_mode(pooling_modes[t]);
+    check_indices(
+        _indices,
+        _offsets,
+        t * batch_size,
+        (t + 1) * batch_size,
+        qweights[t].size(0));
+    outputs.push_back(at::empty(
+        {batch_size, embedding_dims[t]},
+        qweights[t].options().dtype(at::kFloat)));
+  }
+  /*
+  pointer to rowwise_quantized_embedding_bag_kernel_impl(
+      indices, offsets, qweights, bit_widths, pooling_modes, outputs);
+  */
+  rowwise_quantized_embedding_bag_kernel_stub(
+      kCPU, _indices, _offsets, qweights, bit_widths, pooling_modes, outputs);
+  return outputs;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "rowwise_quantize_embedding(Tensor weight, int bit_width) -> Tensor");
+  m.impl(
+      "rowwise_quantize_embedding",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::rowwise_quantize_embedding);
+  m.def(
+      "rowwise_dequantize_embedding(Tensor qweight, int bit_width, "
+      "int embedding_dim) -> Tensor");
+  m.impl(
+      "rowwise_dequantize_embedding",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::rowwise_dequantize_embedding);
+  m.def(
+      "rowwise_quantized_embedding_bag(Tensor qweight, Tensor indices, "
+      "Tensor offsets, int bit_width, int embedding_dim, int pooling_mode, "
+      "bool include_last_offset) -> Tensor");
+  m.impl(
+      "rowwise_quantized_embedding_bag",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::rowwise_quantized_embedding_bag);
+  m.def(
+      "merged_rowwise_quantized_embeddingbag_forward(Tensor indices, "
+      "Tensor offsets, Tensor[] qweights, int[] bit_widths, "
+      "int[] embedding_dims, int[] pooling_modes) -> Tensor[]");
+  m.impl(
+      "merged_rowwise_quantized_embeddingbag_forward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_rowwise_quantized_embeddingbag_forward);
+}
+
+} // namespace
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <csrc/dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+/*
+Row-wise quantized embedding tables. Each row of a float table
+[num_rows, embedding_dim] is quantized with its own scale and bias to
+bit_width (8 or 4) bits, x ~= q * scale + bias with q in [0, 2^bit_width), and
+stored as one row of a uint8 table [num_rows, row_bytes]:
+
+  | q (data bytes) | scale (float) | bias (float) |
+
+The data takes embedding_dim bytes for INT8 and (embedding_dim + 1) / 2 bytes
+for INT4, which packs 2 values per byte, the even one in the low nibble. The
+pooling kernels dequantize the rows as they accumulate them, so the float
+table is never materialized.
+*/
+
+// row_bytes of a quantized table.
+int64_t rowwise_quantized_row_bytes(int64_t embedding_dim, int64_t bit_width);
+
+// Quantize a float or bfloat16 table [num_rows, embedding_dim].
+at::Tensor rowwise_quantize_embedding(
+    const at::Tensor& weight,
+    int64_t bit_width);
+
+// The float table of a quantized table.
+at::Tensor rowwise_dequantize_embedding(
+    const at::Tensor& qweight,
+    int64_t bit_width,
+    int64_t embedding_dim);
+
+// nn.EmbeddingBag (sum or mean) over a quantized table, with 1D indices and
+// offsets. Returns the float [batch_size, embedding_dim].
+at::Tensor rowwise_quantized_embedding_bag(
+    const at::Tensor& qweight,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    int64_t bit_width,
+    int64_t embedding_dim,
+    int64_t pooling_mode,
+    bool include_last_offset);
+
+// merged_embeddingbag_forward over quantized tables, the indices and offsets
+// [num_tables * batch_size + 1] are linearized by
+// MergedEmbeddingBag.linearize_indices_and_offsets.
+std::vector<at::Tensor> merged_rowwise_quantized_embeddingbag_forward(
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const std::vector<at::Tensor>& qweights,
+    const std::vector<int64_t> bit_widths,
+    const std::vector<int64_t> embedding_dims,
+    const std::vector<int64_t> pooling_modes);
+
+namespace {
+
+void rowwise_quantize_embedding_kernel_impl(
+    const at::Tensor& weight,
+    at::Tensor& qweight,
+    int64_t bit_width);
+
+void rowwise_dequantize_embedding_kernel_impl(
+    const at::Tensor& qweight,
+    at::Tensor& weight,
+    int64_t bit_width);
+
+// Pool the bags of all the tables, the bags of table t are
+// [t * batch_size, (t + 1) * batch_size) of offsets.
+void rowwise_quantized_embedding_bag_kernel_impl(
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const std::vector<at::Tensor>& qweights,
+    const std::vector<int64_t>& bit_widths,
+    const std::vector<int64_t>& pooling_modes,
+    std::vector<at::Tensor>& outputs);
+
+} // namespace
+
+using rowwise_quantize_embedding_kernel_fn =
+    void (*)(const at::Tensor&, at::Tensor&, int64_t);
+DECLARE_DISPATCH(
+    rowwise_quantize_embedding_kernel_fn,
+    rowwise_quantize_embedding_kernel_stub);
+
+using rowwise_dequantize_embedding_kernel_fn =
+    void (*)(const at::Tensor&, at::Tensor&, int64_t);
+DECLARE_DISPATCH(
+    rowwise_dequantize_embedding_kernel_fn,
+    rowwise_dequantize_embedding_kernel_stub);
+
+using rowwise_quantized_embedding_bag_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const std::vector<at::Tensor>&,
+    const std::vector<int64_t>&,
+    const std::vector<int64_t>&,
+    std::vector<at::Tensor>&);
+DECLARE_DISPATCH(
+    rowwise_quantized_embedding_bag_kernel_fn,
+    rowwise_quantized_embedding_bag_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,8 +1,12 @@
+#include <torch/csrc/autograd/variable.h>
 #include <torch/extension.h>
 
+#include <cstdlib>
+
+#include "RNN.h"
 #include "WeightPack.h"
 #include "csrc/cpu/ideep/IDeepConversions.h"
-#include "csrc/utils/rw_lock.h"
+#include "csrc/utils/sharded_cache.h"
 #include "utils/utils.h"
 
 namespace torch_ipex {
@@ -19,28 +23,41 @@ namespace {
 using weakref_type =
     c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl>;
 using val_blocked = std::tuple<weakref_type, ideep::tensor>;
-std::unordered_map<c10::TensorImpl*, val_blocked> cached_weights;
 
-using map_iter =
-    std::unordered_map<c10::TensorImpl*, val_blocked>::const_iterator;
+size_t read_weight_cache_capacity_env() {
+  // The capacity in MB, 0 means unlimited.
+  auto envar = std::getenv("IPEX_WEIGHT_CACHE_CAPACITY_MB");
+  return envar == nullptr ? 0 : std::strtoull(envar, nullptr, 10) << 20;
+}
 
-torch_ipex::ReadWriteMutex rwmutex;
+// The key is the TensorImpl of the original weight. The weak reference keeps
+// the TensorImpl from being freed, so its address can't be reused by another
+// weight while the entry is alive, and the entry expires once the weight is
+// released.
+torch_ipex::ShardedCache<c10::TensorImpl*, val_blocked>& get_cached_weights() {
+  static torch_ipex::ShardedCache<c10::TensorImpl*, val_blocked>
+      cached_weights(
+          read_weight_cache_capacity_env(), [](const val_blocked& value) {
+            return std::get<0>(value).expired();
+          });
+  return cached_weights;
+}
 
 ideep::tensor read_cached_weights(const at::Tensor& weight) {
-  torch_ipex::UniqueReadLock<torch_ipex::ReadWriteMutex> lock(rwmutex);
   ideep::tensor cached_weight;
-  auto it = cached_weights.find(weight.unsafeGetTensorImpl());
-  if (it != cached_weights.end()) {
-    cached_weight = std::get<1>(it->second);
-  }
+  get_cached_weights().lookup(
+      weight.unsafeGetTensorImpl(),
+      [&cached_weight](const val_blocked& value) {
+        cached_weight = std::get<1>(value);
+      });
   return cached_weight;
 }
 
 void write_cached_weights(const at::Tensor& weight, ideep::tensor& result) {
-  torch_ipex::UniqueWriteLock<torch_ipex::ReadWriteMutex> lock(rwmutex);
-  cached_weights.emplace(
+  get_cached_weights().insert(
       weight.unsafeGetTensorImpl(),
-      val_blocked{weakref_type(weight.getIntrusivePtr()), result});
+      val_blocked{weakref_type(weight.getIntrusivePtr()), result},
+      result.get_desc().get_size());
 }
 
 } // namespace
@@ -95,6 +112,22 @@ bool is_packed(const at::Tensor& weight) {
   return !cached_weight.is_empty();
 }
 
+ShardedCacheStats get_weight_cache_stats() {
+  return get_cached_weights().get_stats();
+}
+
+void set_weight_cache_capacity(size_t capacity_bytes) {
+  get_cached_weights().set_capacity(capacity_bytes);
+}
+
+size_t get_weight_cache_capacity() {
+  return get_cached_weights().get_capacity();
+}
+
+void clear_weight_cache() {
+  get_cached_weights().clear();
+}
+
 std::tuple<ideep::tensor, ideep::tensor> get_lstm_packed_weight(
     const at::Tensor& weight_ih,
     const at::Tensor& weight_hh,
@@ -127,13 +160,10 @@ std::tuple<ideep::tensor, ideep::tensor> get_lstm_packed_weight(
   auto cached_weight_hh = read_cached_weights(weight_hh);
   bool all_in_cache =
       !cached_weight_ih.is_empty() && !cached_weight_hh.is_empty();
-  bool all_miss = cached_weight_ih.is_empty() && cached_weight_hh.is_empty();
-  TORCH_CHECK(
-      all_in_cache || all_miss,
-      "both of the weights of LSTM should be "
-      "cached or neither should be cached");
 
-  if (cached_weight_ih.is_empty()) {
+  // Only one of the weights is cached if the other one has been evicted by
+  // the capacity limit, repack both of them.
+  if (!all_in_cache) {
     auto w1 = itensor_view_from_dense(
         weight_ih,
         {{1, 1, input_size, num_gates, hidden_size},
@@ -192,6 +222,63 @@ std::tuple<ideep::tensor, ideep::tensor> get_lstm_packed_weight(
   return std::make_tuple(cached_weight_ih, cached_weight_hh);
 }
 
+std::tuple<ideep::tensor, ideep::tensor> get_gru_packed_weight(
+    const at::Tensor& weight_ih,
+    const at::Tensor& weight_hh,
+    int64_t input_size,
+    int64_t hidden_size,
+    const ideep::dims& output_sizes,
+    const ideep::tensor& src_layer,
+    const ideep::tensor& src_iter,
+    const ideep::tensor& bias,
+    const bool reverse) {
+  auto cached_weight_ih = read_cached_weights(weight_ih);
+  auto cached_weight_hh = read_cached_weights(weight_hh);
+  if (!cached_weight_ih.is_empty() && !cached_weight_hh.is_empty()) {
+    return std::make_tuple(cached_weight_ih, cached_weight_hh);
+  }
+
+  // PyTorch gates order (rt, zt, nt) to oneDNN gates order (zt, rt, nt)
+  auto gru_mode = static_cast<int64_t>(ideep::rnn_kind::GRU);
+  auto shuffled_weight_ih = _shuffle_weight(weight_ih, gru_mode);
+  auto shuffled_weight_hh = _shuffle_weight(weight_hh, gru_mode);
+  auto w1 = itensor_view_from_dense(
+      shuffled_weight_ih,
+      {{1, 1, input_size, 3, hidden_size},
+       get_mkldnn_dtype(weight_ih.scalar_type()),
+       ideep::format_tag::ldgoi});
+  auto w2 = itensor_view_from_dense(
+      shuffled_weight_hh,
+      {{1, 1, hidden_size, 3, hidden_size},
+       get_mkldnn_dtype(weight_hh.scalar_type()),
+       ideep::format_tag::ldgoi});
+
+  ideep::tensor::desc packed_desc_ih, packed_desc_hh;
+  std::tie(packed_desc_ih, packed_desc_hh) =
+      ideep::lbr_gru_forward_inference::expected_weights_desc(
+          output_sizes, src_layer, src_iter, w1, w2, bias, reverse);
+
+  // The shuffled weights are temporaries, copy them out instead of returning
+  // views when the expected format is rnn_packed, which is not cached for the
+  // same reason as get_lstm_packed_weight.
+  if (packed_desc_ih.is_rnn_packed() || packed_desc_hh.is_rnn_packed()) {
+    ideep::tensor plain_weight_ih{w1.get_desc()};
+    ideep::tensor plain_weight_hh{w2.get_desc()};
+    plain_weight_ih.feed_from(w1);
+    plain_weight_hh.feed_from(w2);
+    return std::make_tuple(plain_weight_ih, plain_weight_hh);
+  }
+  cached_weight_ih.init(packed_desc_ih);
+  cached_weight_hh.init(packed_desc_hh);
+
+  cached_weight_ih.feed_from(w1);
+  cached_weight_hh.feed_from(w2);
+
+  write_cached_weights(weight_ih, cached_weight_ih);
+  write_cached_weights(weight_hh, cached_weight_hh);
+  return std::make_tuple(cached_weight_ih, cached_weight_hh);
+}
+
 ideep::tensor::desc get_conv_transpose2d_expected_weights_desc(
     const ideep::tensor::dims& weights_dims,
     ideep::tensor::data_type w_dtype,
@@ -247,6 +334,11 @@ void sync_master_weight_to_bf16(
   auto w_master = itensor_view_from_dense(master_weight);
   auto w_bf16 = itensor_view_from_dense(bf16_weight);
   w_bf16.feed_from(w_master);
+  // Written through the data handle, bump the version as the in-place ops do
+  // (see bump_param_version of the fused optimizer steps).
+  if (!bf16_weight.is_inference()) {
+    torch::autograd::increment_version(bf16_weight);
+  }
 }
 
 } // namespace cpu
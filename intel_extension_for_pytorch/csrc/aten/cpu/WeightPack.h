@@ -3,6 +3,7 @@
 #include <ATen/Tensor.h>
 
 #include "csrc/cpu/ideep/ideep.hpp"
+#include "csrc/utils/sharded_cache.h"
 
 #include <vector>
 
@@ -23,8 +24,32 @@ std::tuple<ideep::tensor, ideep::tensor> get_lstm_packed_weight(
     const bool reverse,
     const bool train);
 
+// The GRU weights are shuffled to the gate order of oneDNN before packing, so
+// the packed weights are cached with the original weight_ih and weight_hh of
+// PyTorch as the keys, and the shuffle is only done when they are not cached.
+std::tuple<ideep::tensor, ideep::tensor> get_gru_packed_weight(
+    const at::Tensor& weight_ih,
+    const at::Tensor& weight_hh,
+    int64_t input_size,
+    int64_t hidden_size,
+    const ideep::dims& output_sizes,
+    const ideep::tensor& src_layer,
+    const ideep::tensor& src_iter,
+    const ideep::tensor& bias,
+    const bool reverse);
+
 bool is_packed(const at::Tensor& weight);
 
+// The hit/miss counters and the size of the cache of the packed LSTM and GRU
+// weights.
+ShardedCacheStats get_weight_cache_stats();
+// Byte budget of the weight cache, the least recently used weights are evicted
+// beyond it. 0 means unlimited, which is the default unless
+// IPEX_WEIGHT_CACHE_CAPACITY_MB is set.
+void set_weight_cache_capacity(size_t capacity_bytes);
+size_t get_weight_cache_capacity();
+void clear_weight_cache();
+
 // Get the convolution's expected ideep weight tensor desc.
 ideep::tensor::desc get_conv_expected_weights_desc(
     const ideep::tensor::dims& weights_dims,
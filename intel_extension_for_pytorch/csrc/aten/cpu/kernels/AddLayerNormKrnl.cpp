@@ -8,6 +8,8 @@
 
 #if defined(CPU_CAPABILITY_AVX512)
 #include "csrc/cpu/vec512/add_layernorm.h"
+#elif defined(CPU_CAPABILITY_AVX2)
+#include "csrc/cpu/vec256/add_layernorm.h"
 #endif
 #include <torch/csrc/autograd/function.h>
 
@@ -16,6 +18,12 @@ namespace cpu {
 
 namespace {
 
+#if defined(CPU_CAPABILITY_AVX512)
+namespace kernel_vec = torch_ipex::cpu::kernel::vec::vec512;
+#elif defined(CPU_CAPABILITY_AVX2)
+namespace kernel_vec = torch_ipex::cpu::kernel::vec::vec256;
+#endif
+
 at::Tensor add_layer_norm_kernel_impl(
     const at::Tensor& a,
     const at::Tensor& b,
@@ -24,7 +32,7 @@ at::Tensor add_layer_norm_kernel_impl(
     const c10::optional<at::Tensor>& weight_opt,
     const c10::optional<at::Tensor>& bias_opt,
     float eps) {
-#if defined(CPU_CAPABILITY_AVX512)
+#if defined(CPU_CAPABILITY_AVX512) || defined(CPU_CAPABILITY_AVX2)
   c10::MaybeOwned<Tensor> weight_maybe_owned =
       at::borrow_from_optional_tensor(weight_opt);
   const Tensor& weight = *weight_maybe_owned;
@@ -47,18 +55,16 @@ at::Tensor add_layer_norm_kernel_impl(
       c10::nullopt /* pin_memory */,
       at::MemoryFormat::Contiguous);
   if (a.scalar_type() == at::kFloat && b.scalar_type() == at::kFloat) {
-    torch_ipex::cpu::kernel::vec::vec512::AddLayerNormKernelImpl<float, float>(
+    kernel_vec::AddLayerNormKernelImpl<float, float>(
         X, b, alpha, weight, bias, M, N, eps, Y);
   } else if (
       a.scalar_type() == at::kBFloat16 && b.scalar_type() == at::kBFloat16) {
     if (weight.defined() && weight.scalar_type() == at::kBFloat16) {
-      torch_ipex::cpu::kernel::vec::vec512::
-          AddLayerNormKernelImpl<at::BFloat16, at::BFloat16>(
-              X, b, alpha, weight, bias, M, N, eps, Y);
+      kernel_vec::AddLayerNormKernelImpl<at::BFloat16, at::BFloat16>(
+          X, b, alpha, weight, bias, M, N, eps, Y);
     } else {
-      torch_ipex::cpu::kernel::vec::vec512::
-          AddLayerNormKernelImpl<at::BFloat16, float>(
-              X, b, alpha, weight, bias, M, N, eps, Y);
+      kernel_vec::AddLayerNormKernelImpl<at::BFloat16, float>(
+          X, b, alpha, weight, bias, M, N, eps, Y);
     }
   }
   return Y;
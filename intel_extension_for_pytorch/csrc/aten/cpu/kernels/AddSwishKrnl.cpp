@@ -2,6 +2,8 @@
 
 #if defined(CPU_CAPABILITY_AVX512)
 #include "csrc/cpu/vec512/add_swish.h"
+#elif defined(CPU_CAPABILITY_AVX2)
+#include "csrc/cpu/vec256/add_swish.h"
 #endif
 
 namespace torch_ipex {
@@ -9,18 +11,23 @@ namespace cpu {
 
 namespace {
 
+#if defined(CPU_CAPABILITY_AVX512)
+namespace kernel_vec = torch_ipex::cpu::kernel::vec::vec512;
+#elif defined(CPU_CAPABILITY_AVX2)
+namespace kernel_vec = torch_ipex::cpu::kernel::vec::vec256;
+#endif
+
 at::Tensor add_swish_kernel_impl(
     at::Tensor& x,
     at::Tensor& a,
     const at::Tensor& b,
     const at::Tensor& c) {
-#if defined(CPU_CAPABILITY_AVX512)
+#if defined(CPU_CAPABILITY_AVX512) || defined(CPU_CAPABILITY_AVX2)
   if (a.scalar_type() == at::kFloat && c.scalar_type() == at::kFloat) {
-    return torch_ipex::cpu::kernel::vec::vec512::dil_add_swish<float>(a, c);
+    return kernel_vec::dil_add_swish<float>(a, c);
   } else if (
       a.scalar_type() == at::kBFloat16 && c.scalar_type() == at::kBFloat16) {
-    return torch_ipex::cpu::kernel::vec::vec512::dil_add_swish<at::BFloat16>(
-        a, c);
+    return kernel_vec::dil_add_swish<at::BFloat16>(a, c);
   }
 #endif
   auto lin_res = at::linear(x, b, c);
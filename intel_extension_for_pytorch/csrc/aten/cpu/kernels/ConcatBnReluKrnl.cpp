@@ -4,6 +4,8 @@
 
 #if defined(CPU_CAPABILITY_AVX512)
 #include "csrc/cpu/vec512/concat_bn_relu.h"
+#elif defined(CPU_CAPABILITY_AVX2)
+#include "csrc/cpu/vec256/concat_bn_relu.h"
 #endif
 #include <torch/csrc/autograd/function.h>
 
@@ -12,6 +14,12 @@ namespace cpu {
 
 namespace {
 
+#if defined(CPU_CAPABILITY_AVX512)
+namespace kernel_vec = torch_ipex::cpu::kernel::vec::vec512;
+#elif defined(CPU_CAPABILITY_AVX2)
+namespace kernel_vec = torch_ipex::cpu::kernel::vec::vec256;
+#endif
+
 at::Tensor concat_bn_relu_kernel_impl(
     const c10::List<at::Tensor>& a,
     const at::Tensor& bn_scale,
@@ -51,7 +59,7 @@ at::Tensor concat_bn_relu_kernel_impl(
       }
     }
   }
-#if defined(CPU_CAPABILITY_AVX512)
+#if defined(CPU_CAPABILITY_AVX512) || defined(CPU_CAPABILITY_AVX2)
   if (tensor_check) {
     at::Tensor output;
     if (a[0].scalar_type() == at::kBFloat16) {
@@ -60,16 +68,16 @@ at::Tensor concat_bn_relu_kernel_impl(
           a[0].options()
               .dtype(at::kBFloat16)
               .memory_format(a[0].suggest_memory_format()));
-      torch_ipex::cpu::kernel::vec::vec512::ConcatBnReluKernelImpl_ChannelsLast<
-          at::BFloat16>(a, bn_scale, bn_beta, output);
+      kernel_vec::ConcatBnReluKernelImpl_ChannelsLast<at::BFloat16>(
+          a, bn_scale, bn_beta, output);
     } else {
       output = at::empty(
           output_dim,
           a[0].options()
               .dtype(at::kFloat)
               .memory_format(a[0].suggest_memory_format()));
-      torch_ipex::cpu::kernel::vec::vec512::ConcatBnReluKernelImpl_ChannelsLast<
-          float>(a, bn_scale, bn_beta, output);
+      kernel_vec::ConcatBnReluKernelImpl_ChannelsLast<float>(
+          a, bn_scale, bn_beta, output);
     }
     return output;
   }
@@ -2,6 +2,8 @@
 
 #if defined(CPU_CAPABILITY_AVX512)
 #include "csrc/cpu/vec512/add_softmax.h"
+#elif defined(CPU_CAPABILITY_AVX2)
+#include "csrc/cpu/vec256/add_softmax.h"
 #endif
 
 namespace torch_ipex {
@@ -9,19 +11,25 @@ namespace cpu {
 
 namespace {
 
+#if defined(CPU_CAPABILITY_AVX512)
+namespace kernel_vec = torch_ipex::cpu::kernel::vec::vec512;
+#elif defined(CPU_CAPABILITY_AVX2)
+namespace kernel_vec = torch_ipex::cpu::kernel::vec::vec256;
+#endif
+
 at::Tensor div_maskedfill_softmax_kernel_impl(
     at::Tensor& a,
     const at::Tensor& b,
     const at::IntArrayRef& mask_shape,
     const float& fill,
     const float& dim_per_head) {
-#if defined(CPU_CAPABILITY_AVX512)
+#if defined(CPU_CAPABILITY_AVX512) || defined(CPU_CAPABILITY_AVX2)
   if (a.scalar_type() == at::kFloat) {
-    return torch_ipex::cpu::kernel::vec::vec512::dil_div_maskfill_softmax<
-        float>(a, b, fill, dim_per_head);
+    return kernel_vec::dil_div_maskfill_softmax<float>(
+        a, b, fill, dim_per_head);
   } else if (a.scalar_type() == at::kBFloat16) {
-    return torch_ipex::cpu::kernel::vec::vec512::dil_div_maskfill_softmax<
-        at::BFloat16>(a, b, fill, dim_per_head);
+    return kernel_vec::dil_div_maskfill_softmax<at::BFloat16>(
+        a, b, fill, dim_per_head);
   }
 #endif
   // convert the mask back to bool for fallback path
@@ -0,0 +1,752 @@
+#include <csrc/aten/cpu/FlashAttention.h>
+
+#include <ATen/Parallel.h>
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(CPU_CAPABILITY_AVX512)
+#include "csrc/cpu/vec512/add_softmax.h"
+#endif
+
+#if defined(CPU_CAPABILITY_AMX)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+#if defined(CPU_CAPABILITY_AVX512)
+using namespace torch_ipex::cpu::kernel::vec::vec512;
+
+// Number of the queries and the keys of a block. kBlockN is a multiple of 32,
+// which is the K dim of an AMX BF16 tile.
+constexpr int64_t kBlockM = 32;
+constexpr int64_t kBlockN = 64;
+
+inline __mmask16 tail_mask(int64_t size) {
+  if (size <= 0) {
+    return 0;
+  }
+  return size >= 16 ? 0xFFFF : static_cast<__mmask16>((1 << size) - 1);
+}
+
+template <typename scalar_t>
+struct AttentionParams {
+  const scalar_t* query;
+  const scalar_t* key;
+  const scalar_t* value;
+  // nullptr if there is no mask.
+  const float* mask;
+  scalar_t* output;
+  // Strides of the dims B, H and M (or N) of the inputs, the strides of the
+  // last dims are 1.
+  int64_t query_strides[3];
+  int64_t key_strides[3];
+  int64_t value_strides[3];
+  int64_t mask_strides[3];
+  int64_t batch_size;
+  int64_t num_heads;
+  int64_t q_len;
+  int64_t kv_len;
+  int64_t head_dim;
+  int64_t v_head_dim;
+  float scale;
+  bool mask_fill;
+  float fill;
+};
+
+// Per-thread buffers of a query block.
+struct AttentionBuffers {
+  AttentionBuffers(int64_t head_dim, int64_t v_head_dim, bool use_amx)
+      : scores(kBlockM * kBlockN, 0.f),
+        acc(kBlockM * v_head_dim),
+        row_max(kBlockM),
+        row_sum(kBlockM),
+        rescale(kBlockM) {
+    if (use_amx) {
+      query_bf16.resize(kBlockM * head_dim);
+      key_vnni.resize(head_dim * kBlockN);
+      value_vnni.resize(kBlockN * v_head_dim);
+      probs_bf16.resize(kBlockM * kBlockN);
+      context.resize(kBlockM * v_head_dim);
+    } else {
+      key_t.resize(head_dim * kBlockN, 0.f);
+    }
+  }
+
+  std::vector<float> scores; // [kBlockM, kBlockN]
+  std::vector<float> acc; // [kBlockM, Dv]
+  std::vector<float> row_max; // [kBlockM]
+  std::vector<float> row_sum; // [kBlockM]
+  std::vector<float> rescale; // [kBlockM]
+  // AVX512 path
+  std::vector<float> key_t; // [D, kBlockN]
+  // AMX path
+  std::vector<at::BFloat16> query_bf16; // [kBlockM, D]
+  std::vector<at::BFloat16> key_vnni; // [D / 2, kBlockN, 2]
+  std::vector<at::BFloat16> value_vnni; // [kBlockN / 2, Dv, 2]
+  std::vector<at::BFloat16> probs_bf16; // [kBlockM, kBlockN]
+  std::vector<float> context; // [kBlockM, Dv]
+};
+
+// scores[i, n] = sum_d(query[i, d] * key[n, d])
+// The key block is transposed into key_t, then each row of the scores is
+// accumulated by broadcasting the elements of the query row.
+template <typename scalar_t>
+inline void qk_block(
+    const scalar_t* query,
+    int64_t query_stride,
+    const scalar_t* key,
+    int64_t key_stride,
+    int64_t bm,
+    int64_t bn,
+    int64_t head_dim,
+    float* key_t,
+    float* scores) {
+  for (int64_t n = 0; n < bn; n++) {
+    const scalar_t* key_row = key + n * key_stride;
+    for (int64_t d = 0; d < head_dim; d++) {
+      key_t[d * kBlockN + n] = static_cast<float>(key_row[d]);
+    }
+  }
+
+  int64_t num_vecs = (bn + 15) / 16;
+  for (int64_t i = 0; i < bm; i++) {
+    const scalar_t* query_row = query + i * query_stride;
+    __m512 vec_acc[kBlockN / 16];
+    for (int64_t j = 0; j < num_vecs; j++) {
+      vec_acc[j] = _mm512_setzero_ps();
+    }
+    for (int64_t d = 0; d < head_dim; d++) {
+      auto vec_q = _mm512_set1_ps(static_cast<float>(query_row[d]));
+      const float* key_t_row = key_t + d * kBlockN;
+      for (int64_t j = 0; j < num_vecs; j++) {
+        vec_acc[j] = _mm512_fmadd_ps(
+            vec_q, _mm512_loadu_ps(key_t_row + j * 16), vec_acc[j]);
+      }
+    }
+    for (int64_t j = 0; j < num_vecs; j++) {
+      _mm512_storeu_ps(scores + i * kBlockN + j * 16, vec_acc[j]);
+    }
+  }
+}
+
+// Scale and mask the scores of a key block, and update the running max and
+// sum of each row with them. The scores are replaced by exp(score - max), and
+// rescale[i] is the factor to apply to the context accumulated from the
+// previous key blocks.
+template <typename scalar_t>
+inline void online_softmax_block(
+    const AttentionParams<scalar_t>& params,
+    const float* mask,
+    int64_t bm,
+    int64_t bn,
+    float* scores,
+    float* row_max,
+    float* row_sum,
+    float* rescale) {
+  const float neg_inf = -std::numeric_limits<float>::infinity();
+  auto vec_scale = _mm512_set1_ps(params.scale);
+  auto vec_fill = _mm512_set1_ps(params.fill);
+  auto vec_zero = _mm512_setzero_ps();
+  for (int64_t i = 0; i < bm; i++) {
+    float* scores_row = scores + i * kBlockN;
+    const float* mask_row =
+        mask == nullptr ? nullptr : mask + i * params.mask_strides[2];
+    auto vec_max = _mm512_set1_ps(neg_inf);
+    for (int64_t n = 0; n < bn; n += 16) {
+      auto mask_n = tail_mask(bn - n);
+      auto vec_s = _mm512_mul_ps(_mm512_loadu_ps(scores_row + n), vec_scale);
+      if (mask_row != nullptr) {
+        auto vec_mask = _mm512_maskz_loadu_ps(mask_n, mask_row + n);
+        if (params.mask_fill) {
+          auto fill_mask = _mm512_cmp_ps_mask(vec_mask, vec_zero, _CMP_NEQ_UQ);
+          vec_s = _mm512_mask_blend_ps(fill_mask, vec_s, vec_fill);
+        } else {
+          vec_s = _mm512_add_ps(vec_s, vec_mask);
+        }
+      }
+      vec_max = _mm512_mask_max_ps(vec_max, mask_n, vec_s, vec_max);
+      _mm512_storeu_ps(scores_row + n, vec_s);
+    }
+
+    float new_max = std::max(row_max[i], _mm512_reduce_max_ps(vec_max));
+    // Use 0 as the max of a row whose scores are all -inf so far, to avoid
+    // computing -inf - (-inf).
+    float max_used = new_max == neg_inf ? 0.f : new_max;
+    auto vec_max_used = _mm512_set1_ps(max_used);
+    auto vec_sum = vec_zero;
+    for (int64_t n = 0; n < bn; n += 16) {
+      auto mask_n = tail_mask(bn - n);
+      auto vec_p = _dil_exp_kernel(
+          _mm512_sub_ps(_mm512_loadu_ps(scores_row + n), vec_max_used));
+      // Zero the probabilities of the padding keys.
+      vec_p = _mm512_maskz_mov_ps(mask_n, vec_p);
+      vec_sum = _mm512_add_ps(vec_sum, vec_p);
+      _mm512_storeu_ps(scores_row + n, vec_p);
+    }
+    rescale[i] = std::exp(row_max[i] - max_used);
+    row_sum[i] = row_sum[i] * rescale[i] + _mm512_reduce_add_ps(vec_sum);
+    row_max[i] = new_max;
+  }
+}
+
+// acc[i] = acc[i] * rescale[i] + sum_n(probs[i, n] * value[n])
+template <typename scalar_t>
+inline void pv_block(
+    const scalar_t* value,
+    int64_t value_stride,
+    int64_t bm,
+    int64_t bn,
+    int64_t v_head_dim,
+    const float* probs,
+    const float* rescale,
+    float* acc) {
+  constexpr int64_t kVecs = 4;
+  for (int64_t i = 0; i < bm; i++) {
+    const float* probs_row = probs + i * kBlockN;
+    float* acc_row = acc + i * v_head_dim;
+    auto vec_rescale = _mm512_set1_ps(rescale[i]);
+    for (int64_t j = 0; j < v_head_dim; j += kVecs * 16) {
+      __m512 vec_acc[kVecs];
+      __mmask16 masks[kVecs];
+      for (int64_t k = 0; k < kVecs; k++) {
+        masks[k] = tail_mask(v_head_dim - j - k * 16);
+        vec_acc[k] = _mm512_mul_ps(
+            _mm512_maskz_loadu_ps(masks[k], acc_row + j + k * 16),
+            vec_rescale);
+      }
+      for (int64_t n = 0; n < bn; n++) {
+        auto vec_p = _mm512_set1_ps(probs_row[n]);
+        const scalar_t* value_row = value + n * value_stride + j;
+        for (int64_t k = 0; k < kVecs; k++) {
+          vec_acc[k] = _mm512_fmadd_ps(
+              vec_p, _maskz_loadu(value_row + k * 16, masks[k]), vec_acc[k]);
+        }
+      }
+      for (int64_t k = 0; k < kVecs; k++) {
+        _mm512_mask_storeu_ps(acc_row + j + k * 16, masks[k], vec_acc[k]);
+      }
+    }
+  }
+}
+
+// output[i] = acc[i] / row_sum[i]
+template <typename scalar_t>
+inline void normalize_block(
+    const float* acc,
+    const float* row_sum,
+    int64_t bm,
+    int64_t v_head_dim,
+    scalar_t* output,
+    int64_t output_stride) {
+  for (int64_t i = 0; i < bm; i++) {
+    auto vec_r_sum = _mm512_set1_ps(1.f / row_sum[i]);
+    for (int64_t j = 0; j < v_head_dim; j += 16) {
+      auto mask = tail_mask(v_head_dim - j);
+      auto vec_out = _mm512_mul_ps(
+          _mm512_maskz_loadu_ps(mask, acc + i * v_head_dim + j), vec_r_sum);
+      _mask_storeu(output + i * output_stride + j, vec_out, mask);
+    }
+  }
+}
+
+inline void reset_block_state(AttentionBuffers& buffers) {
+  std::fill(
+      buffers.row_max.begin(),
+      buffers.row_max.end(),
+      -std::numeric_limits<float>::infinity());
+  std::fill(buffers.row_sum.begin(), buffers.row_sum.end(), 0.f);
+  std::fill(buffers.acc.begin(), buffers.acc.end(), 0.f);
+}
+
+// Compute the context of the queries [m0, m0 + kBlockM) of a head.
+template <typename scalar_t>
+void attention_query_block(
+    const AttentionParams<scalar_t>& params,
+    int64_t b,
+    int64_t h,
+    int64_t m0,
+    AttentionBuffers& buffers) {
+  int64_t bm = std::min(kBlockM, params.q_len - m0);
+  const scalar_t* query = params.query + b * params.query_strides[0] +
+      h * params.query_strides[1] + m0 * params.query_strides[2];
+  const scalar_t* key =
+      params.key + b * params.key_strides[0] + h * params.key_strides[1];
+  const scalar_t* value = params.value + b * params.value_strides[0] +
+      h * params.value_strides[1];
+  const float* mask = nullptr;
+  if (params.mask != nullptr) {
+    mask = params.mask + b * params.mask_strides[0] +
+        h * params.mask_strides[1] + m0 * params.mask_strides[2];
+  }
+
+  reset_block_state(buffers);
+  for (int64_t n0 = 0; n0 < params.kv_len; n0 += kBlockN) {
+    int64_t bn = std::min(kBlockN, params.kv_len - n0);
+    qk_block(
+        query,
+        params.query_strides[2],
+        key + n0 * params.key_strides[2],
+        params.key_strides[2],
+        bm,
+        bn,
+        params.head_dim,
+        buffers.key_t.data(),
+        buffers.scores.data());
+    online_softmax_block(
+        params,
+        mask == nullptr ? nullptr : mask + n0,
+        bm,
+        bn,
+        buffers.scores.data(),
+        buffers.row_max.data(),
+        buffers.row_sum.data(),
+        buffers.rescale.data());
+    pv_block(
+        value + n0 * params.value_strides[2],
+        params.value_strides[2],
+        bm,
+        bn,
+        params.v_head_dim,
+        buffers.scores.data(),
+        buffers.rescale.data(),
+        buffers.acc.data());
+  }
+
+  auto output = params.output +
+      ((b * params.num_heads + h) * params.q_len + m0) * params.v_head_dim;
+  normalize_block(
+      buffers.acc.data(),
+      buffers.row_sum.data(),
+      bm,
+      params.v_head_dim,
+      output,
+      params.v_head_dim);
+}
+
+template <typename scalar_t>
+inline bool can_use_amx(const AttentionParams<scalar_t>& params) {
+  return false;
+}
+
+template <typename scalar_t>
+inline void run_query_block(
+    const AttentionParams<scalar_t>& params,
+    int64_t b,
+    int64_t h,
+    int64_t m0,
+    AttentionBuffers& buffers,
+    bool use_amx) {
+  attention_query_block(params, b, h, m0, buffers);
+}
+
+#if defined(CPU_CAPABILITY_AMX)
+typedef struct tileconfig_t {
+  uint8_t palette_id;
+  uint8_t startRow;
+  uint8_t reserved[14];
+  uint16_t colb[16];
+  uint8_t rows[16];
+} tileconfig_t;
+
+// All the tiles have 16 rows of 64 bytes: a C tile holds 16x16 fp32, an A
+// tile holds 16x32 bf16 and a B tile holds 16x16 pairs of bf16.
+inline void load_tile_config() {
+  tileconfig_t tc = {0};
+  tc.palette_id = 1;
+  for (int t = 0; t < 8; ++t) {
+    tc.rows[t] = 16;
+    tc.colb[t] = 64;
+  }
+  _tile_loadconfig((const void*)&tc);
+}
+
+bool request_amx_permission() {
+  // Linux requires the process to request the permission of the AMX tile
+  // data before using it.
+  constexpr int kArchReqXcompPerm = 0x1023;
+  constexpr int kXfeatureXtiledata = 18;
+  return syscall(SYS_arch_prctl, kArchReqXcompPerm, kXfeatureXtiledata) == 0;
+}
+
+template <>
+inline bool can_use_amx<at::BFloat16>(
+    const AttentionParams<at::BFloat16>& params) {
+  static bool amx_permitted = request_amx_permission();
+  return amx_permitted && params.head_dim % 32 == 0 &&
+      params.v_head_dim % 16 == 0;
+}
+
+// Copy the query block into query_bf16, the rows after bm are 0.
+inline void pack_query_block(
+    const at::BFloat16* query,
+    int64_t query_stride,
+    int64_t bm,
+    int64_t head_dim,
+    at::BFloat16* query_bf16) {
+  for (int64_t i = 0; i < kBlockM; i++) {
+    auto dst = query_bf16 + i * head_dim;
+    if (i < bm) {
+      std::memcpy(dst, query + i * query_stride, head_dim * sizeof(*dst));
+    } else {
+      std::memset(dst, 0, head_dim * sizeof(*dst));
+    }
+  }
+}
+
+// key_vnni[d / 2, n, d % 2] = key[n, d], the keys after bn are 0.
+inline void pack_key_block(
+    const at::BFloat16* key,
+    int64_t key_stride,
+    int64_t bn,
+    int64_t head_dim,
+    at::BFloat16* key_vnni) {
+  // Each pair of bf16 is moved as an uint32.
+  auto dst = reinterpret_cast<uint32_t*>(key_vnni);
+  for (int64_t n = 0; n < kBlockN; n++) {
+    auto src = reinterpret_cast<const uint32_t*>(key + n * key_stride);
+    for (int64_t d = 0; d < head_dim / 2; d++) {
+      dst[d * kBlockN + n] = n < bn ? src[d] : 0;
+    }
+  }
+}
+
+// value_vnni[n / 2, j, n % 2] = value[n, j], the keys after bn are 0.
+inline void pack_value_block(
+    const at::BFloat16* value,
+    int64_t value_stride,
+    int64_t bn,
+    int64_t v_head_dim,
+    at::BFloat16* value_vnni) {
+  for (int64_t n = 0; n < kBlockN; n += 2) {
+    auto dst = value_vnni + n * v_head_dim;
+    const at::BFloat16* row0 = value + n * value_stride;
+    const at::BFloat16* row1 = row0 + value_stride;
+    for (int64_t j = 0; j < v_head_dim; j++) {
+      dst[2 * j] = n < bn ? row0[j] : at::BFloat16(0.f);
+      dst[2 * j + 1] = n + 1 < bn ? row1[j] : at::BFloat16(0.f);
+    }
+  }
+}
+
+inline void qk_block_amx(
+    const at::BFloat16* query_bf16,
+    const at::BFloat16* key_vnni,
+    int64_t bm,
+    int64_t bn,
+    int64_t head_dim,
+    float* scores) {
+  const int32_t a_stride = head_dim * sizeof(at::BFloat16);
+  const int32_t b_stride = kBlockN * 2 * sizeof(at::BFloat16);
+  const int32_t c_stride = kBlockN * sizeof(float);
+  for (int64_t i = 0; i < bm; i += 16) {
+    for (int64_t n = 0; n < bn; n += 32) {
+      _tile_zero(0);
+      _tile_zero(1);
+      for (int64_t d = 0; d < head_dim; d += 32) {
+        _tile_loadd(2, query_bf16 + i * head_dim + d, a_stride);
+        _tile_loadd(3, key_vnni + d * kBlockN + n * 2, b_stride);
+        _tile_loadd(4, key_vnni + d * kBlockN + (n + 16) * 2, b_stride);
+        _tile_dpbf16ps(0, 2, 3);
+        _tile_dpbf16ps(1, 2, 4);
+      }
+      _tile_stored(0, scores + i * kBlockN + n, c_stride);
+      _tile_stored(1, scores + i * kBlockN + n + 16, c_stride);
+    }
+  }
+}
+
+inline void pv_block_amx(
+    const at::BFloat16* probs_bf16,
+    const at::BFloat16* value_vnni,
+    int64_t bm,
+    int64_t bn,
+    int64_t v_head_dim,
+    float* context) {
+  const int32_t a_stride = kBlockN * sizeof(at::BFloat16);
+  const int32_t b_stride = v_head_dim * 2 * sizeof(at::BFloat16);
+  const int32_t c_stride = v_head_dim * sizeof(float);
+  for (int64_t i = 0; i < bm; i += 16) {
+    for (int64_t j = 0; j < v_head_dim; j += 16) {
+      _tile_zero(0);
+      for (int64_t n = 0; n < bn; n += 32) {
+        _tile_loadd(2, probs_bf16 + i * kBlockN + n, a_stride);
+        _tile_loadd(3, value_vnni + n * v_head_dim + j * 2, b_stride);
+        _tile_dpbf16ps(0, 2, 3);
+      }
+      _tile_stored(0, context + i * v_head_dim + j, c_stride);
+    }
+  }
+}
+
+// The AMX version of attention_query_block. The two matmuls of a block run
+// on the tiles in BF16, the online softmax is the same as the AVX512 path.
+void attention_query_block_amx(
+    const AttentionParams<at::BFloat16>& params,
+    int64_t b,
+    int64_t h,
+    int64_t m0,
+    AttentionBuffers& buffers) {
+  int64_t bm = std::min(kBlockM, params.q_len - m0);
+  const at::BFloat16* query = params.query + b * params.query_strides[0] +
+      h * params.query_strides[1] + m0 * params.query_strides[2];
+  const at::BFloat16* key =
+      params.key + b * params.key_strides[0] + h * params.key_strides[1];
+  const at::BFloat16* value = params.value + b * params.value_strides[0] +
+      h * params.value_strides[1];
+  const float* mask = nullptr;
+  if (params.mask != nullptr) {
+    mask = params.mask + b * params.mask_strides[0] +
+        h * params.mask_strides[1] + m0 * params.mask_strides[2];
+  }
+  int64_t v_head_dim = params.v_head_dim;
+
+  reset_block_state(buffers);
+  pack_query_block(
+      query,
+      params.query_strides[2],
+      bm,
+      params.head_dim,
+      buffers.query_bf16.data());
+  for (int64_t n0 = 0; n0 < params.kv_len; n0 += kBlockN) {
+    int64_t bn = std::min(kBlockN, params.kv_len - n0);
+    pack_key_block(
+        key + n0 * params.key_strides[2],
+        params.key_strides[2],
+        bn,
+        params.head_dim,
+        buffers.key_vnni.data());
+    qk_block_amx(
+        buffers.query_bf16.data(),
+        buffers.key_vnni.data(),
+        bm,
+        bn,
+        params.head_dim,
+        buffers.scores.data());
+    online_softmax_block(
+        params,
+        mask == nullptr ? nullptr : mask + n0,
+        bm,
+        bn,
+        buffers.scores.data(),
+        buffers.row_max.data(),
+        buffers.row_sum.data(),
+        buffers.rescale.data());
+
+    // The K dim of the tiles is 32 keys, so zero the probabilities up to the
+    // next multiple of 32.
+    int64_t bn_padded = (bn + 31) / 32 * 32;
+    for (int64_t i = 0; i < bm; i++) {
+      for (int64_t n = 0; n < bn_padded; n += 16) {
+        auto vec_p = _mm512_maskz_loadu_ps(
+            tail_mask(bn - n), buffers.scores.data() + i * kBlockN + n);
+        _storeu(buffers.probs_bf16.data() + i * kBlockN + n, vec_p);
+      }
+    }
+    pack_value_block(
+        value + n0 * params.value_strides[2],
+        params.value_strides[2],
+        bn,
+        v_head_dim,
+        buffers.value_vnni.data());
+    pv_block_amx(
+        buffers.probs_bf16.data(),
+        buffers.value_vnni.data(),
+        bm,
+        bn,
+        v_head_dim,
+        buffers.context.data());
+
+    for (int64_t i = 0; i < bm; i++) {
+      float* acc_row = buffers.acc.data() + i * v_head_dim;
+      const float* context_row = buffers.context.data() + i * v_head_dim;
+      auto vec_rescale = _mm512_set1_ps(buffers.rescale[i]);
+      for (int64_t j = 0; j < v_head_dim; j += 16) {
+        auto vec_acc = _mm512_fmadd_ps(
+            _mm512_loadu_ps(acc_row + j),
+            vec_rescale,
+            _mm512_loadu_ps(context_row + j));
+        _mm512_storeu_ps(acc_row + j, vec_acc);
+      }
+    }
+  }
+
+  auto output = params.output +
+      ((b * params.num_heads + h) * params.q_len + m0) * v_head_dim;
+  normalize_block(
+      buffers.acc.data(),
+      buffers.row_sum.data(),
+      bm,
+      v_head_dim,
+      output,
+      v_head_dim);
+}
+
+inline void run_query_block(
+    const AttentionParams<at::BFloat16>& params,
+    int64_t b,
+    int64_t h,
+    int64_t m0,
+    AttentionBuffers& buffers,
+    bool use_amx) {
+  if (use_amx) {
+    attention_query_block_amx(params, b, h, m0, buffers);
+  } else {
+    attention_query_block(params, b, h, m0, buffers);
+  }
+}
+#endif
+
+template <typename scalar_t>
+at::Tensor flash_attention(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& mask,
+    const float& scale,
+    const bool& mask_fill,
+    const float& fill) {
+  AttentionParams<scalar_t> params;
+  params.batch_size = query.size(0);
+  params.num_heads = query.size(1);
+  params.q_len = query.size(2);
+  params.head_dim = query.size(3);
+  params.kv_len = key.size(2);
+  params.v_head_dim = value.size(3);
+  params.scale = scale;
+  params.mask_fill = mask_fill;
+  params.fill = fill;
+
+  auto output = at::empty(
+      {params.batch_size, params.num_heads, params.q_len, params.v_head_dim},
+      query.options());
+  params.query = query.data_ptr<scalar_t>();
+  params.key = key.data_ptr<scalar_t>();
+  params.value = value.data_ptr<scalar_t>();
+  params.mask = mask.defined() ? mask.data_ptr<float>() : nullptr;
+  params.output = output.data_ptr<scalar_t>();
+  for (int i = 0; i < 3; i++) {
+    params.query_strides[i] = query.stride(i);
+    params.key_strides[i] = key.stride(i);
+    params.value_strides[i] = value.stride(i);
+    params.mask_strides[i] = mask.defined() ? mask.stride(i) : 0;
+  }
+
+  bool use_amx = can_use_amx(params);
+  int64_t num_m_blocks = (params.q_len + kBlockM - 1) / kBlockM;
+  at::parallel_for(
+      0,
+      params.batch_size * params.num_heads * num_m_blocks,
+      1,
+      [&](int64_t begin, int64_t end) {
+        AttentionBuffers buffers(
+            params.head_dim, params.v_head_dim, use_amx);
+#if defined(CPU_CAPABILITY_AMX)
+        if (use_amx) {
+          load_tile_config();
+        }
+#endif
+        for (int64_t i = begin; i < end; i++) {
+          int64_t m0 = (i % num_m_blocks) * kBlockM;
+          int64_t h = (i / num_m_blocks) % params.num_heads;
+          int64_t b = i / num_m_blocks / params.num_heads;
+          run_query_block(params, b, h, m0, buffers, use_amx);
+        }
+#if defined(CPU_CAPABILITY_AMX)
+        if (use_amx) {
+          _tile_release();
+        }
+#endif
+      });
+  return output;
+}
+#endif
+
+at::Tensor flash_attention_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    const at::Tensor& mask,
+    const float& scale,
+    const bool& mask_fill,
+    const float& fill) {
+  TORCH_CHECK(
+      query.dim() == 4 && key.dim() == 4 && value.dim() == 4,
+      "FlashAttention: expect 4D query, key and value");
+  TORCH_CHECK(
+      key.size(0) == query.size(0) && key.size(1) == query.size(1) &&
+          key.size(3) == query.size(3),
+      "FlashAttention: the shape of key doesn't match query");
+  TORCH_CHECK(
+      value.size(0) == query.size(0) && value.size(1) == query.size(1) &&
+          value.size(2) == key.size(2),
+      "FlashAttention: the shape of value doesn't match key");
+  std::vector<int64_t> scores_size{
+      query.size(0), query.size(1), query.size(2), key.size(2)};
+
+#if defined(CPU_CAPABILITY_AVX512)
+  if ((query.scalar_type() == at::kFloat ||
+       query.scalar_type() == at::kBFloat16) &&
+      key.scalar_type() == query.scalar_type() &&
+      value.scalar_type() == query.scalar_type() && query.size(2) > 0 &&
+      key.size(2) > 0) {
+    // The kernel only needs the last dims to be dense, and reads the mask
+    // with the strides of its expanded view.
+    auto dense_last_dim = [](const at::Tensor& t) {
+      return t.stride(-1) == 1 ? t : t.contiguous();
+    };
+    auto _mask = mask;
+    if (_mask.defined()) {
+      _mask = _mask.to(at::kFloat).expand(scores_size);
+      if (_mask.stride(-1) != 1) {
+        _mask = _mask.contiguous();
+      }
+    }
+    if (query.scalar_type() == at::kFloat) {
+      return flash_attention<float>(
+          dense_last_dim(query),
+          dense_last_dim(key),
+          dense_last_dim(value),
+          _mask,
+          scale,
+          mask_fill,
+          fill);
+    } else {
+      return flash_attention<at::BFloat16>(
+          dense_last_dim(query),
+          dense_last_dim(key),
+          dense_last_dim(value),
+          _mask,
+          scale,
+          mask_fill,
+          fill);
+    }
+  }
+#endif
+  auto scores = at::matmul(query, key.transpose(-1, -2)).mul_(scale);
+  if (mask.defined()) {
+    auto _mask = mask.expand(scores_size);
+    if (mask_fill) {
+      scores.masked_fill_(_mask.ne(0), fill);
+    } else {
+      scores.add_(_mask);
+    }
+  }
+  return at::matmul(at::softmax(scores, -1), value);
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(flash_attention_kernel_stub, &flash_attention_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -156,7 +156,7 @@ inline at::Tensor _interaction_forward(const std::vector<at::Tensor>& input) {
     ideep::tensor lhs({lhs_desc, cat_buf});
     ideep::tensor rhs({lhs_desc, cat_buf});
     ideep::tensor res({res_desc, mm_buf});
-    ideep::tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = ideep::tensor::make_scratchpad(pd.scratchpad_desc());
     auto p = dnnl::matmul(pd);
     for (int64_t i = start; i < end; i++) {
       move_ker(&out_data[i * out_data_line_len], input_ptr[0], vector_size);
@@ -243,7 +243,7 @@ inline std::vector<at::Tensor> _interaction_backward(
     ideep::tensor lhs({lhs_desc, sum_buf});
     ideep::tensor rhs({lhs_desc, cat_buf});
     ideep::tensor res({res_desc, grad_cat_buf});
-    ideep::tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = ideep::tensor::make_scratchpad(pd.scratchpad_desc());
     auto p = dnnl::matmul(pd);
     for (int64_t i = start; i < end; i++) {
       // Special BMM characteristics in Interaction layer
@@ -0,0 +1,441 @@
+#include <csrc/aten/cpu/KVCache.h>
+
+#include <ATen/Parallel.h>
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(CPU_CAPABILITY_AVX512)
+#include "csrc/cpu/vec512/add_softmax.h"
+#endif
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+#if defined(CPU_CAPABILITY_AVX512)
+using namespace torch_ipex::cpu::kernel::vec::vec512;
+
+inline __mmask16 tail_mask(int64_t size) {
+  return size >= 16 ? 0xFFFF : static_cast<__mmask16>((1 << size) - 1);
+}
+
+inline __m512 maskz_load_f32(const float* data, __mmask16 mask) {
+  return _mm512_maskz_loadu_ps(mask, data);
+}
+
+inline __m512 maskz_load_f32(const at::BFloat16* data, __mmask16 mask) {
+  return _maskz_loadu(data, mask);
+}
+
+inline __m512 maskz_load_f32(const int8_t* data, __mmask16 mask) {
+  return _mm512_cvtepi32_ps(
+      _mm512_cvtepi8_epi32(_mm_maskz_loadu_epi8(mask, data)));
+}
+#endif
+
+template <typename cache_t>
+inline float dot_product(const float* a, const cache_t* b, int64_t size) {
+#if defined(CPU_CAPABILITY_AVX512)
+  auto vec_sum = _mm512_setzero_ps();
+  for (int64_t i = 0; i < size; i += 16) {
+    auto mask = tail_mask(size - i);
+    vec_sum = _mm512_fmadd_ps(
+        _mm512_maskz_loadu_ps(mask, a + i),
+        maskz_load_f32(b + i, mask),
+        vec_sum);
+  }
+  return _mm512_reduce_add_ps(vec_sum);
+#else
+  float sum = 0.f;
+  for (int64_t i = 0; i < size; i++) {
+    sum += a[i] * static_cast<float>(b[i]);
+  }
+  return sum;
+#endif
+}
+
+// out += alpha * b
+template <typename cache_t>
+inline void axpy(float* out, float alpha, const cache_t* b, int64_t size) {
+#if defined(CPU_CAPABILITY_AVX512)
+  auto vec_alpha = _mm512_set1_ps(alpha);
+  for (int64_t i = 0; i < size; i += 16) {
+    auto mask = tail_mask(size - i);
+    auto vec_out = _mm512_fmadd_ps(
+        vec_alpha,
+        maskz_load_f32(b + i, mask),
+        _mm512_maskz_loadu_ps(mask, out + i));
+    _mm512_mask_storeu_ps(out + i, mask, vec_out);
+  }
+#else
+  for (int64_t i = 0; i < size; i++) {
+    out[i] += alpha * static_cast<float>(b[i]);
+  }
+#endif
+}
+
+// Write the scores exp(x - max) in place and return their sum.
+inline float exp_reduce_sum(float* scores, int64_t size, float max) {
+#if defined(CPU_CAPABILITY_AVX512)
+  // scores is allocated by at::empty, so it's 64 bytes aligned.
+  float sum = max;
+  _dil_exp_reduce_sum_fusion_kernel(scores, size, scores, sum);
+  return sum;
+#else
+  float sum = 0.f;
+  for (int64_t i = 0; i < size; i++) {
+    scores[i] = std::exp(scores[i] - max);
+    sum += scores[i];
+  }
+  return sum;
+#endif
+}
+
+template <typename scalar_t, typename cache_t>
+inline void store_token(
+    const scalar_t* src,
+    cache_t* dst,
+    float* /* scale */,
+    int64_t size) {
+  for (int64_t i = 0; i < size; i++) {
+    dst[i] = static_cast<cache_t>(src[i]);
+  }
+}
+
+// Quantize the token with the symmetric scale absmax / 127.
+template <typename scalar_t>
+inline void store_token(
+    const scalar_t* src,
+    int8_t* dst,
+    float* scale,
+    int64_t size) {
+  float absmax = 0.f;
+  for (int64_t i = 0; i < size; i++) {
+    absmax = std::max(absmax, std::abs(static_cast<float>(src[i])));
+  }
+  *scale = absmax / 127.f;
+  float inv_scale = absmax > 0.f ? 127.f / absmax : 0.f;
+  for (int64_t i = 0; i < size; i++) {
+    float q = std::nearbyint(static_cast<float>(src[i]) * inv_scale);
+    dst[i] = static_cast<int8_t>(std::min(std::max(q, -127.f), 127.f));
+  }
+}
+
+template <typename cache_t>
+inline cache_t* cache_data(const at::Tensor& cache) {
+  return static_cast<cache_t*>(cache.data_ptr());
+}
+
+template <typename scalar_t, typename cache_t>
+void kv_cache_append(
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    at::Tensor& key_scale,
+    at::Tensor& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& seq_lens) {
+  int64_t batch_size = key.size(0);
+  int64_t num_heads = key.size(1);
+  int64_t head_dim = key.size(3);
+  int64_t v_head_dim = value.size(3);
+  int64_t block_size = key_cache.size(2);
+  int64_t max_blocks = block_table.size(1);
+
+  auto key_data = key.data_ptr<scalar_t>();
+  auto value_data = value.data_ptr<scalar_t>();
+  auto key_cache_data = cache_data<cache_t>(key_cache);
+  auto value_cache_data = cache_data<cache_t>(value_cache);
+  auto key_scale_data =
+      key_scale.defined() ? key_scale.data_ptr<float>() : nullptr;
+  auto value_scale_data =
+      value_scale.defined() ? value_scale.data_ptr<float>() : nullptr;
+  auto block_table_data = block_table.data_ptr<int64_t>();
+  auto seq_lens_data = seq_lens.data_ptr<int64_t>();
+
+  at::parallel_for(
+      0, batch_size * num_heads, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          int64_t b = i / num_heads;
+          int64_t h = i % num_heads;
+          int64_t pos = seq_lens_data[b];
+          int64_t block = block_table_data[b * max_blocks + pos / block_size];
+          // Index of the token in [num_blocks, num_heads, block_size].
+          int64_t slot = (block * num_heads + h) * block_size + pos % block_size;
+          store_token(
+              key_data + i * head_dim,
+              key_cache_data + slot * head_dim,
+              key_scale_data ? key_scale_data + slot : nullptr,
+              head_dim);
+          store_token(
+              value_data + i * v_head_dim,
+              value_cache_data + slot * v_head_dim,
+              value_scale_data ? value_scale_data + slot : nullptr,
+              v_head_dim);
+        }
+      });
+}
+
+template <typename scalar_t, typename cache_t>
+at::Tensor kv_cache_attention(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& key_scale,
+    const at::Tensor& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& context_lens,
+    const float& scale,
+    const at::Tensor& attention_mask) {
+  int64_t batch_size = query.size(0);
+  int64_t num_heads = query.size(1);
+  int64_t head_dim = query.size(3);
+  int64_t v_head_dim = value_cache.size(3);
+  int64_t block_size = key_cache.size(2);
+  int64_t max_blocks = block_table.size(1);
+  int64_t max_context_len = context_lens.max().item<int64_t>();
+
+  auto output =
+      at::empty({batch_size, num_heads, 1, v_head_dim}, query.options());
+  auto query_data = query.data_ptr<scalar_t>();
+  auto output_data = output.data_ptr<scalar_t>();
+  auto key_cache_data = cache_data<cache_t>(key_cache);
+  auto value_cache_data = cache_data<cache_t>(value_cache);
+  auto key_scale_data =
+      key_scale.defined() ? key_scale.data_ptr<float>() : nullptr;
+  auto value_scale_data =
+      value_scale.defined() ? value_scale.data_ptr<float>() : nullptr;
+  auto block_table_data = block_table.data_ptr<int64_t>();
+  auto context_lens_data = context_lens.data_ptr<int64_t>();
+  auto mask_data =
+      attention_mask.defined() ? attention_mask.data_ptr<float>() : nullptr;
+  int64_t mask_batch_stride = attention_mask.defined() &&
+          attention_mask.size(0) > 1
+      ? attention_mask.size(1)
+      : 0;
+
+  at::parallel_for(
+      0, batch_size * num_heads, 1, [&](int64_t begin, int64_t end) {
+        auto buffer = at::empty(
+            {max_context_len + head_dim + v_head_dim},
+            query.options().dtype(at::kFloat));
+        float* scores = buffer.data_ptr<float>();
+        float* q = scores + max_context_len;
+        float* acc = q + head_dim;
+        for (int64_t i = begin; i < end; i++) {
+          int64_t b = i / num_heads;
+          int64_t h = i % num_heads;
+          int64_t context_len = context_lens_data[b];
+          const int64_t* blocks = block_table_data + b * max_blocks;
+          scalar_t* out = output_data + i * v_head_dim;
+          if (context_len == 0) {
+            std::fill_n(out, v_head_dim, static_cast<scalar_t>(0));
+            continue;
+          }
+
+          // Fold the scale into the query.
+          for (int64_t d = 0; d < head_dim; d++) {
+            q[d] = static_cast<float>(query_data[i * head_dim + d]) * scale;
+          }
+          // scores = q * k^T (+ mask) over the blocks of the sequence.
+          float max = -std::numeric_limits<float>::infinity();
+          for (int64_t t0 = 0; t0 < context_len; t0 += block_size) {
+            int64_t slot0 =
+                (blocks[t0 / block_size] * num_heads + h) * block_size;
+            int64_t len = std::min(block_size, context_len - t0);
+            for (int64_t t = 0; t < len; t++) {
+              float s = dot_product(
+                  q, key_cache_data + (slot0 + t) * head_dim, head_dim);
+              if (key_scale_data != nullptr) {
+                s *= key_scale_data[slot0 + t];
+              }
+              if (mask_data != nullptr) {
+                s += mask_data[b * mask_batch_stride + t0 + t];
+              }
+              scores[t0 + t] = s;
+              max = std::max(max, s);
+            }
+          }
+          if (max == -std::numeric_limits<float>::infinity()) {
+            // All the tokens are masked out.
+            std::fill_n(out, v_head_dim, static_cast<scalar_t>(0));
+            continue;
+          }
+          float sum = exp_reduce_sum(scores, context_len, max);
+
+          // out = softmax(scores) * v
+          std::fill_n(acc, v_head_dim, 0.f);
+          for (int64_t t0 = 0; t0 < context_len; t0 += block_size) {
+            int64_t slot0 =
+                (blocks[t0 / block_size] * num_heads + h) * block_size;
+            int64_t len = std::min(block_size, context_len - t0);
+            for (int64_t t = 0; t < len; t++) {
+              float p = scores[t0 + t];
+              if (value_scale_data != nullptr) {
+                p *= value_scale_data[slot0 + t];
+              }
+              axpy(
+                  acc,
+                  p,
+                  value_cache_data + (slot0 + t) * v_head_dim,
+                  v_head_dim);
+            }
+          }
+          float inv_sum = 1.f / sum;
+          for (int64_t d = 0; d < v_head_dim; d++) {
+            out[d] = static_cast<scalar_t>(acc[d] * inv_sum);
+          }
+        }
+      });
+  return output;
+}
+
+void kv_cache_append_kernel_impl(
+    const at::Tensor& key,
+    const at::Tensor& value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    at::Tensor& key_scale,
+    at::Tensor& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& seq_lens) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, key.scalar_type(), "kv_cache_append_", [&] {
+        TORCH_CHECK(
+            value.scalar_type() == key.scalar_type(),
+            "kv_cache_append_: expect key and value of the same dtype");
+        switch (key_cache.scalar_type()) {
+          case at::kFloat:
+            kv_cache_append<scalar_t, float>(
+                key,
+                value,
+                key_cache,
+                value_cache,
+                key_scale,
+                value_scale,
+                block_table,
+                seq_lens);
+            break;
+          case at::kBFloat16:
+            kv_cache_append<scalar_t, at::BFloat16>(
+                key,
+                value,
+                key_cache,
+                value_cache,
+                key_scale,
+                value_scale,
+                block_table,
+                seq_lens);
+            break;
+          default:
+            kv_cache_append<scalar_t, int8_t>(
+                key,
+                value,
+                key_cache,
+                value_cache,
+                key_scale,
+                value_scale,
+                block_table,
+                seq_lens);
+        }
+      });
+}
+
+at::Tensor kv_cache_attention_kernel_impl(
+    const at::Tensor& query,
+    const at::Tensor& key_cache,
+    const at::Tensor& value_cache,
+    const at::Tensor& key_scale,
+    const at::Tensor& value_scale,
+    const at::Tensor& block_table,
+    const at::Tensor& context_lens,
+    const float& scale,
+    const at::Tensor& attention_mask) {
+  if (query.scalar_type() == at::kBFloat16) {
+    switch (key_cache.scalar_type()) {
+      case at::kFloat:
+        return kv_cache_attention<at::BFloat16, float>(
+            query,
+            key_cache,
+            value_cache,
+            key_scale,
+            value_scale,
+            block_table,
+            context_lens,
+            scale,
+            attention_mask);
+      case at::kBFloat16:
+        return kv_cache_attention<at::BFloat16, at::BFloat16>(
+            query,
+            key_cache,
+            value_cache,
+            key_scale,
+            value_scale,
+            block_table,
+            context_lens,
+            scale,
+            attention_mask);
+      default:
+        return kv_cache_attention<at::BFloat16, int8_t>(
+            query,
+            key_cache,
+            value_cache,
+            key_scale,
+            value_scale,
+            block_table,
+            context_lens,
+            scale,
+            attention_mask);
+    }
+  }
+  switch (key_cache.scalar_type()) {
+    case at::kFloat:
+      return kv_cache_attention<float, float>(
+          query,
+          key_cache,
+          value_cache,
+          key_scale,
+          value_scale,
+          block_table,
+          context_lens,
+          scale,
+          attention_mask);
+    case at::kBFloat16:
+      return kv_cache_attention<float, at::BFloat16>(
+          query,
+          key_cache,
+          value_cache,
+          key_scale,
+          value_scale,
+          block_table,
+          context_lens,
+          scale,
+          attention_mask);
+    default:
+      return kv_cache_attention<float, int8_t>(
+          query,
+          key_cache,
+          value_cache,
+          key_scale,
+          value_scale,
+          block_table,
+          context_lens,
+          scale,
+          attention_mask);
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(kv_cache_append_kernel_stub, &kv_cache_append_kernel_impl);
+REGISTER_DISPATCH(
+    kv_cache_attention_kernel_stub,
+    &kv_cache_attention_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
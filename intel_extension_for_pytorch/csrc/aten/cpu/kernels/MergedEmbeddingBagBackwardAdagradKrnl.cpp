@@ -0,0 +1,144 @@
+#include "MergedEmbeddingBagBackwardKrnl.h"
+
+#include <cmath>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using namespace at;
+
+template <typename T>
+inline void AccGradUpdate<T, AdagradArgs>::update(
+    T* weight,
+    T* grad,
+    const BatchedHyperCompressedSparseColumn& batched_csc,
+    int64_t uniq_index_id,
+    int64_t weight_offsets,
+    int vector_size,
+    int table_id,
+    acc_type<T, true>* buffer,
+    const AdagradArgs& args) {
+  using acc_t = acc_type<T, true>;
+  acc_t* grad_acc_buffer = buffer;
+  accumulate_row_grad(
+      grad_acc_buffer, grad, batched_csc, uniq_index_id, vector_size);
+  T* weight_ptr = &weight[weight_offsets];
+  BFloat16* bf16_trail_ptr =
+      get_trail_ptr<T>(args.bf16_trail, table_id, weight_offsets);
+  acc_t* state_ptr =
+      args.state_sum[table_id].data_ptr<acc_t>() + weight_offsets;
+  acc_t* param_buffer = buffer + vector_size;
+  load_master_weight<T, acc_t>(
+      param_buffer, weight_ptr, bf16_trail_ptr, vector_size);
+  // adagrad update
+  const acc_t weight_decay = args.weight_decay;
+  const acc_t lr = args.lr;
+  const acc_t eps = args.eps;
+#pragma omp simd
+  for (int d = 0; d < vector_size; d++) {
+    acc_t grad_val = grad_acc_buffer[d] + param_buffer[d] * weight_decay;
+    state_ptr[d] += grad_val * grad_val;
+    param_buffer[d] -= lr * grad_val / (std::sqrt(state_ptr[d]) + eps);
+  }
+  store_master_weight<T, acc_t>(
+      weight_ptr, bf16_trail_ptr, param_buffer, vector_size);
+}
+
+template <typename T>
+inline void AccGradUpdate<T, RowwiseAdagradArgs>::update(
+    T* weight,
+    T* grad,
+    const BatchedHyperCompressedSparseColumn& batched_csc,
+    int64_t uniq_index_id,
+    int64_t weight_offsets,
+    int vector_size,
+    int table_id,
+    acc_type<T, true>* buffer,
+    const RowwiseAdagradArgs& args) {
+  using acc_t = acc_type<T, true>;
+  acc_t* grad_acc_buffer = buffer;
+  accumulate_row_grad(
+      grad_acc_buffer, grad, batched_csc, uniq_index_id, vector_size);
+  T* weight_ptr = &weight[weight_offsets];
+  BFloat16* bf16_trail_ptr =
+      get_trail_ptr<T>(args.bf16_trail, table_id, weight_offsets);
+  // One state per row.
+  acc_t* state_ptr =
+      args.state_sum[table_id].data_ptr<acc_t>() + weight_offsets / vector_size;
+  acc_t* param_buffer = buffer + vector_size;
+  load_master_weight<T, acc_t>(
+      param_buffer, weight_ptr, bf16_trail_ptr, vector_size);
+  // row-wise adagrad update
+  const acc_t weight_decay = args.weight_decay;
+  const acc_t lr = args.lr;
+  const acc_t eps = args.eps;
+  acc_t grad_sq_sum = 0;
+#pragma omp simd reduction(+ : grad_sq_sum)
+  for (int d = 0; d < vector_size; d++) {
+    grad_acc_buffer[d] += param_buffer[d] * weight_decay;
+    grad_sq_sum += grad_acc_buffer[d] * grad_acc_buffer[d];
+  }
+  *state_ptr += grad_sq_sum / vector_size;
+  const acc_t step_size = lr / (std::sqrt(*state_ptr) + eps);
+#pragma omp simd
+  for (int d = 0; d < vector_size; d++) {
+    param_buffer[d] -= step_size * grad_acc_buffer[d];
+  }
+  store_master_weight<T, acc_t>(
+      weight_ptr, bf16_trail_ptr, param_buffer, vector_size);
+}
+
+void merged_embeddingbag_backward_adagrad_cpu_kernel_impl(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& bf16_trail,
+    const std::vector<Tensor>& state_sum,
+    bool rowwise,
+    double eps,
+    double weight_decay,
+    double lr) {
+  auto grads_y = get_contiguous_grads(grads_y_, weights);
+  if (rowwise) {
+    RowwiseAdagradArgs args =
+        RowwiseAdagradArgs(bf16_trail, state_sum, eps, weight_decay, lr);
+    merged_embeddingbag_backward_cpu_kernel<RowwiseAdagradArgs>(
+        grads_y,
+        indices,
+        offsets,
+        weights,
+        indices_with_row_offset,
+        row_offsets,
+        pooling_modes,
+        args);
+  } else {
+    AdagradArgs args =
+        AdagradArgs(bf16_trail, state_sum, eps, weight_decay, lr);
+    merged_embeddingbag_backward_cpu_kernel<AdagradArgs>(
+        grads_y,
+        indices,
+        offsets,
+        weights,
+        indices_with_row_offset,
+        row_offsets,
+        pooling_modes,
+        args);
+  }
+
+  return;
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    merged_embeddingbag_backward_adagrad_cpu_kernel_stub,
+    &merged_embeddingbag_backward_adagrad_cpu_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
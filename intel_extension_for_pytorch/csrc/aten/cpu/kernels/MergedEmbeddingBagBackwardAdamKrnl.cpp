@@ -0,0 +1,125 @@
+#include "MergedEmbeddingBagBackwardKrnl.h"
+
+#include <cmath>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using namespace at;
+
+template <typename T>
+inline void AccGradUpdate<T, AdamArgs>::update(
+    T* weight,
+    T* grad,
+    const BatchedHyperCompressedSparseColumn& batched_csc,
+    int64_t uniq_index_id,
+    int64_t weight_offsets,
+    int vector_size,
+    int table_id,
+    acc_type<T, true>* buffer,
+    const AdamArgs& args) {
+  using acc_t = acc_type<T, true>;
+  acc_t* grad_acc_buffer = buffer;
+  accumulate_row_grad(
+      grad_acc_buffer, grad, batched_csc, uniq_index_id, vector_size);
+  T* weight_ptr = &weight[weight_offsets];
+  BFloat16* bf16_trail_ptr =
+      get_trail_ptr<T>(args.bf16_trail, table_id, weight_offsets);
+  acc_t* exp_avg_ptr =
+      args.exp_avg[table_id].data_ptr<acc_t>() + weight_offsets;
+  acc_t* exp_avg_sq_ptr =
+      args.exp_avg_sq[table_id].data_ptr<acc_t>() + weight_offsets;
+  acc_t* param_buffer = buffer + vector_size;
+  load_master_weight<T, acc_t>(
+      param_buffer, weight_ptr, bf16_trail_ptr, vector_size);
+
+  const acc_t beta1 = args.beta1;
+  const acc_t beta2 = args.beta2;
+  const acc_t eps = args.eps;
+  const acc_t weight_decay = args.weight_decay;
+  const acc_t bias_correction1 = 1 - std::pow(beta1, args.step);
+  const acc_t bias_correction2 = 1 - std::pow(beta2, args.step);
+  // Adam decays the grad, LAMB decays the update (as AdamW).
+  const acc_t grad_decay = args.use_lamb ? 0 : weight_decay;
+  const acc_t update_decay = args.use_lamb ? weight_decay : 0;
+  // The update is computed into grad_acc_buffer.
+  acc_t param_norm_sq = 0;
+  acc_t update_norm_sq = 0;
+#pragma omp simd reduction(+ : param_norm_sq, update_norm_sq)
+  for (int d = 0; d < vector_size; d++) {
+    acc_t grad_val = grad_acc_buffer[d] + param_buffer[d] * grad_decay;
+    exp_avg_ptr[d] = beta1 * exp_avg_ptr[d] + (1 - beta1) * grad_val;
+    exp_avg_sq_ptr[d] =
+        beta2 * exp_avg_sq_ptr[d] + (1 - beta2) * grad_val * grad_val;
+    acc_t update_val = (exp_avg_ptr[d] / bias_correction1) /
+            (std::sqrt(exp_avg_sq_ptr[d] / bias_correction2) + eps) +
+        param_buffer[d] * update_decay;
+    grad_acc_buffer[d] = update_val;
+    param_norm_sq += param_buffer[d] * param_buffer[d];
+    update_norm_sq += update_val * update_val;
+  }
+  acc_t step_size = args.lr;
+  if (args.use_lamb && param_norm_sq > 0 && update_norm_sq > 0) {
+    step_size *= std::sqrt(param_norm_sq / update_norm_sq);
+  }
+#pragma omp simd
+  for (int d = 0; d < vector_size; d++) {
+    param_buffer[d] -= step_size * grad_acc_buffer[d];
+  }
+  store_master_weight<T, acc_t>(
+      weight_ptr, bf16_trail_ptr, param_buffer, vector_size);
+}
+
+void merged_embeddingbag_backward_adam_cpu_kernel_impl(
+    const std::vector<Tensor>& grads_y_,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const std::vector<Tensor>& bf16_trail,
+    const std::vector<Tensor>& exp_avg,
+    const std::vector<Tensor>& exp_avg_sq,
+    int64_t step,
+    double beta1,
+    double beta2,
+    double eps,
+    double weight_decay,
+    double lr,
+    bool use_lamb) {
+  auto grads_y = get_contiguous_grads(grads_y_, weights);
+  AdamArgs args = AdamArgs(
+      bf16_trail,
+      exp_avg,
+      exp_avg_sq,
+      step,
+      beta1,
+      beta2,
+      eps,
+      weight_decay,
+      lr,
+      use_lamb);
+  merged_embeddingbag_backward_cpu_kernel<AdamArgs>(
+      grads_y,
+      indices,
+      offsets,
+      weights,
+      indices_with_row_offset,
+      row_offsets,
+      pooling_modes,
+      args);
+
+  return;
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    merged_embeddingbag_backward_adam_cpu_kernel_stub,
+    &merged_embeddingbag_backward_adam_cpu_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
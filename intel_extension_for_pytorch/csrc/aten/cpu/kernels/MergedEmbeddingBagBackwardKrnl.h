@@ -0,0 +1,220 @@
+#pragma once
+
+#include <c10/core/CPUAllocator.h>
+#include <csrc/aten/cpu/MergedEmbeddingBag.h>
+#include <omp.h>
+#include "csrc/cpu/vec512/bf16/vec/bf16_vec_kernel.h"
+#include "csrc/utils/ipex_op_profile.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using namespace at;
+
+// Sum the grads of the outputs which read the row uniq_index_id of
+// batched_csc into grad_acc_buffer.
+template <typename T, typename acc_t>
+inline void accumulate_row_grad(
+    acc_t* grad_acc_buffer,
+    T* grad,
+    const BatchedHyperCompressedSparseColumn& batched_csc,
+    int64_t uniq_index_id,
+    int vector_size) {
+  zero_ker(grad_acc_buffer, vector_size);
+  for (int r = batched_csc.segment_ptr[uniq_index_id];
+       r < batched_csc.segment_ptr[uniq_index_id + 1];
+       ++r) {
+    T* grad_ptr = &grad[batched_csc.output_row_indices[r] * vector_size];
+    if (batched_csc.weights && batched_csc.weights[r] != 1) {
+      madd_ker(grad_acc_buffer, grad_ptr, vector_size, batched_csc.weights[r]);
+    } else {
+      add_ker(grad_acc_buffer, grad_ptr, vector_size);
+    }
+  }
+}
+
+// The optimizers other than SGD update a copy of the row in acc_t, the
+// master weight of a BFloat16 row is the BFloat16 weight + its trail.
+template <typename T, typename acc_t>
+inline void load_master_weight(
+    acc_t* out,
+    const T* weight,
+    const BFloat16* /* trail */,
+    int size) {
+  for (int d = 0; d < size; d++) {
+    out[d] = weight[d];
+  }
+}
+
+template <>
+inline void load_master_weight<BFloat16, float>(
+    float* out,
+    const BFloat16* weight,
+    const BFloat16* trail,
+    int size) {
+  for (int d = 0; d < size; d++) {
+    out[d] = at::vec::pack_bfloat16_float(weight[d], trail[d]);
+  }
+}
+
+template <typename T, typename acc_t>
+inline void store_master_weight(
+    T* weight,
+    BFloat16* /* trail */,
+    const acc_t* in,
+    int size) {
+  for (int d = 0; d < size; d++) {
+    weight[d] = in[d];
+  }
+}
+
+template <>
+inline void store_master_weight<BFloat16, float>(
+    BFloat16* weight,
+    BFloat16* trail,
+    const float* in,
+    int size) {
+  for (int d = 0; d < size; d++) {
+    std::tie(weight[d], trail[d]) = at::vec::unpack_float_bfloat16(in[d]);
+  }
+}
+
+// The trail of the BFloat16 row at weight_offsets of the table.
+template <typename T>
+inline BFloat16* get_trail_ptr(
+    const std::vector<Tensor>& bf16_trail,
+    int table_id,
+    int64_t weight_offsets) {
+  if (std::is_same<T, BFloat16>::value) {
+    return bf16_trail[table_id].data_ptr<BFloat16>() + weight_offsets;
+  }
+  return nullptr;
+}
+
+// Sort the indices into batched_csc, then update each unique row once with
+// the grads of all the outputs which read it, by
+// AccGradUpdate<T, optimizer_arg_t>.
+template <typename optimizer_arg_t>
+void merged_embeddingbag_backward_cpu_kernel(
+    const std::vector<Tensor>& grads_y,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const std::vector<Tensor>& weights,
+    const Tensor& indices_with_row_offset,
+    const Tensor& row_offsets,
+    std::vector<int64_t> pooling_modes,
+    const optimizer_arg_t& args) {
+  int64_t n_tables = weights.size();
+  int64_t bs = (offsets.numel() - 1) / n_tables;
+  int64_t* row_offset_data = row_offsets.data_ptr<int64_t>();
+  int64_t max_embeddings = row_offset_data[n_tables];
+  BatchedHyperCompressedSparseColumn batched_csc;
+  sort_based_batched_csr2csc_opt(
+      batched_csc,
+      bs,
+      offsets,
+      indices_with_row_offset,
+      pooling_modes,
+      max_embeddings);
+  IPEX_RECORD_FUNCTION(__FUNCTION__, std::vector<c10::IValue>({}));
+
+  auto get_table_id = [&](int index) {
+    int table_id = 0;
+    while (index >= row_offset_data[table_id + 1]) {
+      table_id++;
+    }
+    return table_id;
+  };
+
+  int uniq_indice = batched_csc.uniq_indices;
+
+  std::vector<void*> weights_ptr;
+  std::vector<int64_t> weights_max_offsets;
+  std::vector<void*> grads_ptr;
+  std::vector<ScalarType> dtypes;
+
+  int64_t max_vector_size = 0;
+  for (int i = 0; i < n_tables; i++) {
+    weights_ptr.emplace_back(weights[i].data_ptr());
+    grads_ptr.emplace_back(grads_y[i].data_ptr());
+    dtypes.emplace_back(weights[i].scalar_type());
+    weights_max_offsets.emplace_back(weights[i].size(0) * weights[i].size(1));
+    max_vector_size = std::max(max_vector_size, weights[i].size(1));
+  }
+
+  // The accumulated grads and the master weights of a row are kept in the
+  // buffer of the thread, sized for the widest acc type (double).
+  int64_t buffer_bytes = 2 * max_vector_size * sizeof(double);
+  auto buffers = c10::GetCPUAllocator()->allocate(
+      omp_get_max_threads() * buffer_bytes);
+  char* buffers_ptr = static_cast<char*>(buffers.get());
+
+#pragma omp parallel for schedule(static, 1)
+  for (int c = 0; c < uniq_indice; ++c) {
+    int row_index = batched_csc.segment_indices[c];
+    int table_id = get_table_id(row_index);
+    int vector_size = weights[table_id].size(1);
+    void* buffer = buffers_ptr + omp_get_thread_num() * buffer_bytes;
+    int64_t weight_offsets =
+        (row_index - row_offset_data[table_id]) * vector_size;
+    TORCH_CHECK(
+        weight_offsets >= 0 && weight_offsets < weights_max_offsets[table_id]);
+    if (dtypes[table_id] == ScalarType::BFloat16) {
+      AccGradUpdate<BFloat16, optimizer_arg_t>::update(
+          (BFloat16*)weights_ptr[table_id],
+          (BFloat16*)grads_ptr[table_id],
+          batched_csc,
+          c,
+          weight_offsets,
+          vector_size,
+          table_id,
+          static_cast<acc_type<BFloat16, true>*>(buffer),
+          args);
+    } else if (dtypes[table_id] == ScalarType::Float) {
+      AccGradUpdate<float, optimizer_arg_t>::update(
+          (float*)weights_ptr[table_id],
+          (float*)grads_ptr[table_id],
+          batched_csc,
+          c,
+          weight_offsets,
+          vector_size,
+          table_id,
+          static_cast<acc_type<float, true>*>(buffer),
+          args);
+    } else {
+      AccGradUpdate<double, optimizer_arg_t>::update(
+          (double*)weights_ptr[table_id],
+          (double*)grads_ptr[table_id],
+          batched_csc,
+          c,
+          weight_offsets,
+          vector_size,
+          table_id,
+          static_cast<acc_type<double, true>*>(buffer),
+          args);
+    }
+  }
+
+  return;
+}
+
+// The grads of the same dtype as the weights, made contiguous.
+inline std::vector<Tensor> get_contiguous_grads(
+    const std::vector<Tensor>& grads_y_,
+    const std::vector<Tensor>& weights) {
+  int64_t n_tables = weights.size();
+  TORCH_CHECK(n_tables == grads_y_.size());
+  auto grads_y = grads_y_;
+  for (auto i = 0; i < n_tables; i++) {
+    TORCH_CHECK(grads_y_[i].scalar_type() == weights[i].scalar_type());
+    grads_y[i] = grads_y_[i].contiguous();
+  }
+  return grads_y;
+}
+
+} // namespace
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,8 +1,4 @@
-#include <c10/core/CPUAllocator.h>
-#include <csrc/aten/cpu/MergedEmbeddingBag.h>
-#include <omp.h>
-#include "csrc/cpu/vec512/bf16/vec/bf16_vec_kernel.h"
-#include "csrc/utils/ipex_op_profile.h"
+#include "MergedEmbeddingBagBackwardKrnl.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -85,21 +81,13 @@ inline void AccGradUpdate<T, SGDArgs>::update(
     int64_t weight_offsets,
     int vector_size,
     int table_id,
+    acc_type<T, true>* buffer,
     const SGDArgs& args) {
   // grad accumulate
   using acc_t = acc_type<T, true>;
-  acc_t grad_acc_buffer[vector_size];
-  zero_ker(grad_acc_buffer, vector_size);
-  for (int r = batched_csc.segment_ptr[uniq_index_id];
-       r < batched_csc.segment_ptr[uniq_index_id + 1];
-       ++r) {
-    T* grad_ptr = &grad[batched_csc.output_row_indices[r] * vector_size];
-    if (batched_csc.weights && batched_csc.weights[r] != 1) {
-      madd_ker(grad_acc_buffer, grad_ptr, vector_size, batched_csc.weights[r]);
-    } else {
-      add_ker(grad_acc_buffer, grad_ptr, vector_size);
-    }
-  }
+  acc_t* grad_acc_buffer = buffer;
+  accumulate_row_grad(
+      grad_acc_buffer, grad, batched_csc, uniq_index_id, vector_size);
   // sgd update
   T* weight_ptr = &weight[weight_offsets];
   BFloat16* bf16_trail_ptr = nullptr;
@@ -116,97 +104,6 @@ inline void AccGradUpdate<T, SGDArgs>::update(
       vector_size);
 }
 
-template <typename optimizer_arg_t>
-void merged_embeddingbag_backward_cpu_kernel(
-    const std::vector<Tensor>& grads_y,
-    const Tensor& indices,
-    const Tensor& offsets,
-    const std::vector<Tensor>& weights,
-    const Tensor& indices_with_row_offset,
-    const Tensor& row_offsets,
-    std::vector<int64_t> pooling_modes,
-    const optimizer_arg_t& args) {
-  int64_t n_tables = weights.size();
-  int64_t bs = (offsets.numel() - 1) / n_tables;
-  int64_t* row_offset_data = row_offsets.data_ptr<int64_t>();
-  int64_t max_embeddings = row_offset_data[n_tables];
-  BatchedHyperCompressedSparseColumn batched_csc;
-  sort_based_batched_csr2csc_opt(
-      batched_csc,
-      bs,
-      offsets,
-      indices_with_row_offset,
-      pooling_modes,
-      max_embeddings);
-  IPEX_RECORD_FUNCTION(__FUNCTION__, std::vector<c10::IValue>({}));
-
-  auto get_table_id = [&](int index) {
-    int table_id = 0;
-    while (index >= row_offset_data[table_id + 1]) {
-      table_id++;
-    }
-    return table_id;
-  };
-
-  int uniq_indice = batched_csc.uniq_indices;
-
-  std::vector<void*> weights_ptr;
-  std::vector<int64_t> weights_max_offsets;
-  std::vector<void*> grads_ptr;
-  std::vector<ScalarType> dtypes;
-
-  for (int i = 0; i < n_tables; i++) {
-    weights_ptr.emplace_back(weights[i].data_ptr());
-    grads_ptr.emplace_back(grads_y[i].data_ptr());
-    dtypes.emplace_back(weights[i].scalar_type());
-    weights_max_offsets.emplace_back(weights[i].size(0) * weights[i].size(1));
-  }
-
-#pragma omp parallel for schedule(static, 1)
-  for (int c = 0; c < uniq_indice; ++c) {
-    int row_index = batched_csc.segment_indices[c];
-    int table_id = get_table_id(row_index);
-    int vector_size = weights[table_id].size(1);
-    int64_t weight_offsets =
-        (row_index - row_offset_data[table_id]) * vector_size;
-    TORCH_CHECK(
-        weight_offsets >= 0 && weight_offsets < weights_max_offsets[table_id]);
-    if (dtypes[table_id] == ScalarType::BFloat16) {
-      AccGradUpdate<BFloat16, optimizer_arg_t>::update(
-          (BFloat16*)weights_ptr[table_id],
-          (BFloat16*)grads_ptr[table_id],
-          batched_csc,
-          c,
-          weight_offsets,
-          vector_size,
-          table_id,
-          args);
-    } else if (dtypes[table_id] == ScalarType::Float) {
-      AccGradUpdate<float, optimizer_arg_t>::update(
-          (float*)weights_ptr[table_id],
-          (float*)grads_ptr[table_id],
-          batched_csc,
-          c,
-          weight_offsets,
-          vector_size,
-          table_id,
-          args);
-    } else {
-      AccGradUpdate<double, optimizer_arg_t>::update(
-          (double*)weights_ptr[table_id],
-          (double*)grads_ptr[table_id],
-          batched_csc,
-          c,
-          weight_offsets,
-          vector_size,
-          table_id,
-          args);
-    }
-  }
-
-  return;
-}
-
 void merged_embeddingbag_backward_sgd_cpu_kernel_impl(
     const std::vector<Tensor>& grads_y_,
     const Tensor& indices,
@@ -218,13 +115,7 @@ void merged_embeddingbag_backward_sgd_cpu_kernel_impl(
     const std::vector<Tensor>& bf16_trail,
     double weight_decay,
     double lr) {
-  int64_t n_tables = weights.size();
-  TORCH_CHECK(n_tables == grads_y_.size());
-  auto grads_y = grads_y_;
-  for (auto i = 0; i < n_tables; i++) {
-    TORCH_CHECK(grads_y_[i].scalar_type() == weights[i].scalar_type());
-    grads_y[i] = grads_y_[i].contiguous();
-  }
+  auto grads_y = get_contiguous_grads(grads_y_, weights);
   SGDArgs args = SGDArgs(bf16_trail, weight_decay, lr);
   merged_embeddingbag_backward_cpu_kernel<SGDArgs>(
       grads_y,
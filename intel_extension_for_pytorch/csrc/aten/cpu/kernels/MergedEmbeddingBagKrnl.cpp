@@ -2,10 +2,14 @@
 #include <ATen/Tensor.h>
 #include <csrc/aten/cpu/MergedEmbeddingBag.h>
 #include <torch/extension.h>
+#include "csrc/aten/cpu/utils/embedding_bag_utils.h"
 #include "csrc/autocast/autocast_mode.h"
 #include "csrc/cpu/vec512/bf16/vec/bf16_vec_kernel.h"
 #include "csrc/utils/ipex_op_profile.h"
 
+#include <algorithm>
+#include <memory>
+
 namespace torch_ipex {
 namespace cpu {
 
@@ -13,40 +17,135 @@ namespace {
 
 using namespace at;
 
-template <typename T>
-inline void emb_pooling_ker(
+// Pool the bags [bag_begin, bag_end) of one table. kVecSize is the embedding
+// dim known at compile time, or 0 if it is only known at runtime (vec_size).
+// acc_buf holds at least vec_size elements when kVecSize is 0.
+template <typename T, int64_t kVecSize>
+void emb_pooling_ker(
     T* out,
-    T* in,
-    size_t pool_begin,
-    size_t pool_end,
-    size_t vector_size,
-    int64_t* indices_data,
-    int64_t* offsets_data,
-    int64_t pooling_mode) {
-  auto idx = indices_data[pool_begin];
-  auto weight_ptr = &in[idx * vector_size];
-  if (pool_end - pool_begin == 1) {
-    move_ker(out, weight_ptr, vector_size);
-  } else {
-    using acc_t = acc_type<T, true>;
+    T* weight,
+    int64_t bag_begin,
+    int64_t bag_end,
+    int64_t vec_size,
+    const int64_t* indices_data,
+    const int64_t* offsets_data,
+    int64_t pooling_mode,
+    acc_type<T, true>* acc_buf) {
+  using acc_t = acc_type<T, true>;
+  const int64_t vector_size = kVecSize > 0 ? kVecSize : vec_size;
+  // The embedding dims specialized at compile time accumulate on the stack.
+  alignas(64) acc_t acc_local[kVecSize > 0 ? kVecSize : 1];
+  acc_t* acc = kVecSize > 0 ? acc_local : acc_buf;
+  const int64_t row_bytes = vector_size * sizeof(T);
+
+  // The indices of the bags of a block are contiguous.
+  const int64_t idx_begin = offsets_data[bag_begin];
+  const int64_t idx_end = offsets_data[bag_end];
+  const int64_t prefetch_end = std::min(idx_begin + kPrefetchDistance, idx_end);
+  for (int64_t p = idx_begin; p < prefetch_end; ++p) {
+    prefetch_row(&weight[indices_data[p] * vector_size], row_bytes);
+  }
+
+  for (int64_t n = bag_begin; n < bag_end; ++n) {
+    const auto pool_begin = offsets_data[n];
+    const auto pool_end = offsets_data[n + 1];
+    T* out_ptr = &out[(n - bag_begin) * vector_size];
+    if (pool_end - pool_begin == 1) {
+      if (pool_begin + kPrefetchDistance < idx_end) {
+        prefetch_row(
+            &weight[indices_data[pool_begin + kPrefetchDistance] * vector_size],
+            row_bytes);
+      }
+      move_ker(
+          out_ptr,
+          &weight[indices_data[pool_begin] * vector_size],
+          vector_size);
+      continue;
+    }
     // add if there is more than 1 indice in this bag, need accumulate to float
     // buffer
-    acc_t temp_out[vector_size];
-    zero_ker(temp_out, vector_size);
+    zero_ker(acc, vector_size);
     for (auto p = pool_begin; p < pool_end; ++p) {
-      idx = indices_data[p];
-      weight_ptr = &in[idx * vector_size];
-      add_ker(temp_out, weight_ptr, vector_size);
+      if (p + kPrefetchDistance < idx_end) {
+        prefetch_row(
+            &weight[indices_data[p + kPrefetchDistance] * vector_size],
+            row_bytes);
+      }
+      add_ker(acc, &weight[indices_data[p] * vector_size], vector_size);
     }
-    if (pooling_mode == MEAN) {
-      auto L = pool_end - pool_begin;
-      const double scale_factor = 1.0 / L;
+    if (pooling_mode == kMeanPooling) {
+      const double scale_factor =
+          get_pooling_factor(pooling_mode, pool_end - pool_begin);
 #pragma omp simd
-      for (int d = 0; d < vector_size; ++d) {
-        temp_out[d] = scale_factor * temp_out[d];
+      for (int64_t d = 0; d < vector_size; ++d) {
+        acc[d] = scale_factor * acc[d];
       }
     }
-    move_ker(out, temp_out, vector_size);
+    move_ker(out_ptr, acc, vector_size);
+  }
+}
+
+template <typename T>
+void emb_pooling_block(
+    T* out,
+    T* weight,
+    int64_t bag_begin,
+    int64_t bag_end,
+    int64_t vector_size,
+    const int64_t* indices_data,
+    const int64_t* offsets_data,
+    int64_t pooling_mode) {
+  using acc_t = acc_type<T, true>;
+  switch (vector_size) {
+    case 64:
+      emb_pooling_ker<T, 64>(
+          out,
+          weight,
+          bag_begin,
+          bag_end,
+          vector_size,
+          indices_data,
+          offsets_data,
+          pooling_mode,
+          nullptr);
+      break;
+    case 128:
+      emb_pooling_ker<T, 128>(
+          out,
+          weight,
+          bag_begin,
+          bag_end,
+          vector_size,
+          indices_data,
+          offsets_data,
+          pooling_mode,
+          nullptr);
+      break;
+    case 256:
+      emb_pooling_ker<T, 256>(
+          out,
+          weight,
+          bag_begin,
+          bag_end,
+          vector_size,
+          indices_data,
+          offsets_data,
+          pooling_mode,
+          nullptr);
+      break;
+    default: {
+      std::unique_ptr<acc_t[]> acc_buf(new acc_t[vector_size]);
+      emb_pooling_ker<T, 0>(
+          out,
+          weight,
+          bag_begin,
+          bag_end,
+          vector_size,
+          indices_data,
+          offsets_data,
+          pooling_mode,
+          acc_buf.get());
+    }
   }
 }
 
@@ -65,74 +164,64 @@ void merged_embeddingbag_forward_cpu_kernel(
   TORCH_CHECK(B >= 0);
   TORCH_CHECK(indices.is_contiguous());
   TORCH_CHECK(offsets.is_contiguous());
-
-  std::vector<void*> weights_ptr;
-  std::vector<ScalarType> dtypes;
-
   for (auto& w : weights) {
     TORCH_CHECK(w.is_contiguous());
-    weights_ptr.emplace_back(w.data_ptr());
-    dtypes.emplace_back(w.scalar_type());
   }
-
-  std::vector<void*> outs_ptr;
-  for (auto& o : outputs) {
-    outs_ptr.emplace_back(o.data_ptr());
+  if (B == 0) {
+    return;
   }
 
   const auto indices_data = indices.data_ptr<int64_t>();
   const auto offsets_data = offsets.data_ptr<int64_t>();
 
-  int64_t n_offsets = offsets.numel() - 1;
-  parallel_for(0, n_offsets, 0, [&](int64_t offset_begin, int64_t offset_end) {
-    for (int n = offset_begin; n < offset_end; ++n) {
-      int table_id = 0;
-      int64_t temp_n = n;
-      while (temp_n >= B) {
-        temp_n -= B;
-        table_id += 1;
-      }
-      const auto pool_begin = offsets_data[n];
-      const auto pool_end = offsets_data[n + 1];
-      auto feature_size = weights[table_id].size(1);
-      if (dtypes[table_id] == ScalarType::BFloat16) {
-        BFloat16* out_ptr =
-            &(((BFloat16*)outs_ptr[table_id])[temp_n * feature_size]);
-        emb_pooling_ker<BFloat16>(
-            out_ptr,
-            (BFloat16*)weights_ptr[table_id],
-            pool_begin,
-            pool_end,
-            feature_size,
-            indices_data,
-            offsets_data,
-            pooling_modes[table_id]);
-      } else if (dtypes[table_id] == ScalarType::Float) {
-        float* out_ptr = &(((float*)outs_ptr[table_id])[temp_n * feature_size]);
-        emb_pooling_ker<float>(
-            out_ptr,
-            (float*)weights_ptr[table_id],
-            pool_begin,
-            pool_end,
-            feature_size,
-            indices_data,
-            offsets_data,
-            pooling_modes[table_id]);
-      } else {
-        double* out_ptr =
-            &(((double*)outs_ptr[table_id])[temp_n * feature_size]);
-        emb_pooling_ker<double>(
-            out_ptr,
-            (double*)weights_ptr[table_id],
-            pool_begin,
-            pool_end,
-            feature_size,
-            indices_data,
-            offsets_data,
-            pooling_modes[table_id]);
-      }
-    }
-  });
+  // The tasks are table-major: task i pools the bag block (i % n_blocks) of
+  // the table (i / n_blocks), so the bags of table t are [t * B, (t + 1) * B).
+  int64_t n_blocks = get_bag_blocks(B);
+  parallel_for(
+      0, n_tables * n_blocks, 1, [&](int64_t task_begin, int64_t task_end) {
+        for (int64_t task = task_begin; task < task_end; ++task) {
+          int64_t table_id = task / n_blocks;
+          int64_t block_begin = (task % n_blocks) * kBagBlockSize;
+          int64_t block_end = std::min(block_begin + kBagBlockSize, B);
+          int64_t bag_begin = table_id * B + block_begin;
+          int64_t bag_end = table_id * B + block_end;
+          const auto& weight = weights[table_id];
+          auto& output = outputs[table_id];
+          auto feature_size = weight.size(1);
+          auto pooling_mode = pooling_modes[table_id];
+          if (weight.scalar_type() == ScalarType::BFloat16) {
+            emb_pooling_block<BFloat16>(
+                &output.data_ptr<BFloat16>()[block_begin * feature_size],
+                weight.data_ptr<BFloat16>(),
+                bag_begin,
+                bag_end,
+                feature_size,
+                indices_data,
+                offsets_data,
+                pooling_mode);
+          } else if (weight.scalar_type() == ScalarType::Float) {
+            emb_pooling_block<float>(
+                &output.data_ptr<float>()[block_begin * feature_size],
+                weight.data_ptr<float>(),
+                bag_begin,
+                bag_end,
+                feature_size,
+                indices_data,
+                offsets_data,
+                pooling_mode);
+          } else {
+            emb_pooling_block<double>(
+                &output.data_ptr<double>()[block_begin * feature_size],
+                weight.data_ptr<double>(),
+                bag_begin,
+                bag_end,
+                feature_size,
+                indices_data,
+                offsets_data,
+                pooling_mode);
+          }
+        }
+      });
   return;
 }
 
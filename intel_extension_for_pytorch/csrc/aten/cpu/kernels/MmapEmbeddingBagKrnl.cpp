@@ -0,0 +1,116 @@
+#include <csrc/aten/cpu/EmbeddingBag.h>
+#include <csrc/aten/cpu/MmapEmbeddingBag.h>
+
+#include <ATen/Parallel.h>
+#include <c10/util/Exception.h>
+
+#include "csrc/aten/cpu/utils/embedding_bag_utils.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// Pool the bags [bag_begin, bag_end), rows holds the address of the row of
+// each index of the bags, from offsets[bag_begin].
+template <typename T>
+void mmap_pooling_block(
+    T* out,
+    const char** rows,
+    int64_t embedding_dim,
+    int64_t bag_begin,
+    int64_t bag_end,
+    const int64_t* offsets_data,
+    int64_t pooling_mode,
+    float* acc) {
+  const int64_t row_bytes = embedding_dim * sizeof(T);
+  const int64_t idx_begin = offsets_data[bag_begin];
+  const int64_t num_indices = offsets_data[bag_end] - idx_begin;
+  for (int64_t p = 0; p < std::min(kPrefetchDistance, num_indices); ++p) {
+    prefetch_row(rows[p], row_bytes);
+  }
+
+  for (int64_t n = bag_begin; n < bag_end; ++n) {
+    const auto pool_begin = offsets_data[n] - idx_begin;
+    const auto pool_end = offsets_data[n + 1] - idx_begin;
+    std::fill_n(acc, embedding_dim, 0.f);
+    for (auto p = pool_begin; p < pool_end; ++p) {
+      if (p + kPrefetchDistance < num_indices) {
+        prefetch_row(rows[p + kPrefetchDistance], row_bytes);
+      }
+      auto row = reinterpret_cast<const T*>(rows[p]);
+#pragma omp simd
+      for (int64_t d = 0; d < embedding_dim; ++d) {
+        acc[d] += static_cast<float>(row[d]);
+      }
+    }
+    float factor = get_pooling_factor(pooling_mode, pool_end - pool_begin);
+    T* out_ptr = &out[(n - bag_begin) * embedding_dim];
+#pragma omp simd
+    for (int64_t d = 0; d < embedding_dim; ++d) {
+      out_ptr[d] = static_cast<T>(acc[d] * factor);
+    }
+  }
+}
+
+void embedding_bag_mmap_kernel_impl(
+    const MmapEmbeddingTable& table,
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    int64_t pooling_mode,
+    at::Tensor& output) {
+  int64_t B = offsets.numel() - 1;
+  if (B == 0) {
+    return;
+  }
+  const auto indices_data = indices.data_ptr<int64_t>();
+  const auto offsets_data = offsets.data_ptr<int64_t>();
+  const auto embedding_dim = table.embedding_dim();
+
+  int64_t n_blocks = get_bag_blocks(B);
+  at::parallel_for(0, n_blocks, 1, [&](int64_t task_begin, int64_t task_end) {
+    std::vector<const char*> rows;
+    std::vector<float> acc(embedding_dim);
+    for (int64_t task = task_begin; task < task_end; ++task) {
+      int64_t bag_begin = task * kBagBlockSize;
+      int64_t bag_end = std::min(bag_begin + kBagBlockSize, B);
+      // Look up the rows of the block once, in the cache or the mapping.
+      int64_t idx_begin = offsets_data[bag_begin];
+      rows.resize(offsets_data[bag_end] - idx_begin);
+      table.get_rows(&indices_data[idx_begin], rows.size(), rows.data());
+      if (table.dtype() == at::kBFloat16) {
+        mmap_pooling_block<at::BFloat16>(
+            &output.data_ptr<at::BFloat16>()[bag_begin * embedding_dim],
+            rows.data(),
+            embedding_dim,
+            bag_begin,
+            bag_end,
+            offsets_data,
+            pooling_mode,
+            acc.data());
+      } else {
+        mmap_pooling_block<float>(
+            &output.data_ptr<float>()[bag_begin * embedding_dim],
+            rows.data(),
+            embedding_dim,
+            bag_begin,
+            bag_end,
+            offsets_data,
+            pooling_mode,
+            acc.data());
+      }
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    embedding_bag_mmap_kernel_stub,
+    &embedding_bag_mmap_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
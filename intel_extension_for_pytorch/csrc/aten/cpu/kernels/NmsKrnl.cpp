@@ -14,24 +14,121 @@ namespace cpu {
 
 namespace {
 
+// Number of the boxes in a block, whose suppression is a 64-bit mask.
+constexpr int64_t kNmsBlockSize = 64;
+// Number of the later blocks a task suppresses with the boxes kept in a block.
+constexpr int64_t kNmsGrainBlocks = 16;
+
+// The boxes in the score order, as separate arrays, padded to whole blocks
+// with zeros. It's reused by the NMS of the same thread.
+template <typename scalar_t>
+struct NmsBoxes {
+  std::vector<scalar_t> x1;
+  std::vector<scalar_t> y1;
+  std::vector<scalar_t> x2;
+  std::vector<scalar_t> y2;
+  std::vector<scalar_t> areas;
+
+  void resize(int64_t size) {
+    for (auto buf : {&x1, &y1, &x2, &y2, &areas}) {
+      buf->resize(size);
+    }
+  }
+};
+
+// Bit k is set if box i suppresses the box begin + k, i.e. their IoU is at
+// least threshold, for the block of kNmsBlockSize boxes from begin.
+template <typename scalar_t>
+inline uint64_t suppression_mask(
+    const NmsBoxes<scalar_t>& boxes,
+    int64_t i,
+    int64_t begin,
+    const float threshold,
+    const scalar_t bias) {
+  auto x1 = boxes.x1.data();
+  auto y1 = boxes.y1.data();
+  auto x2 = boxes.x2.data();
+  auto y2 = boxes.y2.data();
+  auto areas = boxes.areas.data();
+  uint64_t mask = 0;
+  for (int64_t k = 0; k < kNmsBlockSize; k++) {
+    auto j = begin + k;
+    auto xx1 = std::max(x1[i], x1[j]);
+    auto yy1 = std::max(y1[i], y1[j]);
+    auto xx2 = std::min(x2[i], x2[j]);
+    auto yy2 = std::min(y2[i], y2[j]);
+
+    auto w = std::max(static_cast<scalar_t>(0), xx2 - xx1 + bias);
+    auto h = std::max(static_cast<scalar_t>(0), yy2 - yy1 + bias);
+    auto inter = w * h;
+    auto ovr = inter / (areas[i] + areas[j] - inter);
+    mask |= static_cast<uint64_t>(ovr >= threshold) << k;
+  }
+  return mask;
+}
+
+#ifdef CPU_CAPABILITY_AVX512
+template <>
+inline uint64_t suppression_mask<float>(
+    const NmsBoxes<float>& boxes,
+    int64_t i,
+    int64_t begin,
+    const float threshold,
+    const float bias) {
+  __m512 m512_zero = _mm512_setzero_ps();
+  __m512 m512_bias = _mm512_set1_ps(bias);
+  __m512 m512_ix1 = _mm512_set1_ps(boxes.x1[i]);
+  __m512 m512_ix2 = _mm512_set1_ps(boxes.x2[i]);
+  __m512 m512_iy1 = _mm512_set1_ps(boxes.y1[i]);
+  __m512 m512_iy2 = _mm512_set1_ps(boxes.y2[i]);
+  __m512 m512_iarea = _mm512_set1_ps(boxes.areas[i]);
+  __m512 m512_threshold = _mm512_set1_ps(threshold);
+  uint64_t mask = 0;
+  for (int64_t k = 0; k < kNmsBlockSize; k += 16) {
+    auto j = begin + k;
+    __m512 m512_xx1 = _mm512_max_ps(m512_ix1, _mm512_loadu_ps(&boxes.x1[j]));
+    __m512 m512_yy1 = _mm512_max_ps(m512_iy1, _mm512_loadu_ps(&boxes.y1[j]));
+    __m512 m512_xx2 = _mm512_min_ps(m512_ix2, _mm512_loadu_ps(&boxes.x2[j]));
+    __m512 m512_yy2 = _mm512_min_ps(m512_iy2, _mm512_loadu_ps(&boxes.y2[j]));
+
+    __m512 m512_w = _mm512_max_ps(
+        m512_zero, _mm512_add_ps(_mm512_sub_ps(m512_xx2, m512_xx1), m512_bias));
+    __m512 m512_h = _mm512_max_ps(
+        m512_zero, _mm512_add_ps(_mm512_sub_ps(m512_yy2, m512_yy1), m512_bias));
+
+    __m512 m512_inter = _mm512_mul_ps(m512_w, m512_h);
+    __m512 m512_areas = _mm512_loadu_ps(&boxes.areas[j]);
+    __m512 m512_over = _mm512_div_ps(
+        m512_inter,
+        _mm512_sub_ps(_mm512_add_ps(m512_iarea, m512_areas), m512_inter));
+    __mmask16 mask_sus =
+        _mm512_cmp_ps_mask(m512_over, m512_threshold, _CMP_GE_OS);
+    mask |= static_cast<uint64_t>(mask_sus) << k;
+  }
+  return mask;
+}
+#endif
+
 /*
  When calculating the Intersection over Union:
   MaskRCNN: bias = 1
   SSD-Resnet34: bias = 0
-*/
-template <typename scalar_t, bool sorted>
-at::Tensor nms_cpu_kernel(
-    const at::Tensor& dets,
-    const at::Tensor& scores,
-    const float threshold,
-    float bias = 1.0);
 
+ The boxes are processed by blocks of kNmsBlockSize in the score order. The
+ boxes of a block are reduced serially with the bitmask of the suppressed
+ boxes of the block, then the boxes kept in the block set the bitmasks of the
+ later blocks, in parallel if NMS isn't already run in parallel.
+
+ Return the indices of the kept boxes in ascending order, at most max_output
+ (if it's positive) of the highest scores.
+*/
 template <typename scalar_t, bool sorted>
 at::Tensor nms_cpu_kernel(
     const at::Tensor& dets,
     const at::Tensor& scores,
     const float threshold,
-    float bias) {
+    float bias = 1.0,
+    int64_t max_output = -1) {
   AT_ASSERTM(!dets.is_cuda(), "dets must be a CPU tensor");
   AT_ASSERTM(!scores.is_cuda(), "scores must be a CPU tensor");
   AT_ASSERTM(
@@ -41,331 +138,94 @@ at::Tensor nms_cpu_kernel(
   if (dets.numel() == 0) {
     return at::empty({0}, dets.options().dtype(at::kLong).device(at::kCPU));
   }
-
-  auto x1_t = dets.select(1, 0).contiguous();
-  auto y1_t = dets.select(1, 1).contiguous();
-  auto x2_t = dets.select(1, 2).contiguous();
-  auto y2_t = dets.select(1, 3).contiguous();
-
-  at::Tensor areas_t = (x2_t - x1_t + bias) * (y2_t - y1_t + bias);
+  AT_ASSERTM(dets.dim() == 2 && dets.size(1) == 4, "dets should be (N, 4)");
+  AT_ASSERTM(
+      scores.dim() == 1 && scores.size(0) == dets.size(0),
+      "dets should have number of bboxs as scores");
 
   auto ndets = dets.size(0);
   // If scores and dets are already sorted in descending order, we don't need to
   // sort it again.
-  auto order_t = sorted
-      ? at::arange(0, ndets, scores.options().dtype(at::kLong))
-      : std::get<1>(scores.sort(0, /* descending=*/true));
-
-  at::Tensor suppressed_t =
-      at::zeros({ndets}, dets.options().dtype(at::kByte).device(at::kCPU));
-
-  auto suppressed = suppressed_t.data_ptr<uint8_t>();
-  auto order = order_t.data_ptr<int64_t>();
-  auto x1 = x1_t.data_ptr<scalar_t>();
-  auto y1 = y1_t.data_ptr<scalar_t>();
-  auto x2 = x2_t.data_ptr<scalar_t>();
-  auto y2 = y2_t.data_ptr<scalar_t>();
-  auto areas = areas_t.data_ptr<scalar_t>();
-  for (int64_t _i = 0; _i < ndets; _i++) {
-    auto i = order[_i];
-    if (suppressed[i] == 1)
-      continue;
-    auto ix1 = x1[i];
-    auto iy1 = y1[i];
-    auto ix2 = x2[i];
-    auto iy2 = y2[i];
-    auto iarea = areas[i];
-
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-    for (int64_t _j = _i + 1; _j < ndets; _j++) {
-      auto j = order[_j];
-      if (suppressed[j] == 1)
-        continue;
-      auto xx1 = std::max(ix1, x1[j]);
-      auto yy1 = std::max(iy1, y1[j]);
-      auto xx2 = std::min(ix2, x2[j]);
-      auto yy2 = std::min(iy2, y2[j]);
-
-      auto w = std::max(static_cast<scalar_t>(0), xx2 - xx1 + bias);
-      auto h = std::max(static_cast<scalar_t>(0), yy2 - yy1 + bias);
-      auto inter = w * h;
-      auto ovr = inter / (iarea + areas[j] - inter);
-      if (ovr >= threshold)
-        suppressed[j] = 1;
+  at::Tensor order_t;
+  const int64_t* order = nullptr;
+  if (!sorted) {
+    order_t = std::get<1>(scores.sort(0, /* descending=*/true));
+    order = order_t.data_ptr<int64_t>();
+  }
+  auto get_index = [&](int64_t k) { return sorted ? k : order[k]; };
+
+  auto dets_t = dets.contiguous();
+  auto dets_data = dets_t.data_ptr<scalar_t>();
+  auto nblocks = (ndets + kNmsBlockSize - 1) / kNmsBlockSize;
+  static thread_local NmsBoxes<scalar_t> boxes;
+  boxes.resize(nblocks * kNmsBlockSize);
+  const scalar_t _bias = bias;
+  for (int64_t k = 0; k < nblocks * kNmsBlockSize; k++) {
+    if (k < ndets) {
+      auto box = &dets_data[get_index(k) * 4];
+      boxes.x1[k] = box[0];
+      boxes.y1[k] = box[1];
+      boxes.x2[k] = box[2];
+      boxes.y2[k] = box[3];
+      boxes.areas[k] = (box[2] - box[0] + _bias) * (box[3] - box[1] + _bias);
+    } else {
+      boxes.x1[k] = boxes.y1[k] = boxes.x2[k] = boxes.y2[k] = 0;
+      boxes.areas[k] = 0;
     }
   }
-  return at::nonzero(suppressed_t == 0).squeeze(1);
-}
 
-#ifdef CPU_CAPABILITY_AVX512
-// Optimized nms_cpu_kernel specialized for data type: float32 and sorted_score
-template <>
-at::Tensor nms_cpu_kernel</*scalar_t*/ float, /*sorted*/ true>(
-    const at::Tensor& dets,
-    const at::Tensor& scores,
-    const float threshold,
-    float bias) {
-  AT_ASSERTM(!dets.is_cuda(), "dets must be a CPU tensor");
-  AT_ASSERTM(!scores.is_cuda(), "scores must be a CPU tensor");
-  AT_ASSERTM(
-      dets.scalar_type() == scores.scalar_type(),
-      "dets should have the same type as scores");
-
-  AT_ASSERTM(dets.sizes().size() == 2, "dets should have 2 dimension");
-  AT_ASSERTM(scores.sizes().size() == 1, "scores should have 1 dimension");
-
-  at::Tensor dets_bbox_number_in_lastdim = dets.permute({1, 0}).contiguous();
-  AT_ASSERTM(
-      dets_bbox_number_in_lastdim.size(1) == scores.size(0),
-      "dets should have number of bboxs as scores");
-  AT_ASSERTM(
-      dets_bbox_number_in_lastdim.size(0) == 4,
-      "each bbox in dets should have 4 coordinates");
-
-  if (dets_bbox_number_in_lastdim.numel() == 0) {
-    return at::empty(
-        {0},
-        dets_bbox_number_in_lastdim.options().dtype(at::kLong).device(
-            at::kCPU));
+  // Bit k of removed[b] is set if the box b * kNmsBlockSize + k is suppressed,
+  // the padding boxes are suppressed from the start.
+  static thread_local std::vector<uint64_t> removed;
+  removed.assign(nblocks, 0);
+  if (ndets % kNmsBlockSize != 0) {
+    removed[nblocks - 1] = ~0ULL << (ndets % kNmsBlockSize);
   }
 
-  auto x1_t = dets_bbox_number_in_lastdim.select(0, 0).contiguous();
-  auto y1_t = dets_bbox_number_in_lastdim.select(0, 1).contiguous();
-  auto x2_t = dets_bbox_number_in_lastdim.select(0, 2).contiguous();
-  auto y2_t = dets_bbox_number_in_lastdim.select(0, 3).contiguous();
-
-  auto ndets = dets_bbox_number_in_lastdim.size(1);
-  auto ndets_up_scale = (ndets / 16 + 1) * 16;
-  auto ndets_down_scale = (ndets / 16) * 16;
-  at::Tensor&& areas_t =
-      at::zeros({ndets}, dets_bbox_number_in_lastdim.options()).contiguous();
-  auto areas = areas_t.data_ptr<float>();
-  auto x1 = x1_t.data_ptr<float>();
-  auto y1 = y1_t.data_ptr<float>();
-  auto x2 = x2_t.data_ptr<float>();
-  auto y2 = y2_t.data_ptr<float>();
-  __m512 m512_zero = _mm512_setzero_ps();
-  __m512 m512_bias = _mm512_set1_ps(bias);
-  __m128i m128_zeroi = _mm_setzero_si128();
-
-  // Step1: Calculate the area of all bbox's
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-  for (int i = 0; i < ndets_up_scale; i += 16) {
-    __m512 m512_x1;
-    __m512 m512_x2;
-    __m512 m512_y1;
-    __m512 m512_y2;
-    __m512 m512_result;
-    if (i < ndets_down_scale) {
-      // vector
-      m512_x1 = _mm512_loadu_ps(x1 + i);
-      m512_x2 = _mm512_loadu_ps(x2 + i);
-      m512_y1 = _mm512_loadu_ps(y1 + i);
-      m512_y2 = _mm512_loadu_ps(y2 + i);
-      if (bias == 0) {
-        m512_result = _mm512_mul_ps(
-            _mm512_sub_ps(m512_x2, m512_x1), _mm512_sub_ps(m512_y2, m512_y1));
-      } else {
-        m512_result = _mm512_mul_ps(
-            _mm512_add_ps(_mm512_sub_ps(m512_x2, m512_x1), m512_bias),
-            _mm512_add_ps(_mm512_sub_ps(m512_y2, m512_y1), m512_bias));
+  auto max_keep = max_output > 0 ? std::min(max_output, ndets) : ndets;
+  at::Tensor keep_t = at::empty({max_keep}, dets.options().dtype(at::kLong));
+  auto keep = keep_t.data_ptr<int64_t>();
+  int64_t num_keep = 0;
+  int64_t kept_in_block[kNmsBlockSize];
+  for (int64_t b = 0; b < nblocks && num_keep < max_keep; b++) {
+    auto begin = b * kNmsBlockSize;
+    int64_t num_kept_in_block = 0;
+    for (int64_t k = 0; k < kNmsBlockSize && num_keep < max_keep; k++) {
+      if (removed[b] & (1ULL << k)) {
+        continue;
       }
-      _mm512_storeu_ps(areas + i, m512_result);
-    } else {
-      // tail case
-      unsigned short left_idx = ndets - ndets_down_scale;
-      __mmask16 mask = (1 << left_idx) - 1; // 0x03ff;
-      m512_x1 = _mm512_mask_loadu_ps(m512_zero, mask, x1 + i);
-      m512_x2 = _mm512_mask_loadu_ps(m512_zero, mask, x2 + i);
-      m512_y1 = _mm512_mask_loadu_ps(m512_zero, mask, y1 + i);
-      m512_y2 = _mm512_mask_loadu_ps(m512_zero, mask, y2 + i);
-      if (bias == 0) {
-        m512_result = _mm512_mask_mul_ps(
-            m512_zero,
-            mask,
-            _mm512_mask_sub_ps(m512_zero, mask, m512_x2, m512_x1),
-            _mm512_mask_sub_ps(m512_zero, mask, m512_y2, m512_y1));
-      } else {
-        m512_result = _mm512_mask_mul_ps(
-            m512_zero,
-            mask,
-            _mm512_mask_add_ps(
-                m512_zero,
-                mask,
-                _mm512_mask_sub_ps(m512_zero, mask, m512_x2, m512_x1),
-                m512_bias),
-            _mm512_mask_add_ps(
-                m512_zero,
-                mask,
-                _mm512_mask_sub_ps(m512_zero, mask, m512_y2, m512_y1),
-                m512_bias));
+      keep[num_keep++] = get_index(begin + k);
+      kept_in_block[num_kept_in_block++] = begin + k;
+      if (k + 1 < kNmsBlockSize) {
+        removed[b] |=
+            suppression_mask(boxes, begin + k, begin, threshold, _bias) &
+            (~0ULL << (k + 1));
       }
-      _mm512_mask_storeu_ps(areas + i, mask, m512_result);
     }
-  }
-  // Step2: Go through the NMS flow
-  at::Tensor suppressed_t = at::zeros(
-      {ndets},
-      dets_bbox_number_in_lastdim.options().dtype(at::kByte).device(at::kCPU));
-  auto suppressed = suppressed_t.data_ptr<uint8_t>();
-  for (int64_t i = 0; i < ndets; i++) {
-    if (suppressed[i] == 1)
-      continue;
-    auto ix1 = x1[i];
-    auto iy1 = y1[i];
-    auto ix2 = x2[i];
-    auto iy2 = y2[i];
-    auto iarea = areas[i];
-
-    __m512 m512_ix1 = _mm512_set1_ps(ix1);
-    __m512 m512_ix2 = _mm512_set1_ps(ix2);
-    __m512 m512_iy1 = _mm512_set1_ps(iy1);
-    __m512 m512_iy2 = _mm512_set1_ps(iy2);
-    __m512 m512_iarea = _mm512_set1_ps(iarea);
-    __m512 m512_threshold = _mm512_set1_ps(threshold);
-
-    auto ndets_i_up_scale = ((ndets - i - 1) / 16 + 1) * 16;
-    auto ndets_i_down_scale = ((ndets - i - 1) / 16) * 16;
-
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-    for (int64_t _j = 0; _j < ndets_i_up_scale; _j += 16) {
-      if (_j < ndets_i_down_scale) {
-        int64_t j = _j + i + 1;
-        __m512 m512_x1 = _mm512_loadu_ps(x1 + j);
-        __m512 m512_x2 = _mm512_loadu_ps(x2 + j);
-        __m512 m512_y1 = _mm512_loadu_ps(y1 + j);
-        __m512 m512_y2 = _mm512_loadu_ps(y2 + j);
-
-        __m512 m512_xx1 = _mm512_max_ps(m512_ix1, m512_x1);
-        __m512 m512_yy1 = _mm512_max_ps(m512_iy1, m512_y1);
-        __m512 m512_xx2 = _mm512_min_ps(m512_ix2, m512_x2);
-        __m512 m512_yy2 = _mm512_min_ps(m512_iy2, m512_y2);
-
-        __m512 m512_w;
-        __m512 m512_h;
-        if (bias == 0) {
-          m512_w = _mm512_max_ps(m512_zero, _mm512_sub_ps(m512_xx2, m512_xx1));
-          m512_h = _mm512_max_ps(m512_zero, _mm512_sub_ps(m512_yy2, m512_yy1));
-        } else {
-          m512_w = _mm512_max_ps(
-              m512_zero,
-              _mm512_add_ps(_mm512_sub_ps(m512_xx2, m512_xx1), m512_bias));
-          m512_h = _mm512_max_ps(
-              m512_zero,
-              _mm512_add_ps(_mm512_sub_ps(m512_yy2, m512_yy1), m512_bias));
-        }
-
-        __m512 m512_inter = _mm512_mul_ps(m512_w, m512_h);
-        __m512 m512_areas = _mm512_loadu_ps(areas + j);
-        __m512 m512_over = _mm512_div_ps(
-            m512_inter,
-            _mm512_sub_ps(_mm512_add_ps(m512_iarea, m512_areas), m512_inter));
-        __mmask16 mask_sus =
-            _mm512_cmp_ps_mask(m512_over, m512_threshold, _CMP_GE_OS);
-        __m128i res_sus = _mm_mask_set1_epi8(m128_zeroi, mask_sus, 1);
-        _mm_mask_storeu_epi8(suppressed + j, mask_sus, res_sus);
-
-      } else {
-        // Tail case
-        int64_t j = _j + i + 1;
-        int64_t idx_left = ndets - j;
-        __mmask16 load_mask = (1 << idx_left) - 1;
-
-        __m512 m512_x1 = _mm512_mask_loadu_ps(m512_zero, load_mask, x1 + j);
-        __m512 m512_x2 = _mm512_mask_loadu_ps(m512_zero, load_mask, x2 + j);
-        __m512 m512_y1 = _mm512_mask_loadu_ps(m512_zero, load_mask, y1 + j);
-        __m512 m512_y2 = _mm512_mask_loadu_ps(m512_zero, load_mask, y2 + j);
-
-        __m512 m512_xx1 =
-            _mm512_mask_max_ps(m512_zero, load_mask, m512_ix1, m512_x1);
-        __m512 m512_yy1 =
-            _mm512_mask_max_ps(m512_zero, load_mask, m512_iy1, m512_y1);
-        __m512 m512_xx2 =
-            _mm512_mask_min_ps(m512_zero, load_mask, m512_ix2, m512_x2);
-        __m512 m512_yy2 =
-            _mm512_mask_min_ps(m512_zero, load_mask, m512_iy2, m512_y2);
-
-        __m512 m512_w;
-        __m512 m512_h;
-        if (bias == 0) {
-          m512_w = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_sub_ps(m512_zero, load_mask, m512_xx2, m512_xx1));
-          m512_h = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_sub_ps(m512_zero, load_mask, m512_yy2, m512_yy1));
-        } else {
-          m512_w = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_add_ps(
-                  m512_zero,
-                  load_mask,
-                  _mm512_mask_sub_ps(m512_zero, load_mask, m512_xx2, m512_xx1),
-                  m512_bias));
-          m512_h = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_add_ps(
-                  m512_zero,
-                  load_mask,
-                  _mm512_mask_sub_ps(m512_zero, load_mask, m512_yy2, m512_yy1),
-                  m512_bias));
+    if (num_keep == max_keep) {
+      break;
+    }
+    // boxes and removed are thread_local, the lambda runs on the OMP workers
+    // and has to use the instances of this thread through the references.
+    auto& boxes_ref = boxes;
+    auto& removed_ref = removed;
+    auto suppress_blocks = [&](int64_t c_begin, int64_t c_end) {
+      for (int64_t c = c_begin; c < c_end; c++) {
+        for (int64_t k = 0; k < num_kept_in_block && removed_ref[c] != ~0ULL;
+             k++) {
+          removed_ref[c] |= suppression_mask(
+              boxes_ref, kept_in_block[k], c * kNmsBlockSize, threshold, _bias);
         }
-        __m512 m512_inter =
-            _mm512_mask_mul_ps(m512_zero, load_mask, m512_w, m512_h);
-        __m512 m512_areas =
-            _mm512_mask_loadu_ps(m512_zero, load_mask, areas + j);
-        __m512 m512_over = _mm512_mask_div_ps(
-            m512_zero,
-            load_mask,
-            m512_inter,
-            _mm512_mask_sub_ps(
-                m512_zero,
-                load_mask,
-                _mm512_mask_add_ps(
-                    m512_zero, load_mask, m512_iarea, m512_areas),
-                m512_inter));
-        __mmask16 mask_sus = _mm512_mask_cmp_ps_mask(
-            load_mask, m512_over, m512_threshold, _CMP_GE_OS);
-        __m128i res_sus = _mm_mask_set1_epi8(m128_zeroi, mask_sus, 1);
-        _mm_mask_storeu_epi8(suppressed + j, mask_sus, res_sus);
       }
-    }
+    };
+    // Inline if NMS is already run in parallel, e.g. per image or class.
+    at::parallel_for(b + 1, nblocks, kNmsGrainBlocks, suppress_blocks);
+  }
+  if (!sorted) {
+    std::sort(keep, keep + num_keep);
   }
-  return at::nonzero(suppressed_t == 0).squeeze(1);
+  return keep_t.resize_({num_keep});
 }
-#endif
 
 std::vector<at::Tensor> remove_empty(
     std::vector<at::Tensor>& candidate,
@@ -545,11 +405,8 @@ std::tuple<std::vector<at::Tensor>, std::vector<at::Tensor>> rpn_nms_kernel(
     dets = at::index_select(dets, 0, keep_index);
     scores = at::index_select(scores, 0, keep_index);
     if (threshold > 0) {
-      at::Tensor keep =
-          nms_cpu_kernel<scalar_t, /*sorted*/ true>(dets, scores, threshold);
-      if (max_output > 0) {
-        keep = keep.slice(0, 0, max_output);
-      }
+      at::Tensor keep = nms_cpu_kernel<scalar_t, /*sorted*/ true>(
+          dets, scores, threshold, /*bias*/ 1.0, max_output);
       bboxes_out[i] = dets.index_select(0, keep);
       scores_out[i] = scores.index_select(0, keep);
     } else {
@@ -0,0 +1,340 @@
+#include <csrc/aten/cpu/RowwiseQuantizedEmbeddingBag.h>
+
+#include <ATen/Parallel.h>
+#include <c10/util/Exception.h>
+
+#include "csrc/aten/cpu/utils/embedding_bag_utils.h"
+#include "csrc/utils/ipex_op_profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(CPU_CAPABILITY_AVX512)
+#include <immintrin.h>
+#endif
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+inline int64_t get_data_bytes(int64_t embedding_dim, int64_t bit_width) {
+  return bit_width == 4 ? (embedding_dim + 1) / 2 : embedding_dim;
+}
+
+// The scale and bias behind the data may be unaligned.
+inline void load_scale_bias(
+    const uint8_t* row,
+    int64_t data_bytes,
+    float& scale,
+    float& bias) {
+  std::memcpy(&scale, row + data_bytes, sizeof(float));
+  std::memcpy(&bias, row + data_bytes + sizeof(float), sizeof(float));
+}
+
+#if defined(CPU_CAPABILITY_AVX512)
+inline __mmask16 tail_mask(int64_t size) {
+  return size >= 16 ? 0xFFFF : static_cast<__mmask16>((1 << size) - 1);
+}
+
+// The values [i, i + 16) of the data as floats, the ones past size are 0.
+template <int64_t kBitWidth>
+inline __m512 load_values(const uint8_t* data, int64_t i, int64_t size);
+
+template <>
+inline __m512 load_values<8>(const uint8_t* data, int64_t i, int64_t size) {
+  return _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(
+      _mm_maskz_loadu_epi8(tail_mask(size - i), data + i)));
+}
+
+template <>
+inline __m512 load_values<4>(const uint8_t* data, int64_t i, int64_t size) {
+  // 8 bytes hold the 16 values, the last byte of an odd size holds 1.
+  auto bytes = std::min<int64_t>((size - i + 1) / 2, 8);
+  auto packed = _mm_cvtepu8_epi16(_mm_maskz_loadu_epi8(
+      static_cast<__mmask16>((1 << bytes) - 1), data + i / 2));
+  // Spread the low and high nibbles of each byte to 2 bytes.
+  auto low = _mm_and_si128(packed, _mm_set1_epi16(0x0F));
+  auto high = _mm_slli_epi16(_mm_srli_epi16(packed, 4), 8);
+  auto values = _mm512_cvtepi32_ps(
+      _mm512_cvtepu8_epi32(_mm_or_si128(low, high)));
+  // The high nibble of the last byte of an odd size isn't a value.
+  return _mm512_maskz_mov_ps(tail_mask(size - i), values);
+}
+#else
+template <int64_t kBitWidth>
+inline float load_value(const uint8_t* data, int64_t i);
+
+template <>
+inline float load_value<8>(const uint8_t* data, int64_t i) {
+  return data[i];
+}
+
+template <>
+inline float load_value<4>(const uint8_t* data, int64_t i) {
+  return (data[i / 2] >> ((i & 1) * 4)) & 0x0F;
+}
+#endif
+
+// out += q * scale of the size values of a row. The bias is added once per
+// bag by the caller.
+template <int64_t kBitWidth>
+inline void accumulate_row(
+    float* out,
+    const uint8_t* data,
+    float scale,
+    int64_t size) {
+#if defined(CPU_CAPABILITY_AVX512)
+  auto vec_scale = _mm512_set1_ps(scale);
+  for (int64_t i = 0; i < size; i += 16) {
+    auto mask = tail_mask(size - i);
+    auto vec_out = _mm512_fmadd_ps(
+        load_values<kBitWidth>(data, i, size),
+        vec_scale,
+        _mm512_maskz_loadu_ps(mask, out + i));
+    _mm512_mask_storeu_ps(out + i, mask, vec_out);
+  }
+#else
+  for (int64_t i = 0; i < size; i++) {
+    out[i] += load_value<kBitWidth>(data, i) * scale;
+  }
+#endif
+}
+
+// out = (out + bias) * factor
+inline void add_bias_and_scale(
+    float* out,
+    float bias,
+    float factor,
+    int64_t size) {
+#if defined(CPU_CAPABILITY_AVX512)
+  auto vec_bias = _mm512_set1_ps(bias);
+  auto vec_factor = _mm512_set1_ps(factor);
+  for (int64_t i = 0; i < size; i += 16) {
+    auto mask = tail_mask(size - i);
+    auto vec_out = _mm512_mul_ps(
+        _mm512_add_ps(_mm512_maskz_loadu_ps(mask, out + i), vec_bias),
+        vec_factor);
+    _mm512_mask_storeu_ps(out + i, mask, vec_out);
+  }
+#else
+  for (int64_t i = 0; i < size; i++) {
+    out[i] = (out[i] + bias) * factor;
+  }
+#endif
+}
+
+// Pool the bags [bag_begin, bag_end) of one table into out. The rows are
+// dequantized in registers, the sum of the scaled values and the sum of the
+// biases are accumulated separately, so that each value takes one fma.
+template <int64_t kBitWidth>
+void rowwise_quantized_pooling_block(
+    float* out,
+    const uint8_t* qweight,
+    int64_t embedding_dim,
+    int64_t bag_begin,
+    int64_t bag_end,
+    const int64_t* indices_data,
+    const int64_t* offsets_data,
+    int64_t pooling_mode) {
+  const int64_t data_bytes = get_data_bytes(embedding_dim, kBitWidth);
+  const int64_t row_bytes = data_bytes + 2 * sizeof(float);
+
+  // The indices of the bags of a block are contiguous.
+  const int64_t idx_begin = offsets_data[bag_begin];
+  const int64_t idx_end = offsets_data[bag_end];
+  const int64_t prefetch_end = std::min(idx_begin + kPrefetchDistance, idx_end);
+  for (int64_t p = idx_begin; p < prefetch_end; ++p) {
+    prefetch_row(&qweight[indices_data[p] * row_bytes], row_bytes);
+  }
+
+  for (int64_t n = bag_begin; n < bag_end; ++n) {
+    const auto pool_begin = offsets_data[n];
+    const auto pool_end = offsets_data[n + 1];
+    float* out_ptr = &out[(n - bag_begin) * embedding_dim];
+    std::fill_n(out_ptr, embedding_dim, 0.f);
+    float bias_sum = 0.f;
+    for (auto p = pool_begin; p < pool_end; ++p) {
+      if (p + kPrefetchDistance < idx_end) {
+        prefetch_row(
+            &qweight[indices_data[p + kPrefetchDistance] * row_bytes],
+            row_bytes);
+      }
+      const uint8_t* row = &qweight[indices_data[p] * row_bytes];
+      float scale, bias;
+      load_scale_bias(row, data_bytes, scale, bias);
+      accumulate_row<kBitWidth>(out_ptr, row, scale, embedding_dim);
+      bias_sum += bias;
+    }
+    // The modes are checked by check_pooling_mode before the kernel.
+    float factor = get_pooling_factor(pooling_mode, pool_end - pool_begin);
+    add_bias_and_scale(out_ptr, bias_sum, factor, embedding_dim);
+  }
+}
+
+void rowwise_quantized_embedding_bag_kernel_impl(
+    const at::Tensor& indices,
+    const at::Tensor& offsets,
+    const std::vector<at::Tensor>& qweights,
+    const std::vector<int64_t>& bit_widths,
+    const std::vector<int64_t>& pooling_modes,
+    std::vector<at::Tensor>& outputs) {
+  int64_t n_tables = qweights.size();
+  // offsets.numel = [T x B  + 1]
+  int64_t B = (offsets.numel() - 1) / n_tables;
+  if (B == 0) {
+    return;
+  }
+
+  const auto indices_data = indices.data_ptr<int64_t>();
+  const auto offsets_data = offsets.data_ptr<int64_t>();
+
+  // The tasks are table-major: task i pools the bag block (i % n_blocks) of
+  // the table (i / n_blocks), so the bags of table t are [t * B, (t + 1) * B).
+  int64_t n_blocks = get_bag_blocks(B);
+  at::parallel_for(
+      0, n_tables * n_blocks, 1, [&](int64_t task_begin, int64_t task_end) {
+        for (int64_t task = task_begin; task < task_end; ++task) {
+          int64_t table_id = task / n_blocks;
+          int64_t block_begin = (task % n_blocks) * kBagBlockSize;
+          int64_t block_end = std::min(block_begin + kBagBlockSize, B);
+          auto& output = outputs[table_id];
+          auto embedding_dim = output.size(1);
+          auto out = &output.data_ptr<float>()[block_begin * embedding_dim];
+          auto qweight = qweights[table_id].data_ptr<uint8_t>();
+          if (bit_widths[table_id] == 4) {
+            rowwise_quantized_pooling_block<4>(
+                out,
+                qweight,
+                embedding_dim,
+                table_id * B + block_begin,
+                table_id * B + block_end,
+                indices_data,
+                offsets_data,
+                pooling_modes[table_id]);
+          } else {
+            rowwise_quantized_pooling_block<8>(
+                out,
+                qweight,
+                embedding_dim,
+                table_id * B + block_begin,
+                table_id * B + block_end,
+                indices_data,
+                offsets_data,
+                pooling_modes[table_id]);
+          }
+        }
+      });
+}
+
+// Quantize a row with scale (max - min) / (2^bit_width - 1) and bias min.
+template <typename scalar_t>
+void quantize_row(
+    const scalar_t* src,
+    uint8_t* dst,
+    int64_t embedding_dim,
+    int64_t bit_width) {
+  float min = static_cast<float>(src[0]);
+  float max = min;
+  for (int64_t i = 1; i < embedding_dim; i++) {
+    min = std::min(min, static_cast<float>(src[i]));
+    max = std::max(max, static_cast<float>(src[i]));
+  }
+  const float levels = (1 << bit_width) - 1;
+  const float range = max - min;
+  const float scale = range / levels;
+  const float inverse_scale = range > 0.f ? levels / range : 0.f;
+
+  const int64_t data_bytes = get_data_bytes(embedding_dim, bit_width);
+  std::fill_n(dst, data_bytes, 0);
+  for (int64_t i = 0; i < embedding_dim; i++) {
+    float q =
+        std::nearbyint((static_cast<float>(src[i]) - min) * inverse_scale);
+    auto value = static_cast<uint8_t>(std::min(std::max(q, 0.f), levels));
+    if (bit_width == 4) {
+      dst[i / 2] |= value << ((i & 1) * 4);
+    } else {
+      dst[i] = value;
+    }
+  }
+  std::memcpy(dst + data_bytes, &scale, sizeof(float));
+  std::memcpy(dst + data_bytes + sizeof(float), &min, sizeof(float));
+}
+
+void rowwise_quantize_embedding_kernel_impl(
+    const at::Tensor& weight,
+    at::Tensor& qweight,
+    int64_t bit_width) {
+  int64_t num_rows = weight.size(0);
+  int64_t embedding_dim = weight.size(1);
+  int64_t row_bytes = qweight.size(1);
+  auto qweight_data = qweight.data_ptr<uint8_t>();
+  if (embedding_dim == 0) {
+    qweight.zero_();
+    return;
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::kBFloat16, weight.scalar_type(), "rowwise_quantize_embedding", [&] {
+        auto weight_data = weight.data_ptr<scalar_t>();
+        at::parallel_for(0, num_rows, 64, [&](int64_t begin, int64_t end) {
+          for (int64_t r = begin; r < end; r++) {
+            quantize_row(
+                &weight_data[r * embedding_dim],
+                &qweight_data[r * row_bytes],
+                embedding_dim,
+                bit_width);
+          }
+        });
+      });
+}
+
+template <int64_t kBitWidth>
+void dequantize_rows(
+    const uint8_t* qweight,
+    float* weight,
+    int64_t num_rows,
+    int64_t embedding_dim) {
+  const int64_t data_bytes = get_data_bytes(embedding_dim, kBitWidth);
+  const int64_t row_bytes = data_bytes + 2 * sizeof(float);
+  at::parallel_for(0, num_rows, 64, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      const uint8_t* row = &qweight[r * row_bytes];
+      float* out = &weight[r * embedding_dim];
+      float scale, bias;
+      load_scale_bias(row, data_bytes, scale, bias);
+      std::fill_n(out, embedding_dim, bias);
+      accumulate_row<kBitWidth>(out, row, scale, embedding_dim);
+    }
+  });
+}
+
+void rowwise_dequantize_embedding_kernel_impl(
+    const at::Tensor& qweight,
+    at::Tensor& weight,
+    int64_t bit_width) {
+  auto qweight_data = qweight.data_ptr<uint8_t>();
+  auto weight_data = weight.data_ptr<float>();
+  if (bit_width == 4) {
+    dequantize_rows<4>(
+        qweight_data, weight_data, weight.size(0), weight.size(1));
+  } else {
+    dequantize_rows<8>(
+        qweight_data, weight_data, weight.size(0), weight.size(1));
+  }
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    rowwise_quantize_embedding_kernel_stub,
+    &rowwise_quantize_embedding_kernel_impl);
+REGISTER_DISPATCH(
+    rowwise_dequantize_embedding_kernel_stub,
+    &rowwise_dequantize_embedding_kernel_impl);
+REGISTER_DISPATCH(
+    rowwise_quantized_embedding_bag_kernel_stub,
+    &rowwise_quantized_embedding_bag_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
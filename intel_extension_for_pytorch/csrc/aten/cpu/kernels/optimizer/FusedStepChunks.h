@@ -0,0 +1,89 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// The fused optimizer steps split each tensor of the list into chunks of at
+// most kFusedStepChunkSize elements, and update the chunks of all the tensors
+// in a single parallel region, so that the small tensors (bias, LayerNorm)
+// don't pay for a fork/join each.
+constexpr int64_t kFusedStepChunkSize = 2048;
+
+// The elements [begin, end) of the tensor tensor_id of the list.
+struct FusedStepChunk {
+  int64_t tensor_id;
+  int64_t begin;
+  int64_t end;
+};
+
+// The dtype of the optimizer states (momentum_buf, state_sum, exp_avg and
+// exp_avg_sq) of a param of scalar_t, float for BFloat16.
+template <typename scalar_t>
+using fused_step_acc_t = typename std::
+    conditional<std::is_same<scalar_t, double>::value, double, float>::type;
+
+inline std::vector<FusedStepChunk> make_fused_step_chunks(
+    const std::vector<at::Tensor>& params) {
+  std::vector<FusedStepChunk> chunks;
+  int64_t n_tensors = params.size();
+  for (int64_t t = 0; t < n_tensors; t++) {
+    int64_t numel = params[t].numel();
+    for (int64_t begin = 0; begin < numel; begin += kFusedStepChunkSize) {
+      chunks.push_back(
+          {t, begin, std::min(begin + kFusedStepChunkSize, numel)});
+    }
+  }
+  return chunks;
+}
+
+// The data of each tensor of the list, nullptr for an undefined or an empty
+// tensor (e.g. no trail).
+template <typename T>
+inline std::vector<T*> get_data_ptrs(const std::vector<at::Tensor>& tensors) {
+  std::vector<T*> data;
+  for (const auto& tensor : tensors) {
+    data.emplace_back(
+        tensor.defined() && tensor.numel() > 0 ? tensor.data_ptr<T>()
+                                               : nullptr);
+  }
+  return data;
+}
+
+// The first element of the chunk in data, nullptr if data is.
+template <typename T>
+inline T* get_chunk_ptr(T* data, const FusedStepChunk& chunk) {
+  return data ? data + chunk.begin : nullptr;
+}
+
+inline std::vector<at::Tensor> get_contiguous_list(
+    const std::vector<at::Tensor>& tensors) {
+  std::vector<at::Tensor> contiguous;
+  for (const auto& tensor : tensors) {
+    contiguous.emplace_back(tensor.defined() ? tensor.contiguous() : tensor);
+  }
+  return contiguous;
+}
+
+// Copy the results of the kernel back to the non-contiguous tensors.
+inline void copy_back_list(
+    const std::vector<at::Tensor>& tensors,
+    const std::vector<at::Tensor>& results) {
+  for (size_t t = 0; t < tensors.size(); t++) {
+    if (tensors[t].defined() && !tensors[t].is_contiguous()) {
+      tensors[t].copy_(results[t]);
+    }
+  }
+}
+
+} // namespace
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,4 +1,5 @@
 #include <csrc/aten/cpu/optimizer/optimizer.h>
+#include "FusedStepChunks.h"
 #include "csrc/cpu/vec512/bf16/vec/vec_type_cvt.h"
 
 #include <torch/csrc/autograd/function.h>
@@ -11,420 +12,427 @@ namespace {
 
 using namespace at::vec;
 
-template <typename scalar_t, typename grad_t>
-void sgd_fused_step_kernel(
-    at::Tensor& param,
-    const at::Tensor& grad,
-    at::Tensor& momentum_buf,
-    at::Tensor& param2,
+// Update the elements [0, size) of a chunk, the pointers point to the first
+// element of the chunk.
+template <typename scalar_t>
+void sgd_fused_step_range(
+    scalar_t* param_ptr,
+    scalar_t* grad_ptr,
+    scalar_t* momentum_buf_ptr,
+    at::BFloat16* /* param2_ptr */,
+    int64_t size,
     double momentum,
     double learning_rate,
     double weight_decay,
     double dampening,
     bool nesterov,
     bool momentum_buf_initialized) {
-  scalar_t* param_data = param.data_ptr<scalar_t>();
-  scalar_t* grad_data = grad.data_ptr<scalar_t>();
-  scalar_t* momentum_buf_data =
-      momentum_buf.defined() ? momentum_buf.data_ptr<scalar_t>() : nullptr;
-
   using Vec = at::vec::Vectorized<scalar_t>;
 
-  int64_t grain_size = 512;
-
-  // purely element-wise operations
-  at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
-        // local pointers
-        scalar_t* param_ptr = param_data + begin;
-        scalar_t* grad_ptr = grad_data + begin;
-        scalar_t* momentum_buf_ptr = momentum_buf_data + begin;
-
-        const int64_t size = end - begin;
-        scalar_t grad_decay = 1 - dampening;
-        int64_t d = 0;
-        for (; d < size - (size % Vec::size()); d += Vec::size()) {
-          Vec param_vec = Vec::loadu(param_ptr + d);
-          Vec grad_vec = Vec::loadu(grad_ptr + d) +
-              param_vec * Vec(scalar_t(weight_decay));
-
-          if (momentum != 0) {
-            Vec momentum_vec;
-            if (!momentum_buf_initialized) {
-              momentum_vec = grad_vec;
-            } else {
-              momentum_vec =
-                  Vec::loadu(momentum_buf_ptr + d) * Vec(scalar_t(momentum)) +
-                  grad_vec * Vec(grad_decay);
-            }
-            momentum_vec.store(momentum_buf_ptr + d);
-            if (nesterov) {
-              grad_vec += momentum_vec * Vec(scalar_t(momentum));
-            } else {
-              grad_vec = momentum_vec;
-            }
-          }
-          param_vec -= grad_vec * Vec(scalar_t(learning_rate));
-          param_vec.store(param_ptr + d);
-        }
-        for (; d < size; d++) {
-          scalar_t grad_val = grad_ptr[d] + param_ptr[d] * weight_decay;
-          if (momentum != 0) {
-            if (!momentum_buf_initialized) {
-              momentum_buf_ptr[d] = grad_val;
-            } else {
-              momentum_buf_ptr[d] =
-                  momentum_buf_ptr[d] * momentum + grad_val * grad_decay;
-            }
-            if (nesterov) {
-              grad_val += momentum_buf_ptr[d] * momentum;
-            } else {
-              grad_val = momentum_buf_ptr[d];
-            }
-          }
-          param_ptr[d] -= grad_val * learning_rate;
-        }
-      });
+  scalar_t grad_decay = 1 - dampening;
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    Vec param_vec = Vec::loadu(param_ptr + d);
+    Vec grad_vec =
+        Vec::loadu(grad_ptr + d) + param_vec * Vec(scalar_t(weight_decay));
+
+    if (momentum != 0) {
+      Vec momentum_vec;
+      if (!momentum_buf_initialized) {
+        momentum_vec = grad_vec;
+      } else {
+        momentum_vec =
+            Vec::loadu(momentum_buf_ptr + d) * Vec(scalar_t(momentum)) +
+            grad_vec * Vec(grad_decay);
+      }
+      momentum_vec.store(momentum_buf_ptr + d);
+      if (nesterov) {
+        grad_vec += momentum_vec * Vec(scalar_t(momentum));
+      } else {
+        grad_vec = momentum_vec;
+      }
+    }
+    param_vec -= grad_vec * Vec(scalar_t(learning_rate));
+    param_vec.store(param_ptr + d);
+  }
+  for (; d < size; d++) {
+    scalar_t grad_val = grad_ptr[d] + param_ptr[d] * weight_decay;
+    if (momentum != 0) {
+      if (!momentum_buf_initialized) {
+        momentum_buf_ptr[d] = grad_val;
+      } else {
+        momentum_buf_ptr[d] =
+            momentum_buf_ptr[d] * momentum + grad_val * grad_decay;
+      }
+      if (nesterov) {
+        grad_val += momentum_buf_ptr[d] * momentum;
+      } else {
+        grad_val = momentum_buf_ptr[d];
+      }
+    }
+    param_ptr[d] -= grad_val * learning_rate;
+  }
 }
 
-template <>
-void sgd_fused_step_kernel<at::BFloat16, at::BFloat16>(
-    at::Tensor& param,
-    const at::Tensor& grad,
-    at::Tensor& momentum_buf,
-    at::Tensor& param2,
+// BFloat16 param, the float master weight is param + its trail param2.
+void sgd_fused_step_range(
+    at::BFloat16* param_ptr,
+    at::BFloat16* grad_ptr,
+    float* momentum_buf_ptr,
+    at::BFloat16* param2_ptr,
+    int64_t size,
     double momentum,
     double learning_rate,
     double weight_decay,
     double dampening,
     bool nesterov,
     bool momentum_buf_initialized) {
-  TORCH_CHECK(
-      param.scalar_type() == at::kBFloat16,
-      "sgd_fused_step_kernel: expect param to be at::BFloat16");
-  TORCH_CHECK(
-      grad.scalar_type() == at::kBFloat16,
-      "sgd_fused_step_kernel: expect grad to be at::BFloat16");
-  TORCH_CHECK(
-      !momentum_buf.defined() || momentum_buf.scalar_type() == at::kFloat,
-      "sgd_fused_step_kernel: expect momentum_buf to be float32");
-  TORCH_CHECK(
-      param2.scalar_type() == at::kBFloat16,
-      "sgd_fused_step_kernel: expect param2 to be at::BFloat16");
-
-  at::BFloat16* param_data = param.data_ptr<at::BFloat16>();
-  at::BFloat16* grad_data = grad.data_ptr<at::BFloat16>();
-  float* momentum_buf_data =
-      momentum_buf.defined() ? momentum_buf.data_ptr<float>() : nullptr;
-  at::BFloat16* param2_data = param2.data_ptr<at::BFloat16>();
-
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
 
-  int64_t grain_size = 512;
-
-  // purely element-wise operations
-  at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
-        // local pointers
-        at::BFloat16* param_ptr = param_data + begin;
-        at::BFloat16* grad_ptr = grad_data + begin;
-        float* momentum_buf_ptr = momentum_buf_data + begin;
-        at::BFloat16* param2_ptr = param2_data + begin;
-
-        const int64_t size = end - begin;
-        float grad_decay = 1 - dampening;
-        int64_t d = 0;
-        for (; d < size - (size % bVec::size()); d += bVec::size()) {
-          bVec param_bvec = bVec::loadu(param_ptr + d);
-          bVec param2_bvec = bVec::loadu(param2_ptr + d);
-          fVec param_fvec, param_fvec2;
-          std::tie(param_fvec, param_fvec2) =
-              at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
-
-          bVec grad_bvec = bVec::loadu(grad_ptr + d);
-          fVec grad_fvec, grad_fvec2;
-          std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
-
-          grad_fvec = grad_fvec + param_fvec * fVec(float(weight_decay));
-          grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(float(weight_decay));
-
-          if (momentum != 0) {
-            fVec momentum_vec, momentum_vec2;
-            if (!momentum_buf_initialized) {
-              momentum_vec = grad_fvec;
-              momentum_vec2 = grad_fvec2;
-            } else {
-              momentum_vec =
-                  fVec::loadu(momentum_buf_ptr + d) * fVec(float(momentum)) +
-                  grad_fvec * fVec(grad_decay);
-              momentum_vec2 = fVec::loadu(momentum_buf_ptr + d + fVec::size()) *
-                      fVec(float(momentum)) +
-                  grad_fvec2 * fVec(grad_decay);
-            }
-            momentum_vec.store(momentum_buf_ptr + d);
-            momentum_vec2.store(momentum_buf_ptr + d + fVec::size());
-            if (nesterov) {
-              grad_fvec += momentum_vec * fVec(momentum);
-              grad_fvec2 += momentum_vec2 * fVec(momentum);
-            } else {
-              grad_fvec = momentum_vec;
-              grad_fvec2 = momentum_vec2;
-            }
-          }
+  float grad_decay = 1 - dampening;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec param_bvec = bVec::loadu(param_ptr + d);
+    bVec param2_bvec = bVec::loadu(param2_ptr + d);
+    fVec param_fvec, param_fvec2;
+    std::tie(param_fvec, param_fvec2) =
+        at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
+
+    bVec grad_bvec = bVec::loadu(grad_ptr + d);
+    fVec grad_fvec, grad_fvec2;
+    std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+
+    grad_fvec = grad_fvec + param_fvec * fVec(float(weight_decay));
+    grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(float(weight_decay));
+
+    if (momentum != 0) {
+      fVec momentum_vec, momentum_vec2;
+      if (!momentum_buf_initialized) {
+        momentum_vec = grad_fvec;
+        momentum_vec2 = grad_fvec2;
+      } else {
+        momentum_vec =
+            fVec::loadu(momentum_buf_ptr + d) * fVec(float(momentum)) +
+            grad_fvec * fVec(grad_decay);
+        momentum_vec2 = fVec::loadu(momentum_buf_ptr + d + fVec::size()) *
+                fVec(float(momentum)) +
+            grad_fvec2 * fVec(grad_decay);
+      }
+      momentum_vec.store(momentum_buf_ptr + d);
+      momentum_vec2.store(momentum_buf_ptr + d + fVec::size());
+      if (nesterov) {
+        grad_fvec += momentum_vec * fVec(momentum);
+        grad_fvec2 += momentum_vec2 * fVec(momentum);
+      } else {
+        grad_fvec = momentum_vec;
+        grad_fvec2 = momentum_vec2;
+      }
+    }
 
-          param_fvec -= grad_fvec * fVec(learning_rate);
-          param_fvec2 -= grad_fvec2 * fVec(learning_rate);
+    param_fvec -= grad_fvec * fVec(learning_rate);
+    param_fvec2 -= grad_fvec2 * fVec(learning_rate);
 
-          std::tie(param_bvec, param2_bvec) =
-              at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
-          param_bvec.store(param_ptr + d);
-          param2_bvec.store(param2_ptr + d);
-        }
-        for (; d < size; d++) {
-          float param_val =
-              at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
-          float grad_val = float(grad_ptr[d]) + param_val * weight_decay;
-          if (momentum != 0) {
-            if (!momentum_buf_initialized) {
-              momentum_buf_ptr[d] = grad_val;
-            } else {
-              momentum_buf_ptr[d] =
-                  momentum_buf_ptr[d] * momentum + grad_val * grad_decay;
-            }
-            if (nesterov) {
-              grad_val += momentum_buf_ptr[d] * momentum;
-            } else {
-              grad_val = momentum_buf_ptr[d];
-            }
-          }
-          param_val -= grad_val * learning_rate;
-          std::tie(param_ptr[d], param2_ptr[d]) =
-              at::vec::unpack_float_bfloat16(param_val);
-        }
-      });
+    std::tie(param_bvec, param2_bvec) =
+        at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
+    param_bvec.store(param_ptr + d);
+    param2_bvec.store(param2_ptr + d);
+  }
+  for (; d < size; d++) {
+    float param_val = at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
+    float grad_val = float(grad_ptr[d]) + param_val * weight_decay;
+    if (momentum != 0) {
+      if (!momentum_buf_initialized) {
+        momentum_buf_ptr[d] = grad_val;
+      } else {
+        momentum_buf_ptr[d] =
+            momentum_buf_ptr[d] * momentum + grad_val * grad_decay;
+      }
+      if (nesterov) {
+        grad_val += momentum_buf_ptr[d] * momentum;
+      } else {
+        grad_val = momentum_buf_ptr[d];
+      }
+    }
+    param_val -= grad_val * learning_rate;
+    std::tie(param_ptr[d], param2_ptr[d]) =
+        at::vec::unpack_float_bfloat16(param_val);
+  }
 }
 
-template <>
-void sgd_fused_step_kernel<float, at::BFloat16>(
-    at::Tensor& param,
-    const at::Tensor& grad,
-    at::Tensor& momentum_buf,
-    at::Tensor& param2,
+// Float master weight param of the BFloat16 param2, with BFloat16 grad.
+void sgd_fused_step_range(
+    float* param_ptr,
+    at::BFloat16* grad_ptr,
+    float* momentum_buf_ptr,
+    at::BFloat16* param2_ptr,
+    int64_t size,
     double momentum,
     double learning_rate,
     double weight_decay,
     double dampening,
     bool nesterov,
     bool momentum_buf_initialized) {
-  TORCH_CHECK(
-      param.scalar_type() == at::kFloat,
-      "sgd_fused_step_kernel: expect param to be at::kFloat");
-  TORCH_CHECK(
-      grad.scalar_type() == at::kBFloat16,
-      "sgd_fused_step_kernel: expect grad to be at::BFloat16");
-  TORCH_CHECK(
-      !momentum_buf.defined() || momentum_buf.scalar_type() == at::kFloat,
-      "sgd_fused_step_kernel: expect momentum_buf to be float32");
-  TORCH_CHECK(
-      param2.scalar_type() == at::kBFloat16,
-      "sgd_fused_step_kernel: expect param to be at::kBFloat16");
-
-  float* param_data = param.data_ptr<float>();
-  at::BFloat16* grad_data = grad.data_ptr<at::BFloat16>();
-  float* momentum_buf_data =
-      momentum_buf.defined() ? momentum_buf.data_ptr<float>() : nullptr;
-  at::BFloat16* param2_data = param2.data_ptr<at::BFloat16>();
-
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
 
-  int64_t grain_size = 512;
-
-  // purely element-wise operations
-  at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
-        // local pointers
-        float* param_ptr = param_data + begin;
-        at::BFloat16* grad_ptr = grad_data + begin;
-        float* momentum_buf_ptr = momentum_buf_data + begin;
-        at::BFloat16* param2_ptr = param2_data + begin;
-
-        const int64_t size = end - begin;
-        float grad_decay = 1 - dampening;
-        int64_t d = 0;
-        for (; d < size - (size % bVec::size()); d += bVec::size()) {
-          fVec param_fvec = fVec::loadu(param_ptr + d);
-          fVec param_fvec2 = fVec::loadu(param_ptr + d + fVec::size());
-          bVec grad_bvec = bVec::loadu(grad_ptr + d);
-          fVec grad_fvec, grad_fvec2;
-          std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
-
-          grad_fvec = grad_fvec + param_fvec * fVec(float(weight_decay));
-          grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(float(weight_decay));
+  float grad_decay = 1 - dampening;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec param_fvec = fVec::loadu(param_ptr + d);
+    fVec param_fvec2 = fVec::loadu(param_ptr + d + fVec::size());
+    bVec grad_bvec = bVec::loadu(grad_ptr + d);
+    fVec grad_fvec, grad_fvec2;
+    std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+
+    grad_fvec = grad_fvec + param_fvec * fVec(float(weight_decay));
+    grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(float(weight_decay));
+
+    if (momentum != 0) {
+      fVec momentum_vec, momentum_vec2;
+      if (!momentum_buf_initialized) {
+        momentum_vec = grad_fvec;
+        momentum_vec2 = grad_fvec2;
+      } else {
+        momentum_vec =
+            fVec::loadu(momentum_buf_ptr + d) * fVec(float(momentum)) +
+            grad_fvec * fVec(grad_decay);
+        momentum_vec2 = fVec::loadu(momentum_buf_ptr + d + fVec::size()) *
+                fVec(float(momentum)) +
+            grad_fvec2 * fVec(grad_decay);
+      }
+      momentum_vec.store(momentum_buf_ptr + d);
+      momentum_vec2.store(momentum_buf_ptr + d + fVec::size());
+      if (nesterov) {
+        grad_fvec += momentum_vec * fVec(momentum);
+        grad_fvec2 += momentum_vec2 * fVec(momentum);
+      } else {
+        grad_fvec = momentum_vec;
+        grad_fvec2 = momentum_vec2;
+      }
+    }
 
-          if (momentum != 0) {
-            fVec momentum_vec, momentum_vec2;
-            if (!momentum_buf_initialized) {
-              momentum_vec = grad_fvec;
-              momentum_vec2 = grad_fvec2;
-            } else {
-              momentum_vec =
-                  fVec::loadu(momentum_buf_ptr + d) * fVec(float(momentum)) +
-                  grad_fvec * fVec(grad_decay);
-              momentum_vec2 = fVec::loadu(momentum_buf_ptr + d + fVec::size()) *
-                      fVec(float(momentum)) +
-                  grad_fvec2 * fVec(grad_decay);
-            }
-            momentum_vec.store(momentum_buf_ptr + d);
-            momentum_vec2.store(momentum_buf_ptr + d + fVec::size());
-            if (nesterov) {
-              grad_fvec += momentum_vec * fVec(momentum);
-              grad_fvec2 += momentum_vec2 * fVec(momentum);
-            } else {
-              grad_fvec = momentum_vec;
-              grad_fvec2 = momentum_vec2;
-            }
-          }
+    param_fvec -= grad_fvec * fVec(learning_rate);
+    param_fvec2 -= grad_fvec2 * fVec(learning_rate);
 
-          param_fvec -= grad_fvec * fVec(learning_rate);
-          param_fvec2 -= grad_fvec2 * fVec(learning_rate);
+    param_fvec.store(param_ptr + d);
+    param_fvec2.store(param_ptr + d + fVec::size());
+    // sync float param to bfloat16
+    bVec param2_bvec = convert_float_bfloat16(param_fvec, param_fvec2);
+    param2_bvec.store(param2_ptr + d);
+  }
+  for (; d < size; d++) {
+    float param_val = param_ptr[d];
+    float grad_val = float(grad_ptr[d]) + param_val * weight_decay;
+    if (momentum != 0) {
+      if (!momentum_buf_initialized) {
+        momentum_buf_ptr[d] = grad_val;
+      } else {
+        momentum_buf_ptr[d] =
+            momentum_buf_ptr[d] * momentum + grad_val * grad_decay;
+      }
+      if (nesterov) {
+        grad_val += momentum_buf_ptr[d] * momentum;
+      } else {
+        grad_val = momentum_buf_ptr[d];
+      }
+    }
+    param_val -= grad_val * learning_rate;
+    param_ptr[d] = param_val;
+    param2_ptr[d] = at::BFloat16(param_val);
+  }
+}
 
-          param_fvec.store(param_ptr + d);
-          param_fvec2.store(param_ptr + d + fVec::size());
-          // sync float param to bfloat16
-          bVec param2_bvec = convert_float_bfloat16(param_fvec, param_fvec2);
-          param2_bvec.store(param2_ptr + d);
-        }
-        for (; d < size; d++) {
-          float param_val = param_ptr[d];
-          float grad_val = float(grad_ptr[d]) + param_val * weight_decay;
-          if (momentum != 0) {
-            if (!momentum_buf_initialized) {
-              momentum_buf_ptr[d] = grad_val;
-            } else {
-              momentum_buf_ptr[d] =
-                  momentum_buf_ptr[d] * momentum + grad_val * grad_decay;
-            }
-            if (nesterov) {
-              grad_val += momentum_buf_ptr[d] * momentum;
-            } else {
-              grad_val = momentum_buf_ptr[d];
-            }
-          }
-          param_val -= grad_val * learning_rate;
-          param_ptr[d] = param_val;
-          param2_ptr[d] = at::BFloat16(param_val);
-        }
-      });
+// Update all the tensors of the lists by the chunks of a single parallel
+// region.
+template <typename scalar_t, typename grad_t>
+void sgd_fused_step_kernel(
+    const std::vector<at::Tensor>& params,
+    const std::vector<at::Tensor>& grads,
+    const std::vector<at::Tensor>& momentum_bufs,
+    const std::vector<at::Tensor>& params2,
+    const std::vector<bool>& momentum_buf_initialized,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double dampening,
+    bool nesterov) {
+  using acc_t = fused_step_acc_t<scalar_t>;
+  auto param_data = get_data_ptrs<scalar_t>(params);
+  auto grad_data = get_data_ptrs<grad_t>(grads);
+  auto momentum_buf_data = get_data_ptrs<acc_t>(momentum_bufs);
+  // param2 is only used by the BFloat16 training.
+  auto param2_data = std::is_same<grad_t, at::BFloat16>::value
+      ? get_data_ptrs<at::BFloat16>(params2)
+      : std::vector<at::BFloat16*>(params.size(), nullptr);
+
+  auto chunks = make_fused_step_chunks(params);
+  at::parallel_for(0, chunks.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      const auto& chunk = chunks[c];
+      auto t = chunk.tensor_id;
+      sgd_fused_step_range(
+          get_chunk_ptr(param_data[t], chunk),
+          get_chunk_ptr(grad_data[t], chunk),
+          get_chunk_ptr(momentum_buf_data[t], chunk),
+          get_chunk_ptr(param2_data[t], chunk),
+          chunk.end - chunk.begin,
+          momentum,
+          learning_rate,
+          weight_decay,
+          dampening,
+          nesterov,
+          momentum_buf_initialized[t]);
+    }
+  });
 }
 
-c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
-    at::Tensor& param_,
-    const at::Tensor& grad_,
-    const c10::optional<at::Tensor>& momentum_buf_,
-    at::Tensor& param2_,
+std::vector<at::Tensor> sgd_fused_step_multi_tensor_kernel_impl(
+    const std::vector<at::Tensor>& params_,
+    const std::vector<at::Tensor>& grads_,
+    const std::vector<at::Tensor>& momentum_bufs_,
+    const std::vector<at::Tensor>& params2_,
     double momentum,
     double learning_rate,
     double weight_decay,
     double dampening,
     bool nesterov) {
-  auto param = param_.contiguous();
-  auto grad = grad_.contiguous();
-  auto param2 = param2_.contiguous();
+  if (params_.empty()) {
+    return {};
+  }
+  auto params = get_contiguous_list(params_);
+  auto grads = get_contiguous_list(grads_);
+  auto params2 = get_contiguous_list(params2_);
 
-  at::Tensor momentum_buf;
-  bool momentum_buf_initialized;
+  // An undefined or empty momentum_buf is created by this step.
+  std::vector<at::Tensor> momentum_bufs(params.size());
+  std::vector<bool> momentum_buf_initialized(params.size(), false);
   if (momentum != 0) {
-    if (!momentum_buf_.has_value()) {
-      auto acc_dtype =
-          param.scalar_type() == at::kDouble ? at::kDouble : at::kFloat;
-      momentum_buf = at::empty_like(param, acc_dtype);
-      momentum_buf_initialized = false;
-    } else {
-      momentum_buf = momentum_buf_.value().contiguous();
-      momentum_buf_initialized = true;
+    for (size_t t = 0; t < params.size(); t++) {
+      const auto& momentum_buf = momentum_bufs_[t];
+      if (momentum_buf.defined() && momentum_buf.numel() > 0) {
+        momentum_bufs[t] = momentum_buf.contiguous();
+        momentum_buf_initialized[t] = true;
+      } else {
+        auto acc_dtype =
+            params[t].scalar_type() == at::kDouble ? at::kDouble : at::kFloat;
+        momentum_bufs[t] = at::empty_like(params[t], acc_dtype);
+      }
     }
   }
 
-  auto grad_dtype = grad_.scalar_type();
-  auto param_dtype = param_.scalar_type();
+  auto grad_dtype = grads_[0].scalar_type();
+  auto param_dtype = params_[0].scalar_type();
   if (at::ScalarType::Float == grad_dtype) {
     sgd_fused_step_kernel<float, float>(
-        param,
-        grad,
-        momentum_buf,
-        param2,
+        params,
+        grads,
+        momentum_bufs,
+        params2,
+        momentum_buf_initialized,
         momentum,
         learning_rate,
         weight_decay,
         dampening,
-        nesterov,
-        momentum_buf_initialized);
+        nesterov);
   } else if (at::ScalarType::Double == grad_dtype) {
     sgd_fused_step_kernel<double, double>(
-        param,
-        grad,
-        momentum_buf,
-        param2,
+        params,
+        grads,
+        momentum_bufs,
+        params2,
+        momentum_buf_initialized,
         momentum,
         learning_rate,
         weight_decay,
         dampening,
-        nesterov,
-        momentum_buf_initialized);
+        nesterov);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::BFloat16 == param_dtype) {
     sgd_fused_step_kernel<at::BFloat16, at::BFloat16>(
-        param,
-        grad,
-        momentum_buf,
-        param2,
+        params,
+        grads,
+        momentum_bufs,
+        params2,
+        momentum_buf_initialized,
         momentum,
         learning_rate,
         weight_decay,
         dampening,
-        nesterov,
-        momentum_buf_initialized);
+        nesterov);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::Float == param_dtype) {
     sgd_fused_step_kernel<float, at::BFloat16>(
-        param,
-        grad,
-        momentum_buf,
-        param2,
+        params,
+        grads,
+        momentum_bufs,
+        params2,
+        momentum_buf_initialized,
         momentum,
         learning_rate,
         weight_decay,
         dampening,
-        nesterov,
-        momentum_buf_initialized);
+        nesterov);
   } else {
     TORCH_CHECK(false, "expect bfloat16 or float or double param");
   }
-  if (!param_.is_contiguous()) {
-    param_.copy_(param);
-  }
+  copy_back_list(params_, params);
+  copy_back_list(params2_, params2);
 
-  if (!param2_.is_contiguous()) {
-    param2_.copy_(param2);
+  if (momentum == 0) {
+    return {};
   }
-
-  if (momentum_buf_.has_value() && !momentum_buf_.value().is_contiguous()) {
-    momentum_buf_.value().copy_(momentum_buf);
+  // Return the given momentum_buf, or the new one.
+  for (size_t t = 0; t < params.size(); t++) {
+    if (momentum_buf_initialized[t]) {
+      if (!momentum_bufs_[t].is_contiguous()) {
+        momentum_bufs_[t].copy_(momentum_bufs[t]);
+      }
+      momentum_bufs[t] = momentum_bufs_[t];
+    }
   }
+  return momentum_bufs;
+}
 
+c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
+    at::Tensor& param_,
+    const at::Tensor& grad_,
+    const c10::optional<at::Tensor>& momentum_buf_,
+    at::Tensor& param2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double dampening,
+    bool nesterov) {
+  std::vector<at::Tensor> params = {param_};
+  std::vector<at::Tensor> grads = {grad_};
+  std::vector<at::Tensor> momentum_bufs = {
+      momentum_buf_.has_value() ? momentum_buf_.value() : at::Tensor()};
+  std::vector<at::Tensor> params2 = {param2_};
+  auto momentum_bufs_out = sgd_fused_step_multi_tensor_kernel_impl(
+      params,
+      grads,
+      momentum_bufs,
+      params2,
+      momentum,
+      learning_rate,
+      weight_decay,
+      dampening,
+      nesterov);
   if (momentum == 0) {
     return c10::nullopt;
   } else
-    return momentum_buf;
+    return momentum_bufs_out[0];
 }
 
 } // anonymous namespace
 
 REGISTER_DISPATCH(sgd_fused_step_kernel_stub, &sgd_fused_step_kernel_impl);
+REGISTER_DISPATCH(
+    sgd_fused_step_multi_tensor_kernel_stub,
+    &sgd_fused_step_multi_tensor_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
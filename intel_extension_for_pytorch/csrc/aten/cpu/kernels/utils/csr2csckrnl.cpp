@@ -2,11 +2,80 @@
 #include <csrc/aten/cpu/utils/radix_sort.h>
 #include "csrc/utils/ipex_op_profile.h"
 
+#include <ATen/Parallel.h>
+#include <cstring>
+
 namespace torch_ipex {
 namespace cpu {
 
 namespace {
 
+// The tables with fewer indices are sorted by a thread each, in parallel.
+constexpr int64_t kSerialSortThreshold = 1 << 16;
+// Stride of num_uniq, a cache line of ints.
+constexpr int kNumUniqStride = 16;
+
+template <typename T>
+void grow(std::vector<T>& buffer, int64_t size) {
+  if (buffer.size() < static_cast<size_t>(size)) {
+    buffer.resize(size);
+  }
+}
+
+// Sort the indices [begin, end) of a table, into the buffer of the workspace.
+void sort_table(
+    CSR2CSCWorkspace& ws,
+    int64_t begin,
+    int64_t end,
+    bool has_weights,
+    bool parallel) {
+  int64_t n = end - begin;
+  if (n <= 1) {
+    return;
+  }
+  int min_key, max_key;
+  if (scan_keys(&ws.keys[begin], n, min_key, max_key, parallel)) {
+    return;
+  }
+  Key_Value_Weight_Buffer<int> inp_buf = {
+      &ws.keys[begin],
+      &ws.values[begin],
+      has_weights ? &ws.weights[begin] : nullptr};
+  Key_Value_Weight_Buffer<int> tmp_buf = {
+      &ws.keys_tmp[begin],
+      &ws.values_tmp[begin],
+      has_weights ? &ws.weights_tmp[begin] : nullptr};
+  int hist_offset = parallel ? 0 : omp_get_thread_num();
+  auto sorted = radix_sort_parallel<int>(
+      inp_buf,
+      tmp_buf,
+      n,
+      min_key,
+      max_key,
+      &ws.histogram[HIST_SIZE * hist_offset],
+      &ws.histogram_ps[(HIST_SIZE + 1) * hist_offset],
+      parallel);
+  if (sorted.keys == inp_buf.keys) {
+    return;
+  }
+  // An odd number of passes, copy the result back.
+  auto copy_back = [&](int64_t from, int64_t to) {
+    auto size = to - from;
+    std::memcpy(inp_buf.keys + from, sorted.keys + from, size * sizeof(int));
+    std::memcpy(
+        inp_buf.values + from, sorted.values + from, size * sizeof(int));
+    if (has_weights) {
+      std::memcpy(
+          inp_buf.weights + from, sorted.weights + from, size * sizeof(float));
+    }
+  };
+  if (parallel) {
+    at::parallel_for(0, n, 4096, copy_back);
+  } else {
+    copy_back(0, n);
+  }
+}
+
 void sort_based_batched_csr2csc_opt_kernel_impl(
     BatchedHyperCompressedSparseColumn& batched_csc,
     int B,
@@ -16,7 +85,7 @@ void sort_based_batched_csr2csc_opt_kernel_impl(
     int64_t max_embeddings) {
   IPEX_RECORD_FUNCTION(__FUNCTION__, std::vector<c10::IValue>({}));
 
-  Allocator* allocator = c10::GetAllocator(c10::DeviceType::CPU);
+  CSR2CSCWorkspace& ws = *batched_csc.workspace;
   TensorAccessor<int64_t, 1> offsets_data = offsets.accessor<int64_t, 1>();
   TensorAccessor<int64_t, 1> batched_csr_indices =
       indices.accessor<int64_t, 1>();
@@ -24,22 +93,28 @@ void sort_based_batched_csr2csc_opt_kernel_impl(
   batched_csc.num_tables = num_tables;
   int64_t n_indices = indices.numel();
   int64_t n_offsets = offsets.numel() - 1;
+  bool has_weights = false;
   for (auto pooling_mode : pooling_modes) {
-    if (pooling_mode == MEAN) {
-      batched_csc.weights =
-          (float*)allocator->raw_allocate(n_indices * sizeof(float));
-      break;
-    }
+    has_weights |= pooling_mode == MEAN;
+  }
+
+  int max_thds = omp_get_max_threads();
+  grow(ws.keys, n_indices);
+  grow(ws.values, n_indices);
+  grow(ws.keys_tmp, n_indices);
+  grow(ws.values_tmp, n_indices);
+  if (has_weights) {
+    grow(ws.weights, n_indices);
+    grow(ws.weights_tmp, n_indices);
   }
+  grow(ws.histogram, HIST_SIZE * max_thds);
+  grow(ws.histogram_ps, (HIST_SIZE + 1) * max_thds);
+  grow(ws.num_uniq, kNumUniqStride * max_thds);
 
   auto get_table_id = [&](int n) { return n / B; };
 
-  Key_Value_Weight_Tuple<int>* tmpBuf =
-      (Key_Value_Weight_Tuple<int>*)allocator->raw_allocate(
-          (n_indices) * sizeof(Key_Value_Weight_Tuple<int>));
-  Key_Value_Weight_Tuple<int>* tmpBuf1 =
-      (Key_Value_Weight_Tuple<int>*)allocator->raw_allocate(
-          (n_indices) * sizeof(Key_Value_Weight_Tuple<int>));
+  // The output rows are stored modulo B, as the rows of the grads of each
+  // table.
 #pragma omp parallel for
   for (int n = 0; n < n_offsets; ++n) {
     int64_t pool_begin = offsets_data[n];
@@ -48,79 +123,91 @@ void sort_based_batched_csr2csc_opt_kernel_impl(
     float scale_factor =
         pooling_modes[table_id] == MEAN ? 1.0 / (pool_end - pool_begin) : 1;
     for (int64_t p = pool_begin; p < pool_end; ++p) {
-      std::get<0>(tmpBuf[p]) = batched_csr_indices[p];
-      std::get<1>(tmpBuf[p]) = n;
-      if (batched_csc.weights) {
-        std::get<2>(tmpBuf[p]) = scale_factor;
+      ws.keys[p] = batched_csr_indices[p];
+      ws.values[p] = n % B;
+      if (has_weights) {
+        ws.weights[p] = scale_factor;
       }
     }
   }
 
-  Key_Value_Weight_Tuple<int>* sorted_col_row_index_pairs =
-      radix_sort_parallel<int>(
-          &tmpBuf[0], &tmpBuf1[0], n_indices, max_embeddings);
-  int max_thds = omp_get_max_threads();
-  int num_uniq[max_thds][64];
+  // The indices of a table are contiguous and their rows (with the row offset
+  // of the table) don't overlap the rows of the other tables, so the tables
+  // are sorted independently, by the digits of their own range of rows.
+  auto is_large_table = [&](int t) {
+    return offsets_data[(t + 1) * B] - offsets_data[t * B] >=
+        kSerialSortThreshold;
+  };
+#pragma omp parallel for schedule(dynamic)
+  for (int t = 0; t < num_tables; t++) {
+    if (!is_large_table(t)) {
+      sort_table(
+          ws,
+          offsets_data[t * B],
+          offsets_data[(t + 1) * B],
+          has_weights,
+          false);
+    }
+  }
+  for (int t = 0; t < num_tables; t++) {
+    if (is_large_table(t)) {
+      sort_table(
+          ws,
+          offsets_data[t * B],
+          offsets_data[(t + 1) * B],
+          has_weights,
+          true);
+    }
+  }
 
+  const int* sorted_keys = ws.keys.data();
+  int* num_uniq = ws.num_uniq.data();
+  std::fill_n(num_uniq, kNumUniqStride * max_thds, 0);
 #pragma omp parallel
   {
     int tid = omp_get_thread_num();
-    num_uniq[tid][0] = 0;
 #pragma omp for schedule(static)
-    for (int i = 1; i < n_indices; i++) {
-      if (std::get<0>(sorted_col_row_index_pairs[i]) !=
-          std::get<0>(sorted_col_row_index_pairs[i - 1]))
-        num_uniq[tid][0]++;
+    for (int64_t i = 1; i < n_indices; i++) {
+      if (sorted_keys[i] != sorted_keys[i - 1])
+        num_uniq[tid * kNumUniqStride]++;
     }
   }
-  num_uniq[0][0] += 1;
+  // Turn the counts to the ends of the unique indices found by each thread.
+  num_uniq[0] += n_indices > 0;
   for (int i = 1; i < max_thds; i++)
-    num_uniq[i][0] += num_uniq[i - 1][0];
-  int U = num_uniq[max_thds - 1][0];
-
-  batched_csc.segment_ptr =
-      (int*)allocator->raw_allocate((U + 1) * sizeof(int));
-  batched_csc.segment_indices = (int*)allocator->raw_allocate(U * sizeof(int));
-  batched_csc.output_row_indices =
-      (int*)allocator->raw_allocate(n_indices * sizeof(int));
-
-  batched_csc.segment_ptr[0] = 0;
-  batched_csc.output_row_indices[0] =
-      std::get<1>(sorted_col_row_index_pairs[0]) % B;
-  batched_csc.segment_indices[0] = std::get<0>(sorted_col_row_index_pairs[0]);
-  if (batched_csc.weights) {
-    batched_csc.weights[0] = std::get<2>(sorted_col_row_index_pairs[0]);
+    num_uniq[i * kNumUniqStride] += num_uniq[(i - 1) * kNumUniqStride];
+  int U = num_uniq[(max_thds - 1) * kNumUniqStride];
+
+  grow(ws.segment_ptr, U + 1);
+  grow(ws.segment_indices, U);
+  batched_csc.segment_ptr = ws.segment_ptr.data();
+  batched_csc.segment_indices = ws.segment_indices.data();
+  batched_csc.output_row_indices = ws.values.data();
+  batched_csc.weights = has_weights ? ws.weights.data() : nullptr;
+
+  if (n_indices > 0) {
+    batched_csc.segment_ptr[0] = 0;
+    batched_csc.segment_indices[0] = sorted_keys[0];
   }
 #pragma omp parallel
   {
     int tid = omp_get_thread_num();
-    int* tstart =
-        (tid == 0 ? batched_csc.segment_indices + 1
-                  : batched_csc.segment_indices + num_uniq[tid - 1][0]);
-    int* t_offs =
-        (tid == 0 ? batched_csc.segment_ptr + 1
-                  : batched_csc.segment_ptr + num_uniq[tid - 1][0]);
+    int start = tid == 0 ? 1 : num_uniq[(tid - 1) * kNumUniqStride];
+    int* tstart = batched_csc.segment_indices + start;
+    int* t_offs = batched_csc.segment_ptr + start;
 
 #pragma omp for schedule(static)
-    for (int i = 1; i < n_indices; i++) {
-      batched_csc.output_row_indices[i] =
-          std::get<1>(sorted_col_row_index_pairs[i]) % B;
-      if (batched_csc.weights) {
-        batched_csc.weights[i] = std::get<2>(sorted_col_row_index_pairs[i]);
-      }
-      if (std::get<0>(sorted_col_row_index_pairs[i]) !=
-          std::get<0>(sorted_col_row_index_pairs[i - 1])) {
-        *tstart = std::get<0>(sorted_col_row_index_pairs[i]);
+    for (int64_t i = 1; i < n_indices; i++) {
+      if (sorted_keys[i] != sorted_keys[i - 1]) {
+        *tstart = sorted_keys[i];
         *t_offs = i;
         tstart++;
         t_offs++;
       }
     }
   }
-  batched_csc.uniq_indices += U;
+  batched_csc.uniq_indices = U;
   batched_csc.segment_ptr[U] = n_indices;
-  allocator->raw_deallocate(tmpBuf);
-  allocator->raw_deallocate(tmpBuf1);
 }
 
 } // anonymous namespace
@@ -8,6 +8,7 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(adagrad_fused_step_kernel_stub);
+DEFINE_DISPATCH(adagrad_fused_step_multi_tensor_kernel_stub);
 
 std::tuple<at::Tensor, at::Tensor> adagrad_fused_step(
     const at::Tensor& param_,
@@ -60,7 +61,7 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step(
       lr_decay,
       eps);
   */
-  return adagrad_fused_step_kernel_stub(
+  auto result = adagrad_fused_step_kernel_stub(
       kCPU,
       param_,
       grad_,
@@ -71,6 +72,88 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step(
       weight_decay,
       lr_decay,
       eps);
+  bump_param_version(param_);
+  return result;
+}
+
+// Update all the params of the lists in a single parallel region, the params
+// of the lists should have the same dtype, and so do the grads.
+void adagrad_fused_step_multi_tensor(
+    const std::vector<at::Tensor>& params_,
+    const std::vector<at::Tensor>& grads_,
+    const std::vector<at::Tensor>& state_sums_,
+    const std::vector<at::Tensor>& params2_,
+    const std::vector<int64_t>& steps,
+    double learning_rate,
+    double weight_decay,
+    double lr_decay,
+    double eps) {
+  IPEX_RECORD_FUNCTION(
+      "torch_ipex::adagrad_fused_step_multi_tensor",
+      std::vector<c10::IValue>({}));
+
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(lr_decay >= 0, "Expect lr_decay >=0.0 , got ", lr_decay);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  auto n_tensors = params_.size();
+  TORCH_CHECK(
+      grads_.size() == n_tensors && state_sums_.size() == n_tensors &&
+          params2_.size() == n_tensors && steps.size() == n_tensors,
+      "Expect params, grads, state_sums, params2 and steps have the same "
+      "length");
+  for (size_t t = 0; t < n_tensors; t++) {
+    TORCH_CHECK(
+        params_[t].scalar_type() == params_[0].scalar_type() &&
+            grads_[t].scalar_type() == grads_[0].scalar_type(),
+        "Expect all the params and all the grads have the same dtype");
+    TORCH_CHECK(
+        params_[t].sizes() == grads_[t].sizes(),
+        "Expect param and grad_ have the same sizes, param sizes: ",
+        params_[t].sizes(),
+        "; grad_ sizes: ",
+        grads_[t].sizes());
+    TORCH_CHECK(
+        params_[t].sizes() == state_sums_[t].sizes(),
+        "Expect param and state_sum have the same sizes, param sizes: ",
+        params_[t].sizes(),
+        "; state_sum sizes: ",
+        state_sums_[t].sizes());
+    TORCH_CHECK(
+        params2_[t].numel() == 0 || params_[t].sizes() == params2_[t].sizes(),
+        "Expect param and param2_ have the same sizes, param sizes: ",
+        params_[t].sizes(),
+        "; param2_ sizes: ",
+        params2_[t].sizes());
+  }
+
+  /*
+  pointer to adagrad_fused_step_multi_tensor_kernel_impl(
+      params_,
+      grads_,
+      state_sums_,
+      params2_,
+      steps,
+      learning_rate,
+      weight_decay,
+      lr_decay,
+      eps);
+  */
+  adagrad_fused_step_multi_tensor_kernel_stub(
+      kCPU,
+      params_,
+      grads_,
+      state_sums_,
+      params2_,
+      steps,
+      learning_rate,
+      weight_decay,
+      lr_decay,
+      eps);
+  bump_param_versions(params_);
 }
 
 } // namespace cpu
@@ -84,6 +167,11 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "state_sum, Tensor trail, int step, float lr, float weight_decay, "
       "float lr_decay, float eps) -> (Tensor(a!), Tensor(b!))",
       torch_ipex::cpu::adagrad_fused_step);
+  m.def(
+      "adagrad_fused_step_multi_tensor(Tensor(a!)[] params, Tensor[] grads, "
+      "Tensor(b!)[] state_sums, Tensor(c!)[] trails, int[] steps, float lr, "
+      "float weight_decay, float lr_decay, float eps) -> ()",
+      torch_ipex::cpu::adagrad_fused_step_multi_tensor);
 }
 
 } // namespace
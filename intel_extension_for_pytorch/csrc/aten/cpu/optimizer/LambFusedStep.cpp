@@ -8,6 +8,7 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(lamb_fused_step_kernel_stub);
+DEFINE_DISPATCH(lamb_fused_step_multi_tensor_kernel_stub);
 
 std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step(
     const at::Tensor& param_,
@@ -71,7 +72,7 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step(
       weight_decay,
       eps);
   */
-  return lamb_fused_step_kernel_stub(
+  auto result = lamb_fused_step_kernel_stub(
       kCPU,
       param_,
       exp_avg_,
@@ -84,6 +85,103 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step(
       learning_rate,
       weight_decay,
       eps);
+  bump_param_version(param_);
+  return result;
+}
+
+// Update all the params of the lists in a single pass, the norms of each
+// param are computed in the same pass. The params of the lists should have the
+// same dtype, and so do the grads.
+void lamb_fused_step_multi_tensor(
+    const std::vector<at::Tensor>& params_,
+    const std::vector<at::Tensor>& exp_avgs_,
+    const std::vector<at::Tensor>& exp_avg_sqs_,
+    const std::vector<at::Tensor>& grads_,
+    const std::vector<at::Tensor>& params2_,
+    const std::vector<int64_t>& steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  IPEX_RECORD_FUNCTION(
+      "torch_ipex::lamb_fused_step_multi_tensor",
+      std::vector<c10::IValue>({}));
+
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(beta1 >= 0 && beta1 < 1, "Expect 0.0 <= beta1 < 1.0, got", beta1);
+  TORCH_CHECK(beta2 >= 0 && beta2 < 1, "Expect 0.0 <= beta2 < 1.0, got", beta2);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  auto n_tensors = params_.size();
+  TORCH_CHECK(
+      exp_avgs_.size() == n_tensors && exp_avg_sqs_.size() == n_tensors &&
+          grads_.size() == n_tensors && params2_.size() == n_tensors &&
+          steps.size() == n_tensors,
+      "Expect params, exp_avgs, exp_avg_sqs, grads, params2 and steps have "
+      "the same length");
+  for (size_t t = 0; t < n_tensors; t++) {
+    TORCH_CHECK(
+        params_[t].scalar_type() == params_[0].scalar_type() &&
+            grads_[t].scalar_type() == grads_[0].scalar_type(),
+        "Expect all the params and all the grads have the same dtype");
+    TORCH_CHECK(
+        params_[t].sizes() == grads_[t].sizes(),
+        "Expect param and grad have the same sizes, param sizes: ",
+        params_[t].sizes(),
+        "; grad sizes: ",
+        grads_[t].sizes());
+    TORCH_CHECK(
+        params_[t].sizes() == exp_avgs_[t].sizes(),
+        "Expect param and exp_avg have the same sizes, param sizes: ",
+        params_[t].sizes(),
+        "; exp_avg sizes: ",
+        exp_avgs_[t].sizes());
+    TORCH_CHECK(
+        params_[t].sizes() == exp_avg_sqs_[t].sizes(),
+        "Expect param and exp_avg_sq_ have the same sizes, param sizes: ",
+        params_[t].sizes(),
+        "; exp_avg_sq sizes: ",
+        exp_avg_sqs_[t].sizes());
+    TORCH_CHECK(
+        params2_[t].numel() == 0 || params_[t].sizes() == params2_[t].sizes(),
+        "Expect param and param2_ have the same sizes, param sizes: ",
+        params_[t].sizes(),
+        "; param2_ sizes: ",
+        params2_[t].sizes());
+  }
+
+  /*
+  pointer to lamb_fused_step_multi_tensor_kernel_impl(
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      grads_,
+      params2_,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+  */
+  lamb_fused_step_multi_tensor_kernel_stub(
+      kCPU,
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      grads_,
+      params2_,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+  bump_param_versions(params_);
 }
 
 } // namespace cpu
@@ -98,6 +196,12 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "beta2, float lr, float weight_decay, float eps) -> (Tensor(a!), "
       "Tensor(b!), Tensor(c!))",
       torch_ipex::cpu::lamb_fused_step);
+  m.def(
+      "lamb_fused_step_multi_tensor(Tensor(a!)[] params, Tensor(b!)[] "
+      "exp_avgs, Tensor(c!)[] exp_avg_sqs, Tensor[] grads, Tensor(d!)[] "
+      "trails, int[] steps, float beta1, float beta2, float lr, float "
+      "weight_decay, float eps) -> ()",
+      torch_ipex::cpu::lamb_fused_step_multi_tensor);
 }
 
 } // namespace
@@ -0,0 +1,22 @@
+#include "optimizer.h"
+
+#include <torch/csrc/autograd/variable.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+void bump_param_version(const at::Tensor& param) {
+  // Inference tensors have no version counter.
+  if (param.defined() && !param.is_inference()) {
+    torch::autograd::increment_version(param);
+  }
+}
+
+void bump_param_versions(const std::vector<at::Tensor>& params) {
+  for (const auto& param : params) {
+    bump_param_version(param);
+  }
+}
+
+} // namespace cpu
+} // namespace torch_ipex
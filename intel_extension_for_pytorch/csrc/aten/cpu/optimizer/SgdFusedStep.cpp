@@ -8,6 +8,7 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(sgd_fused_step_kernel_stub);
+DEFINE_DISPATCH(sgd_fused_step_multi_tensor_kernel_stub);
 
 /**
  * SGD fused update kernel.
@@ -74,7 +75,7 @@ c10::optional<at::Tensor> sgd_fused_step(
       dampening,
       nesterov);
   */
-  return sgd_fused_step_kernel_stub(
+  auto momentum_buf = sgd_fused_step_kernel_stub(
       kCPU,
       param_,
       grad_,
@@ -85,6 +86,94 @@ c10::optional<at::Tensor> sgd_fused_step(
       weight_decay,
       dampening,
       nesterov);
+  bump_param_version(param_);
+  return momentum_buf;
+}
+
+/**
+ * Multi-tensor SGD fused update kernel, updates all the params of the list in
+ * a single parallel region.
+ * The params of the list should have the same dtype, and so do the grads.
+ *@param momentum_bufs_ An undefined or empty momentum_buf is created by
+ *this step
+ *@return The momentum_bufs, empty if momentum is 0
+ * The other args are the same as sgd_fused_step.
+ */
+std::vector<at::Tensor> sgd_fused_step_multi_tensor(
+    const std::vector<at::Tensor>& params_,
+    const std::vector<at::Tensor>& grads_,
+    const std::vector<at::Tensor>& momentum_bufs_,
+    const std::vector<at::Tensor>& params2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double dampening,
+    bool nesterov) {
+  IPEX_RECORD_FUNCTION(
+      "torch_ipex::sgd_fused_step_multi_tensor",
+      std::vector<c10::IValue>({}));
+
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  auto n_tensors = params_.size();
+  TORCH_CHECK(
+      grads_.size() == n_tensors && momentum_bufs_.size() == n_tensors &&
+          params2_.size() == n_tensors,
+      "Expect params, grads, momentum_bufs and params2 have the same length");
+  for (size_t t = 0; t < n_tensors; t++) {
+    TORCH_CHECK(
+        params_[t].scalar_type() == params_[0].scalar_type() &&
+            grads_[t].scalar_type() == grads_[0].scalar_type(),
+        "Expect all the params and all the grads have the same dtype");
+    TORCH_CHECK(
+        params_[t].sizes() == grads_[t].sizes(),
+        "Expect param and grad_ have the same sizes, param sizes: ",
+        params_[t].sizes(),
+        "; grad_ sizes: ",
+        grads_[t].sizes());
+    TORCH_CHECK(
+        !momentum_bufs_[t].defined() || momentum_bufs_[t].numel() == 0 ||
+            params_[t].sizes() == momentum_bufs_[t].sizes(),
+        "Expect param and momentum_buf have the same sizes, param sizes: ",
+        params_[t].sizes(),
+        "; momentum_buf sizes: ",
+        momentum_bufs_[t].sizes());
+    TORCH_CHECK(
+        params2_[t].numel() == 0 || params_[t].sizes() == params2_[t].sizes(),
+        "Expect param and param2_ have the same sizes, param sizes: ",
+        params_[t].sizes(),
+        "; param2_ sizes: ",
+        params2_[t].sizes());
+  }
+
+  /*
+  pointer to sgd_fused_step_multi_tensor_kernel_impl(
+      params_,
+      grads_,
+      momentum_bufs_,
+      params2_,
+      momentum,
+      learning_rate,
+      weight_decay,
+      dampening,
+      nesterov);
+  */
+  auto momentum_bufs = sgd_fused_step_multi_tensor_kernel_stub(
+      kCPU,
+      params_,
+      grads_,
+      momentum_bufs_,
+      params2_,
+      momentum,
+      learning_rate,
+      weight_decay,
+      dampening,
+      nesterov);
+  bump_param_versions(params_);
+  return momentum_bufs;
 }
 
 } // namespace cpu
@@ -98,6 +187,11 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "trail, float momentum, float learning_rate, float weight_decay, float "
       "dampening, bool nesterov) -> Tensor?",
       torch_ipex::cpu::sgd_fused_step);
+  m.def(
+      "sgd_fused_step_multi_tensor(Tensor[] params, Tensor[] grads, Tensor[] "
+      "momentum_bufs, Tensor[] trails, float momentum, float learning_rate, "
+      "float weight_decay, float dampening, bool nesterov) -> Tensor[]",
+      torch_ipex::cpu::sgd_fused_step_multi_tensor);
 }
 
 } // namespace
@@ -15,6 +15,8 @@ void packed_add(
     double alpha) {
   // pointer to packed_add_kernel_impl(top_half_, bot_half_, grad_, alpha);
   packed_add_kernel_stub(kCPU, top_half_, bot_half_, grad_, alpha);
+  // The top half is the bf16 param.
+  bump_param_version(top_half_);
 }
 
 } // namespace cpu
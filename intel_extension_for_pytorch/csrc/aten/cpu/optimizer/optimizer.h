@@ -5,6 +5,13 @@
 namespace torch_ipex {
 namespace cpu {
 
+// The fused steps write the params through data_ptr, which doesn't go
+// through the version counter of the in-place ops. Bump it as they do, so the
+// copies derived from a param (e.g. the NUMA weight replicas of the prepacked
+// weights) see that it is updated.
+void bump_param_version(const at::Tensor& param);
+void bump_param_versions(const std::vector<at::Tensor>& params);
+
 namespace {
 
 std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step_kernel_impl(
@@ -42,6 +49,41 @@ c10::optional<at::Tensor> sgd_fused_step_kernel_impl(
     double dampening,
     bool nesterov);
 
+void lamb_fused_step_multi_tensor_kernel_impl(
+    const std::vector<at::Tensor>& params_,
+    const std::vector<at::Tensor>& exp_avgs_,
+    const std::vector<at::Tensor>& exp_avg_sqs_,
+    const std::vector<at::Tensor>& grads_,
+    const std::vector<at::Tensor>& params2_,
+    const std::vector<int64_t>& steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps);
+
+void adagrad_fused_step_multi_tensor_kernel_impl(
+    const std::vector<at::Tensor>& params_,
+    const std::vector<at::Tensor>& grads_,
+    const std::vector<at::Tensor>& state_sums_,
+    const std::vector<at::Tensor>& params2_,
+    const std::vector<int64_t>& steps,
+    double learning_rate,
+    double weight_decay,
+    double lr_decay,
+    double eps);
+
+std::vector<at::Tensor> sgd_fused_step_multi_tensor_kernel_impl(
+    const std::vector<at::Tensor>& params_,
+    const std::vector<at::Tensor>& grads_,
+    const std::vector<at::Tensor>& momentum_bufs_,
+    const std::vector<at::Tensor>& params2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double dampening,
+    bool nesterov);
+
 void packed_add_kernel_impl(
     at::Tensor& top_half,
     at::Tensor& bot_half,
@@ -89,6 +131,50 @@ using sgd_fused_step_kernel_fn = c10::optional<at::Tensor> (*)(
     bool);
 DECLARE_DISPATCH(sgd_fused_step_kernel_fn, sgd_fused_step_kernel_stub);
 
+using adagrad_fused_step_multi_tensor_kernel_fn = void (*)(
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    const std::vector<int64_t>&,
+    double,
+    double,
+    double,
+    double);
+DECLARE_DISPATCH(
+    adagrad_fused_step_multi_tensor_kernel_fn,
+    adagrad_fused_step_multi_tensor_kernel_stub);
+
+using lamb_fused_step_multi_tensor_kernel_fn = void (*)(
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    const std::vector<int64_t>&,
+    double,
+    double,
+    double,
+    double,
+    double);
+DECLARE_DISPATCH(
+    lamb_fused_step_multi_tensor_kernel_fn,
+    lamb_fused_step_multi_tensor_kernel_stub);
+
+using sgd_fused_step_multi_tensor_kernel_fn = std::vector<at::Tensor> (*)(
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    const std::vector<at::Tensor>&,
+    double,
+    double,
+    double,
+    double,
+    bool);
+DECLARE_DISPATCH(
+    sgd_fused_step_multi_tensor_kernel_fn,
+    sgd_fused_step_multi_tensor_kernel_stub);
+
 using packed_add_kernel_fn =
     void (*)(at::Tensor&, at::Tensor&, const at::Tensor&, double);
 DECLARE_DISPATCH(packed_add_kernel_fn, packed_add_kernel_stub);
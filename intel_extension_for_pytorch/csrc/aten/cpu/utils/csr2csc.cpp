@@ -6,6 +6,11 @@ namespace cpu {
 
 DEFINE_DISPATCH(sort_based_batched_csr2csc_opt_kernel_stub);
 
+CSR2CSCWorkspace& CSR2CSCWorkspace::get_thread_local() {
+  static thread_local CSR2CSCWorkspace workspace;
+  return workspace;
+}
+
 void sort_based_batched_csr2csc_opt(
     BatchedHyperCompressedSparseColumn& batched_csc,
     int B,
@@ -13,6 +18,9 @@ void sort_based_batched_csr2csc_opt(
     const Tensor& indices,
     std::vector<int64_t> pooling_modes,
     int64_t max_embeddings) {
+  if (!batched_csc.workspace) {
+    batched_csc.workspace = &CSR2CSCWorkspace::get_thread_local();
+  }
   /*
   pointer to sort_based_batched_csr2csc_opt_kernel_impl(
       batched_csc, B, offsets, indices, pooling_modes, max_embeddings);
@@ -5,6 +5,7 @@
 #include <csrc/dyndisp/DispatchStub.h>
 #include <omp.h>
 #include <torch/extension.h>
+#include <vector>
 
 namespace torch_ipex {
 namespace cpu {
@@ -13,6 +14,32 @@ using namespace at;
 
 enum PoolingMode { SUM = 0, MEAN = 1 };
 
+// The buffers of sort_based_batched_csr2csc_opt, which only grow, so that
+// they are reused across the iterations instead of being allocated by each
+// backward.
+struct CSR2CSCWorkspace {
+  // The keys (rows of the tables), values (output rows) and weights of the
+  // indices, and the buffers of the radix sort.
+  std::vector<int> keys;
+  std::vector<int> values;
+  std::vector<float> weights;
+  std::vector<int> keys_tmp;
+  std::vector<int> values_tmp;
+  std::vector<float> weights_tmp;
+  std::vector<int> segment_ptr;
+  std::vector<int> segment_indices;
+  // HIST_SIZE per thread, HIST_SIZE + 1 per thread.
+  std::vector<int> histogram;
+  std::vector<int> histogram_ps;
+  // The unique indices found by each thread, a cache line apart.
+  std::vector<int> num_uniq;
+
+  // The workspace of the calling thread, the BatchedHyperCompressedSparseColumn
+  // built by it is valid until the next sort_based_batched_csr2csc_opt of the
+  // thread.
+  static CSR2CSCWorkspace& get_thread_local();
+};
+
 struct BatchedHyperCompressedSparseColumn {
   // A data structure to describe how sparse grads got by MergeEmbedingBag
   // should be used to update weights/tables
@@ -56,17 +83,8 @@ struct BatchedHyperCompressedSparseColumn {
   // [0.5, 0.5, 0.33, 0.5, 0.5, 0.33, 0.33]
   float* weights = nullptr; // length column_ptr[table_ptr[T]]
 
-  ~BatchedHyperCompressedSparseColumn() {
-    Allocator* allocator = c10::GetAllocator(c10::DeviceType::CPU);
-    if (segment_ptr) {
-      allocator->raw_deallocate(segment_ptr);
-      allocator->raw_deallocate(segment_indices);
-      allocator->raw_deallocate(output_row_indices);
-    }
-    if (weights) {
-      allocator->raw_deallocate(weights);
-    }
-  };
+  // Owns the arrays above, the thread-local workspace if it's not set.
+  CSR2CSCWorkspace* workspace = nullptr;
 };
 
 void sort_based_batched_csr2csc_opt(
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+namespace torch_ipex {
+namespace cpu {
+
+// The helpers are internal to each pooling kernel, which is compiled for each
+// ISA level.
+namespace {
+
+// Number of the bags of one table pooled by a task. The bags of a block read
+// the same table, so its hot rows are likely to stay in L2 across the block.
+constexpr int64_t kBagBlockSize = 64;
+// Number of the indices the rows are prefetched ahead of the accumulation.
+constexpr int64_t kPrefetchDistance = 16;
+constexpr int64_t kCacheLineSize = 64;
+// The mean pooling_mode of nn.EmbeddingBag.
+constexpr int64_t kMeanPooling = 1;
+
+inline int64_t get_bag_blocks(int64_t num_bags) {
+  return (num_bags + kBagBlockSize - 1) / kBagBlockSize;
+}
+
+// A row which isn't resident (e.g. of a memory-mapped table) is only read by
+// the page fault, the prefetch doesn't wait for it.
+inline void prefetch_row(const void* row, int64_t row_bytes) {
+  auto ptr = static_cast<const char*>(row);
+  for (int64_t i = 0; i < row_bytes; i += kCacheLineSize) {
+    __builtin_prefetch(ptr + i, 0 /* read */, 3 /* keep in all levels */);
+  }
+}
+
+// The factor of the sum of the pool_size rows of a bag. The sum of an empty
+// bag is kept, so that it's pooled to zeros by both modes.
+inline double get_pooling_factor(int64_t pooling_mode, int64_t pool_size) {
+  return pooling_mode == kMeanPooling && pool_size > 0 ? 1.0 / pool_size : 1.0;
+}
+
+} // namespace
+
+} // namespace cpu
+} // namespace torch_ipex
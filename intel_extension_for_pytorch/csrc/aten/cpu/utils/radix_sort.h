@@ -2,6 +2,7 @@
 #pragma once
 
 #include <omp.h>
+#include <algorithm>
 #include <cstdint>
 #include <utility>
 #include "csrc/utils/ipex_op_profile.h"
@@ -9,111 +10,110 @@
 namespace torch_ipex {
 namespace cpu {
 
+// Structure of arrays of the keys to sort, and the values and the weights
+// (optional) moved with them.
 template <typename T>
-using Key_Value_Weight_Tuple = std::tuple<T, T, float>;
+struct Key_Value_Weight_Buffer {
+  T* keys;
+  T* values;
+  float* weights;
+};
+
 // histogram size per thread
 const int HIST_SIZE = 256;
 
+// Scan the keys [0, elements_count), return whether they are sorted, and
+// their min and max.
+template <typename T>
+bool scan_keys(
+    const T* keys,
+    int64_t elements_count,
+    T& min_key,
+    T& max_key,
+    bool parallel) {
+  T min_val = keys[0];
+  T max_val = keys[0];
+  int64_t descents = 0;
+#pragma omp parallel for if (parallel) schedule(static) \
+    reduction(min : min_val) reduction(max : max_val) reduction(+ : descents)
+  for (int64_t i = 1; i < elements_count; i++) {
+    min_val = std::min(min_val, keys[i]);
+    max_val = std::max(max_val, keys[i]);
+    descents += keys[i] < keys[i - 1];
+  }
+  min_key = min_val;
+  max_key = max_val;
+  return descents == 0;
+}
+
+// LSD radix sort of the keys in [min_key, max_key] of inp_buf, by the 8-bit
+// digits of key - min_key, with the threads of the omp team if parallel or by
+// the calling thread only. histogram holds HIST_SIZE ints and histogram_ps
+// HIST_SIZE + 1 ints per thread. Return the buffer which holds the result.
 template <typename T>
-Key_Value_Weight_Tuple<T>* radix_sort_parallel(
-    Key_Value_Weight_Tuple<T>* inp_buf,
-    Key_Value_Weight_Tuple<T>* tmp_buf,
+Key_Value_Weight_Buffer<T> radix_sort_parallel(
+    Key_Value_Weight_Buffer<T> inp_buf,
+    Key_Value_Weight_Buffer<T> tmp_buf,
     int64_t elements_count,
-    int64_t max_value) {
+    T min_key,
+    T max_key,
+    int* histogram,
+    int* histogram_ps,
+    bool parallel = true) {
   IPEX_RECORD_FUNCTION(__FUNCTION__, std::vector<c10::IValue>({}));
-  int maxthreads = omp_get_max_threads();
-  alignas(64) int histogram[HIST_SIZE * maxthreads],
-      histogram_ps[HIST_SIZE * maxthreads + 1];
+  uint64_t max_value = static_cast<uint64_t>(max_key - min_key);
   if (max_value == 0)
     return inp_buf;
-  int num_bits = sizeof(T) * 8 - __builtin_clz(max_value);
+  int num_bits = 64 - __builtin_clzll(max_value);
   int num_passes = (num_bits + 7) / 8;
+  bool has_weights = inp_buf.weights != nullptr;
 
-#pragma omp parallel
+#pragma omp parallel if (parallel)
   {
     int tid = omp_get_thread_num();
     int nthreads = omp_get_num_threads();
 
     int* local_histogram = &histogram[HIST_SIZE * tid];
     int* local_histogram_ps = &histogram_ps[HIST_SIZE * tid];
-    int elements_count_4 = elements_count / 4 * 4;
-    Key_Value_Weight_Tuple<T>* input = inp_buf;
-    Key_Value_Weight_Tuple<T>* output = tmp_buf;
+    Key_Value_Weight_Buffer<T> input = inp_buf;
+    Key_Value_Weight_Buffer<T> output = tmp_buf;
 
-    for (unsigned int pass = 0; pass < num_passes; pass++) {
+    for (int pass = 0; pass < num_passes; pass++) {
+      int shift = pass * 8;
+      auto digit = [&](T key) { return ((key - min_key) >> shift) & 0xFF; };
       /* Step 1: compute histogram
          Reset histogram */
       for (int i = 0; i < HIST_SIZE; i++)
         local_histogram[i] = 0;
 
 #pragma omp for schedule(static)
-      for (int64_t i = 0; i < elements_count_4; i += 4) {
-        T val_1 = std::get<0>(input[i]);
-        T val_2 = std::get<0>(input[i + 1]);
-        T val_3 = std::get<0>(input[i + 2]);
-        T val_4 = std::get<0>(input[i + 3]);
-
-        local_histogram[(val_1 >> (pass * 8)) & 0xFF]++;
-        local_histogram[(val_2 >> (pass * 8)) & 0xFF]++;
-        local_histogram[(val_3 >> (pass * 8)) & 0xFF]++;
-        local_histogram[(val_4 >> (pass * 8)) & 0xFF]++;
-      }
-      if (tid == (nthreads - 1)) {
-        for (int64_t i = elements_count_4; i < elements_count; i++) {
-          T val = std::get<0>(input[i]);
-          local_histogram[(val >> (pass * 8)) & 0xFF]++;
-        }
+      for (int64_t i = 0; i < elements_count; i++) {
+        local_histogram[digit(input.keys[i])]++;
       }
-#pragma omp barrier
       /* Step 2: prefix sum */
-      if (tid == 0) {
-        int sum = 0, prev_sum = 0;
+#pragma omp single
+      {
+        int sum = 0;
         for (int bins = 0; bins < HIST_SIZE; bins++)
           for (int t = 0; t < nthreads; t++) {
+            histogram_ps[t * HIST_SIZE + bins] = sum;
             sum += histogram[t * HIST_SIZE + bins];
-            histogram_ps[t * HIST_SIZE + bins] = prev_sum;
-            prev_sum = sum;
           }
-        histogram_ps[HIST_SIZE * nthreads] = prev_sum;
-        if (prev_sum != elements_count) {
-          /* printf("Error1!\n"); exit(123); */
-        }
+        histogram_ps[HIST_SIZE * nthreads] = sum;
       }
-#pragma omp barrier
 
       /* Step 3: scatter */
 #pragma omp for schedule(static)
-      for (int64_t i = 0; i < elements_count_4; i += 4) {
-        T val_1 = std::get<0>(input[i]);
-        T val_2 = std::get<0>(input[i + 1]);
-        T val_3 = std::get<0>(input[i + 2]);
-        T val_4 = std::get<0>(input[i + 3]);
-        T bin_1 = (val_1 >> (pass * 8)) & 0xFF;
-        T bin_2 = (val_2 >> (pass * 8)) & 0xFF;
-        T bin_3 = (val_3 >> (pass * 8)) & 0xFF;
-        T bin_4 = (val_4 >> (pass * 8)) & 0xFF;
-        int pos;
-        pos = local_histogram_ps[bin_1]++;
-        output[pos] = input[i];
-        pos = local_histogram_ps[bin_2]++;
-        output[pos] = input[i + 1];
-        pos = local_histogram_ps[bin_3]++;
-        output[pos] = input[i + 2];
-        pos = local_histogram_ps[bin_4]++;
-        output[pos] = input[i + 3];
-      }
-      if (tid == (nthreads - 1)) {
-        for (int64_t i = elements_count_4; i < elements_count; i++) {
-          T val = std::get<0>(input[i]);
-          int pos = local_histogram_ps[(val >> (pass * 8)) & 0xFF]++;
-          output[pos] = input[i];
+      for (int64_t i = 0; i < elements_count; i++) {
+        int pos = local_histogram_ps[digit(input.keys[i])]++;
+        output.keys[pos] = input.keys[i];
+        output.values[pos] = input.values[i];
+        if (has_weights) {
+          output.weights[pos] = input.weights[i];
         }
       }
 
-      Key_Value_Weight_Tuple<T>* temp = input;
-      input = output;
-      output = temp;
-#pragma omp barrier
+      std::swap(input, output);
     }
   }
   return (num_passes % 2 == 0 ? inp_buf : tmp_buf);
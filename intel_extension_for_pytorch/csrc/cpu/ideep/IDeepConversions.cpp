@@ -2,6 +2,8 @@
 #include <ATen/OpaqueTensorImpl.h>
 #include <c10/core/Allocator.h>
 
+#include "csrc/cpu/runtime/CachingAllocator.h"
+
 namespace torch_ipex {
 
 namespace cpu {
@@ -184,7 +186,7 @@ at::Tensor empty_aten_tensor_from_desc(
   for (auto i = 0; i < ndims; i++) {
     at_sizes[i] = padded_dims[i] / blk_size_per_dim[i];
   }
-  return at::empty(at_sizes, options);
+  return runtime::empty_with_ipex_allocator(at_sizes, options);
 }
 
 } // namespace cpu
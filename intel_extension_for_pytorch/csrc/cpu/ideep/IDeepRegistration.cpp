@@ -4,15 +4,18 @@
 // needs to be included only once in library.
 #include "ideep_pin_singletons.hpp"
 
+#include "csrc/cpu/runtime/CachingAllocator.h"
+
 using namespace ideep;
 
+// It's registered again by set_caching_allocator_enabled.
 RegisterEngineAllocator cpu_alloc(
     engine::cpu_engine(),
-    [](size_t size) {
-      return c10::GetAllocator(c10::DeviceType::CPU)->raw_allocate(size);
+    [allocator = torch_ipex::runtime::get_ipex_cpu_allocator()](size_t size) {
+      return allocator->raw_allocate(size);
     },
-    [](void* p) {
-      c10::GetAllocator(c10::DeviceType::CPU)->raw_deallocate(p);
+    [allocator = torch_ipex::runtime::get_ipex_cpu_allocator()](void* p) {
+      allocator->raw_deallocate(p);
     });
 
 namespace torch_ipex {
@@ -23,6 +26,7 @@ void clear_computation_cache() {
   // Reset computation_cache for forward convolutions
   // As it also caches max number of OpenMP workers
   ideep::convolution_forward::t_store().clear();
+  ideep::convolution_forward::s_store().clear();
 }
 
 } // namespace mkldnn
@@ -1,6 +1,10 @@
 #ifndef IDEEP_ALLOCATOR_HPP
 #define IDEEP_ALLOCATOR_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <sstream>
 
 namespace ideep {
@@ -30,6 +34,85 @@ class allocator {
   }
 };
 
+/*
+scratchpad_arena is a grow-only scratchpad buffer of the calling thread, which
+is shared by all the primitives run on it. The primitives of a thread are
+executed one after another and only use their scratchpad during the
+execution, so they don't need a buffer each.
+
+The buffer is replaced by a larger one when a primitive needs more, the
+scratchpad tensors which still reference the previous buffer keep it alive.
+*/
+class scratchpad_arena {
+ public:
+  static scratchpad_arena& get() {
+    static thread_local scratchpad_arena arena;
+    return arena;
+  }
+
+  ~scratchpad_arena() {
+    release();
+  }
+
+  // Return a buffer of at least size bytes.
+  std::shared_ptr<void> acquire(
+      size_t size,
+      const std::function<void*(size_t)>& malloc,
+      const std::function<void(void*)>& free) {
+    auto& peak = peak_bytes();
+    auto current_peak = peak.load(std::memory_order_relaxed);
+    while (static_cast<int64_t>(size) > current_peak &&
+           !peak.compare_exchange_weak(current_peak, size)) {
+    }
+    if (!buffer_ || size > capacity_) {
+      auto new_capacity = (size + allocator::tensor_memalignment - 1) /
+          allocator::tensor_memalignment * allocator::tensor_memalignment;
+      buffer_.reset(malloc(new_capacity), free);
+      total_bytes().fetch_add(
+          static_cast<int64_t>(new_capacity) - static_cast<int64_t>(capacity_));
+      capacity_ = new_capacity;
+    }
+    return buffer_;
+  }
+
+  // Release the buffer of the calling thread.
+  void release() {
+    buffer_.reset();
+    total_bytes().fetch_sub(capacity_);
+    capacity_ = 0;
+  }
+
+  // The largest scratchpad requested by a primitive since the last reset.
+  static int64_t get_peak_bytes() {
+    return peak_bytes().load();
+  }
+
+  static void reset_peak_bytes() {
+    peak_bytes().store(0);
+  }
+
+  // The bytes of the buffers held by the arenas of all the threads.
+  static int64_t get_total_bytes() {
+    return total_bytes().load();
+  }
+
+ private:
+  scratchpad_arena() = default;
+
+  static std::atomic<int64_t>& peak_bytes() {
+    static std::atomic<int64_t> bytes{0};
+    return bytes;
+  }
+
+  static std::atomic<int64_t>& total_bytes() {
+    static std::atomic<int64_t> bytes{0};
+    return bytes;
+  }
+
+  std::shared_ptr<void> buffer_;
+  size_t capacity_ = 0;
+};
+
 } // namespace utils
 } // namespace ideep
 #endif
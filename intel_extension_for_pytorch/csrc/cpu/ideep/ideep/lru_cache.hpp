@@ -1,7 +1,10 @@
 #ifndef IDEEP_LRU_CACHE_CPP
 #define IDEEP_LRU_CACHE_CPP
 
+#include <atomic>
 #include <list>
+#include <mutex>
+#include <typeinfo>
 #include <unordered_map>
 #include "abstract_types.hpp"
 
@@ -149,6 +152,237 @@ class lru_cache {
   size_type capacity_;
 };
 
+struct computation_cache_stats {
+  std::string name;
+  int64_t hits;
+  int64_t misses;
+  int64_t evictions;
+  int64_t size;
+};
+
+// Interface of the shared caches known by the registry.
+class shared_cache_base {
+ public:
+  virtual ~shared_cache_base() = default;
+  virtual computation_cache_stats get_stats() const = 0;
+  virtual void resize(size_t new_capacity) = 0;
+  virtual void clear() = 0;
+};
+
+// Concurrent LRU cache shared by all the threads. The key is the binary key
+// of utils::create_key together with its hash, which is computed once per
+// lookup and also selects the shard. The lookup doesn't copy the key, only
+// an insert does.
+template <class key_t, class value_t, size_t num_shards = 16>
+class concurrent_lru_cache : public shared_cache_base {
+ public:
+  concurrent_lru_cache(std::string name, size_t capacity)
+      : name_(std::move(name)) {
+    resize(capacity);
+  }
+
+  bool find(const key_t& key, size_t hash, value_t& value) {
+    auto& shard = shards_[hash % num_shards];
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto it = find_locked(shard, key, hash);
+      if (it != shard.map.end()) {
+        shard.vlist.splice(shard.vlist.begin(), shard.vlist, it->second);
+        value = it->second->value;
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Keep the existing value if another thread has inserted the same key.
+  void insert(const key_t& key, size_t hash, const value_t& value) {
+    auto& shard = shards_[hash % num_shards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (find_locked(shard, key, hash) != shard.map.end()) {
+      return;
+    }
+    shard.vlist.push_front({hash, key, value});
+    shard.map.emplace(hash, shard.vlist.begin());
+    trim_locked(shard);
+  }
+
+  computation_cache_stats get_stats() const override {
+    computation_cache_stats stats{
+        name_, hits_.load(), misses_.load(), evictions_.load(), 0};
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      stats.size += shard.vlist.size();
+    }
+    return stats;
+  }
+
+  // The capacity is split evenly over the shards.
+  void resize(size_t new_capacity) override {
+    shard_capacity_.store(
+        std::max<size_t>(1, (new_capacity + num_shards - 1) / num_shards));
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      trim_locked(shard);
+    }
+  }
+
+  void clear() override {
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.map.clear();
+      shard.vlist.clear();
+    }
+  }
+
+ private:
+  struct node_t {
+    size_t hash;
+    key_t key;
+    value_t value;
+  };
+  using list_it = typename std::list<node_t>::iterator;
+  using map_t = std::unordered_multimap<size_t, list_it>;
+
+  struct shard_t {
+    mutable std::mutex mutex;
+    std::list<node_t> vlist;
+    map_t map;
+  };
+
+  // Must hold shard.mutex.
+  typename map_t::iterator find_locked(
+      shard_t& shard,
+      const key_t& key,
+      size_t hash) {
+    auto range = shard.map.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second->key == key) {
+        return it;
+      }
+    }
+    return shard.map.end();
+  }
+
+  // Must hold shard.mutex.
+  void trim_locked(shard_t& shard) {
+    while (shard.vlist.size() > shard_capacity_.load()) {
+      auto last = std::prev(shard.vlist.end());
+      auto range = shard.map.equal_range(last->hash);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == last) {
+          shard.map.erase(it);
+          break;
+        }
+      }
+      shard.vlist.pop_back();
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  std::string name_;
+  shard_t shards_[num_shards];
+  std::atomic<size_t> shard_capacity_{1};
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+  std::atomic<int64_t> evictions_{0};
+};
+
+// Process-wide settings of the shared computation caches. The shared caches
+// are disabled by default, in which case each thread keeps its own cache.
+// The defaults are read from the env IDEEP_SHARED_COMPUTATION_CACHE=1 and
+// LRU_CACHE_CAPACITY (capacity of each op's cache).
+class shared_cache_registry {
+ public:
+  static shared_cache_registry& instance() {
+    static shared_cache_registry registry;
+    return registry;
+  }
+
+  bool enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  void set_enabled(bool enabled) {
+    enabled_.store(enabled);
+  }
+
+  size_t capacity() const {
+    return capacity_.load();
+  }
+
+  void set_capacity(size_t capacity) {
+    IDEEP_ENFORCE(capacity > 0, "The capacity should be positive");
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_.store(capacity);
+    for (auto cache : caches_) {
+      cache->resize(capacity);
+    }
+  }
+
+  void add(shared_cache_base* cache) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache->resize(capacity_.load());
+    caches_.push_back(cache);
+  }
+
+  std::vector<computation_cache_stats> get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<computation_cache_stats> stats;
+    for (auto cache : caches_) {
+      stats.push_back(cache->get_stats());
+    }
+    return stats;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto cache : caches_) {
+      cache->clear();
+    }
+  }
+
+ private:
+  shared_cache_registry() {
+    auto shared = std::getenv("IDEEP_SHARED_COMPUTATION_CACHE");
+    enabled_.store(shared != nullptr && std::strcmp(shared, "1") == 0);
+    auto capacity = std::getenv("LRU_CACHE_CAPACITY");
+    if (capacity != nullptr && std::atoi(capacity) > 0) {
+      capacity_.store(std::atoi(capacity));
+    }
+  }
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<size_t> capacity_{1024};
+  mutable std::mutex mutex_;
+  std::vector<shared_cache_base*> caches_;
+};
+
+// Name of the cache of a computation in the stats.
+template <class value_t>
+inline const char* computation_name() {
+  return typeid(value_t).name();
+}
+
+template <>
+inline const char* computation_name<
+    dnnl::convolution_forward::primitive_desc>() {
+  return "convolution_forward";
+}
+
+template <>
+inline const char* computation_name<
+    dnnl::inner_product_forward::primitive_desc>() {
+  return "inner_product_forward";
+}
+
+template <>
+inline const char* computation_name<dnnl::matmul::primitive_desc>() {
+  return "matmul";
+}
+
 template <class value_t, size_t capacity = 1024, class key_t = std::string>
 class computation_cache {
  public:
@@ -178,9 +412,20 @@ class computation_cache {
   }
 
  public:
-  static inline value_t& fetch_or_create(
+  // Return a copy, since the value of the shared cache may be evicted by
+  // another thread.
+  static inline value_t fetch_or_create(
       const key_t& key,
       const std::function<value_t()>& callback) {
+    if (shared_cache_registry::instance().enabled()) {
+      auto hash = std::hash<key_t>()(key);
+      value_t value;
+      if (!s_store().find(key, hash, value)) {
+        value = callback();
+        s_store().insert(key, hash, value);
+      }
+      return value;
+    }
     auto it = find(key);
     return it == end() ? fetch(create((key), callback())) : fetch(it);
   }
@@ -203,6 +448,18 @@ class computation_cache {
     }(std::getenv("LRU_CACHE_CAPACITY"));
     return t_store_;
   }
+
+  static inline concurrent_lru_cache<key_t, value_t>& s_store() {
+    static concurrent_lru_cache<key_t, value_t> s_store_(
+        computation_name<value_t>(),
+        shared_cache_registry::instance().capacity());
+    static bool registered = [&]() {
+      shared_cache_registry::instance().add(&s_store_);
+      return true;
+    }();
+    (void)registered;
+    return s_store_;
+  }
 };
 } // namespace utils
 } // namespace ideep
@@ -67,7 +67,7 @@ struct batch_normalization_forward_inference
         aengine);
 
     tensor scale_shift{pd.weights_desc()};
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     auto* scale_shift_buf = static_cast<char*>(scale_shift.get_data_handle());
     std::memcpy(scale_shift_buf, scale.get_data_handle(), scale.get_size());
     std::memcpy(
@@ -132,7 +132,7 @@ struct batch_normalization_forward_training
         aengine);
 
     tensor scale_shift{pd.weights_desc()};
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     auto* scale_shift_buf = static_cast<char*>(scale_shift.get_data_handle());
     std::memcpy(scale_shift_buf, scale.get_data_handle(), scale.get_size());
     std::memcpy(
@@ -226,7 +226,7 @@ struct batch_normalization_backward
     diff_src.reinit_if_possible(pd.diff_src_desc());
     diff_scale_shift.reinit_if_possible(pd.diff_weights_desc());
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     exec_args args{
         {DNNL_ARG_SRC, expected_src},
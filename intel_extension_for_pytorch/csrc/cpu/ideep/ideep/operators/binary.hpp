@@ -22,7 +22,7 @@ struct binary : public dnnl::binary {
     auto pd = primitive_desc(
         {aalgorithm, src0_desc, src1_desc, dst_desc}, op_attr, aengine);
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     auto expected_src0 = src0.reorder_if_differ_in(pd.src0_desc());
     auto expected_src1 = src1.reorder_if_differ_in(pd.src1_desc());
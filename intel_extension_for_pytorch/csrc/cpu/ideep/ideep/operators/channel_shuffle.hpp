@@ -28,7 +28,7 @@ struct channel_shuffle_forward : public dnnl::shuffle_forward {
     auto expected_src = src.reorder_if_differ_in(pd.src_desc());
     dst.reinit_if_possible(pd.dst_desc());
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     super(pd).execute(
         stream::default_stream(),
@@ -63,7 +63,7 @@ struct channel_shuffle_backward : public dnnl::shuffle_backward {
     auto expected_diff_dst = diff_dst.reorder_if_differ_in(pd.diff_dst_desc());
     diff_src.reinit_if_possible(pd.diff_src_desc());
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     super(pd).execute(
         stream::default_stream(),
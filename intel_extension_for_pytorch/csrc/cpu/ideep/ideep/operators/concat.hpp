@@ -50,7 +50,7 @@ struct concat : public dnnl::concat {
       pd = primitive_desc(axis, input_descs, aengine, op_attr);
     }
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     exec_args args{{DNNL_ARG_DST, output}, {DNNL_ARG_SCRATCHPAD, scratchpad}};
 
     for (int i = 0; i < opt_inputs.size(); ++i) {
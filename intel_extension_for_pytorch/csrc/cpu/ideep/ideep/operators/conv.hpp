@@ -382,7 +382,7 @@ struct convolution_forward
       dst_desc_query = dst_desc.to_format(memory_format);
     }
 
-    auto key = utils::create_key(
+    const auto& key = utils::create_thread_local_key(
         aprop_kind,
         aalgorithm,
         src_desc_query,
@@ -709,7 +709,7 @@ struct convolution_forward
       tensor& dst) {
     auto& pd = param.pd;
     // allocate scratchpad
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     auto expected_src = src.reorder_if_differ_in(pd.src_desc());
     tensor expected_weights;
     // it will be removed after block format reorder performance improved.
@@ -774,7 +774,7 @@ struct convolution_forward
       tensor& dst) {
     auto& pd = param.pd;
     // allocate scratchpad
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     auto expected_src = src.reorder_if_differ_in(pd.src_desc());
     tensor expected_weights;
     // it will be removed after block format reorder performance improved.
@@ -901,7 +901,7 @@ struct convolution_backward_data : public dnnl::convolution_backward_data {
       expected_diff_src.init(expected_diff_src_desc);
     }
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     super(pd).execute(
         stream::default_stream(),
@@ -1084,7 +1084,7 @@ struct convolution_backward_weights
       expected_diff_weights.init(expected_diff_weights_desc);
     }
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     if (with_diff_bias) {
       diff_bias.reinit_if_possible(pd.diff_bias_desc());
@@ -263,7 +263,7 @@ struct convolution_transpose_forward : public dnnl::deconvolution_forward {
         aprop_kind,
         aengine);
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     auto expected_src = src.reorder_if_differ_in(pd.src_desc());
     auto expected_weights = weights_.reorder_if_differ_in(pd.weights_desc());
     dst.reinit_if_possible(pd.dst_desc());
@@ -347,7 +347,7 @@ struct convolution_transpose_backward_data
     auto expected_diff_dst = diff_dst.reorder_if_differ_in(pd.diff_dst_desc());
     auto expected_weights = weights_.reorder_if_differ_in(pd.weights_desc());
     diff_src.reinit_if_possible(pd.diff_src_desc());
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     super(pd).execute(
         stream::default_stream(),
@@ -511,7 +511,7 @@ struct convolution_transpose_backward_weights
 
     tensor expected_diff_weights;
     expected_diff_weights.init(expected_diff_weights_desc);
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     if (with_diff_bias) {
       diff_bias.reinit_if_possible(pd.diff_bias_desc());
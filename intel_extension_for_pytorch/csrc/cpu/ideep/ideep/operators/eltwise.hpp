@@ -33,7 +33,7 @@ struct eltwise_forward : public dnnl::eltwise_forward {
     if (src_in.has_scale()) {
       dst.set_scale(src_in.get_scale());
     }
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     super(pd).execute(
         stream::default_stream(),
@@ -90,7 +90,7 @@ struct eltwise_backward : public dnnl::eltwise_backward {
     auto src_dst_arg = use_dst ? DNNL_ARG_DST : DNNL_ARG_SRC;
     auto expected_src_dst_desc = use_dst ? pd.dst_desc() : pd.src_desc();
     auto expected_src_dst = src.reorder_if_differ_in(expected_src_dst_desc);
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     super(pd).execute(
         stream::default_stream(),
         {{DNNL_ARG_DIFF_DST, expected_diff_dst},
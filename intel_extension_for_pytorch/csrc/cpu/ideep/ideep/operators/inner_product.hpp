@@ -93,7 +93,7 @@ struct inner_product_forward
       const attr_t& attr = attr_t(),
       const prop_kind aprop_kind = prop_kind::forward,
       const engine& aengine = engine::cpu_engine()) {
-    auto key = utils::create_key(
+    const auto& key = utils::create_thread_local_key(
         aprop_kind,
         src_desc,
         weights_desc,
@@ -284,7 +284,7 @@ struct inner_product_forward
       dst.set_scale(dst_scales_in);
     }
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     if (with_bias) {
       super(pd).execute(
@@ -354,7 +354,7 @@ struct inner_product_backward_data : public dnnl::inner_product_backward_data {
       diff_src.init(pd.diff_src_desc(), diff_src.get_data_handle());
     }
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     super(pd).execute(
         stream::default_stream(),
         {{DNNL_ARG_DIFF_DST, diff_dst},
@@ -440,7 +440,7 @@ struct inner_product_backward_weights
       diff_weights.init(pd.diff_weights_desc());
     }
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     exec_args args{
         {DNNL_ARG_DIFF_DST, diff_dst},
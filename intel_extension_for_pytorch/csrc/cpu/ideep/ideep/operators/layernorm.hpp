@@ -38,7 +38,7 @@ struct layer_normalization_forward : public dnnl::layer_normalization_forward {
     mean.reinit_if_possible(pd.mean_desc());
     variance.reinit_if_possible(pd.variance_desc());
     dst.reinit_if_possible(pd.dst_desc());
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     super(pd).execute(
         stream::default_stream(),
@@ -29,7 +29,7 @@ struct lrn_forward : public dnnl::lrn_forward {
 
     auto expected_src = src.reorder_if_differ_in(pd.src_desc());
     dst.reinit_if_possible(pd.dst_desc());
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     exec_args args{
         {DNNL_ARG_SRC, expected_src},
@@ -85,7 +85,7 @@ struct lrn_backward : public dnnl::lrn_backward {
 
     auto expected_diff_dst = diff_dst.reorder_if_differ_in(pd.diff_dst_desc());
     diff_src.reinit_if_possible(pd.diff_src_desc());
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     exec_args args{
         {DNNL_ARG_SRC, src},
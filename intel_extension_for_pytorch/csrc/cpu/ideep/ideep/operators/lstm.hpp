@@ -70,7 +70,7 @@ struct lstm_forward_inference : public dnnl::lstm_forward {
         weights_layer.reorder_if_differ_in(pd.weights_layer_desc(), op_attr);
     auto expected_weights_iter =
         weights_iter.reorder_if_differ_in(pd.weights_iter_desc(), op_attr);
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     super(pd).execute(
         stream::default_stream(),
@@ -206,7 +206,7 @@ struct lstm_forward_training : public dnnl::lstm_forward {
     dst_layer.reinit_if_possible(pd.dst_layer_desc());
     dst_iter.reinit_if_possible(pd.dst_iter_desc());
     dst_iter_c.reinit_if_possible(pd.dst_iter_c_desc());
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     super(pd).execute(
         stream::default_stream(),
@@ -368,7 +368,7 @@ struct lstm_backward : public dnnl::lstm_backward {
     expected_diff_weights_iter.zero_init(pd.diff_weights_iter_desc());
     tensor expected_diff_bias;
     expected_diff_bias.zero_init(pd.diff_bias_desc());
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     super(pd).execute(
         stream::default_stream(),
@@ -315,7 +315,7 @@ struct matmul_forward : public dnnl::matmul,
 
     dst_data_type = dst_type == data_type::undef ? dst_data_type : dst_type;
     tensor::desc dst_desc(dst_dims, dst_data_type, tag::any);
-    auto key = utils::create_key(
+    const auto& key = utils::create_thread_local_key(
         src_desc,
         weights_desc,
         bias_desc,
@@ -361,7 +361,7 @@ struct matmul_forward : public dnnl::matmul,
       auto expected_bias = bias.reorder_if_differ_in(pd.bias_desc(), bias_attr);
       primitive_args.insert({DNNL_ARG_BIAS, expected_bias});
     }
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     primitive_args.insert({DNNL_ARG_SCRATCHPAD, scratchpad});
     super(pd).execute(stream::default_stream(), primitive_args);
   }
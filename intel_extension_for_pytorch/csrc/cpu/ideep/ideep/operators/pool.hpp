@@ -48,7 +48,7 @@ struct pooling_forward : public dnnl::pooling_forward {
       dst.set_scale(src.get_scale());
     }
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     exec_args args{
         {DNNL_ARG_SRC, expected_src},
@@ -104,7 +104,7 @@ struct pooling_backward : public dnnl::pooling_backward {
     auto expected_diff_dst = diff_dst.reorder_if_differ_in(pd.diff_dst_desc());
     diff_src.reinit_if_possible(pd.diff_src_desc());
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     exec_args args{
         {DNNL_ARG_DIFF_DST, expected_diff_dst},
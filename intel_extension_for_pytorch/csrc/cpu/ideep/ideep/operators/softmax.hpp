@@ -21,7 +21,7 @@ struct softmax_forward : public dnnl::softmax_forward {
 
     auto pd =
         primitive_desc({aprop_kind, src_desc, softmax_axis}, op_attr, aengine);
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     super(pd).execute(
         stream::default_stream(),
         {{DNNL_ARG_SRC, src},
@@ -55,7 +55,7 @@ struct softmax_backward : public dnnl::softmax_backward {
     auto expected_diff_dst = diff_dst.reorder_if_differ_in(pd.diff_dst_desc());
     diff_src.reinit_if_possible(pd.diff_src_desc());
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
 
     super(pd).execute(
         stream::default_stream(),
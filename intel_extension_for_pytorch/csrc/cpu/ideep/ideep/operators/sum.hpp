@@ -23,7 +23,7 @@ struct sum : public dnnl::sum {
     auto pd = primitive_desc(scales, src_descs, aengine, op_attr);
 
     dst.reinit_if_possible(pd.dst_desc());
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     exec_args args{{DNNL_ARG_DST, dst}, {DNNL_ARG_SCRATCHPAD, scratchpad}};
     for (int i = 0; i < srcs.size(); ++i) {
       args.insert({DNNL_ARG_MULTIPLE_SRC + i, srcs[i]});
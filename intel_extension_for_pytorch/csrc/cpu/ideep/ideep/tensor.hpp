@@ -565,6 +565,19 @@ class tensor : public memory {
     reset_internal(adesc, aengine, ahandle);
   }
 
+  /// Constructs the scratchpad of a primitive on the scratchpad arena of the
+  /// calling thread, see utils::scratchpad_arena.
+  static tensor make_scratchpad(
+      const desc& adesc,
+      const engine& aengine = engine::cpu_engine()) {
+    tensor scratchpad;
+    scratchpad.buffer_ = utils::scratchpad_arena::get().acquire(
+        adesc.get_size(), aengine.malloc, aengine.free);
+    scratchpad.eng_ = aengine;
+    scratchpad.reset_internal(adesc, aengine, scratchpad.buffer_.get());
+    return scratchpad;
+  }
+
   /// Function that refill tensor with new description or buffer
   void init(const desc& adesc, const engine& aengine = engine::cpu_engine()) {
     buffer_.reset(aengine.malloc(adesc.get_size()), aengine.free);
@@ -883,7 +896,7 @@ class tensor : public memory {
     op_attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
     auto pd = dnnl::reorder::primitive_desc(src, *this, op_attr);
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     dnnl::reorder(pd).execute(
         stream::default_stream(),
         {{DNNL_ARG_FROM, const_cast<tensor&>(src)},
@@ -897,7 +910,7 @@ class tensor : public memory {
     op_attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
     auto pd = dnnl::reorder::primitive_desc(*this, dst, op_attr);
 
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     dnnl::reorder(pd).execute(
         stream::default_stream(),
         {{DNNL_ARG_FROM, const_cast<tensor&>(*this)},
@@ -1005,7 +1018,7 @@ class tensor : public memory {
 
     auto pd = dnnl::reorder::primitive_desc(
         src.get_engine(), src.get_desc(), get_engine(), view, op_attr);
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     dnnl::reorder(pd).execute(
         stream::default_stream(),
         {{DNNL_ARG_FROM, const_cast<tensor&>(src)},
@@ -1026,7 +1039,7 @@ class tensor : public memory {
 
     auto pd = dnnl::reorder::primitive_desc(
         get_engine(), view, dst.get_engine(), dst.get_desc(), op_attr);
-    tensor scratchpad(pd.scratchpad_desc());
+    auto scratchpad = tensor::make_scratchpad(pd.scratchpad_desc());
     dnnl::reorder(pd).execute(
         stream::default_stream(),
         {{DNNL_ARG_FROM, const_cast<tensor&>(*this)},
@@ -242,6 +242,18 @@ inline key_t create_key(Ts&&... args) {
   return k;
 }
 
+// Same as create_key, but the key is built in a buffer of the calling thread,
+// which keeps its capacity across the calls so that building the key of a
+// cached computation doesn't allocate. The key is overwritten by the next
+// call on the same thread.
+template <typename... Ts>
+inline const key_t& create_thread_local_key(Ts&&... args) {
+  static thread_local key_t k;
+  k.clear();
+  to_bytes(k, std::forward<Ts>(args)...);
+  return k;
+}
+
 /** sorts an array of values using @p comparator. While sorting the array
  * of value, the function permutes an array of @p keys accordingly.
  *
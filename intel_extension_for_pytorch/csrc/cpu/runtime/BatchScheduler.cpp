@@ -0,0 +1,270 @@
+#include "BatchScheduler.h"
+
+#include <ATen/ATen.h>
+
+namespace torch_ipex {
+namespace runtime {
+
+namespace {
+// Split the batched output along dim 0 and return the output of each request.
+std::vector<c10::IValue> split_output(
+    const c10::IValue& output,
+    const std::vector<int64_t>& batch_sizes) {
+  auto num_requests = batch_sizes.size();
+  std::vector<c10::IValue> results;
+  results.reserve(num_requests);
+  if (output.isTensor()) {
+    auto splits = at::split_with_sizes(output.toTensor(), batch_sizes, 0);
+    for (auto& split : splits) {
+      results.emplace_back(std::move(split));
+    }
+  } else if (output.isTuple()) {
+    const auto& elements = output.toTuple()->elements();
+    std::vector<std::vector<c10::IValue>> tuples(num_requests);
+    for (const auto& element : elements) {
+      auto element_splits = split_output(element, batch_sizes);
+      for (size_t i = 0; i < num_requests; i++) {
+        tuples[i].emplace_back(std::move(element_splits[i]));
+      }
+    }
+    for (auto& tuple : tuples) {
+      results.emplace_back(c10::ivalue::Tuple::create(std::move(tuple)));
+    }
+  } else if (output.isTensorList()) {
+    auto tensors = output.toTensorVector();
+    std::vector<std::vector<at::Tensor>> lists(num_requests);
+    for (const auto& tensor : tensors) {
+      auto splits = at::split_with_sizes(tensor, batch_sizes, 0);
+      for (size_t i = 0; i < num_requests; i++) {
+        lists[i].emplace_back(std::move(splits[i]));
+      }
+    }
+    for (auto& list : lists) {
+      results.emplace_back(std::move(list));
+    }
+  } else {
+    throw std::runtime_error(
+        "BatchScheduler only supports the output of Tensor, or tuple/list of Tensor.");
+  }
+  return results;
+}
+} // namespace
+
+BatchScheduler::BatchScheduler(
+    const torch::jit::Module& module,
+    const std::vector<std::vector<int32_t>>& stream_cpu_core_lists,
+    int64_t max_batch_size,
+    int64_t max_latency_us,
+    bool bind_memory)
+    : module_(module),
+      max_batch_size_(max_batch_size),
+      max_latency_(max_latency_us) {
+  if (stream_cpu_core_lists.empty()) {
+    throw std::runtime_error(
+        "Fail to init BatchScheduler. At least one stream is needed.");
+  }
+  if (max_batch_size < 1 || max_latency_us < 0) {
+    throw std::runtime_error(
+        "Fail to init BatchScheduler. max_batch_size should be positive and max_latency_us should be non-negative.");
+  }
+  for (size_t i = 0; i < stream_cpu_core_lists.size(); i++) {
+    this->stream_executors.emplace_back(
+        std::make_shared<TaskExecutor>(
+            stream_cpu_core_lists[i], false, bind_memory));
+    this->idle_streams.emplace_back(i);
+  }
+  this->scheduler =
+      std::make_shared<std::thread>([this] { this->scheduler_loop(); });
+}
+
+std::future<c10::IValue> BatchScheduler::submit(
+    std::vector<c10::IValue>&& inputs) {
+  if (inputs.empty()) {
+    throw std::runtime_error("BatchScheduler: the request has no input.");
+  }
+  int64_t batch_size = -1;
+  for (const auto& input : inputs) {
+    if (!input.isTensor() || input.toTensor().dim() < 1) {
+      throw std::runtime_error(
+          "BatchScheduler: each input of the request should be a Tensor with the batch dim at dim 0.");
+    }
+    auto input_batch_size = input.toTensor().size(0);
+    if (batch_size != -1 && batch_size != input_batch_size) {
+      throw std::runtime_error(
+          "BatchScheduler: the inputs of the request have different batch size.");
+    }
+    batch_size = input_batch_size;
+  }
+
+  auto request = std::make_unique<Request>();
+  request->inputs = std::move(inputs);
+  request->batch_size = batch_size;
+  request->grad_mode = at::GradMode::is_enabled();
+  request->arrival_time = Clock::now();
+  auto res = request->promise.get_future();
+  {
+    std::unique_lock<std::mutex> lock(this->scheduler_mutex);
+    // submit request to a stopping scheduler is not allowed
+    if (this->stop)
+      throw std::runtime_error("Request submit on stopped BatchScheduler");
+    this->requests.emplace_back(std::move(request));
+  }
+  this->scheduler_condition.notify_all();
+  return res;
+}
+
+bool BatchScheduler::can_batch(const Request& first, const Request& request)
+    const {
+  if (first.grad_mode != request.grad_mode ||
+      first.inputs.size() != request.inputs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < first.inputs.size(); i++) {
+    const auto& lhs = first.inputs[i].toTensor();
+    const auto& rhs = request.inputs[i].toTensor();
+    if (lhs.scalar_type() != rhs.scalar_type() || lhs.dim() != rhs.dim() ||
+        lhs.sizes().slice(1) != rhs.sizes().slice(1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void BatchScheduler::scheduler_loop() {
+  while (true) {
+    auto batch = std::make_shared<std::vector<std::unique_ptr<Request>>>();
+    int32_t stream_id;
+    {
+      std::unique_lock<std::mutex> lock(this->scheduler_mutex);
+      // Wait for a pending request and a free stream.
+      this->scheduler_condition.wait(lock, [this] {
+        return (this->stop && this->requests.empty()) ||
+            (!this->requests.empty() && !this->idle_streams.empty());
+      });
+      if (this->stop && this->requests.empty())
+        return;
+
+      // Size of the batch which can be built from the pending requests now.
+      auto ready_batch_size = [this]() -> int64_t {
+        int64_t size = 0;
+        for (const auto& request : this->requests) {
+          if (!this->can_batch(*this->requests.front(), *request))
+            break;
+          size += request->batch_size;
+          if (size >= this->max_batch_size_)
+            break;
+        }
+        return size;
+      };
+      // Wait for more requests until the batch is full or the deadline of the
+      // oldest request. Flush the pending requests directly when stopping.
+      auto deadline = this->requests.front()->arrival_time + this->max_latency_;
+      this->scheduler_condition.wait_until(lock, deadline, [&] {
+        return this->stop || ready_batch_size() >= this->max_batch_size_ ||
+            (this->requests.size() > 1 &&
+             !this->can_batch(*this->requests.front(), *this->requests[1]));
+      });
+
+      int64_t batch_size = 0;
+      while (!this->requests.empty()) {
+        auto& request = this->requests.front();
+        if (!batch->empty() &&
+            (!this->can_batch(*(*batch)[0], *request) ||
+             batch_size + request->batch_size > this->max_batch_size_))
+          break;
+        batch_size += request->batch_size;
+        batch->emplace_back(std::move(request));
+        this->requests.pop_front();
+      }
+      stream_id = this->idle_streams.back();
+      this->idle_streams.pop_back();
+    }
+
+    this->stream_executors[stream_id]->submit([this, batch, stream_id]() {
+      this->run_batch(*batch);
+      {
+        std::unique_lock<std::mutex> lock(this->scheduler_mutex);
+        this->idle_streams.emplace_back(stream_id);
+      }
+      this->scheduler_condition.notify_all();
+    });
+  }
+}
+
+void BatchScheduler::run_batch(std::vector<std::unique_ptr<Request>>& batch) {
+  try {
+    // set the thread local status, such as the grad mode before execuating
+    // the batch
+    at::AutoGradMode grad_mode_guard(batch[0]->grad_mode);
+    if (batch.size() == 1) {
+      batch[0]->promise.set_value(
+          this->module_.forward(std::move(batch[0]->inputs)));
+      return;
+    }
+
+    std::vector<int64_t> batch_sizes;
+    batch_sizes.reserve(batch.size());
+    for (const auto& request : batch) {
+      batch_sizes.emplace_back(request->batch_size);
+    }
+    auto num_inputs = batch[0]->inputs.size();
+    std::vector<c10::IValue> inputs;
+    inputs.reserve(num_inputs);
+    for (size_t i = 0; i < num_inputs; i++) {
+      std::vector<at::Tensor> input_tensors;
+      input_tensors.reserve(batch.size());
+      for (const auto& request : batch) {
+        input_tensors.emplace_back(request->inputs[i].toTensor());
+      }
+      inputs.emplace_back(at::cat(input_tensors, 0));
+    }
+
+    auto outputs =
+        split_output(this->module_.forward(std::move(inputs)), batch_sizes);
+    for (size_t i = 0; i < batch.size(); i++) {
+      batch[i]->promise.set_value(std::move(outputs[i]));
+    }
+  } catch (...) {
+    for (auto& request : batch) {
+      try {
+        request->promise.set_exception(std::current_exception());
+      } catch (const std::future_error&) {
+        // The result of this request has been set.
+      }
+    }
+  }
+}
+
+void BatchScheduler::stop_scheduler() {
+  {
+    std::unique_lock<std::mutex> lock(this->scheduler_mutex);
+    if (this->stop)
+      return;
+    this->stop = true;
+  }
+  this->scheduler_condition.notify_all();
+  this->scheduler->join();
+  // Wait for the in-flight batches.
+  for (auto& stream_executor : this->stream_executors) {
+    stream_executor->stop_executor();
+  }
+}
+
+int64_t BatchScheduler::get_num_streams() const {
+  return this->stream_executors.size();
+}
+
+int64_t BatchScheduler::get_max_batch_size() const {
+  return this->max_batch_size_;
+}
+
+int64_t BatchScheduler::get_max_latency_us() const {
+  return this->max_latency_.count();
+}
+
+BatchScheduler::~BatchScheduler() {
+  this->stop_scheduler();
+}
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ATen/core/ivalue.h>
+#include <torch/csrc/jit/api/module.h>
+#include "TaskExecutor.h"
+
+namespace torch_ipex {
+namespace runtime {
+
+/*
+BatchScheduler coalesces many small concurrent requests of one script module
+into batches and runs them on a set of streams, each stream is a TaskExecutor
+bound to its own cpu_core_list.
+
+1. Each request is a list of Tensor inputs with the batch dim at dim 0.
+2. The scheduler thread waits for a free stream, then builds a batch from the
+pending requests in FIFO order until max_batch_size is reached or the oldest
+request has waited max_latency_us. Requests with different shapes (except
+dim 0), dtypes or grad modes are not batched together.
+3. The batched inputs are concatenated along dim 0 and run on the free stream,
+the outputs (Tensor, or tuple/list of Tensor) are split along dim 0 and
+scattered back to the future of each request.
+*/
+class BatchScheduler {
+ public:
+  explicit BatchScheduler(
+      const torch::jit::Module& module,
+      const std::vector<std::vector<int32_t>>& stream_cpu_core_lists,
+      int64_t max_batch_size,
+      int64_t max_latency_us,
+      bool bind_memory = false);
+  BatchScheduler(const BatchScheduler& batch_scheduler) = delete;
+  BatchScheduler(BatchScheduler&& batch_scheduler) = delete;
+  BatchScheduler& operator=(const BatchScheduler& batch_scheduler) = delete;
+  BatchScheduler& operator=(BatchScheduler&& batch_scheduler) = delete;
+  ~BatchScheduler();
+
+  std::future<c10::IValue> submit(std::vector<c10::IValue>&& inputs);
+  void stop_scheduler();
+
+  int64_t get_num_streams() const;
+  int64_t get_max_batch_size() const;
+  int64_t get_max_latency_us() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  struct Request {
+    std::vector<c10::IValue> inputs;
+    int64_t batch_size;
+    bool grad_mode;
+    Clock::time_point arrival_time;
+    std::promise<c10::IValue> promise;
+  };
+
+  void scheduler_loop();
+  bool can_batch(const Request& first, const Request& request) const;
+  void run_batch(std::vector<std::unique_ptr<Request>>& batch);
+
+  torch::jit::Module module_;
+  int64_t max_batch_size_;
+  std::chrono::microseconds max_latency_;
+
+  // Streams
+  std::vector<std::shared_ptr<TaskExecutor>> stream_executors;
+  std::vector<int32_t> idle_streams;
+
+  // Pending requests and the state of the streams are guarded by
+  // scheduler_mutex.
+  std::deque<std::unique_ptr<Request>> requests;
+  bool stop{false};
+  std::mutex scheduler_mutex;
+  std::condition_variable scheduler_condition;
+  std::shared_ptr<std::thread> scheduler;
+};
+
+} // namespace runtime
+} // namespace torch_ipex
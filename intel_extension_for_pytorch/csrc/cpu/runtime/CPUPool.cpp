@@ -1,4 +1,5 @@
 #include "CPUPool.h"
+#include "CPUTopology.h"
 namespace torch_ipex {
 namespace runtime {
 
@@ -19,6 +20,11 @@ bool iomp_symbol_loaded{
 // of _pin_cpu_cores. It's thread_local, so different task thread can have
 // different settings to support task API.
 thread_local std::vector<int32_t> current_cpu_core_list{-1};
+// Whether the memory policy of this thread has been set by _pin_cpu_cores.
+thread_local bool thread_memory_policy_bound{false};
+// The numa node of the cpu_core_list set by _pin_cpu_cores, -1 if the thread
+// isn't pinned or the cores span multiple numa nodes.
+thread_local int32_t current_numa_node_id{-1};
 } // namespace
 
 void loading_iomp_symbol() {
@@ -59,7 +65,9 @@ void init_runtime_ext() {
   return;
 }
 
-void _pin_cpu_cores(const std::vector<int32_t>& cpu_core_list) {
+void _pin_cpu_cores(
+    const std::vector<int32_t>& cpu_core_list,
+    bool bind_memory) {
   if (!is_runtime_ext_enabled()) {
     throw std::runtime_error(
         "Didn't preload IOMP before using the runtime API");
@@ -77,9 +85,28 @@ void _pin_cpu_cores(const std::vector<int32_t>& cpu_core_list) {
     kmp_set_affinity_mask_proc_ext(phy_core_id, &mask);
     kmp_set_affinity_ext(&mask);
     kmp_destroy_affinity_mask_ext(&mask);
+    if (bind_memory) {
+      // The pages first touched by this thread, such as the activations
+      // written in the parallel region, are placed on the local numa node.
+      thread_memory_policy_bound = set_thread_memory_policy_preferred(
+          get_numa_node_id_of_cpu(phy_core_id));
+    } else if (thread_memory_policy_bound) {
+      reset_thread_memory_policy();
+      thread_memory_policy_bound = false;
+    }
   }
   // Cache the cpu_core_list for query.
   current_cpu_core_list = cpu_core_list;
+  current_numa_node_id = -1;
+  for (auto core_id : cpu_core_list) {
+    auto numa_node_id = get_numa_node_id_of_cpu(core_id);
+    if (current_numa_node_id == -1) {
+      current_numa_node_id = numa_node_id;
+    } else if (current_numa_node_id != numa_node_id) {
+      current_numa_node_id = -1;
+      break;
+    }
+  }
   return;
 }
 
@@ -120,10 +147,23 @@ void set_mask_affinity_from_cpu_pool(const CPUPool& cpu_pool) {
     int thread_id = omp_get_thread_num();
     kmp_affinity_mask_t mask = threads_mask[thread_id];
     kmp_set_affinity_ext(&mask);
+    if (thread_memory_policy_bound) {
+      reset_thread_memory_policy();
+      thread_memory_policy_bound = false;
+    }
   }
+  current_numa_node_id = -1;
+}
+
+int32_t get_current_numa_node_id() {
+  return current_numa_node_id;
+}
+
+int32_t get_numa_node_id_of_cpu(int32_t cpu_id) {
+  return CPUTopology::get_instance().get_cpu(cpu_id).numa_node_id;
 }
 
-CPUPool::CPUPool(const std::vector<int32_t>& cpu_core_list) {
+CPUPool::CPUPool(const std::vector<int32_t>& cpu_core_list, bool bind_memory) {
   // Notice: We shouldn't load iomp symbol in sub_thread, otherwise race
   // condition happens.
   if (!is_runtime_ext_enabled()) {
@@ -132,6 +172,7 @@ CPUPool::CPUPool(const std::vector<int32_t>& cpu_core_list) {
   }
   this->cpu_core_list = cpu_core_list;
   this->cpu_core_list_initialized_ = true;
+  this->bind_memory_ = bind_memory;
 }
 
 CPUPool::CPUPool(std::vector<kmp_affinity_mask_t>&& cpu_core_mask) {
@@ -155,6 +196,7 @@ CPUPool::CPUPool(CPUPool&& source_cpu_pool) {
     this->cpu_core_list = std::move(
         const_cast<std::vector<int32_t>&>(source_cpu_pool.get_cpu_core_list()));
     this->cpu_core_list_initialized_ = true;
+    this->bind_memory_ = source_cpu_pool.is_memory_binding_enabled();
   } else {
     this->cpu_affinity_mask =
         std::move(const_cast<std::vector<kmp_affinity_mask_t>&>(
@@ -187,6 +229,29 @@ bool CPUPool::is_cpu_affinity_mask_initialized() const {
   return this->cpu_affinity_mask_initialized_;
 }
 
+bool CPUPool::is_memory_binding_enabled() const {
+  return this->bind_memory_;
+}
+
+std::vector<int32_t> CPUPool::get_numa_node_ids() const {
+  return CPUTopology::get_instance().get_numa_node_ids_of_cpus(
+      this->get_cpu_core_list());
+}
+
+CPUPool get_cpu_pool_of_numa_node(
+    int32_t numa_node_id,
+    bool physical_core_only,
+    bool bind_memory) {
+  auto cpu_core_list = CPUTopology::get_instance().get_cpu_list_of_numa_node(
+      numa_node_id, physical_core_only);
+  if (cpu_core_list.empty()) {
+    throw std::runtime_error(
+        "Fail to get the CPUPool of numa node " +
+        std::to_string(numa_node_id) + ". It has no online cpu.");
+  }
+  return CPUPool(cpu_core_list, bind_memory);
+}
+
 CPUPool::~CPUPool() {
   if (this->cpu_affinity_mask_initialized_) {
     // If we are using the cpu_affinity_mask expression for CPUPool
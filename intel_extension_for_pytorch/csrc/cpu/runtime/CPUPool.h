@@ -16,7 +16,11 @@ typedef int (*kmp_get_affinity_p)(kmp_affinity_mask_t*);
 
 class CPUPool {
  public:
-  explicit CPUPool(const std::vector<int32_t>& cpu_core_list);
+  // If bind_memory, the threads pinned to this CPUPool prefer to allocate the
+  // pages they first touch on the numa node of their own core.
+  explicit CPUPool(
+      const std::vector<int32_t>& cpu_core_list,
+      bool bind_memory = false);
   explicit CPUPool(std::vector<kmp_affinity_mask_t>&& cpu_core_mask);
   CPUPool(CPUPool&& source_cpu_pool);
 
@@ -24,6 +28,9 @@ class CPUPool {
   const std::vector<kmp_affinity_mask_t>& get_cpu_affinity_mask() const;
   bool is_cpu_core_list_initialized() const;
   bool is_cpu_affinity_mask_initialized() const;
+  bool is_memory_binding_enabled() const;
+  // The numa nodes of the cores in cpu_core_list.
+  std::vector<int32_t> get_numa_node_ids() const;
   ~CPUPool();
 
  private:
@@ -34,6 +41,7 @@ class CPUPool {
   bool cpu_core_list_initialized_{false};
   std::vector<kmp_affinity_mask_t> cpu_affinity_mask;
   bool cpu_affinity_mask_initialized_{false};
+  bool bind_memory_{false};
 
   // Put deleted function into private.
   CPUPool() = delete;
@@ -46,10 +54,21 @@ class CPUPool {
 
 bool is_runtime_ext_enabled();
 void init_runtime_ext();
-void _pin_cpu_cores(const std::vector<int32_t>& cpu_core_list);
+void _pin_cpu_cores(
+    const std::vector<int32_t>& cpu_core_list,
+    bool bind_memory = false);
 bool is_same_core_affinity_setting(const std::vector<int32_t>& cpu_core_list);
 CPUPool get_cpu_pool_from_mask_affinity();
 void set_mask_affinity_from_cpu_pool(const CPUPool& cpu_pool);
+int32_t get_numa_node_id_of_cpu(int32_t cpu_id);
+// The numa node of the cores the calling thread is pinned to by
+// _pin_cpu_cores. Return -1 if the thread isn't pinned, or the cores span
+// multiple numa nodes.
+int32_t get_current_numa_node_id();
+CPUPool get_cpu_pool_of_numa_node(
+    int32_t numa_node_id,
+    bool physical_core_only = true,
+    bool bind_memory = false);
 
 class WithCPUPool {
  public:
@@ -57,7 +76,9 @@ class WithCPUPool {
       : previous_cpu_pool(
             torch_ipex::runtime::get_cpu_pool_from_mask_affinity()),
         current_cpu_pool(std::move(cpu_pool)) {
-    torch_ipex::runtime::_pin_cpu_cores(current_cpu_pool.get_cpu_core_list());
+    torch_ipex::runtime::_pin_cpu_cores(
+        current_cpu_pool.get_cpu_core_list(),
+        current_cpu_pool.is_memory_binding_enabled());
   }
 
   ~WithCPUPool() {
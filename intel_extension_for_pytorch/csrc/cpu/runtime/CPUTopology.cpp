@@ -0,0 +1,296 @@
+#include "CPUTopology.h"
+
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace torch_ipex {
+namespace runtime {
+
+namespace {
+// Memory policy modes and flags, refer to <numaif.h>. Define them here to
+// avoid the dependency on libnuma.
+constexpr int kMPolDefault = 0;
+constexpr int kMPolPreferred = 1;
+constexpr int kMPolBind = 2;
+constexpr unsigned kMPolMfMove = (1 << 1);
+constexpr unsigned long kMPolFNode = (1 << 0);
+constexpr unsigned long kMPolFAddr = (1 << 1);
+constexpr size_t kBitsPerLong = 8 * sizeof(unsigned long);
+
+const char* kSysCpuPath = "/sys/devices/system/cpu/";
+
+bool read_file(const std::string& path, std::string& content) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::getline(file, content);
+  return true;
+}
+
+int32_t read_int(const std::string& path, int32_t default_value) {
+  std::string content;
+  if (!read_file(path, content) || content.empty()) {
+    return default_value;
+  }
+  try {
+    return std::stoi(content);
+  } catch (const std::exception&) {
+    return default_value;
+  }
+}
+
+int32_t read_numa_node_id(int32_t cpu_id) {
+  // The sysfs directory of each logical cpu has a "node<N>" entry linked to
+  // the NUMA node it belongs to.
+  std::string cpu_path = kSysCpuPath + std::string("cpu") +
+      std::to_string(cpu_id) + "/";
+  DIR* dir = opendir(cpu_path.c_str());
+  if (dir == NULL) {
+    return 0;
+  }
+  int32_t node_id = 0;
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (strncmp(entry->d_name, "node", 4) == 0 && isdigit(entry->d_name[4])) {
+      node_id = std::stoi(entry->d_name + 4);
+      break;
+    }
+  }
+  closedir(dir);
+  return node_id;
+}
+
+std::vector<unsigned long> build_node_mask(
+    int32_t numa_node_id,
+    unsigned long& max_node) {
+  std::vector<unsigned long> node_mask(numa_node_id / kBitsPerLong + 1, 0);
+  node_mask[numa_node_id / kBitsPerLong] |= 1UL
+      << (numa_node_id % kBitsPerLong);
+  // The kernel reads max_node - 1 bits.
+  max_node = node_mask.size() * kBitsPerLong + 1;
+  return node_mask;
+}
+} // namespace
+
+std::vector<int32_t> parse_cpu_list(const std::string& cpu_list_str) {
+  std::vector<int32_t> cpu_list;
+  std::stringstream ss(cpu_list_str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty() || !isdigit(item[0])) {
+      continue;
+    }
+    auto dash = item.find('-');
+    if (dash == std::string::npos) {
+      cpu_list.emplace_back(std::stoi(item));
+    } else {
+      int32_t begin = std::stoi(item.substr(0, dash));
+      int32_t end = std::stoi(item.substr(dash + 1));
+      for (int32_t cpu_id = begin; cpu_id <= end; cpu_id++) {
+        cpu_list.emplace_back(cpu_id);
+      }
+    }
+  }
+  return cpu_list;
+}
+
+CPUTopology::CPUTopology() {
+  std::string online;
+  std::vector<int32_t> online_cpus;
+  if (read_file(kSysCpuPath + std::string("online"), online)) {
+    online_cpus = parse_cpu_list(online);
+  }
+  if (online_cpus.empty()) {
+    // sysfs is not available, assume 1 socket without SMT.
+    auto num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int32_t cpu_id = 0; cpu_id < num_cpus; cpu_id++) {
+      online_cpus.emplace_back(cpu_id);
+    }
+  }
+
+  std::set<std::pair<int32_t, int32_t>> seen_physical_cores;
+  std::map<std::string, int32_t> l3_domains;
+  std::set<int32_t> sockets;
+  std::set<int32_t> numa_nodes;
+  for (auto cpu_id : online_cpus) {
+    std::string cpu_path =
+        kSysCpuPath + std::string("cpu") + std::to_string(cpu_id) + "/";
+    CPUInfo info;
+    info.cpu_id = cpu_id;
+    info.socket_id = std::max(
+        read_int(cpu_path + "topology/physical_package_id", 0), 0);
+    info.core_id = read_int(cpu_path + "topology/core_id", cpu_id);
+    info.numa_node_id = read_numa_node_id(cpu_id);
+    // The cpus sharing the same L3 have the same shared_cpu_list.
+    std::string l3_shared_cpu_list;
+    if (!read_file(
+            cpu_path + "cache/index3/shared_cpu_list", l3_shared_cpu_list)) {
+      // No L3 info, take each socket as one L3 domain.
+      l3_shared_cpu_list = "socket" + std::to_string(info.socket_id);
+    }
+    auto l3_domain = l3_domains.find(l3_shared_cpu_list);
+    if (l3_domain == l3_domains.end()) {
+      l3_domain = l3_domains
+                      .emplace(
+                          l3_shared_cpu_list,
+                          static_cast<int32_t>(l3_domains.size()))
+                      .first;
+    }
+    info.l3_cache_id = l3_domain->second;
+    // online_cpus is in ascending order, so the first seen hardware thread of
+    // each physical core is the one with the smallest cpu id.
+    info.is_smt_sibling =
+        !seen_physical_cores.emplace(info.socket_id, info.core_id).second;
+
+    sockets.insert(info.socket_id);
+    numa_nodes.insert(info.numa_node_id);
+    if (cpu_id >= static_cast<int32_t>(cpu_index_.size())) {
+      cpu_index_.resize(cpu_id + 1, -1);
+    }
+    cpu_index_[cpu_id] = cpus_.size();
+    cpus_.emplace_back(info);
+  }
+  num_sockets_ = sockets.size();
+  num_l3_domains_ = l3_domains.size();
+  numa_node_ids_.assign(numa_nodes.begin(), numa_nodes.end());
+}
+
+const CPUTopology& CPUTopology::get_instance() {
+  static CPUTopology topology;
+  return topology;
+}
+
+const std::vector<CPUInfo>& CPUTopology::get_cpus() const {
+  return cpus_;
+}
+
+const CPUInfo& CPUTopology::get_cpu(int32_t cpu_id) const {
+  if (cpu_id < 0 || cpu_id >= static_cast<int32_t>(cpu_index_.size()) ||
+      cpu_index_[cpu_id] < 0) {
+    throw std::runtime_error(
+        "Fail to get the topology of cpu " + std::to_string(cpu_id) +
+        ". It's not an online cpu.");
+  }
+  return cpus_[cpu_index_[cpu_id]];
+}
+
+int32_t CPUTopology::get_num_sockets() const {
+  return num_sockets_;
+}
+
+int32_t CPUTopology::get_num_numa_nodes() const {
+  return numa_node_ids_.size();
+}
+
+int32_t CPUTopology::get_num_l3_domains() const {
+  return num_l3_domains_;
+}
+
+const std::vector<int32_t>& CPUTopology::get_numa_node_ids() const {
+  return numa_node_ids_;
+}
+
+std::vector<int32_t> CPUTopology::get_cpu_list_of_numa_node(
+    int32_t numa_node_id,
+    bool physical_core_only) const {
+  std::vector<int32_t> cpu_list;
+  for (const auto& cpu : cpus_) {
+    if (cpu.numa_node_id == numa_node_id &&
+        !(physical_core_only && cpu.is_smt_sibling)) {
+      cpu_list.emplace_back(cpu.cpu_id);
+    }
+  }
+  return cpu_list;
+}
+
+std::vector<int32_t> CPUTopology::get_cpu_list_of_socket(
+    int32_t socket_id,
+    bool physical_core_only) const {
+  std::vector<int32_t> cpu_list;
+  for (const auto& cpu : cpus_) {
+    if (cpu.socket_id == socket_id &&
+        !(physical_core_only && cpu.is_smt_sibling)) {
+      cpu_list.emplace_back(cpu.cpu_id);
+    }
+  }
+  return cpu_list;
+}
+
+std::vector<int32_t> CPUTopology::get_cpu_list_of_l3_domain(
+    int32_t l3_cache_id,
+    bool physical_core_only) const {
+  std::vector<int32_t> cpu_list;
+  for (const auto& cpu : cpus_) {
+    if (cpu.l3_cache_id == l3_cache_id &&
+        !(physical_core_only && cpu.is_smt_sibling)) {
+      cpu_list.emplace_back(cpu.cpu_id);
+    }
+  }
+  return cpu_list;
+}
+
+std::vector<int32_t> CPUTopology::get_numa_node_ids_of_cpus(
+    const std::vector<int32_t>& cpu_list) const {
+  std::set<int32_t> numa_nodes;
+  for (auto cpu_id : cpu_list) {
+    numa_nodes.insert(get_cpu(cpu_id).numa_node_id);
+  }
+  return std::vector<int32_t>(numa_nodes.begin(), numa_nodes.end());
+}
+
+bool set_thread_memory_policy_preferred(int32_t numa_node_id) {
+  unsigned long max_node;
+  auto node_mask = build_node_mask(numa_node_id, max_node);
+  return syscall(
+             SYS_set_mempolicy, kMPolPreferred, node_mask.data(), max_node) ==
+      0;
+}
+
+bool reset_thread_memory_policy() {
+  return syscall(SYS_set_mempolicy, kMPolDefault, NULL, 0) == 0;
+}
+
+bool bind_memory_to_numa_node(void* addr, size_t len, int32_t numa_node_id) {
+  // mbind requires the page aligned start address.
+  auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  auto start = reinterpret_cast<uintptr_t>(addr) & ~(page_size - 1);
+  auto end = reinterpret_cast<uintptr_t>(addr) + len;
+  unsigned long max_node;
+  auto node_mask = build_node_mask(numa_node_id, max_node);
+  return syscall(
+             SYS_mbind,
+             reinterpret_cast<void*>(start),
+             end - start,
+             kMPolBind,
+             node_mask.data(),
+             max_node,
+             kMPolMfMove) == 0;
+}
+
+int32_t get_numa_node_id_of_address(void* addr) {
+  int numa_node_id = -1;
+  if (syscall(
+          SYS_get_mempolicy,
+          &numa_node_id,
+          NULL,
+          0,
+          addr,
+          kMPolFNode | kMPolFAddr) != 0) {
+    return -1;
+  }
+  return numa_node_id;
+}
+
+} // namespace runtime
+} // namespace torch_ipex
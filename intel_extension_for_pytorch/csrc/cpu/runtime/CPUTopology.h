@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace torch_ipex {
+namespace runtime {
+
+struct CPUInfo {
+  // Logical cpu id used by the affinity API.
+  int32_t cpu_id;
+  int32_t socket_id;
+  int32_t numa_node_id;
+  // Physical core id, unique inside one socket.
+  int32_t core_id;
+  // Id of the L3 cache domain (LLC) this cpu belongs to.
+  int32_t l3_cache_id;
+  // False if this cpu is the first hardware thread of its physical core,
+  // true for the other SMT siblings.
+  bool is_smt_sibling;
+};
+
+/*
+CPUTopology discovers the sockets, NUMA nodes, physical cores, SMT siblings
+and L3 domains of the online cpus from sysfs once per process.
+*/
+class CPUTopology {
+ public:
+  static const CPUTopology& get_instance();
+
+  const std::vector<CPUInfo>& get_cpus() const;
+  const CPUInfo& get_cpu(int32_t cpu_id) const;
+  int32_t get_num_sockets() const;
+  int32_t get_num_numa_nodes() const;
+  int32_t get_num_l3_domains() const;
+  // The numa node ids which have online cpus, in ascending order.
+  const std::vector<int32_t>& get_numa_node_ids() const;
+  // The cpu ids of the numa node. If physical_core_only, only the first
+  // hardware thread of each physical core is returned.
+  std::vector<int32_t> get_cpu_list_of_numa_node(
+      int32_t numa_node_id,
+      bool physical_core_only = true) const;
+  std::vector<int32_t> get_cpu_list_of_socket(
+      int32_t socket_id,
+      bool physical_core_only = true) const;
+  std::vector<int32_t> get_cpu_list_of_l3_domain(
+      int32_t l3_cache_id,
+      bool physical_core_only = true) const;
+  // The numa node ids of the cpus, without duplication.
+  std::vector<int32_t> get_numa_node_ids_of_cpus(
+      const std::vector<int32_t>& cpu_list) const;
+
+ private:
+  CPUTopology();
+  CPUTopology(const CPUTopology&) = delete;
+  CPUTopology& operator=(const CPUTopology&) = delete;
+
+  std::vector<CPUInfo> cpus_;
+  // Index of each cpu_id inside cpus_, -1 for offline cpus.
+  std::vector<int32_t> cpu_index_;
+  std::vector<int32_t> numa_node_ids_;
+  int32_t num_sockets_{1};
+  int32_t num_l3_domains_{1};
+};
+
+// Parse the cpu list format of sysfs, such as "0-3,8,10-11".
+std::vector<int32_t> parse_cpu_list(const std::string& cpu_list_str);
+
+// Memory policy of the calling thread. The pages touched first by the thread
+// are placed on the preferred numa node.
+bool set_thread_memory_policy_preferred(int32_t numa_node_id);
+bool reset_thread_memory_policy();
+// Bind the pages of [addr, addr + len) to the numa node, and migrate the
+// pages which have already been touched.
+bool bind_memory_to_numa_node(void* addr, size_t len, int32_t numa_node_id);
+// The numa node of the page which contains addr, -1 if it's unknown.
+int32_t get_numa_node_id_of_address(void* addr);
+
+} // namespace runtime
+} // namespace torch_ipex
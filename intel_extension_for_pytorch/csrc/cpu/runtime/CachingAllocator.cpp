@@ -0,0 +1,407 @@
+#include "CachingAllocator.h"
+
+#include <ATen/EmptyTensor.h>
+#include <ATen/Functions.h>
+#include <c10/util/Exception.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "CPUPool.h"
+#include "CPUTopology.h"
+#include "csrc/cpu/ideep/ideep.hpp"
+
+namespace torch_ipex {
+namespace runtime {
+
+namespace {
+// The header in front of each block keeps the 64 bytes alignment of the data.
+constexpr size_t kHeaderSize = 64;
+constexpr size_t kMinClassSize = 64;
+constexpr int kClassesPerDoubling = 4;
+// The larger blocks are returned to the OS on free.
+constexpr size_t kMaxCachedSize = size_t(1) << 30;
+constexpr int kNumClasses = 97;
+// The blocks up to this size are cached by the freeing thread first.
+constexpr size_t kMaxThreadCachedSize = size_t(1) << 20;
+constexpr size_t kMaxThreadCachedBlocks = 16;
+constexpr size_t kHugePageSize = size_t(1) << 21;
+
+struct BlockHeader {
+  // Size of the block including the header.
+  size_t size;
+  size_t requested;
+  int32_t numa_node_id;
+  // -1 if the block isn't cached.
+  int32_t class_index;
+};
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "BlockHeader is too large");
+
+// The size classes are 64, then 4 classes (1 + k / 4) * 2^b, k = 1..4 for
+// each power of 2.
+int get_class_index(size_t size) {
+  if (size <= kMinClassSize) {
+    return 0;
+  }
+  if (size > kMaxCachedSize) {
+    return -1;
+  }
+  // 2^b < size <= 2^(b + 1)
+  int b = 63 - __builtin_clzll(size - 1);
+  size_t step = size_t(1) << (b - 2);
+  size_t k = (size - (size_t(1) << b) + step - 1) / step;
+  return (b - 6) * kClassesPerDoubling + k;
+}
+
+size_t get_class_size(int class_index) {
+  if (class_index == 0) {
+    return kMinClassSize;
+  }
+  int b = (class_index - 1) / kClassesPerDoubling + 6;
+  size_t k = (class_index - 1) % kClassesPerDoubling + 1;
+  return (size_t(1) << b) + k * (size_t(1) << (b - 2));
+}
+
+bool read_env_flag(const char* name) {
+  auto envar = std::getenv(name);
+  return envar != nullptr && std::strcmp(envar, "1") == 0;
+}
+
+// Function local statics, since the ideep engine allocator is registered
+// during the static initialization.
+std::atomic<bool>& caching_allocator_enabled() {
+  static std::atomic<bool> enabled{read_env_flag("IPEX_CACHING_ALLOCATOR")};
+  return enabled;
+}
+
+std::atomic<bool>& huge_pages_enabled() {
+  static std::atomic<bool> enabled{
+      read_env_flag("IPEX_CACHING_ALLOCATOR_HUGE_PAGES")};
+  return enabled;
+}
+
+struct Counters {
+  std::atomic<int64_t> requested_bytes{0};
+  std::atomic<int64_t> allocated_bytes{0};
+  std::atomic<int64_t> cached_bytes{0};
+  std::atomic<int64_t> reserved_bytes{0};
+  std::atomic<int64_t> peak_allocated_bytes{0};
+  std::atomic<int64_t> peak_reserved_bytes{0};
+  std::atomic<int64_t> num_os_allocations{0};
+  std::atomic<int64_t> num_os_frees{0};
+};
+
+Counters& counters() {
+  static Counters counters;
+  return counters;
+}
+
+void update_peak(std::atomic<int64_t>& peak, int64_t value) {
+  auto current = peak.load(std::memory_order_relaxed);
+  while (value > current && !peak.compare_exchange_weak(current, value)) {
+  }
+}
+
+void* os_allocate(size_t size, int32_t numa_node_id) {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  bool huge = huge_pages_enabled().load() && size >= kHugePageSize;
+  size_t alignment = kHeaderSize;
+  if (huge) {
+    alignment = kHugePageSize;
+  } else if (numa_node_id >= 0 && size >= page_size) {
+    // Only bind the blocks which don't share their pages with the others.
+    alignment = page_size;
+  }
+  void* ptr = nullptr;
+  TORCH_CHECK(
+      posix_memalign(&ptr, alignment, size) == 0,
+      "CachingAllocator: failed to allocate ",
+      size,
+      " bytes");
+  if (huge) {
+    madvise(ptr, size, MADV_HUGEPAGE);
+  }
+  if (numa_node_id >= 0 && alignment >= page_size) {
+    bind_memory_to_numa_node(ptr, size, numa_node_id);
+  }
+  auto& stats = counters();
+  stats.num_os_allocations.fetch_add(1, std::memory_order_relaxed);
+  update_peak(stats.peak_reserved_bytes, stats.reserved_bytes += size);
+  return ptr;
+}
+
+void os_free(void* block, size_t size) {
+  std::free(block);
+  auto& stats = counters();
+  stats.num_os_frees.fetch_add(1, std::memory_order_relaxed);
+  stats.reserved_bytes -= size;
+}
+
+// The free blocks of one numa node shared by all the threads.
+struct NodePool {
+  std::mutex mutex;
+  std::vector<void*> blocks[kNumClasses];
+};
+
+class NodePools {
+ public:
+  static NodePools& get_instance() {
+    // Never destroyed, the tensors may be freed after the static destructors.
+    static NodePools* pools = new NodePools();
+    return *pools;
+  }
+
+  // The pool of numa_node_id -1 holds the blocks of the unpinned threads.
+  NodePool& get_pool(int32_t numa_node_id) {
+    auto index = numa_node_id + 1;
+    if (index < 0 || index >= static_cast<int32_t>(pools_.size())) {
+      index = 0;
+    }
+    return *pools_[index];
+  }
+
+  void push(void* block, const BlockHeader& header) {
+    auto& pool = get_pool(header.numa_node_id);
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.blocks[header.class_index].push_back(block);
+  }
+
+  void* pop(int32_t numa_node_id, int class_index) {
+    auto& pool = get_pool(numa_node_id);
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    auto& blocks = pool.blocks[class_index];
+    if (blocks.empty()) {
+      return nullptr;
+    }
+    auto block = blocks.back();
+    blocks.pop_back();
+    return block;
+  }
+
+  void release_all() {
+    for (auto& pool : pools_) {
+      std::lock_guard<std::mutex> lock(pool->mutex);
+      for (int i = 0; i < kNumClasses; i++) {
+        for (auto block : pool->blocks[i]) {
+          counters().cached_bytes -= get_class_size(i);
+          os_free(block, get_class_size(i));
+        }
+        pool->blocks[i].clear();
+      }
+    }
+  }
+
+ private:
+  NodePools() {
+    const auto& numa_node_ids = CPUTopology::get_instance().get_numa_node_ids();
+    int32_t num_pools = numa_node_ids.empty() ? 1 : numa_node_ids.back() + 2;
+    for (int32_t i = 0; i < num_pools; i++) {
+      pools_.emplace_back(new NodePool());
+    }
+  }
+
+  std::vector<std::unique_ptr<NodePool>> pools_;
+};
+
+// Trivially destructible, so that it can still be read while the other
+// thread local objects are destroyed.
+thread_local bool thread_cache_alive = false;
+
+// The free blocks of one thread, all of them on numa_node_id.
+struct ThreadCache {
+  ThreadCache() {
+    thread_cache_alive = true;
+  }
+
+  ~ThreadCache() {
+    thread_cache_alive = false;
+    flush();
+  }
+
+  void flush() {
+    auto& pools = NodePools::get_instance();
+    for (int i = 0; i < kNumClasses; i++) {
+      for (auto block : blocks[i]) {
+        pools.push(block, *static_cast<BlockHeader*>(block));
+      }
+      blocks[i].clear();
+    }
+  }
+
+  int32_t numa_node_id = -1;
+  std::vector<void*> blocks[kNumClasses];
+};
+
+ThreadCache* get_thread_cache() {
+  static thread_local ThreadCache cache;
+  return thread_cache_alive ? &cache : nullptr;
+}
+
+void caching_deallocate(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto block = static_cast<char*>(ptr) - kHeaderSize;
+  auto& header = *reinterpret_cast<BlockHeader*>(block);
+  auto& stats = counters();
+  stats.requested_bytes -= header.requested;
+  stats.allocated_bytes -= header.size;
+  if (header.class_index < 0) {
+    os_free(block, header.size);
+    return;
+  }
+  stats.cached_bytes += header.size;
+  if (header.size <= kMaxThreadCachedSize) {
+    auto cache = get_thread_cache();
+    if (cache != nullptr && cache->numa_node_id == header.numa_node_id) {
+      auto& blocks = cache->blocks[header.class_index];
+      if (blocks.size() < kMaxThreadCachedBlocks) {
+        blocks.push_back(block);
+        return;
+      }
+    }
+  }
+  NodePools::get_instance().push(block, header);
+}
+
+class CachingAllocator final : public c10::Allocator {
+ public:
+  c10::DataPtr allocate(size_t nbytes) const override {
+    if (nbytes == 0) {
+      return {nullptr, nullptr, &caching_deallocate, at::Device(at::kCPU)};
+    }
+    auto size = nbytes + kHeaderSize;
+    auto class_index = get_class_index(size);
+    auto numa_node_id = get_current_numa_node_id();
+    void* block = nullptr;
+    if (class_index >= 0) {
+      size = get_class_size(class_index);
+      auto cache = get_thread_cache();
+      if (cache != nullptr) {
+        // The thread is pinned to another numa node.
+        if (cache->numa_node_id != numa_node_id) {
+          cache->flush();
+          cache->numa_node_id = numa_node_id;
+        }
+        auto& blocks = cache->blocks[class_index];
+        if (!blocks.empty()) {
+          block = blocks.back();
+          blocks.pop_back();
+        }
+      }
+      if (block == nullptr) {
+        block = NodePools::get_instance().pop(numa_node_id, class_index);
+      }
+      if (block != nullptr) {
+        counters().cached_bytes -= size;
+      }
+    }
+    if (block == nullptr) {
+      block = os_allocate(size, numa_node_id);
+    }
+
+    auto& header = *static_cast<BlockHeader*>(block);
+    header.size = size;
+    header.requested = nbytes;
+    header.numa_node_id = numa_node_id;
+    header.class_index = class_index;
+    auto& stats = counters();
+    stats.requested_bytes += nbytes;
+    update_peak(stats.peak_allocated_bytes, stats.allocated_bytes += size);
+
+    auto data = static_cast<char*>(block) + kHeaderSize;
+    return {data, data, &caching_deallocate, at::Device(at::kCPU)};
+  }
+
+  c10::DeleterFnPtr raw_deleter() const override {
+    return &caching_deallocate;
+  }
+};
+
+CachingAllocator* get_caching_allocator() {
+  static CachingAllocator allocator;
+  return &allocator;
+}
+
+// The buffers of ideep tensors keep the free function of the allocator which
+// allocated them.
+void register_ideep_allocator(c10::Allocator* allocator) {
+  ideep::engine::cpu_engine().set_allocator(
+      [allocator](size_t size) { return allocator->raw_allocate(size); },
+      [allocator](void* ptr) { allocator->raw_deallocate(ptr); });
+}
+} // namespace
+
+void set_caching_allocator_enabled(bool enabled) {
+  caching_allocator_enabled().store(enabled);
+  register_ideep_allocator(get_ipex_cpu_allocator());
+}
+
+bool is_caching_allocator_enabled() {
+  return caching_allocator_enabled().load();
+}
+
+void set_caching_allocator_huge_pages_enabled(bool enabled) {
+  huge_pages_enabled().store(enabled);
+}
+
+bool is_caching_allocator_huge_pages_enabled() {
+  return huge_pages_enabled().load();
+}
+
+c10::Allocator* get_ipex_cpu_allocator() {
+  if (is_caching_allocator_enabled()) {
+    return get_caching_allocator();
+  }
+  return c10::GetAllocator(c10::DeviceType::CPU);
+}
+
+at::Tensor empty_with_ipex_allocator(
+    at::IntArrayRef sizes,
+    const at::TensorOptions& options) {
+  if (!is_caching_allocator_enabled()) {
+    return at::empty(sizes, options);
+  }
+  return at::Tensor(at::detail::empty_generic(
+      sizes,
+      get_caching_allocator(),
+      c10::DispatchKeySet(c10::DispatchKey::CPU),
+      c10::typeMetaToScalarType(options.dtype()),
+      options.memory_format_opt()));
+}
+
+CachingAllocatorStats get_caching_allocator_stats() {
+  auto& stats = counters();
+  return {
+      stats.requested_bytes.load(),
+      stats.allocated_bytes.load(),
+      stats.cached_bytes.load(),
+      stats.reserved_bytes.load(),
+      stats.peak_allocated_bytes.load(),
+      stats.peak_reserved_bytes.load(),
+      stats.num_os_allocations.load(),
+      stats.num_os_frees.load()};
+}
+
+void reset_caching_allocator_peak_stats() {
+  auto& stats = counters();
+  stats.peak_allocated_bytes.store(stats.allocated_bytes.load());
+  stats.peak_reserved_bytes.store(stats.reserved_bytes.load());
+}
+
+void empty_caching_allocator_cache() {
+  auto cache = get_thread_cache();
+  if (cache != nullptr) {
+    cache->flush();
+  }
+  NodePools::get_instance().release_all();
+}
+
+} // namespace runtime
+} // namespace torch_ipex
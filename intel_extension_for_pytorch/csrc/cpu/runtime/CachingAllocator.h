@@ -0,0 +1,67 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <c10/core/Allocator.h>
+
+#include <cstdint>
+
+namespace torch_ipex {
+namespace runtime {
+
+struct CachingAllocatorStats {
+  // Bytes requested by the live allocations.
+  int64_t requested_bytes;
+  // Bytes of the blocks of the live allocations, the difference with
+  // requested_bytes is the internal fragmentation of the size classes.
+  int64_t allocated_bytes;
+  // Bytes of the free blocks kept in the caches.
+  int64_t cached_bytes;
+  // Bytes obtained from the OS and not released yet.
+  int64_t reserved_bytes;
+  int64_t peak_allocated_bytes;
+  int64_t peak_reserved_bytes;
+  int64_t num_os_allocations;
+  int64_t num_os_frees;
+};
+
+/*
+CachingAllocator keeps the freed blocks in size classes (4 classes per power
+of 2) and reuses them for the later allocations, so that the steady state of
+an inference doesn't allocate from the OS, nor page faults on fresh pages.
+
+1. The blocks up to 1MB are first cached by the thread which frees them, the
+others (and the overflow of the thread caches) go to a pool per numa node
+shared by all the threads.
+2. The numa node of a block is the one of the CPUPool the allocating thread
+is pinned to. The fresh page-sized blocks are bound to that numa node, and a
+thread only reuses the blocks of its own numa node.
+3. With huge pages enabled, the blocks from 2MB are 2MB aligned and advised
+to be backed by transparent huge pages.
+
+It's used by the ideep tensors and some outputs of IPEX if it's enabled. It's
+disabled by default and can be enabled by the env IPEX_CACHING_ALLOCATOR=1,
+the huge pages by IPEX_CACHING_ALLOCATOR_HUGE_PAGES=1. It should be switched
+before running any model, the blocks are always freed by the allocator which
+allocated them though.
+*/
+void set_caching_allocator_enabled(bool enabled);
+bool is_caching_allocator_enabled();
+void set_caching_allocator_huge_pages_enabled(bool enabled);
+bool is_caching_allocator_huge_pages_enabled();
+
+// The caching allocator if it's enabled, otherwise the default CPU allocator.
+c10::Allocator* get_ipex_cpu_allocator();
+
+// at::empty on the allocator of get_ipex_cpu_allocator.
+at::Tensor empty_with_ipex_allocator(
+    at::IntArrayRef sizes,
+    const at::TensorOptions& options);
+
+CachingAllocatorStats get_caching_allocator_stats();
+void reset_caching_allocator_peak_stats();
+// Release the cached blocks of the shared pools and of the calling thread to
+// the OS.
+void empty_caching_allocator_cache();
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,229 @@
+#include "StaticMemoryPlan.h"
+
+#include <ATen/EmptyTensor.h>
+#include <ATen/Functions.h>
+#include <c10/util/Exception.h>
+#include <c10/util/intrusive_ptr.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "CachingAllocator.h"
+
+namespace torch_ipex {
+namespace runtime {
+
+namespace {
+struct Plan {
+  int64_t arena_bytes;
+  int64_t planned_value_bytes;
+};
+
+class PlanRegistry {
+ public:
+  static PlanRegistry& get_instance() {
+    // Never destroyed, the graphs may still be run during the static
+    // destruction.
+    static PlanRegistry* registry = new PlanRegistry();
+    return *registry;
+  }
+
+  int64_t add(const Plan& plan) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    plans_.push_back(plan);
+    return plans_.size() - 1;
+  }
+
+  Plan get(int64_t plan_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TORCH_CHECK(
+        plan_id >= 0 && plan_id < static_cast<int64_t>(plans_.size()),
+        "StaticMemoryPlan: unknown plan id ",
+        plan_id);
+    return plans_[plan_id];
+  }
+
+  void get_stats(StaticMemoryPlanStats& stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.num_plans = plans_.size();
+    for (const auto& plan : plans_) {
+      stats.planned_arena_bytes += plan.arena_bytes;
+      stats.planned_value_bytes += plan.planned_value_bytes;
+    }
+  }
+
+ private:
+  PlanRegistry() = default;
+
+  std::mutex mutex_;
+  std::vector<Plan> plans_;
+};
+
+struct Counters {
+  std::atomic<int64_t> num_arenas{0};
+  std::atomic<int64_t> num_planned_allocations{0};
+  std::atomic<int64_t> num_unplanned_allocations{0};
+};
+
+Counters& counters() {
+  static Counters counters;
+  return counters;
+}
+
+// Referenced by the thread which runs the plan and by each tensor in it, so
+// the tensors which outlive their run (or their thread) keep it alive.
+struct Arena : c10::intrusive_ptr_target {
+  explicit Arena(size_t nbytes)
+      : buffer(get_ipex_cpu_allocator()->allocate(nbytes)), nbytes(nbytes) {}
+
+  c10::DataPtr buffer;
+  size_t nbytes;
+};
+
+struct Slot {
+  // -1 if no buffer is assigned.
+  int64_t plan_id = -1;
+  int64_t offset = 0;
+  int64_t nbytes = 0;
+};
+
+struct ThreadState {
+  Slot slot;
+  std::unordered_map<int64_t, c10::intrusive_ptr<Arena>> arenas;
+};
+
+ThreadState& get_thread_state() {
+  static thread_local ThreadState state;
+  return state;
+}
+
+void release_arena(void* ctx) {
+  c10::raw::intrusive_ptr::decref(static_cast<Arena*>(ctx));
+}
+
+class PlannedOutputAllocator final : public c10::Allocator {
+ public:
+  c10::DataPtr allocate(size_t nbytes) const override {
+    auto& state = get_thread_state();
+    auto& slot = state.slot;
+    if (slot.plan_id >= 0) {
+      // The assigned buffer is only for the first output allocation.
+      auto plan_id = slot.plan_id;
+      slot.plan_id = -1;
+      auto it = state.arenas.find(plan_id);
+      if (static_cast<int64_t>(nbytes) == slot.nbytes &&
+          it != state.arenas.end()) {
+        auto arena = it->second.get();
+        TORCH_CHECK(
+            static_cast<size_t>(slot.offset) + nbytes <= arena->nbytes,
+            "StaticMemoryPlan: the buffer at ",
+            slot.offset,
+            " is out of the arena of ",
+            arena->nbytes,
+            " bytes");
+        c10::raw::intrusive_ptr::incref(arena);
+        counters().num_planned_allocations.fetch_add(
+            1, std::memory_order_relaxed);
+        auto data = static_cast<char*>(arena->buffer.get()) + slot.offset;
+        return {data, arena, &release_arena, at::Device(at::kCPU)};
+      }
+      counters().num_unplanned_allocations.fetch_add(
+          1, std::memory_order_relaxed);
+    }
+    return get_ipex_cpu_allocator()->allocate(nbytes);
+  }
+
+  // The buffers are slices of the arenas, which can't be freed by pointer.
+  c10::DeleterFnPtr raw_deleter() const override {
+    return nullptr;
+  }
+};
+
+PlannedOutputAllocator* get_planned_allocator() {
+  static PlannedOutputAllocator allocator;
+  return &allocator;
+}
+} // namespace
+
+int64_t register_static_memory_plan(
+    int64_t arena_bytes,
+    int64_t planned_value_bytes) {
+  return PlanRegistry::get_instance().add({arena_bytes, planned_value_bytes});
+}
+
+void begin_static_memory_plan(int64_t plan_id) {
+  auto& state = get_thread_state();
+  // Drop the buffer assigned to a node which failed in a previous run.
+  state.slot.plan_id = -1;
+  auto& arena = state.arenas[plan_id];
+  // A tensor of the previous run is still alive, leave that arena to it.
+  if (!arena || arena.use_count() > 1) {
+    auto plan = PlanRegistry::get_instance().get(plan_id);
+    arena = c10::make_intrusive<Arena>(plan.arena_bytes);
+    counters().num_arenas.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void assign_planned_buffer(int64_t plan_id, int64_t offset, int64_t nbytes) {
+  auto& slot = get_thread_state().slot;
+  slot.plan_id = plan_id;
+  slot.offset = offset;
+  slot.nbytes = nbytes;
+}
+
+void clear_planned_buffer() {
+  get_thread_state().slot.plan_id = -1;
+}
+
+c10::Allocator* get_planned_output_allocator() {
+  if (get_thread_state().slot.plan_id >= 0) {
+    return get_planned_allocator();
+  }
+  return get_ipex_cpu_allocator();
+}
+
+at::Tensor empty_planned_output(
+    at::IntArrayRef sizes,
+    const at::TensorOptions& options) {
+  if (get_thread_state().slot.plan_id < 0) {
+    return empty_with_ipex_allocator(sizes, options);
+  }
+  return at::Tensor(at::detail::empty_generic(
+      sizes,
+      get_planned_allocator(),
+      c10::DispatchKeySet(c10::DispatchKey::CPU),
+      c10::typeMetaToScalarType(options.dtype()),
+      options.memory_format_opt()));
+}
+
+at::Tensor empty_strided_planned_output(
+    at::IntArrayRef sizes,
+    at::IntArrayRef strides,
+    const at::TensorOptions& options) {
+  if (get_thread_state().slot.plan_id < 0) {
+    return at::empty_strided(sizes, strides, options);
+  }
+  return at::Tensor(at::detail::empty_strided_generic(
+      sizes,
+      strides,
+      get_planned_allocator(),
+      c10::DispatchKeySet(c10::DispatchKey::CPU),
+      c10::typeMetaToScalarType(options.dtype())));
+}
+
+StaticMemoryPlanStats get_static_memory_plan_stats() {
+  auto& stats = counters();
+  StaticMemoryPlanStats result{
+      0,
+      0,
+      0,
+      stats.num_arenas.load(),
+      stats.num_planned_allocations.load(),
+      stats.num_unplanned_allocations.load()};
+  PlanRegistry::get_instance().get_stats(result);
+  return result;
+}
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <c10/core/Allocator.h>
+
+#include <cstdint>
+
+namespace torch_ipex {
+namespace runtime {
+
+struct StaticMemoryPlanStats {
+  int64_t num_plans;
+  // Sum of the arena sizes of the plans.
+  int64_t planned_arena_bytes;
+  // Sum of the sizes of the planned values, i.e. what they would take if
+  // none of them shared their buffer.
+  int64_t planned_value_bytes;
+  // Arenas allocated by the threads running the plans.
+  int64_t num_arenas;
+  // Outputs written into their planned buffer.
+  int64_t num_planned_allocations;
+  // Outputs of planned nodes whose size didn't match the plan, so they were
+  // allocated by the default allocator instead.
+  int64_t num_unplanned_allocations;
+};
+
+/*
+A static memory plan gives the intermediate tensors of a frozen graph offsets
+in one arena, the tensors whose lifetimes don't overlap share the same bytes.
+The plan is computed by the static memory planning JIT pass, which surrounds
+each planned node with the ops below:
+
+  ipex::memory_plan_begin(plan_id)            # once, at the graph entry
+  ...
+  ipex::memory_plan_assign(plan_id, offset, nbytes)
+  %out = ipex_prepack::convolution_relu_run(%x, %ctx)
+  ipex::memory_plan_clear()
+
+The thread running the graph (i.e. the inference stream) owns one arena per
+plan. Only the output allocations which go through
+get_planned_output_allocator consume the assigned buffer, and only if the
+size matches, any other allocation is left untouched.
+*/
+
+// Register a plan whose arena is arena_bytes, returns the plan id.
+int64_t register_static_memory_plan(
+    int64_t arena_bytes,
+    int64_t planned_value_bytes);
+
+// Make sure the calling thread has an arena for the plan. A new arena is
+// allocated if a tensor of the previous run is still alive in the current one.
+void begin_static_memory_plan(int64_t plan_id);
+// Assign the buffer at offset of the plan's arena to the next output
+// allocation of nbytes on the calling thread.
+void assign_planned_buffer(int64_t plan_id, int64_t offset, int64_t nbytes);
+void clear_planned_buffer();
+
+// The allocator for the output of an op which may be planned. It returns the
+// assigned buffer if any and the size matches, otherwise it allocates from
+// get_ipex_cpu_allocator.
+c10::Allocator* get_planned_output_allocator();
+
+// at::empty on the allocator of get_planned_output_allocator.
+at::Tensor empty_planned_output(
+    at::IntArrayRef sizes,
+    const at::TensorOptions& options);
+at::Tensor empty_strided_planned_output(
+    at::IntArrayRef sizes,
+    at::IntArrayRef strides,
+    const at::TensorOptions& options);
+
+StaticMemoryPlanStats get_static_memory_plan_stats();
+
+} // namespace runtime
+} // namespace torch_ipex
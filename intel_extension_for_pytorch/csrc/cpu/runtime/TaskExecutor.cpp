@@ -1,9 +1,55 @@
 #include "TaskExecutor.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 namespace torch_ipex {
 namespace runtime {
 
-TaskExecutor::TaskExecutor(const std::vector<int32_t>& cpu_core_list) {
+namespace {
+// Default capacity of the local queue of each TaskExecutor.
+constexpr size_t kTaskQueueCapacity = 1024;
+
+std::mutex work_stealing_groups_mutex;
+// The work stealing TaskExecutors on the same NUMA node share one group.
+std::unordered_map<int32_t, std::shared_ptr<TaskExecutorGroup>>
+    work_stealing_groups;
+
+std::shared_ptr<TaskExecutorGroup> get_work_stealing_group(
+    int32_t numa_node_id) {
+  std::lock_guard<std::mutex> lock(work_stealing_groups_mutex);
+  auto& group = work_stealing_groups[numa_node_id];
+  if (!group) {
+    group = std::make_shared<TaskExecutorGroup>();
+  }
+  return group;
+}
+} // namespace
+
+void TaskExecutorGroup::add_queue(const TaskQueuePtr& queue) {
+  std::lock_guard<std::mutex> lock(this->update_mutex);
+  auto new_queues =
+      std::make_shared<std::vector<TaskQueuePtr>>(*std::atomic_load(&queues));
+  new_queues->emplace_back(queue);
+  std::atomic_store(
+      &queues, std::shared_ptr<const std::vector<TaskQueuePtr>>(new_queues));
+}
+
+void TaskExecutorGroup::remove_queue(const TaskQueuePtr& queue) {
+  std::lock_guard<std::mutex> lock(this->update_mutex);
+  auto new_queues =
+      std::make_shared<std::vector<TaskQueuePtr>>(*std::atomic_load(&queues));
+  new_queues->erase(
+      std::remove(new_queues->begin(), new_queues->end(), queue),
+      new_queues->end());
+  std::atomic_store(
+      &queues, std::shared_ptr<const std::vector<TaskQueuePtr>>(new_queues));
+}
+
+TaskExecutor::TaskExecutor(
+    const std::vector<int32_t>& cpu_core_list,
+    bool enable_work_stealing,
+    bool bind_memory) {
   // Notice: We shouldn't load iomp symbol in sub_thread, otherwise race
   // condition happens.
   if (!is_runtime_ext_enabled()) {
@@ -12,57 +58,121 @@ TaskExecutor::TaskExecutor(const std::vector<int32_t>& cpu_core_list) {
         "before using the runtime API.");
   }
   this->cpu_core_list = cpu_core_list;
-  this->stop = false;
-
-  this->worker = std::make_shared<std::thread>([&, this] {
-    _pin_cpu_cores(this->cpu_core_list);
-    while (true) {
-      std::function<void()> task;
-      {
-        std::unique_lock<std::mutex> lock(this->worker_mutex);
-        this->worker_condition.wait(
-            lock, [this] { return this->stop || !this->tasks.empty(); });
-
-        if (this->stop && this->tasks.empty())
-          return;
-
-        task = std::move(this->tasks.front());
-        this->tasks.pop();
-      }
-      task();
-    }
+  this->work_stealing_enabled_ = enable_work_stealing;
+  this->bind_memory_ = bind_memory;
+  this->numa_node_id_ = cpu_core_list.empty()
+      ? 0
+      : get_numa_node_id_of_cpu(cpu_core_list[0]);
+  this->tasks = std::make_shared<TaskQueue<std::function<void()>>>(
+      kTaskQueueCapacity);
+  this->group = enable_work_stealing
+      ? get_work_stealing_group(this->numa_node_id_)
+      : std::make_shared<TaskExecutorGroup>();
+  this->group->add_queue(this->tasks);
+
+  this->worker = std::make_shared<std::thread>([this] {
+    _pin_cpu_cores(this->cpu_core_list, this->bind_memory_);
+    this->worker_loop();
   });
 }
 
-std::mutex& TaskExecutor::get_mutex() {
-  return this->worker_mutex;
+bool TaskExecutor::try_get_task(std::function<void()>& task) {
+  // Always drain the local queue first.
+  if (this->tasks->try_pop(task)) {
+    return true;
+  }
+  if (!this->work_stealing_enabled_) {
+    return false;
+  }
+  auto queues = std::atomic_load(&this->group->queues);
+  auto num_queues = queues->size();
+  if (num_queues <= 1) {
+    return false;
+  }
+  // Start from the queue next to the local one, so the victims of the
+  // different thieves are spread over the group.
+  auto self = std::find(queues->begin(), queues->end(), this->tasks);
+  size_t start = self == queues->end() ? 0 : (self - queues->begin()) + 1;
+  for (size_t i = 0; i < num_queues; i++) {
+    auto& victim = (*queues)[(start + i) % num_queues];
+    if (victim != this->tasks && victim->try_pop(task)) {
+      this->stolen_tasks.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
 }
 
-std::condition_variable& TaskExecutor::get_condition() {
-  return this->worker_condition;
+void TaskExecutor::worker_loop() {
+  std::function<void()> task;
+  while (true) {
+    if (this->try_get_task(task)) {
+      this->group->pending_tasks.fetch_sub(1);
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    if (this->stop.load() && this->submitting.load() == 0 &&
+        this->tasks->empty())
+      return;
+
+    std::unique_lock<std::mutex> lock(this->group->park_mutex);
+    this->group->sleeping_workers.fetch_add(1);
+    this->group->park_condition.wait(lock, [this] {
+      return this->stop.load() || this->group->pending_tasks.load() > 0;
+    });
+    this->group->sleeping_workers.fetch_sub(1);
+  }
+}
+
+void TaskExecutor::submit(std::function<void()>&& task) {
+  this->submitting.fetch_add(1);
+  // submit task to a stopping the pool is not allowed
+  if (this->stop.load()) {
+    this->submitting.fetch_sub(1);
+    throw std::runtime_error("Task submit on stopped TaskExecutor");
+  }
+  this->tasks->push(std::move(task));
+  this->group->pending_tasks.fetch_add(1);
+  this->submitting.fetch_sub(1);
+
+  // Only take the park mutex when there is a worker to wake up. Since the
+  // worker increases sleeping_workers before checking pending_tasks under the
+  // park mutex, the wakeup can't be lost.
+  if (this->group->sleeping_workers.load() > 0) {
+    { std::lock_guard<std::mutex> lock(this->group->park_mutex); }
+    this->group->park_condition.notify_one();
+  }
 }
 
 bool TaskExecutor::is_stop() {
-  return this->stop;
+  return this->stop.load();
+}
+
+bool TaskExecutor::is_work_stealing_enabled() const {
+  return this->work_stealing_enabled_;
+}
+
+int32_t TaskExecutor::get_numa_node_id() const {
+  return this->numa_node_id_;
 }
 
-std::queue<std::function<void()>>& TaskExecutor::get_tasks() {
-  return this->tasks;
+int64_t TaskExecutor::get_num_stolen_tasks() const {
+  return this->stolen_tasks.load(std::memory_order_relaxed);
 }
 
 void TaskExecutor::stop_executor() {
-  bool should_wait_worker_join = false;
-  {
-    std::unique_lock<std::mutex> lock(this->worker_mutex);
-    if (this->stop == false) {
-      should_wait_worker_join = true;
-      this->stop = true;
-    }
+  bool expected = false;
+  if (!this->stop.compare_exchange_strong(expected, true)) {
+    return;
   }
-  if (should_wait_worker_join) {
-    this->worker_condition.notify_all();
-    this->worker->join();
+  {
+    std::lock_guard<std::mutex> lock(this->group->park_mutex);
   }
+  this->group->park_condition.notify_all();
+  this->worker->join();
+  this->group->remove_queue(this->tasks);
   return;
 }
 
@@ -2,6 +2,7 @@
 
 #include <dlfcn.h>
 #include <omp.h>
+#include <atomic>
 #include <cassert>
 #include <condition_variable>
 #include <functional>
@@ -9,7 +10,6 @@
 #include <iostream>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <stdexcept>
 #include <thread>
 #include <vector>
@@ -18,31 +18,71 @@
 #include <torch/csrc/autograd/profiler.h>
 #include <torch/csrc/jit/api/module.h>
 #include "CPUPool.h"
+#include "TaskQueue.h"
 
 namespace torch_ipex {
 namespace runtime {
 
+using TaskQueuePtr = std::shared_ptr<TaskQueue<std::function<void()>>>;
+
+// TaskExecutors in the same TaskExecutorGroup park their workers on the same
+// condition variable, and an idle worker steals tasks from the local queues of
+// the other members. Executors without work stealing own a private group.
+struct TaskExecutorGroup {
+  // Number of tasks pushed into the queues of this group but not yet popped.
+  std::atomic<int64_t> pending_tasks{0};
+  std::atomic<int32_t> sleeping_workers{0};
+  std::mutex park_mutex;
+  std::condition_variable park_condition;
+
+  // Copy-on-write snapshot of the member queues, read with std::atomic_load
+  // by the stealing workers and only replaced under update_mutex.
+  std::shared_ptr<const std::vector<TaskQueuePtr>> queues{
+      std::make_shared<const std::vector<TaskQueuePtr>>()};
+  std::mutex update_mutex;
+
+  void add_queue(const TaskQueuePtr& queue);
+  void remove_queue(const TaskQueuePtr& queue);
+};
+
 class TaskExecutor {
  public:
-  explicit TaskExecutor(const std::vector<int32_t>& cpu_core_list);
-  std::mutex& get_mutex();
-  std::condition_variable& get_condition();
+  explicit TaskExecutor(
+      const std::vector<int32_t>& cpu_core_list,
+      bool enable_work_stealing = false,
+      bool bind_memory = false);
+  // Submit the task into the local queue of this executor. The task will be
+  // run by the worker of this executor, or stolen by an idle worker of other
+  // executor on the same NUMA node if work stealing is enabled.
+  void submit(std::function<void()>&& task);
   bool is_stop();
-  std::queue<std::function<void()>>& get_tasks();
+  bool is_work_stealing_enabled() const;
+  int32_t get_numa_node_id() const;
+  // Number of the tasks this worker has stolen from the other executors.
+  int64_t get_num_stolen_tasks() const;
   void stop_executor();
   ~TaskExecutor();
 
  private:
-  std::queue<std::function<void()>> tasks;
+  void worker_loop();
+  bool try_get_task(std::function<void()>& task);
+
+  TaskQueuePtr tasks;
+  std::shared_ptr<TaskExecutorGroup> group;
   std::shared_ptr<std::thread> worker;
 
   // Synchronization
-  bool stop;
-  std::mutex worker_mutex;
-  std::condition_variable worker_condition;
+  std::atomic<bool> stop{false};
+  // Number of submit calls which passed the stop check but haven't finished
+  // the push, the worker can only exit when it's 0.
+  std::atomic<int32_t> submitting{0};
+  std::atomic<int64_t> stolen_tasks{0};
 
   // Executor' thread_pool
   std::vector<int32_t> cpu_core_list;
+  bool work_stealing_enabled_{false};
+  bool bind_memory_{false};
+  int32_t numa_node_id_{0};
 
   // Put the deleted function in the private.
   TaskExecutor(const TaskExecutor& task_executor) =
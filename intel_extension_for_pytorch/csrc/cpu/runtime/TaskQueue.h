@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace torch_ipex {
+namespace runtime {
+
+// Bounded lock-free multi-producer/multi-consumer queue.
+// refer to
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+// Each TaskExecutor owns one TaskQueue as its local deque: submitters push
+// into it, the owner worker pops from it, and idle workers of the other
+// executors on the same NUMA node steal from it. No lock is taken on either
+// path, the only contention is the CAS on the head/tail position.
+template <typename T>
+class TaskQueue {
+ public:
+  // capacity must be power of 2.
+  explicit TaskQueue(size_t capacity = 1024)
+      : buffer_(new Cell[capacity]), buffer_mask_(capacity - 1) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+      throw std::runtime_error(
+          "Fail to init TaskQueue. The capacity must be power of 2.");
+    }
+    for (size_t i = 0; i < capacity; i++) {
+      buffer_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    enqueue_pos_.store(0, std::memory_order_relaxed);
+    dequeue_pos_.store(0, std::memory_order_relaxed);
+  }
+
+  TaskQueue(const TaskQueue&) = delete;
+  TaskQueue& operator=(const TaskQueue&) = delete;
+  TaskQueue(TaskQueue&&) = delete;
+  TaskQueue& operator=(TaskQueue&&) = delete;
+
+  bool try_push(T&& data) {
+    Cell* cell;
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &buffer_[pos & buffer_mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+      if (dif == 0) {
+        if (enqueue_pos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (dif < 0) {
+        // The queue is full.
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::move(data);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Push with back-pressure: yield to the consumers until one slot is free.
+  void push(T&& data) {
+    while (!try_push(std::move(data))) {
+      std::this_thread::yield();
+    }
+  }
+
+  bool try_pop(T& data) {
+    Cell* cell;
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &buffer_[pos & buffer_mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+      if (dif == 0) {
+        if (dequeue_pos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (dif < 0) {
+        // The queue is empty.
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    data = std::move(cell->data);
+    cell->sequence.store(pos + buffer_mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Only an approximation when there are concurrent producers/consumers.
+  bool empty() const {
+    return enqueue_pos_.load(std::memory_order_acquire) ==
+        dequeue_pos_.load(std::memory_order_acquire);
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+  // Keep the producer and consumer positions on different cache lines to
+  // avoid the false sharing between submitter and worker.
+  static constexpr size_t kCacheLineSize = 64;
+  typedef char CacheLinePad[kCacheLineSize];
+
+  CacheLinePad pad0_;
+  std::unique_ptr<Cell[]> buffer_;
+  const size_t buffer_mask_;
+  CacheLinePad pad1_;
+  std::atomic<size_t> enqueue_pos_;
+  CacheLinePad pad2_;
+  std::atomic<size_t> dequeue_pos_;
+  CacheLinePad pad3_;
+};
+
+} // namespace runtime
+} // namespace torch_ipex
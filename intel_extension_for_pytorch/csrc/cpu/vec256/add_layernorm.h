@@ -0,0 +1,144 @@
+#pragma once
+
+#include <immintrin.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <c10/util/irange.h>
+#include "utils.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+namespace vec {
+namespace vec256 {
+
+using Tensor = at::Tensor;
+
+template <typename T>
+std::pair<float, float> _add_and_compute_mean_var(
+    const T* a_ptr,
+    const T* b_ptr,
+    const int& size,
+    float* out) {
+  // compute add and mean/var of the value after add
+  // we should firstly store add value
+  auto vec_acc_mean = _mm256_setzero_ps();
+  auto vec_acc_pow = _mm256_setzero_ps();
+
+  int i = 0;
+  for (; i <= size - 8; i += 8) {
+    auto vec_a = _loadu(a_ptr + i);
+    auto vec_b = _loadu(b_ptr + i);
+    auto vec_add = _mm256_add_ps(vec_a, vec_b);
+    vec_acc_mean = _mm256_add_ps(vec_add, vec_acc_mean);
+    _mm256_storeu_ps(out + i, vec_add);
+    vec_acc_pow = _mm256_fmadd_ps(vec_add, vec_add, vec_acc_pow);
+  }
+
+  if (i < size) {
+    // The zero lanes beyond the tail don't change the sums.
+    auto vec_a = _maskz_loadu(a_ptr + i, size - i);
+    auto vec_b = _maskz_loadu(b_ptr + i, size - i);
+    auto vec_add = _mm256_add_ps(vec_a, vec_b);
+    _mask_storeu(out + i, vec_add, size - i);
+    vec_acc_mean = _mm256_add_ps(vec_add, vec_acc_mean);
+    vec_acc_pow = _mm256_fmadd_ps(vec_add, vec_add, vec_acc_pow);
+  }
+  float mean_var = _reduce_add_ps(vec_acc_mean) / float(size);
+  float var_val = _reduce_add_ps(vec_acc_pow);
+  return std::make_pair(mean_var, var_val);
+}
+
+template <typename T, typename T1>
+void _normalize_kernel(
+    T* out_ptr,
+    const float* input_ptr,
+    const int& size,
+    float scale,
+    float bias,
+    const T1* gamma_ptr,
+    const T1* beta_ptr) {
+  auto vec_one = _mm256_set1_ps(1.0);
+  auto vec_zero = _mm256_set1_ps(0.0);
+  auto vec_scale = _mm256_set1_ps(scale);
+  auto vec_bias = _mm256_set1_ps(bias);
+  int i = 0;
+  for (; i <= size - 8; i += 8) {
+    auto vec_input = _loadu(input_ptr + i);
+    auto vec_gamma = vec_one;
+    auto vec_beta = vec_zero;
+    if (gamma_ptr) {
+      vec_gamma = _loadu(gamma_ptr + i);
+    }
+    if (beta_ptr) {
+      vec_beta = _loadu(beta_ptr + i);
+    }
+    //(a_ptr[i] * scale + bias) * gamma + beta;
+    auto vec_norm = _mm256_fmadd_ps(vec_input, vec_scale, vec_bias);
+    auto vec_res = _mm256_fmadd_ps(vec_norm, vec_gamma, vec_beta);
+    _storeu(out_ptr + i, vec_res);
+  }
+  if (i < size) {
+    auto vec_input = _maskz_loadu(input_ptr + i, size - i);
+    auto vec_gamma = vec_one;
+    auto vec_beta = vec_zero;
+    if (gamma_ptr) {
+      vec_gamma = _maskz_loadu(gamma_ptr + i, size - i);
+    }
+    if (beta_ptr) {
+      vec_beta = _maskz_loadu(beta_ptr + i, size - i);
+    }
+    //(a_ptr[i] * scale + bias) * gamma + beta;
+    auto vec_norm = _mm256_fmadd_ps(vec_input, vec_scale, vec_bias);
+    auto vec_res = _mm256_fmadd_ps(vec_norm, vec_gamma, vec_beta);
+    _mask_storeu(out_ptr + i, vec_res, size - i);
+  }
+}
+
+template <typename T, typename T1>
+void AddLayerNormKernelImpl(
+    const Tensor& a,
+    const at::Tensor& b,
+    int alpha,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    T eps,
+    Tensor& Y) {
+  DCHECK_EQ(a.numel(), M * N);
+  DCHECK(!gamma.defined() || gamma.numel() == N);
+  DCHECK(!beta.defined() || beta.numel() == N);
+  const T* a_data = a.data_ptr<T>();
+  const T* b_data = b.data_ptr<T>();
+  const T1* gamma_data = gamma.defined() ? gamma.data_ptr<T1>() : nullptr;
+  const T1* beta_data = beta.defined() ? beta.data_ptr<T1>() : nullptr;
+  T* Y_data = Y.data_ptr<T>();
+  const float c = float(1) / static_cast<float>(N);
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    at::Tensor tmp_out = at::empty({N});
+    float* tmp_out_ptr = tmp_out.data_ptr<float>();
+    for (const auto i : c10::irange(start, end)) {
+      const T* a_ptr = a_data + i * N;
+      const T* b_ptr = b_data + i * N;
+      T* Y_ptr = Y_data + i * N;
+      float mean_val;
+      float rstd_val;
+      std::tie(mean_val, rstd_val) =
+          _add_and_compute_mean_var<T>(a_ptr, b_ptr, N, tmp_out_ptr);
+      rstd_val = std::max(rstd_val * c - mean_val * mean_val, float(0));
+      rstd_val = float(1.0) / std::sqrt(rstd_val + eps);
+      float scale = rstd_val;
+      float bias = -rstd_val * mean_val;
+      _normalize_kernel<T, T1>(
+          Y_ptr, tmp_out_ptr, N, scale, bias, gamma_data, beta_data);
+    }
+  });
+}
+
+} // namespace vec256
+} // namespace vec
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,410 @@
+#pragma once
+
+#include <immintrin.h>
+
+#include <ATen/ATen.h>
+#include <ATen/ExpandUtils.h>
+#include <ATen/Parallel.h>
+#include <limits>
+#include "utils.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+namespace vec {
+namespace vec256 {
+
+inline std::vector<int64_t> _adjust_strides(
+    const at::Tensor& src,
+    std::vector<int64_t>& infered_size) {
+  // We does NOT support broadcasting last dim which mean last_dim = 1
+  TORCH_INTERNAL_ASSERT_DEBUG_ONLY(src.stride(src.ndimension() - 1) == 1);
+
+  auto original_shape = src.sizes();
+  auto original_stride = src.strides();
+  auto offset = infered_size.size() - original_shape.size();
+
+  std::vector<int64_t> adjusted_stride;
+  if (offset > 0)
+    adjusted_stride.resize(infered_size.size(), 0);
+  else
+    adjusted_stride.resize(infered_size.size());
+
+  for (size_t i = 0; i < original_shape.size(); i++) {
+    // see NOTE: [Computing output strides]
+    if (original_shape[i] == 1 && infered_size[offset + i] != 1) {
+      adjusted_stride[offset + i] = 0;
+    } else {
+      adjusted_stride[offset + i] = original_stride[i];
+    }
+  }
+
+  return adjusted_stride;
+}
+
+inline int64_t _calc_element_offset(
+    const int64_t& outer_loop_idx,
+    const std::vector<int64_t>& outer_loop_size,
+    const std::vector<int64_t>& outer_loop_strides) {
+  int64_t __outer_loop_idx = outer_loop_idx;
+  int64_t b_offset = 0;
+  for (size_t j = 0; j < outer_loop_size.size(); j++) {
+    auto idx = __outer_loop_idx / outer_loop_size[j];
+    __outer_loop_idx -= idx * outer_loop_size[j];
+    // The stride could be any number if the dim equals to 1
+    b_offset += idx * outer_loop_strides[j];
+  }
+  return b_offset;
+}
+
+inline __m256 _dil_exp_kernel(__m256 vec_src) {
+  static __m256 vec_factorial_1 =
+      _mm256_set1_ps(0.999999701f); // 1/factorial(1)
+  static __m256 vec_factorial_2 =
+      _mm256_set1_ps(0.499991506f); // 1/factorial(2)
+  static __m256 vec_factorial_3 =
+      _mm256_set1_ps(0.166676521f); // 1/factorial(3)
+  static __m256 vec_factorial_4 =
+      _mm256_set1_ps(0.0418978221f); // 1/factorial(4)
+  static __m256 vec_factorial_5 =
+      _mm256_set1_ps(0.00828929059f); // 1/factorial(5)
+  static __m256 vec_exp_log2ef =
+      _mm256_castsi256_ps(_mm256_set1_epi32(0x3fb8aa3b)); // log2(e)
+  static __m256 vec_half = _mm256_set1_ps(0.5f);
+  static __m256 vec_one = _mm256_set1_ps(1.f);
+  static __m256 vec_zero = _mm256_set1_ps(0.f);
+  static __m256 vec_two = _mm256_set1_ps(2.f);
+  static __m256 vec_ln2f =
+      _mm256_castsi256_ps(_mm256_set1_epi32(0x3f317218)); // ln(2)
+  static __m256 vec_ln_flt_min =
+      _mm256_castsi256_ps(_mm256_set1_epi32(0xc2aeac50));
+  static __m256 vec_ln_flt_max =
+      _mm256_castsi256_ps(_mm256_set1_epi32(0x42b17218));
+  static __m256i vec_127 = _mm256_set1_epi32(0x0000007f);
+  static int n_mantissa_bits = 23;
+
+  // exp(x) =
+  // = exp(n * ln(2) + r) // divide x by ln(2) and get quot and rem
+  // = 2^n * exp(r) // simplify the exp(n*ln(2)) expression
+
+  auto less_ln_flt_min_mask =
+      _mm256_cmp_ps(vec_src, vec_ln_flt_min, _CMP_LT_OS);
+  vec_src = _mm256_min_ps(vec_src, vec_ln_flt_max);
+  vec_src = _mm256_max_ps(vec_src, vec_ln_flt_min);
+
+  // fx = floorf(x * log2ef + 0.5)
+  auto vec_fx = _mm256_fmadd_ps(vec_src, vec_exp_log2ef, vec_half);
+  vec_fx = _mm256_floor_ps(vec_fx);
+
+  // x = x - fx * ln2
+  auto vec_exp_poly = _mm256_fnmadd_ps(vec_fx, vec_ln2f, vec_src);
+
+  // compute polynomial
+  auto vec_res =
+      _mm256_fmadd_ps(vec_exp_poly, vec_factorial_5, vec_factorial_4);
+  vec_res = _mm256_fmadd_ps(vec_exp_poly, vec_res, vec_factorial_3);
+  vec_res = _mm256_fmadd_ps(vec_exp_poly, vec_res, vec_factorial_2);
+  vec_res = _mm256_fmadd_ps(vec_exp_poly, vec_res, vec_factorial_1);
+  vec_res = _mm256_fmadd_ps(vec_exp_poly, vec_res, vec_one);
+
+  // compute 2^(n-1)
+  auto vec_exp_number = _mm256_sub_ps(vec_fx, vec_one);
+  auto vec_exp_number_i = _mm256_cvtps_epi32(vec_exp_number);
+  auto vec_two_pow_n_i = _mm256_add_epi32(vec_exp_number_i, vec_127);
+  vec_two_pow_n_i = _mm256_slli_epi32(vec_two_pow_n_i, n_mantissa_bits);
+  auto vec_two_pow_n = _mm256_castsi256_ps(vec_two_pow_n_i);
+  vec_two_pow_n =
+      _mm256_blendv_ps(vec_two_pow_n, vec_zero, less_ln_flt_min_mask);
+
+  // y = y * 2^n
+  vec_res = _mm256_mul_ps(vec_res, vec_two_pow_n);
+  vec_res = _mm256_mul_ps(vec_res, vec_two);
+  return vec_res;
+}
+
+template <typename scalar_t>
+inline void _dil_div_add_reduce_max_fusion_kernel(
+    const scalar_t* a,
+    const scalar_t* b,
+    const float& dim_per_head,
+    const int& size,
+    float* out,
+    float& max) {
+  auto vec_max = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+  auto vec_r_dim_per_head = _mm256_set1_ps(1.0 / dim_per_head);
+
+  int i = 0;
+  for (; i <= size - 8; i += 8) {
+    auto vec_a = _loadu(a + i);
+    auto vec_b = _loadu(b + i);
+    auto vec_out = _mm256_fmadd_ps(vec_a, vec_r_dim_per_head, vec_b);
+    vec_max = _mm256_max_ps(vec_max, vec_out);
+    _mm256_storeu_ps(out + i, vec_out);
+  }
+
+  if (i < size) {
+    auto vec_a = _maskz_loadu(a + i, size - i);
+    auto vec_b = _maskz_loadu(b + i, size - i);
+    auto vec_out = _mm256_fmadd_ps(vec_a, vec_r_dim_per_head, vec_b);
+    vec_max = _mm256_blendv_ps(
+        vec_max, _mm256_max_ps(vec_max, vec_out), _tail_mask(size - i));
+    _mask_storeu(out + i, vec_out, size - i);
+  }
+
+  max = _reduce_max_ps(vec_max);
+}
+
+template <typename scalar_t>
+inline void _dil_maskedfill_div_max_fusion_kernel(
+    const scalar_t* a,
+    const float* b,
+    const float& fill_value,
+    const float& dim_per_head,
+    const int& size,
+    float* out,
+    float& max) {
+  auto vec_fill = _mm256_set1_ps(fill_value);
+  auto vec_max = vec_fill;
+  auto mask_c = _mm256_set1_ps(1.0);
+  auto vec_dim_per_head = _mm256_set1_ps(dim_per_head);
+
+  int i = 0;
+  for (; i <= size - 8; i += 8) {
+    auto vec_a = _loadu(a + i);
+    auto vec_b = _loadu(b + i);
+    auto fill_mask = _mm256_cmp_ps(vec_b, mask_c, _CMP_NEQ_UQ);
+    auto vec_out = _mm256_blendv_ps(
+        vec_fill, _mm256_div_ps(vec_a, vec_dim_per_head), fill_mask);
+    vec_max = _mm256_max_ps(vec_max, vec_out);
+    _mm256_storeu_ps(out + i, vec_out);
+  }
+
+  if (i < size) {
+    auto vec_a = _maskz_loadu(a + i, size - i);
+    auto vec_b = _maskz_loadu(b + i, size - i);
+    auto fill_mask = _mm256_cmp_ps(vec_b, mask_c, _CMP_NEQ_UQ);
+    auto vec_out = _mm256_blendv_ps(
+        vec_fill, _mm256_div_ps(vec_a, vec_dim_per_head), fill_mask);
+    vec_max = _mm256_blendv_ps(
+        vec_max, _mm256_max_ps(vec_max, vec_out), _tail_mask(size - i));
+    _mask_storeu(out + i, vec_out, size - i);
+  }
+
+  max = _reduce_max_ps(vec_max);
+}
+
+inline void _dil_exp_reduce_sum_fusion_kernel(
+    const float* a,
+    const int& size,
+    float* out,
+    float& val) {
+  auto vec_max = _mm256_set1_ps(val);
+  auto vec_sum = _mm256_set1_ps(0.f);
+
+  int i = 0;
+  for (; i <= size - 8; i += 8) {
+    auto vec_a = _mm256_loadu_ps(a + i);
+    auto vec_out = _mm256_sub_ps(vec_a, vec_max);
+    vec_out = _dil_exp_kernel(vec_out);
+    vec_sum = _mm256_add_ps(vec_sum, vec_out);
+    _mm256_storeu_ps(out + i, vec_out);
+  }
+
+  if (i < size) {
+    auto vec_a = _maskz_loadu(a + i, size - i);
+    auto vec_out = _mm256_sub_ps(vec_a, vec_max);
+    vec_out = _dil_exp_kernel(vec_out);
+    vec_sum =
+        _mm256_add_ps(vec_sum, _mm256_and_ps(vec_out, _tail_mask(size - i)));
+    _mask_storeu(out + i, vec_out, size - i);
+  }
+
+  val = _reduce_add_ps(vec_sum);
+}
+
+template <typename scalar_t>
+inline void _dil_normalization_kernel(
+    const float* a,
+    const float& sum,
+    const int& size,
+    scalar_t* out) {
+  auto vec_sum = _mm256_set1_ps(sum);
+
+  int i = 0;
+  for (; i <= size - 8; i += 8) {
+    auto vec_a = _mm256_loadu_ps(a + i);
+    auto vec_out = _mm256_div_ps(vec_a, vec_sum);
+    _storeu(out + i, vec_out);
+  }
+
+  if (i < size) {
+    auto vec_a = _maskz_loadu(a + i, size - i);
+    auto vec_out = _mm256_div_ps(vec_a, vec_sum);
+    _mask_storeu(out + i, vec_out, size - i);
+  }
+}
+
+/**
+ * @brief The AVX2 version of vec512::dil_div_add_softmax.
+ * softmax(alpah * a + b)
+ *
+ * @param[in] a a contiguous tensor to be added
+ * @param[in] b a tensor to be added while it should be broadcastable
+ * @return The tensor stores the result of @code softmax(a + b) @endcode
+ */
+template <typename scalar_t>
+at::Tensor dil_div_add_softmax(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    const float& dim_per_head) {
+  scalar_t* a_data_base = a.data_ptr<scalar_t>();
+  scalar_t* b_data_base = b.data_ptr<scalar_t>();
+
+  // Check if the tensor needs to be broadcasted
+  auto infered_size = a.sizes().vec();
+  auto need_broadcast = (infered_size != b.sizes());
+  if (need_broadcast) {
+    infered_size = at::infer_size(a.sizes(), b.sizes());
+  }
+  at::Tensor output = at::empty_like(a);
+  // Create an new tensor to store the output
+  scalar_t* output_data_base = output.data_ptr<scalar_t>();
+
+  // Calculate the strides for the input tensor
+  std::vector<int64_t> b_adjusted_strides = _adjust_strides(b, infered_size);
+
+  std::vector<int64_t> outer_size_per_dim;
+  int64_t dim_size = infered_size[infered_size.size() - 1];
+  TORCH_INTERNAL_ASSERT_DEBUG_ONLY(dim_size != 1);
+
+  int64_t outer_size = 1;
+  // The last dim is the loop unit. We need to minus 2 to exclude the last dim.
+  // infered_size.size() - 2 is the -2th dimension.
+  for (int64_t i = infered_size.size() - 2; i >= 0; i--) {
+    // Record outer dimensions
+    outer_size_per_dim.insert(outer_size_per_dim.begin(), outer_size);
+    // Calculate outer loop number;
+    outer_size *= infered_size[i];
+  }
+
+  int64_t grain_size = at::internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
+    float val = 0.0;
+    int64_t b_offset = 0;
+    at::Tensor tmp_out = at::empty({dim_size});
+    float* tmp_out_ptr = tmp_out.data_ptr<float>();
+    for (int64_t i = begin; i < end; i++) {
+      if (need_broadcast) {
+        b_offset =
+            _calc_element_offset(i, outer_size_per_dim, b_adjusted_strides);
+      } else {
+        b_offset = i * dim_size;
+      }
+      // Add a and b and get the maximum value:
+      //    output_data = a + b
+      //    val = max(output_data)
+      _dil_div_add_reduce_max_fusion_kernel<scalar_t>(
+          a_data_base + i * dim_size,
+          b_data_base + b_offset,
+          dim_per_head,
+          dim_size,
+          tmp_out_ptr,
+          val);
+      // Calculate the e^x and get the sum value:
+      //    output_data = output_data - max(output_data)
+      //    output_data = e^(output_data)
+      //    val = sum(output_data)
+      _dil_exp_reduce_sum_fusion_kernel(
+          tmp_out_ptr, dim_size, tmp_out_ptr, val);
+      // Calculat the normalization [e^x / sum(e^x)]:
+      //    output_data = output_data / sum(output_data)
+      _dil_normalization_kernel<scalar_t>(
+          tmp_out_ptr, val, dim_size, output_data_base + i * dim_size);
+    }
+  });
+  return output;
+} // dil_add_softmax
+
+/**
+ * @brief The AVX2 version of vec512::dil_div_maskfill_softmax.
+ * softmax(mask? a/dim_per_head : fill value)
+ *
+ * @param[in] a a contiguous tensor to do div and softmax
+ * @param[in] b a mask tensor to be masked_fill into tensor a after div and
+ * before softmax
+ * @return The tensor stores the result of @code softmax(mask? a/dim_per_head :
+ * fill value) @endcode
+ */
+template <typename scalar_t>
+at::Tensor dil_div_maskfill_softmax(
+    const at::Tensor& a, // qk scores
+    const at::Tensor& b, // mask
+    const float& fill_value,
+    const float& dim_per_head) {
+  scalar_t* a_data_base = a.data_ptr<scalar_t>();
+  float* b_data_base = b.data_ptr<float>();
+
+  auto infered_size = a.sizes().vec();
+
+  // Create an new tensor to store the output
+  at::Tensor output = at::empty_like(a);
+  scalar_t* output_data_base = output.data_ptr<scalar_t>();
+
+  int64_t dim_size = infered_size[infered_size.size() - 1];
+  TORCH_INTERNAL_ASSERT_DEBUG_ONLY(dim_size != 1);
+
+  int64_t outer_size = 1;
+  // The last dim is the loop unit. We need to minus 2 to exclude the last dim.
+  // infered_size.size() - 2 is the -2th dimension.
+  for (int64_t i = infered_size.size() - 2; i >= 0; i--) {
+    // Calculate outer loop number;
+    outer_size *= infered_size[i];
+  }
+
+  auto mask_offset = outer_size / infered_size[0];
+
+  int64_t grain_size = at::internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+  at::parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
+    float val = 0.0;
+    at::Tensor tmp_out = at::empty({dim_size});
+    float* tmp_out_ptr = tmp_out.data_ptr<float>();
+    for (int64_t i = begin; i < end; i++) {
+      // mask fill and do div on a and get the maximum value:
+      //    output_data = mask? a/dim_per_head : fill value
+      //    val = max(output_data)
+      int64_t b_offset = (i / mask_offset);
+      // b_offset takes mid dims because the mask is
+      // expand_as a with the mid dims (bs :: seq_length)
+      _dil_maskedfill_div_max_fusion_kernel<scalar_t>(
+          a_data_base + i * dim_size,
+          b_data_base + b_offset * dim_size,
+          fill_value,
+          dim_per_head,
+          dim_size,
+          tmp_out_ptr,
+          val);
+      // Calculate the e^x and get the sum value:
+      //    output_data = output_data - max(output_data)
+      //    output_data = e^(output_data)
+      //    val = sum(output_data)
+      _dil_exp_reduce_sum_fusion_kernel(
+          tmp_out_ptr, dim_size, tmp_out_ptr, val);
+      // Calculat the normalization [e^x / sum(e^x)]:
+      //    output_data = output_data / sum(output_data)
+      _dil_normalization_kernel<scalar_t>(
+          tmp_out_ptr, val, dim_size, output_data_base + i * dim_size);
+    }
+  });
+  return output;
+} // dil_div_maskfill_softmax
+
+} // namespace vec256
+} // namespace vec
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <immintrin.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include "utils.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+namespace vec {
+namespace vec256 {
+
+using Tensor = at::Tensor;
+
+// use float as accumulation type for BFloat16
+template <typename scalar_t>
+struct AccType {
+  using type = scalar_t;
+};
+template <>
+struct AccType<at::BFloat16> {
+  using type = float;
+};
+
+// The float and BFloat16 inputs share the kernel since _loadu/_storeu convert
+// BFloat16 from/to 8 floats.
+template <typename T, typename ACC_T>
+static void _concat_bn_relu_kernel_channels_last(
+    const std::vector<const T*>& in_ptr,
+    const std::vector<int64_t>& in_ch,
+    T* out_ptr,
+    const ACC_T* scale_ptr,
+    const ACC_T* beta_ptr,
+    int64_t total_size_except_channels,
+    int64_t ci,
+    int64_t co) {
+  int64_t i = 0, j = 0, k = 0;
+  auto zero = _mm256_set1_ps(0.0);
+#ifdef _OPENMP
+#if (_OPENMP >= 201307)
+#pragma omp parallel for simd schedule( \
+    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
+#else
+#pragma omp parallel for schedule( \
+    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
+#endif
+#endif
+  for (i = 0; i < total_size_except_channels; ++i) {
+    for (j = 0; j < in_ptr.size(); ++j) {
+      auto concat_in_ptr = in_ptr[j] + i * in_ch[j + 1] - (i + 1) * in_ch[j];
+      for (k = in_ch[j]; k < in_ch[j + 1]; k += 8) {
+        auto in = _loadu(concat_in_ptr + k);
+        auto beta = _mm256_loadu_ps(beta_ptr + k);
+        auto scale = _mm256_loadu_ps(scale_ptr + k);
+        auto bn_out = _mm256_fmadd_ps(scale, in, beta);
+        auto out = _mm256_max_ps(zero, bn_out);
+        _storeu(out_ptr + i * co + k, out);
+      }
+    }
+  }
+}
+
+//  All the fusion conditions have been applied before calling this kernel.
+//  Please refer ../../jit/cpu/passes/graph_rewrite.cpp for details.
+template <typename T>
+void ConcatBnReluKernelImpl_ChannelsLast(
+    const c10::List<Tensor>& a,
+    const Tensor& scale,
+    const Tensor& beta,
+    Tensor& output) {
+  using ACC_T = typename AccType<T>::type;
+  int64_t list_length = a.size();
+  int64_t total_size_except_channels = 1;
+  std::vector<const T*> input_ptr(list_length);
+  std::vector<int64_t> input_channels(list_length + 1);
+
+  for (int64_t i = 0; i < list_length; ++i) {
+    input_channels[i + 1] = input_channels[i] + a[i].size(1);
+    input_ptr[i] = a[i].contiguous(a[i].suggest_memory_format()).data_ptr<T>();
+  }
+  //  Return the product of all the input dimensions except for the channel
+  //  and check if the dimension and sizes of the tensors meet the fusion
+  //  requirements.
+  for (int64_t i = 0; i < a[0].ndimension(); ++i) {
+    if (i != 1)
+      total_size_except_channels *= a[0].size(i);
+  }
+
+  const ACC_T* scale_data = scale.data_ptr<ACC_T>();
+  const ACC_T* beta_data = beta.data_ptr<ACC_T>();
+  T* output_data = output.data_ptr<T>();
+
+  _concat_bn_relu_kernel_channels_last<T, ACC_T>(
+      input_ptr,
+      input_channels,
+      output_data,
+      scale_data,
+      beta_data,
+      total_size_except_channels,
+      a[0].size(1),
+      output.size(1));
+}
+
+} // namespace vec256
+} // namespace vec
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
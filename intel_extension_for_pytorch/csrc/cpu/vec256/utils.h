@@ -0,0 +1,110 @@
+#pragma once
+
+#include <immintrin.h>
+
+#include <ATen/ATen.h>
+#include <cstring>
+
+namespace torch_ipex {
+namespace cpu {
+namespace kernel {
+namespace vec {
+namespace vec256 {
+
+// Conversion from BF16 to FP32
+inline __m256 cvt_bf16_to_fp32(const __m128i src) {
+  auto y = _mm256_cvtepu16_epi32(src);
+  return _mm256_castsi256_ps(_mm256_slli_epi32(y, 16));
+}
+
+// Conversion from FP32 to BF16 with rounding to nearest even
+inline __m128i cvt_fp32_to_bf16(const __m256 src) {
+  __m256i value = _mm256_castps_si256(src);
+  __m256i nan = _mm256_set1_epi32(0xffff);
+  __m256i mask_value =
+      _mm256_castps_si256(_mm256_cmp_ps(src, src, _CMP_ORD_Q));
+  __m256i ones = _mm256_set1_epi32(0x1);
+  __m256i vec_bias = _mm256_set1_epi32(0x7fff);
+  // uint32_t lsb = (input >> 16) & 1;
+  auto t_value = _mm256_and_si256(_mm256_srli_epi32(value, 16), ones);
+  // uint32_t rounding_bias = 0x7fff + lsb;
+  t_value = _mm256_add_epi32(t_value, vec_bias);
+  // input += rounding_bias;
+  t_value = _mm256_add_epi32(t_value, value);
+  // input = input >> 16;
+  t_value = _mm256_srli_epi32(t_value, 16);
+  // Check NaN before converting back to bf16
+  t_value = _mm256_blendv_epi8(nan, t_value, mask_value);
+  // packus works within the 128-bit lanes, gather the low 64 bits of both.
+  t_value = _mm256_packus_epi32(t_value, t_value);
+  t_value = _mm256_permute4x64_epi64(t_value, 0xd8);
+  return _mm256_castsi256_si128(t_value);
+}
+
+// The lanes [0, count) are set, which selects the tail elements since AVX2
+// has no mask registers.
+inline __m256 _tail_mask(int count) {
+  auto index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  return _mm256_castsi256_ps(
+      _mm256_cmpgt_epi32(_mm256_set1_epi32(count), index));
+}
+
+// below is for unaligned data load
+inline __m256 _loadu(const float* data_base) {
+  return _mm256_loadu_ps(data_base);
+}
+
+inline __m256 _loadu(const at::BFloat16* data_base) {
+  return cvt_bf16_to_fp32(_mm_loadu_si128((__m128i*)data_base));
+}
+
+// Load count (< 8) elements, the rest lanes are zero.
+inline __m256 _maskz_loadu(const float* data_base, int count) {
+  return _mm256_maskload_ps(data_base, _mm256_castps_si256(_tail_mask(count)));
+}
+
+inline __m256 _maskz_loadu(const at::BFloat16* data_base, int count) {
+  at::BFloat16 buffer[8] = {};
+  std::memcpy(buffer, data_base, count * sizeof(at::BFloat16));
+  return _loadu(buffer);
+}
+
+// below is for unaligned data store
+inline void _storeu(float* data_base, __m256 a) {
+  _mm256_storeu_ps(data_base, a);
+}
+
+inline void _storeu(at::BFloat16* data_base, __m256 a) {
+  _mm_storeu_si128((__m128i*)data_base, cvt_fp32_to_bf16(a));
+}
+
+// Store the first count (< 8) elements.
+inline void _mask_storeu(float* data_base, __m256 a, int count) {
+  _mm256_maskstore_ps(data_base, _mm256_castps_si256(_tail_mask(count)), a);
+}
+
+inline void _mask_storeu(at::BFloat16* data_base, __m256 a, int count) {
+  at::BFloat16 buffer[8];
+  _storeu(buffer, a);
+  std::memcpy(data_base, buffer, count * sizeof(at::BFloat16));
+}
+
+inline float _reduce_add_ps(__m256 a) {
+  auto v = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  v = _mm_add_ss(v, _mm_movehdup_ps(v));
+  return _mm_cvtss_f32(v);
+}
+
+inline float _reduce_max_ps(__m256 a) {
+  auto v = _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+  v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+  v = _mm_max_ss(v, _mm_movehdup_ps(v));
+  return _mm_cvtss_f32(v);
+}
+
+} // namespace vec256
+} // namespace vec
+} // namespace kernel
+} // namespace cpu
+} // namespace torch_ipex
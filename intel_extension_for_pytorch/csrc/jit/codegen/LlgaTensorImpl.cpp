@@ -1,4 +1,5 @@
 #include "LlgaTensorImpl.h"
+#include "csrc/cpu/runtime/StaticMemoryPlan.h"
 #include "jit/codegen/onednn/runtime.h"
 
 #include <c10/core/CPUAllocator.h>
@@ -26,7 +27,7 @@ Tensor empty_llga(const LlgaTensorDesc& desc, const TensorOptions& options) {
   auto sizes = desc.sizes();
   auto nbytes = desc.storage_size();
 
-  auto allocator = at::GetCPUAllocator();
+  auto allocator = torch_ipex::runtime::get_planned_output_allocator();
   auto storage_impl = c10::make_intrusive<c10::StorageImpl>(
       c10::StorageImpl::use_byte_size_t(),
       nbytes,
@@ -102,6 +102,10 @@ struct LlgaTensorDesc {
     return layout_type_;
   }
 
+  size_t layout_id() const {
+    return layout_id_;
+  }
+
   LlgaTensorDesc layout_type(desc::layout_type new_layout_type) {
     auto ret = *this;
     ret.layout_type_ = new_layout_type;
@@ -117,6 +117,22 @@ RegisterOperators LLGAFusionGroupOp({
         AliasAnalysisKind::PURE_FUNCTION),
 });
 
+namespace {
+// With the dynamic shape of LLGA, the kernel compiles the partition for each
+// input shape, so only the dtype, device, rank and grad mode are checked.
+bool matchTensorIgnoringShape(
+    const c10::TensorTypePtr& type,
+    const at::Tensor& tensor) {
+  bool requires_grad = at::GradMode::is_enabled() && tensor.requires_grad();
+  return type->scalarType().value_or(tensor.scalar_type()) ==
+      tensor.scalar_type() &&
+      type->device().value_or(tensor.device()) == tensor.device() &&
+      type->dim().value_or(tensor.dim()) ==
+      static_cast<size_t>(tensor.dim()) &&
+      type->requiresGrad().value_or(requires_grad) == requires_grad;
+}
+} // namespace
+
 Operation createLlgaGuardKernel(const Node* node) {
   return [node](Stack* stack) {
     IPEX_RECORD_FUNCTION(
@@ -150,7 +166,10 @@ Operation createLlgaGuardKernel(const Node* node) {
         continue;
       }
 
-      if (!guard_tensor_type->matchTensor(tensor)) {
+      bool matched = fuser::onednn::getLlgaDynamicShapeEnabled()
+          ? matchTensorIgnoringShape(guard_tensor_type, tensor)
+          : guard_tensor_type->matchTensor(tensor);
+      if (!matched) {
         GRAPH_DEBUG("input ", i, " check failed, return false");
         push(stack, IValue(false));
         return;
@@ -20,6 +20,27 @@ void setLlgaWeightCacheEnabled(bool enabled);
 
 bool getLlgaWeightCacheEnabled();
 
+// Max number of the compiled partitions cached by each LlgaKernel, 0 means
+// unlimited.
+void setLlgaCompilationCacheCapacity(int64_t capacity);
+int64_t getLlgaCompilationCacheCapacity();
+
+// The shape guard of the LLGA fusion groups only checks the dtype and the
+// rank of the inputs, and the kernels compile the partition for each new
+// shape instead of running the fallback graph.
+void setLlgaDynamicShapeEnabled(bool enabled);
+bool getLlgaDynamicShapeEnabled();
+
+// Sizes the row dim (dim -2) of the inputs is padded up to, so that
+// the lengths in the same bucket share one compiled partition. Only the
+// partitions whose ops compute each row independently are padded.
+void setLlgaShapeBuckets(std::vector<int64_t> buckets);
+std::vector<int64_t> getLlgaShapeBuckets();
+
+// Number of the runs which hit or miss the compiled partitions cached by all
+// the LlgaKernels.
+std::tuple<int64_t, int64_t> getLlgaCompilationCacheStats();
+
 } // namespace onednn
 } // namespace fuser
 
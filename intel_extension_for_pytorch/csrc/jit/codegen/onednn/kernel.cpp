@@ -1,13 +1,20 @@
 #include <omp.h>
 
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+
 #include "kernel.h"
 #include "graph_helper.h"
+#include "interface.h"
 #include "operator.h"
+#include "persistent_cache.h"
 #include "runtime.h"
 
 #include <ATen/core/functional.h>
 #include <ATen/quantized/Quantizer.h>
 #include <torch/csrc/jit/jit_log.h>
+#include "csrc/cpu/runtime/StaticMemoryPlan.h"
 #include "csrc/utils/ipex_op_profile.h"
 
 namespace torch {
@@ -19,13 +26,66 @@ using namespace dnnl::graph;
 
 using data_type = dnnl::graph::logical_tensor::data_type;
 
+namespace {
+// Each kernel usually sees a handful of shapes, a few shards are enough.
+constexpr size_t kCompilationCacheShards = 4;
+
+std::atomic<int64_t> compilation_cache_capacity{64};
+std::atomic<bool> dynamic_shape_enabled{false};
+std::shared_ptr<const std::vector<int64_t>> shape_buckets =
+    std::make_shared<const std::vector<int64_t>>();
+std::atomic<int64_t> compilation_cache_hits{0};
+std::atomic<int64_t> compilation_cache_misses{0};
+} // namespace
+
+void setLlgaCompilationCacheCapacity(int64_t capacity) {
+  TORCH_CHECK(
+      capacity >= 0, "The capacity of the LLGA compilation cache must be >= 0");
+  compilation_cache_capacity.store(capacity);
+}
+
+int64_t getLlgaCompilationCacheCapacity() {
+  return compilation_cache_capacity.load();
+}
+
+void setLlgaDynamicShapeEnabled(bool enabled) {
+  dynamic_shape_enabled.store(enabled);
+}
+
+bool getLlgaDynamicShapeEnabled() {
+  return dynamic_shape_enabled.load();
+}
+
+void setLlgaShapeBuckets(std::vector<int64_t> buckets) {
+  for (auto bucket : buckets) {
+    TORCH_CHECK(bucket > 0, "The LLGA shape buckets must be positive");
+  }
+  std::sort(buckets.begin(), buckets.end());
+  std::atomic_store(
+      &shape_buckets,
+      std::make_shared<const std::vector<int64_t>>(std::move(buckets)));
+}
+
+std::vector<int64_t> getLlgaShapeBuckets() {
+  return *std::atomic_load(&shape_buckets);
+}
+
+std::tuple<int64_t, int64_t> getLlgaCompilationCacheStats() {
+  return std::make_tuple(
+      compilation_cache_hits.load(), compilation_cache_misses.load());
+}
+
 LlgaKernel::LlgaKernel(const Node* fusionNode)
     : fusionNode_(fusionNode),
       graph_(fusionNode->g(attr::Subgraph)),
       nGraphInputs_(graph_->inputs().size()),
       nOutputs_(graph_->outputs().size()),
       debugName_(genDebugName()),
-      profileName_(genProfileName()) {
+      profileName_(genProfileName()),
+      compilations_(
+          getLlgaCompilationCacheCapacity(),
+          nullptr,
+          kCompilationCacheShards) {
   // TODO: This is a workaround to recreate the partitions here.
   // The ideal way is to use the partition serialization API (not available from
   // LLGA now) to carry a serialized string representation from graph rewrite
@@ -39,9 +99,20 @@ LlgaKernel::LlgaKernel(const Node* fusionNode)
       "LLGA subgraph should contain only one partition");
   partition_ = partitions[0];
   nPartitionInputs_ = partition_.get_in_ports().size();
+  rowWise_ = isRowWisePartition();
+  // The mapping of the inputs is not related to the input shapes and
+  // omp_num_threads
+  initializeRunArgs();
+  loadPersistentCompilations();
   GRAPH_DEBUG("Initialized ", debugName(), "\n", graph_->toString());
 }
 
+LlgaKernel::~LlgaKernel() {
+  if (preload_.valid()) {
+    preload_.wait();
+  }
+}
+
 bool LlgaKernel::useOpaqueLayout(size_t offset) const {
   return LlgaNodeWrapper(fusionNode_).useOpaqueLayout(offset);
 }
@@ -107,28 +178,33 @@ void LlgaKernel::initializeConstantInputs() {
   }
 }
 
-ArgSpecs LlgaKernel::initializeInputSpecs(const TensorArgs& inputs) {
-  ArgSpecs inputSpecs;
-  inputSpecs.reserve(nPartitionInputs_);
-  GRAPH_DEBUG("Initializing graph input logical tensors");
-
-  std::map<size_t, int64_t> tensorIdToOccurence =
-      initializeTensorIdToOccurence();
+void LlgaKernel::initializeRunArgs() {
+  GRAPH_DEBUG("Initializing the mapping of graph inputs");
+  tensorIdToOccurence_ = initializeTensorIdToOccurence();
   for (size_t i = 0; i < nGraphInputs_; i++) {
-    auto spec = ArgSpec(graph_->inputs()[i]).supplementTensorInfo(inputs[i]);
-    initializedInputIds_.insert(spec.tid());
-
-    int64_t occurence = tensorIdToOccurence[spec.tid()];
-    inputSpecs.insert(inputSpecs.end(), occurence, spec);
-    runArgsIdx_.insert(runArgsIdx_.end(), occurence, i);
+    auto tid = graph_->inputs()[i]->unique();
+    initializedInputIds_.insert(tid);
+    runArgsIdx_.insert(runArgsIdx_.end(), tensorIdToOccurence_[tid], i);
   }
 
   GRAPH_DEBUG("Initializing constant input tensors");
   initializeConstantInputs();
 
   TORCH_CHECK(
-      inputSpecs.size() + constantValues_.size() == nPartitionInputs_,
+      runArgsIdx_.size() + constantValues_.size() == nPartitionInputs_,
       "Partition inputs are missing");
+}
+
+ArgSpecs LlgaKernel::initializeInputSpecs(const TensorArgs& inputs) const {
+  ArgSpecs inputSpecs;
+  inputSpecs.reserve(nPartitionInputs_);
+  GRAPH_DEBUG("Initializing graph input logical tensors");
+  for (size_t i = 0; i < nGraphInputs_; i++) {
+    auto spec = ArgSpec(graph_->inputs()[i]).supplementTensorInfo(inputs[i]);
+    auto it = tensorIdToOccurence_.find(spec.tid());
+    int64_t occurence = it == tensorIdToOccurence_.end() ? 0 : it->second;
+    inputSpecs.insert(inputSpecs.end(), occurence, spec);
+  }
 
   GRAPH_DEBUG(
       "Concatenating constant input logical tensors to graph input "
@@ -139,11 +215,19 @@ ArgSpecs LlgaKernel::initializeInputSpecs(const TensorArgs& inputs) {
   return inputSpecs;
 }
 
-ArgSpecs LlgaKernel::initializeOutputSpecs() const {
+ArgSpecs LlgaKernel::initializeOutputSpecs(bool dynamicShape) const {
   ArgSpecs outputSpecs;
   outputSpecs.reserve(nOutputs_);
   for (size_t i = 0; i < nOutputs_; i++) {
     auto spec = ArgSpec(graph_->outputs()[i]);
+    if (dynamicShape) {
+      spec = ArgSpec(
+          spec.tid(),
+          {},
+          {},
+          spec.dtype(),
+          dnnl::graph::logical_tensor::property_type::variable);
+    }
 
     if (spec.is_quantized())
       spec = getQuantizedSpec(spec, i);
@@ -155,7 +239,103 @@ ArgSpecs LlgaKernel::initializeOutputSpecs() const {
   return outputSpecs;
 }
 
+bool LlgaKernel::matchGraphInputs(const TensorArgs& inputs) const {
+  for (size_t i = 0; i < nGraphInputs_; i++) {
+    // The tensors between partitions have passed the guard of the upstream
+    // partition.
+    if (inputs[i].is_mkldnn()) {
+      continue;
+    }
+    auto type = graph_->inputs()[i]->type()->cast<TensorType>();
+    if (!type || !type->matchTensor(inputs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LlgaKernel::isRowWisePartition() const {
+  for (size_t i = 0; i < nOutputs_; i++) {
+    // The outputs in opaque layout can't be sliced.
+    if (useOpaqueLayout(i)) {
+      return false;
+    }
+  }
+  for (auto* node : graph_->nodes()) {
+    auto kind = node->kind();
+    if (kind == aten::linear) {
+      // The weight must not be padded.
+      if (node->input(1)->node()->kind() != prim::Constant) {
+        return false;
+      }
+    } else if (kind == aten::layer_norm) {
+      auto normalized_shape = toIValue(node->input(1));
+      if (!normalized_shape.has_value() ||
+          normalized_shape->toIntVector().size() != 1) {
+        return false;
+      }
+    } else if (
+        kind != prim::Constant && kind != prim::ListConstruct &&
+        kind != aten::add && kind != aten::mul && kind != aten::relu &&
+        kind != aten::gelu && kind != aten::sigmoid && kind != aten::tanh &&
+        kind != aten::quantize_per_tensor && kind != aten::dequantize &&
+        kind != aten::to) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int64_t LlgaKernel::getPaddedRows(const TensorArgs& inputs, int64_t& rows)
+    const {
+  if (!rowWise_) {
+    return 0;
+  }
+  auto buckets = std::atomic_load(&shape_buckets);
+  if (buckets->empty()) {
+    return 0;
+  }
+  // The rows are the dim -2 of the input with the highest rank.
+  int64_t max_dim = 1;
+  for (auto& input : inputs) {
+    if (input.is_mkldnn() || input.is_quantized()) {
+      return 0;
+    }
+    if (input.dim() > max_dim) {
+      max_dim = input.dim();
+      rows = input.size(-2);
+    }
+  }
+  if (max_dim < 2) {
+    return 0;
+  }
+  auto bucket = std::lower_bound(buckets->begin(), buckets->end(), rows);
+  if (bucket == buckets->end() || *bucket == rows) {
+    return 0;
+  }
+  return *bucket;
+}
+
+std::vector<int64_t> LlgaKernel::getCacheKey(
+    const ArgSpecs& inputSpecs,
+    int n_thread) {
+  std::vector<int64_t> key{n_thread};
+  for (auto& spec : inputSpecs) {
+    key.push_back(static_cast<int64_t>(spec.dtype()));
+    key.push_back(static_cast<int64_t>(spec.layout_type()));
+    key.push_back(spec.sizes().size());
+    key.insert(key.end(), spec.sizes().begin(), spec.sizes().end());
+    if (spec.is_opaque()) {
+      key.push_back(spec.layout_id());
+    } else if (spec.is_strided()) {
+      key.insert(key.end(), spec.strides().begin(), spec.strides().end());
+    }
+  }
+  return key;
+}
+
 std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
+    const LlgaCompiledPartition& compiled,
     const TensorArgs& inputs,
     TensorArgs& outputs) const {
   IPEX_RECORD_FUNCTION(
@@ -163,7 +343,7 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
 
   RunArgs runInputs, runOutputs;
   for (size_t i = 0; i < runArgsIdx_.size(); i++) {
-    auto spec = inputSpecs_[i];
+    auto spec = compiled.inputSpecs[i];
     auto input = inputs[runArgsIdx_[i]];
     runInputs.push_back(
         {spec.logical_tensor(), Engine::getEngine(), input.data_ptr()});
@@ -171,7 +351,7 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
   for (size_t i = 0; i < constantInputs_.size(); i++) {
     // constantInputSpecs are placed after graphInputSpecs
     auto constantInputSpecIdx = nGraphInputs_ + i;
-    auto constantInputSpec = inputSpecs_[constantInputSpecIdx];
+    auto constantInputSpec = compiled.inputSpecs[constantInputSpecIdx];
     runInputs.push_back(
         {constantInputSpec.logical_tensor(),
          Engine::getEngine(),
@@ -179,12 +359,12 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
   }
 
   for (size_t i = 0; i < nOutputs_; i++) {
-    auto spec = outputSpecs_[i];
+    auto spec = compiled.outputSpecs[i];
     auto opt = c10::TensorOptions(spec.aten_scalar_type()).device(device_);
 
     auto outputId = spec.tid();
-    auto iter = inplacePairs_.find(outputId);
-    if (iter != inplacePairs_.end()) {
+    auto iter = compiled.inplacePairs.find(outputId);
+    if (iter != compiled.inplacePairs.end()) {
       // output reuses one of input tensors
 #ifdef GRAPH_DEBUG_ENABLED
       GRAPH_DEBUG("Inplace computation");
@@ -250,7 +430,8 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
         runOutputs.push_back(
             {spec.logical_tensor(), Engine::getEngine(), qtensor.data_ptr()});
       } else {
-        auto tensor = at::empty_strided(spec.sizes(), spec.strides(), opt);
+        auto tensor = torch_ipex::runtime::empty_strided_planned_output(
+            spec.sizes(), spec.strides(), opt);
         outputs.push_back(tensor);
         runOutputs.push_back(
             {spec.logical_tensor(), Engine::getEngine(), tensor.data_ptr()});
@@ -261,46 +442,200 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
   return std::make_tuple(runInputs, runOutputs);
 }
 
-compiled_partition LlgaKernel::compile(const partition& partition) {
-  auto inputs = fmap(inputSpecs_, toLogicalTensor);
-  auto outputs = fmap(outputSpecs_, toLogicalTensor);
-  auto compilation = partition.compile(inputs, outputs, Engine::getEngine());
-
-  // Since layouts of opaque outputs would be known after compilation,
-  // we need to query them out from compilation and update outputSpecs
+LlgaCompiledPartitionPtr LlgaKernel::compile(
+    const ArgSpecs& inputSpecs,
+    bool dynamicShape) const {
+  auto compiled = std::make_shared<LlgaCompiledPartition>();
+  compiled->inputSpecs = inputSpecs;
+  compiled->outputSpecs = initializeOutputSpecs(dynamicShape);
+  auto& outputSpecs = compiled->outputSpecs;
+
+  auto inputs = fmap(inputSpecs, toLogicalTensor);
+  auto outputs = fmap(outputSpecs, toLogicalTensor);
+  compiled->compilation =
+      partition_.compile(inputs, outputs, Engine::getEngine());
+
+  // Since layouts of opaque outputs (and the shapes of dynamic outputs) would
+  // be known after compilation, we need to query them out from compilation
+  // and update outputSpecs
   for (size_t i = 0; i < nOutputs_; i++) {
-    auto tid = outputSpecs_[i].tid();
-    outputSpecs_[i] =
-        outputSpecs_[i].update_desc(compilation.query_logical_tensor(tid));
+    auto tid = outputSpecs[i].tid();
+    outputSpecs[i] = outputSpecs[i].update_desc(
+        compiled->compilation.query_logical_tensor(tid));
   }
 
   // Build static mapping from output id to input offset
   // in accordance with available inplace options
-  for (auto&& option : compilation.get_inplace_ports()) {
+  for (auto&& option : compiled->compilation.get_inplace_ports()) {
     size_t inputId = option.first;
     size_t outputId = option.second;
     auto inputSpecIter =
-        std::find_if(inputSpecs_.begin(), inputSpecs_.end(), [&](auto& spec) {
+        std::find_if(inputSpecs.begin(), inputSpecs.end(), [&](auto& spec) {
           return spec.tid() == inputId;
         });
-    TORCH_CHECK(inputSpecIter != inputSpecs_.end(), "In-place input not found");
-    auto inputOffset = inputSpecIter - inputSpecs_.begin();
-    inplacePairs_[outputId] = inputOffset;
+    TORCH_CHECK(inputSpecIter != inputSpecs.end(), "In-place input not found");
+    auto inputOffset = inputSpecIter - inputSpecs.begin();
+    compiled->inplacePairs[outputId] = inputOffset;
   }
 
-  return compilation;
+  return compiled;
 }
 
-dnnl::graph::compiled_partition& LlgaKernel::compileAndCache(
-    const dnnl::graph::partition& partition,
-    int n_thread) {
-  // index starts from 0 while min(omp_get_max_threads) = 1
-  int i_thread = n_thread - 1;
-  std::call_once(compilation_initialized_flags_[i_thread], [&]() {
-    GRAPH_DEBUG("Compiling partition for i_thread ", i_thread);
-    compilations_[i_thread] = compile(partition_);
-  });
-  return compilations_[i_thread];
+std::string LlgaKernel::getPartitionSignature() const {
+  std::ostringstream ss;
+  ss << graph_->toString(false);
+  for (size_t i = 0; i < nOutputs_; i++) {
+    ss << useOpaqueLayout(i);
+  }
+  return ss.str();
+}
+
+bool LlgaKernel::decodeCompilationRecord(
+    const std::vector<int64_t>& record,
+    int& n_thread,
+    bool& dynamicShape,
+    ArgSpecs& inputSpecs) const {
+  using logical_tensor = dnnl::graph::logical_tensor;
+  // (dynamic shape flag, thread count, input specs)
+  if (record.size() < 2) {
+    return false;
+  }
+  dynamicShape = record[0] != 0;
+  n_thread = record[1];
+  size_t pos = 2;
+  size_t nInputSpecs = runArgsIdx_.size() + constantValues_.size();
+  for (size_t i = 0; i < nInputSpecs; i++) {
+    if (pos + 3 > record.size()) {
+      return false;
+    }
+    auto dtype = static_cast<data_type>(record[pos++]);
+    auto layoutType = static_cast<logical_tensor::layout_type>(record[pos++]);
+    auto ndims = record[pos++];
+    if (ndims < 0 || pos + ndims > record.size()) {
+      return false;
+    }
+    std::vector<int64_t> sizes(
+        record.begin() + pos, record.begin() + pos + ndims);
+    pos += ndims;
+    size_t tid = i < runArgsIdx_.size()
+        ? graph_->inputs()[runArgsIdx_[i]]->unique()
+        : constantValues_[i - runArgsIdx_.size()]->unique();
+    if (layoutType == logical_tensor::layout_type::opaque) {
+      if (pos + 1 > record.size()) {
+        return false;
+      }
+      inputSpecs.emplace_back(logical_tensor(
+          tid,
+          dtype,
+          sizes,
+          static_cast<size_t>(record[pos++]),
+          logical_tensor::property_type::variable));
+    } else if (layoutType == logical_tensor::layout_type::strided) {
+      if (pos + ndims > record.size()) {
+        return false;
+      }
+      std::vector<int64_t> strides(
+          record.begin() + pos, record.begin() + pos + ndims);
+      pos += ndims;
+      inputSpecs.emplace_back(
+          tid,
+          sizes,
+          strides,
+          dtype,
+          logical_tensor::property_type::variable);
+    } else {
+      return false;
+    }
+  }
+  // The constant inputs keep their own specs.
+  for (size_t i = 0; i < constantValues_.size(); i++) {
+    inputSpecs[runArgsIdx_.size() + i] = ArgSpec(constantValues_[i]);
+  }
+  return pos == record.size();
+}
+
+void LlgaKernel::loadPersistentCompilations() {
+  persistentCachePath_ = getPersistentCachePath(getPartitionSignature());
+  if (persistentCachePath_.empty()) {
+    return;
+  }
+  auto capacity = static_cast<size_t>(getLlgaCompilationCacheCapacity());
+  if (compilations_.get_capacity() != capacity) {
+    compilations_.set_capacity(capacity);
+  }
+  // Only the most recent records which fit the compilation cache are
+  // compiled, the older ones would be evicted right away.
+  struct Preload {
+    std::vector<int64_t> key;
+    ArgSpecs inputSpecs;
+    bool dynamicShape;
+  };
+  std::vector<Preload> preloads;
+  int current_n_thread = omp_get_max_threads();
+  auto records = loadCompilationRecords(persistentCachePath_);
+  for (auto it = records.rbegin();
+       it != records.rend() && preloads.size() < capacity;
+       ++it) {
+    int n_thread;
+    bool dynamicShape;
+    ArgSpecs inputSpecs;
+    if (!decodeCompilationRecord(*it, n_thread, dynamicShape, inputSpecs)) {
+      GRAPH_DEBUG("Skip an invalid compilation record of ", debugName());
+      continue;
+    }
+    // The kernels compiled for other thread counts are not used by this
+    // process.
+    if (n_thread != current_n_thread) {
+      continue;
+    }
+    auto key = getCacheKey(inputSpecs, n_thread);
+    preloadingKeys_.insert(key);
+    preloads.push_back({std::move(key), std::move(inputSpecs), dynamicShape});
+  }
+  if (preloads.empty()) {
+    return;
+  }
+  // The kernel is built by the first run of the graph, which doesn't wait for
+  // the compilations of the other keys.
+  preload_ = std::async(
+      std::launch::async,
+      [this, current_n_thread, preloads = std::move(preloads)]() {
+        // The compilation depends on the threads of the thread building the
+        // kernel.
+        omp_set_num_threads(current_n_thread);
+        // Insert the most recent record last, so it's the last one to be
+        // evicted.
+        for (auto it = preloads.rbegin(); it != preloads.rend(); ++it) {
+          // A stale record only costs its compilation.
+          try {
+            compilations_.insert(
+                it->key, compile(it->inputSpecs, it->dynamicShape), 1);
+          } catch (const std::exception& e) {
+            GRAPH_DEBUG("Failed to compile a cached record: ", e.what());
+            continue;
+          }
+          countPersistentCacheLoad();
+          std::lock_guard<std::mutex> lock(preloadedKeysMutex_);
+          preloadedKeys_.insert(it->key);
+          numPreloadedKeys_.store(preloadedKeys_.size());
+        }
+      });
+}
+
+void LlgaKernel::waitPreloadedKey(const std::vector<int64_t>& key) {
+  if (preload_.valid() && preloadingKeys_.count(key) > 0) {
+    preload_.wait();
+  }
+}
+
+bool LlgaKernel::takePreloadedKey(const std::vector<int64_t>& key) {
+  if (numPreloadedKeys_.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(preloadedKeysMutex_);
+  bool found = preloadedKeys_.erase(key) > 0;
+  numPreloadedKeys_.store(preloadedKeys_.size());
+  return found;
 }
 
 void LlgaKernel::run(Stack& stack) {
@@ -314,48 +649,79 @@ void LlgaKernel::run(Stack& stack) {
     return v.toTensor();
   });
 
-  // Input and output specs are not related to omp_num_threads
-  std::call_once(
-      spec_initialized_flag_,
-      [&](const TensorArgs& inputs) {
-#ifdef GRAPH_DEBUG_ENABLED
-        GRAPH_DEBUG("Initializing input logical tensors");
-#endif
-        inputSpecs_ = initializeInputSpecs(inputs);
+  // Pad the rows of the inputs to the bucket size
+  int64_t rows = 0;
+  int64_t paddedRows = getPaddedRows(inputs, rows);
+  if (paddedRows > 0) {
 #ifdef GRAPH_DEBUG_ENABLED
-        GRAPH_DEBUG("Initializing output logical tensors");
+    GRAPH_DEBUG("Padding ", rows, " rows to ", paddedRows);
 #endif
-        outputSpecs_ = initializeOutputSpecs();
-      },
-      inputs);
-
-  TensorArgs outputs;
-  RunArgs runInputs, runOutputs;
-  dnnl::graph::compiled_partition compilation;
+    for (auto& input : inputs) {
+      if (input.dim() >= 2 && input.size(-2) == rows) {
+        input = at::constant_pad_nd(input, {0, 0, 0, paddedRows - rows});
+      }
+    }
+  }
 
-  int n_thread = omp_get_max_threads();
-  if (n_thread > 0 && n_thread <= MAX_COMPILATION_CACHE_SIZE) {
-#ifdef GRAPH_DEBUG_ENABLED
-    GRAPH_DEBUG("Cached compilation");
-#endif
-    compilation = compileAndCache(partition_, n_thread);
+  auto inputSpecs = initializeInputSpecs(inputs);
+  auto key = getCacheKey(inputSpecs, omp_get_max_threads());
+  LlgaCompiledPartitionPtr compiled;
+  bool hit = compilations_.lookup(key, compiled);
+  if (!hit) {
+    waitPreloadedKey(key);
+    hit = compilations_.lookup(key, compiled);
+  }
+  if (hit) {
+    compilation_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    // The first run of a preloaded key is saved a compilation by the
+    // persistent cache.
+    if (takePreloadedKey(key)) {
+      countPersistentCacheLookup(/* hit */ true);
+    }
   } else {
+    compilation_cache_misses.fetch_add(1, std::memory_order_relaxed);
+    // A preloaded key evicted before its first run doesn't count as a hit
+    // later.
+    takePreloadedKey(key);
 #ifdef GRAPH_DEBUG_ENABLED
-    GRAPH_DEBUG("Runtime compilation");
+    GRAPH_DEBUG("Compiling partition");
 #endif
-    compilation = compile(partition_);
+    // Concurrent runs may compile the same key, the last one is kept.
+    bool dynamicShape = !matchGraphInputs(inputs);
+    compiled = compile(inputSpecs, dynamicShape);
+    if (!persistentCachePath_.empty()) {
+      countPersistentCacheLookup(/* hit */ false);
+      std::vector<int64_t> record{dynamicShape};
+      record.insert(record.end(), key.begin(), key.end());
+      storeCompilationRecord(persistentCachePath_, record);
+    }
+    auto capacity = getLlgaCompilationCacheCapacity();
+    if (compilations_.get_capacity() != static_cast<size_t>(capacity)) {
+      compilations_.set_capacity(capacity);
+    }
+    compilations_.insert(key, compiled, /* nbytes */ 1);
   }
+
+  TensorArgs outputs;
+  RunArgs runInputs, runOutputs;
 #ifdef GRAPH_DEBUG_ENABLED
   GRAPH_DEBUG("Preparing runtime tensors");
 #endif
-  std::tie(runInputs, runOutputs) = prepareRunArgs(inputs, outputs);
+  std::tie(runInputs, runOutputs) = prepareRunArgs(*compiled, inputs, outputs);
 #ifdef GRAPH_DEBUG_ENABLED
   GRAPH_DEBUG("Executing partition");
 #endif
-  compilation.execute(Stream::getStream(), runInputs, runOutputs);
+  compiled->compilation.execute(Stream::getStream(), runInputs, runOutputs);
 #ifdef GRAPH_DEBUG_ENABLED
   GRAPH_DEBUG("Partition executed");
 #endif
+  if (paddedRows > 0) {
+    for (auto& output : outputs) {
+      if (output.dim() >= 2 && output.size(-2) == paddedRows) {
+        output = output.narrow(-2, 0, rows);
+      }
+    }
+  }
   // Update the stack.
   drop(stack, nGraphInputs_);
   for (auto& o : outputs) {
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <set>
 #include <unordered_map>
+#include <vector>
 #include "csrc/jit/codegen/LlgaTensorImpl.h"
 #include "csrc/utils/rw_lock.h"
+#include "csrc/utils/sharded_cache.h"
 #include "graph_helper.h"
 
+#include <c10/util/hash.h>
+
 #include <oneapi/dnnl/dnnl_graph.hpp>
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/jit_log.h>
@@ -21,11 +29,23 @@ using RunArg = dnnl::graph::tensor;
 using RunArgs = std::vector<RunArg>;
 using TensorArgs = std::vector<at::Tensor>;
 
-constexpr int MAX_COMPILATION_CACHE_SIZE = 1024;
+// Partition compiled for one signature of the inputs, with the specs it's
+// compiled for.
+struct LlgaCompiledPartition {
+  ArgSpecs inputSpecs;
+  ArgSpecs outputSpecs;
+  std::unordered_map<size_t, size_t> inplacePairs; // output id -> input offset
+  dnnl::graph::compiled_partition compilation;
+};
+using LlgaCompiledPartitionPtr = std::shared_ptr<const LlgaCompiledPartition>;
+
 class LlgaKernel {
  public:
   explicit LlgaKernel(const Node* fusionNode);
 
+  // Wait for the compilations preloaded in the background.
+  ~LlgaKernel();
+
   void run(Stack& stack);
 
   const std::string& debugName() const {
@@ -54,18 +74,61 @@ class LlgaKernel {
   // constant inputs.
   void initializeConstantInputs();
 
-  ArgSpecs initializeInputSpecs(const TensorArgs& inputs);
+  // Initialize the mapping from the partition inputs to the graph inputs and
+  // the constant inputs, which don't depend on the input shapes.
+  void initializeRunArgs();
+
+  ArgSpecs initializeInputSpecs(const TensorArgs& inputs) const;
+
+  // With dynamicShape, the output shapes are inferred by the compilation
+  // instead of copied from the specialized graph.
+  ArgSpecs initializeOutputSpecs(bool dynamicShape) const;
+
+  // Whether the inputs match the input types of the specialized graph.
+  bool matchGraphInputs(const TensorArgs& inputs) const;
 
-  ArgSpecs initializeOutputSpecs() const;
+  // Whether each output row (dim -2) is computed only from the same rows of
+  // the inputs, so the rows can be padded.
+  bool isRowWisePartition() const;
 
-  dnnl::graph::compiled_partition compile(
-      const dnnl::graph::partition& partition);
+  // Return the padded number of the rows of the inputs, or 0 if the inputs
+  // aren't padded.
+  int64_t getPaddedRows(const TensorArgs& inputs, int64_t& rows) const;
 
-  dnnl::graph::compiled_partition& compileAndCache(
-      const dnnl::graph::partition& partition,
+  static std::vector<int64_t> getCacheKey(
+      const ArgSpecs& inputSpecs,
       int n_thread);
 
+  LlgaCompiledPartitionPtr compile(
+      const ArgSpecs& inputSpecs,
+      bool dynamicShape) const;
+
+  // The partition graph and the layout of the outputs, which identify the
+  // partition in the persistent cache.
+  std::string getPartitionSignature() const;
+
+  // Decode the input specs from a record of the persistent cache, return
+  // false if the record doesn't fit the partition.
+  bool decodeCompilationRecord(
+      const std::vector<int64_t>& record,
+      int& n_thread,
+      bool& dynamicShape,
+      ArgSpecs& inputSpecs) const;
+
+  // Compile the most recent keys recorded in the persistent cache for the
+  // current omp_num_threads in the background, at most the capacity of the
+  // compilation cache.
+  void loadPersistentCompilations();
+
+  // Wait for the background preload if it compiles the key, which is missing
+  // in the compilation cache.
+  void waitPreloadedKey(const std::vector<int64_t>& key);
+
+  // Remove the key from the preloaded keys, return true if it was preloaded.
+  bool takePreloadedKey(const std::vector<int64_t>& key);
+
   std::tuple<RunArgs, RunArgs> prepareRunArgs(
+      const LlgaCompiledPartition& compiled,
       const TensorArgs& inputs,
       TensorArgs& outputs) const;
 
@@ -101,20 +164,29 @@ class LlgaKernel {
   // nPartitionInputs_ = nGraphInputs_ + constantInputs_.size() since Constant
   // inputs are copied to the inside of the subgraph
   int64_t nPartitionInputs_;
-  // We cache the compilation for each omp_num_threads
-  std::vector<dnnl::graph::compiled_partition> compilations_ =
-      std::vector<dnnl::graph::compiled_partition>(MAX_COMPILATION_CACHE_SIZE);
   std::set<size_t> initializedInputIds_;
+  std::map<size_t, int64_t> tensorIdToOccurence_;
   std::vector<Value*> constantValues_;
   TensorArgs constantInputs_;
-  ArgSpecs inputSpecs_;
-  ArgSpecs outputSpecs_;
-  std::unordered_map<size_t, size_t> inplacePairs_; // output id -> input offset
   std::string debugName_;
   std::string profileName_;
-  std::once_flag spec_initialized_flag_;
-  std::vector<std::once_flag> compilation_initialized_flags_ =
-      std::vector<std::once_flag>(MAX_COMPILATION_CACHE_SIZE);
+  bool rowWise_;
+  // Cache file of the partition, "" if the persistent cache is disabled.
+  std::string persistentCachePath_;
+  // The keys compiled from the persistent cache which haven't run yet.
+  std::mutex preloadedKeysMutex_;
+  std::set<std::vector<int64_t>> preloadedKeys_;
+  std::atomic<size_t> numPreloadedKeys_{0};
+  // The keys compiled by the background preload, set before it starts.
+  std::set<std::vector<int64_t>> preloadingKeys_;
+  std::shared_future<void> preload_;
+  // Compiled partitions keyed by the signature of the input specs and
+  // omp_num_threads, in LRU order.
+  torch_ipex::ShardedCache<
+      std::vector<int64_t>,
+      LlgaCompiledPartitionPtr,
+      c10::hash<std::vector<int64_t>>>
+      compilations_;
 };
 
 } // namespace onednn
@@ -0,0 +1,229 @@
+#include "persistent_cache.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#include <oneapi/dnnl/dnnl_graph.h>
+#include <torch/csrc/jit/jit_log.h>
+#include "csrc/dyndisp/DispatchStub.h"
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+namespace {
+constexpr const char* kCacheFormat = "ipex-llga-cache-v1";
+
+std::string read_cache_dir_env() {
+  auto envar = std::getenv("IPEX_LLGA_CACHE_DIR");
+  return envar == nullptr ? "" : envar;
+}
+
+// Guards cache_dir and the updates of the cache files by this process.
+std::mutex cache_mutex;
+std::string cache_dir = read_cache_dir_env();
+std::atomic<int64_t> num_loaded{0};
+std::atomic<int64_t> num_stored{0};
+std::atomic<int64_t> num_hits{0};
+std::atomic<int64_t> num_misses{0};
+
+// The compiled layouts and kernels depend on the ISA level and the oneDNN
+// Graph build.
+const std::string& get_cache_header() {
+  static const std::string header = []() {
+    auto version = dnnl_graph_version();
+    std::ostringstream ss;
+    ss << kCacheFormat << " isa="
+       << torch_ipex::cpu::CPUCapabilityToString(
+              torch_ipex::cpu::get_cpu_capability())
+       << " dnnl_graph=" << version->major << "." << version->minor << "."
+       << version->patch << "-" << version->hash;
+    return ss.str();
+  }();
+  return header;
+}
+
+std::vector<std::vector<int64_t>> read_records(const std::string& path) {
+  std::vector<std::vector<int64_t>> records;
+  std::ifstream file(path);
+  std::string line;
+  if (!file || !std::getline(file, line) || line != get_cache_header()) {
+    return records;
+  }
+  while (std::getline(file, line)) {
+    // Skip the malformed lines, e.g. written by an older appending process.
+    std::istringstream ss(line);
+    std::vector<int64_t> record;
+    int64_t value;
+    while (ss >> value) {
+      record.push_back(value);
+    }
+    if (ss.eof() && !record.empty()) {
+      records.emplace_back(std::move(record));
+    }
+  }
+  return records;
+}
+
+// Move the new records to the end of the records of the file, the file is
+// replaced once for all of them.
+void write_records(
+    const std::string& path,
+    const std::vector<std::vector<int64_t>>& new_records) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  auto records = read_records(path);
+  for (const auto& record : new_records) {
+    records.erase(
+        std::remove(records.begin(), records.end(), record), records.end());
+    records.push_back(record);
+  }
+  if (records.size() > kMaxCompilationRecords) {
+    records.erase(
+        records.begin(),
+        records.end() - static_cast<int64_t>(kMaxCompilationRecords));
+  }
+
+  // Write a private file and rename it over the cache file, the concurrent
+  // writers may drop each other's records but never corrupt the file.
+  auto tmp_path = path + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream file(tmp_path, std::ios::trunc);
+    if (!file) {
+      GRAPH_DEBUG("Failed to open the LLGA cache file ", tmp_path);
+      return;
+    }
+    file << get_cache_header() << "\n";
+    for (const auto& r : records) {
+      for (size_t i = 0; i < r.size(); i++) {
+        file << (i == 0 ? "" : " ") << r[i];
+      }
+      file << "\n";
+    }
+    if (!file.flush()) {
+      GRAPH_DEBUG("Failed to write the LLGA cache file ", tmp_path);
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    GRAPH_DEBUG("Failed to replace the LLGA cache file ", path);
+    std::remove(tmp_path.c_str());
+    return;
+  }
+  num_stored.fetch_add(new_records.size());
+}
+
+// The records stored by this process which aren't written yet, in the order
+// of their last compilation.
+class PendingRecords {
+ public:
+  static PendingRecords& get_instance() {
+    static PendingRecords instance;
+    return instance;
+  }
+
+  ~PendingRecords() {
+    flush();
+  }
+
+  void add(const std::string& path, const std::vector<int64_t>& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& records = records_[path];
+    records.erase(
+        std::remove(records.begin(), records.end(), record), records.end());
+    records.push_back(record);
+  }
+
+  void flush() {
+    std::map<std::string, std::vector<std::vector<int64_t>>> records;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      records.swap(records_);
+    }
+    for (const auto& item : records) {
+      write_records(item.first, item.second);
+    }
+  }
+
+ private:
+  PendingRecords() {
+    // Construct the statics used by flush() first, so that they are still
+    // alive when the records are flushed at exit.
+    get_cache_header();
+    GRAPH_DEBUG("Buffering the LLGA cache records");
+  }
+
+  std::mutex mutex_;
+  std::map<std::string, std::vector<std::vector<int64_t>>> records_;
+};
+} // namespace
+
+void setLlgaPersistentCacheDir(const std::string& dir) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  cache_dir = dir;
+}
+
+std::string getLlgaPersistentCacheDir() {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  return cache_dir;
+}
+
+std::tuple<int64_t, int64_t, int64_t, int64_t> getLlgaPersistentCacheStats() {
+  return std::make_tuple(
+      num_loaded.load(), num_stored.load(), num_hits.load(), num_misses.load());
+}
+
+void countPersistentCacheLoad() {
+  num_loaded.fetch_add(1, std::memory_order_relaxed);
+}
+
+void countPersistentCacheLookup(bool hit) {
+  (hit ? num_hits : num_misses).fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string getPersistentCachePath(const std::string& partitionSignature) {
+  auto dir = getLlgaPersistentCacheDir();
+  if (dir.empty()) {
+    return "";
+  }
+  // Fails if the directory exists, which is fine.
+  mkdir(dir.c_str(), 0755);
+  auto hash = std::hash<std::string>()(get_cache_header() + partitionSignature);
+  std::ostringstream ss;
+  ss << dir << "/llga_" << std::hex << std::setw(16) << std::setfill('0')
+     << hash << ".cache";
+  return ss.str();
+}
+
+std::vector<std::vector<int64_t>> loadCompilationRecords(
+    const std::string& path) {
+  auto records = read_records(path);
+  GRAPH_DEBUG("Read ", records.size(), " compilation records from ", path);
+  return records;
+}
+
+void storeCompilationRecord(
+    const std::string& path,
+    const std::vector<int64_t>& record) {
+  PendingRecords::get_instance().add(path, record);
+}
+
+void flushLlgaPersistentCache() {
+  PendingRecords::get_instance().flush();
+}
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch
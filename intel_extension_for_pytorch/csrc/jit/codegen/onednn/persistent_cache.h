@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+/*
+The persistent cache keeps the signatures of the LLGA partitions compiled by
+the previous processes in a local directory, so that a new process compiles
+them when the partition runs for the first time, instead of compiling each
+shape on its first request.
+
+1. There is one file per partition, named by the hash of the partition graph,
+the ISA level and the oneDNN Graph version. The first line is the version
+header, a file with another header is ignored.
+2. Each following line is one compilation record: the dynamic shape flag
+followed by the key of the compilation in LlgaKernel (thread count and input
+specs). The records are unique and in the order of their last compilation by
+any process, a compiled key moves its record to the end. The file keeps the
+last kMaxCompilationRecords records, and is replaced by a rename so the
+readers never see a partial file.
+3. A kernel compiles the most recent records which fit its compilation cache
+in the background once it's built, a run only waits for them if its key is
+one of the records.
+4. The records compiled by this process are buffered, and written to the
+files by flushLlgaPersistentCache() or when the process exits, so a
+compilation doesn't rewrite the file.
+
+The cache is disabled if the directory is empty, the default directory is
+read from the env IPEX_LLGA_CACHE_DIR.
+*/
+void setLlgaPersistentCacheDir(const std::string& dir);
+std::string getLlgaPersistentCacheDir();
+
+// The records of a partition file are capped to the most recent ones.
+constexpr size_t kMaxCompilationRecords = 256;
+
+// Number of the compilations preloaded from the records, the records stored,
+// the runs which used a preloaded compilation for the first time (hits) and
+// the runs which compiled a key missing in the records (misses).
+std::tuple<int64_t, int64_t, int64_t, int64_t> getLlgaPersistentCacheStats();
+
+void countPersistentCacheLoad();
+void countPersistentCacheLookup(bool hit);
+
+// Path of the cache file of the partition, or "" if the cache is disabled.
+std::string getPersistentCachePath(const std::string& partitionSignature);
+
+// The records of the file, from the oldest to the most recent.
+std::vector<std::vector<int64_t>> loadCompilationRecords(
+    const std::string& path);
+
+// Move the record to the end of the file, or add it if it's new, once the
+// buffered records are flushed.
+void storeCompilationRecord(
+    const std::string& path,
+    const std::vector<int64_t>& record);
+
+// Write the buffered records to their files.
+void flushLlgaPersistentCache();
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch
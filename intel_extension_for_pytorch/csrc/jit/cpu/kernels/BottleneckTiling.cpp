@@ -0,0 +1,564 @@
+#include "BottleneckTiling.h"
+
+#include <ATen/ATen.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+#include "ContextConvolution.h"
+#include "csrc/cpu/ideep/ideep.hpp"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+// The primitive of a conv for a tile shape, whose src and dst are the dense
+// nhwc rows of one image.
+struct TileConv {
+  dnnl::convolution_forward::primitive_desc pd_;
+  dnnl::convolution_forward primitive_;
+};
+
+// The conv1 rows [row_begin_, row_begin_ + rows_) around the first row of a
+// tile, which are read by the conv2 of the tiles on both sides.
+struct BottleneckBoundary {
+  int64_t row_begin_;
+  int64_t rows_;
+  int conv1_;
+};
+
+struct BottleneckTile {
+  // The output rows [row_begin_, row_begin_ + rows_) of the tile.
+  int64_t row_begin_;
+  int64_t rows_;
+  // The conv1 rows computed by the tile and their first row in the conv1
+  // buffer, conv1_ is -1 if all the rows are in the boundaries.
+  int64_t conv1_row_begin_;
+  int64_t conv1_buffer_row_;
+  int conv1_;
+  // The boundaries above and below the tile, -1 for the image edge.
+  int top_boundary_;
+  int bottom_boundary_;
+  // The first row of the conv1 buffer read by conv2.
+  int64_t conv2_buffer_row_;
+  int conv2_;
+  int conv3_;
+  int downsample_;
+};
+
+struct BottleneckTilingPlan {
+  int64_t tile_rows_;
+  // The rows of conv2 padding, a boundary holds 2 * halo_ conv1 rows.
+  int64_t halo_;
+  int64_t height_;
+  int64_t width_;
+  int64_t conv1_channels_;
+  int64_t conv2_channels_;
+  // The boundaries and the tiles of an image index into convs_.
+  std::vector<TileConv> convs_;
+  std::vector<BottleneckBoundary> boundaries_;
+  std::vector<BottleneckTile> tiles_;
+  dnnl::memory::desc scratchpad_desc_;
+};
+
+namespace {
+// The intermediate bytes of a tile per thread for the automatic tile rows,
+// which leaves the rest of L2 to the weights and the input and output rows.
+constexpr int64_t kTileBytesPerThread = 256 * 1024;
+
+int64_t read_tile_rows_env() {
+  auto envar = std::getenv("IPEX_CONV_BOTTLENECK_TILE_ROWS");
+  return envar == nullptr ? -1 : std::strtoll(envar, nullptr, 10);
+}
+
+std::atomic<int64_t> bottleneck_tile_rows{read_tile_rows_env()};
+std::atomic<int64_t> bottleneck_tiled_runs{0};
+
+int64_t get_in_channels(const ContextConvolution& context) {
+  return context.original_desc_.get_dims()[1] * context.groups_;
+}
+
+int64_t get_out_channels(const ContextConvolution& context) {
+  return context.original_desc_.get_dims()[0];
+}
+
+bool is_pointwise(const ContextConvolution& context) {
+  return context.kernel_size_ == std::vector<int64_t>{1, 1} &&
+      context.stride_ == std::vector<int64_t>{1, 1} &&
+      context.padding_ == std::vector<int64_t>{0, 0};
+}
+
+// The kxk conv keeps the spatial size, so that its output rows of a tile only
+// depend on the halo_ input rows around them.
+bool is_same_padded(const ContextConvolution& context) {
+  if (context.kernel_size_.size() != 2 ||
+      context.stride_ != std::vector<int64_t>{1, 1} ||
+      context.dilation_ != std::vector<int64_t>{1, 1}) {
+    return false;
+  }
+  for (int i = 0; i < 2; i++) {
+    if (context.kernel_size_[i] != 2 * context.padding_[i] + 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int64_t choose_tile_rows(
+    int64_t tile_rows,
+    int64_t batch,
+    int64_t height,
+    int64_t row_bytes,
+    int64_t halo) {
+  if (tile_rows == 0) {
+    return 0;
+  }
+  if (tile_rows < 0) {
+    // The intermediates of small batches already stay in the cache.
+    if (batch * height * row_bytes <=
+        omp_get_max_threads() * kTileBytesPerThread) {
+      return 0;
+    }
+    // Each thread runs its own tiles.
+    tile_rows = kTileBytesPerThread / row_bytes;
+  }
+  // The boundaries of a tile must not overlap.
+  tile_rows = std::max({tile_rows, 2 * halo, int64_t(1)});
+  return tile_rows < height ? tile_rows : 0;
+}
+
+// Create the primitive of the conv for `rows` input rows of one image, which
+// are padded by pad_top and pad_bottom rows. Return false if the primitive
+// wants another weight layout than the packed weight.
+bool create_tile_conv(
+    const ContextConvolution& context,
+    int64_t channels,
+    int64_t rows,
+    int64_t width,
+    int64_t pad_top,
+    int64_t pad_bottom,
+    dnnl::memory::data_type data_type,
+    TileConv& conv) {
+  const auto& prepacked_pd = context.conv_params_.pd;
+  auto weights_desc = prepacked_pd.weights_desc();
+  int64_t pad_width = context.padding_[1];
+  int64_t out_rows = rows + pad_top + pad_bottom - context.kernel_size_[0] + 1;
+  int64_t out_width = width + 2 * pad_width - context.kernel_size_[1] + 1;
+
+  dnnl::memory::desc src_desc(
+      {1, channels, rows, width}, data_type, dnnl::memory::format_tag::nhwc);
+  dnnl::memory::desc dst_desc(
+      {1, get_out_channels(context), out_rows, out_width},
+      data_type,
+      dnnl::memory::format_tag::nhwc);
+  dnnl::memory::desc weights_query(
+      weights_desc.dims(), data_type, dnnl::memory::format_tag::any);
+  dnnl::memory::dims strides{1, 1};
+  dnnl::memory::dims dilates{0, 0};
+  dnnl::memory::dims padding_l{pad_top, pad_width};
+  dnnl::memory::dims padding_r{pad_bottom, pad_width};
+
+  dnnl::convolution_forward::primitive_desc pd;
+  if (context.bias_.is_empty()) {
+    pd = dnnl::convolution_forward::primitive_desc(
+        {dnnl::prop_kind::forward_inference,
+         dnnl::algorithm::convolution_direct,
+         src_desc,
+         weights_query,
+         dst_desc,
+         strides,
+         dilates,
+         padding_l,
+         padding_r},
+        context.conv_params_.op_attr,
+        ideep::engine::cpu_engine());
+  } else {
+    pd = dnnl::convolution_forward::primitive_desc(
+        {dnnl::prop_kind::forward_inference,
+         dnnl::algorithm::convolution_direct,
+         src_desc,
+         weights_query,
+         prepacked_pd.bias_desc(),
+         dst_desc,
+         strides,
+         dilates,
+         padding_l,
+         padding_r},
+        context.conv_params_.op_attr,
+        ideep::engine::cpu_engine());
+  }
+  if (pd.weights_desc() != weights_desc) {
+    return false;
+  }
+  conv = TileConv{pd, dnnl::convolution_forward(pd)};
+  return true;
+}
+
+std::shared_ptr<const BottleneckTilingPlan> create_plan(
+    const std::vector<int64_t>& input_sizes,
+    const ContextConvolution& conv1,
+    const ContextConvolution& conv2,
+    const ContextConvolution& conv3,
+    const ContextConvolution* downsample,
+    int64_t tile_rows) {
+  if (input_sizes.size() != 4) {
+    return nullptr;
+  }
+  auto data_type = conv1.conv_params_.pd.src_desc().data_type();
+  if (data_type != dnnl::memory::data_type::f32 &&
+      data_type != dnnl::memory::data_type::bf16) {
+    return nullptr;
+  }
+  if (!is_pointwise(conv1) || !is_same_padded(conv2) ||
+      !is_pointwise(conv3) || (downsample && !is_pointwise(*downsample))) {
+    return nullptr;
+  }
+  // Leave the mismatched channels to the untiled run, which reports them.
+  int64_t channels = input_sizes[1];
+  int64_t conv1_channels = get_out_channels(conv1);
+  int64_t conv2_channels = get_out_channels(conv2);
+  int64_t out_channels = get_out_channels(conv3);
+  if (get_in_channels(conv1) != channels ||
+      get_in_channels(conv2) != conv1_channels ||
+      get_in_channels(conv3) != conv2_channels) {
+    return nullptr;
+  }
+  if (downsample
+          ? (get_in_channels(*downsample) != channels ||
+             get_out_channels(*downsample) != out_channels)
+          : out_channels != channels) {
+    return nullptr;
+  }
+
+  int64_t height = input_sizes[2];
+  int64_t width = input_sizes[3];
+  int64_t halo = conv2.padding_[0];
+  int64_t element_size = data_type == dnnl::memory::data_type::f32 ? 4 : 2;
+  tile_rows = choose_tile_rows(
+      tile_rows,
+      input_sizes[0],
+      height,
+      width * (conv1_channels + conv2_channels) * element_size,
+      halo);
+  if (tile_rows == 0) {
+    return nullptr;
+  }
+
+  auto plan = std::make_shared<BottleneckTilingPlan>();
+  plan->tile_rows_ = tile_rows;
+  plan->halo_ = halo;
+  plan->height_ = height;
+  plan->width_ = width;
+  plan->conv1_channels_ = conv1_channels;
+  plan->conv2_channels_ = conv2_channels;
+
+  // Only the first, the last and the full tiles (and the last boundary)
+  // differ in shape, which share the primitives.
+  using ConvKey =
+      std::tuple<const ContextConvolution*, int64_t, int64_t, int64_t>;
+  std::map<ConvKey, int> conv_ids;
+  auto get_conv = [&](const ContextConvolution& context,
+                      int64_t channels,
+                      int64_t rows,
+                      int64_t pad_top,
+                      int64_t pad_bottom) {
+    auto key = std::make_tuple(&context, rows, pad_top, pad_bottom);
+    auto it = conv_ids.find(key);
+    if (it != conv_ids.end()) {
+      return it->second;
+    }
+    TileConv conv;
+    if (!create_tile_conv(
+            context,
+            channels,
+            rows,
+            width,
+            pad_top,
+            pad_bottom,
+            data_type,
+            conv)) {
+      return -1;
+    }
+    plan->convs_.emplace_back(std::move(conv));
+    int id = static_cast<int>(plan->convs_.size()) - 1;
+    conv_ids.emplace(key, id);
+    return id;
+  };
+
+  // The boundary conv1 rows [row_begin - halo, row_begin + halo) of each
+  // tile but the first one.
+  if (halo > 0) {
+    for (int64_t row_begin = tile_rows; row_begin < height;
+         row_begin += tile_rows) {
+      BottleneckBoundary boundary;
+      boundary.row_begin_ = row_begin - halo;
+      boundary.rows_ = std::min(row_begin + halo, height) - boundary.row_begin_;
+      boundary.conv1_ = get_conv(conv1, channels, boundary.rows_, 0, 0);
+      if (boundary.conv1_ < 0) {
+        return nullptr;
+      }
+      plan->boundaries_.push_back(boundary);
+    }
+  }
+
+  int num_boundaries = static_cast<int>(plan->boundaries_.size());
+  for (int64_t row_begin = 0; row_begin < height; row_begin += tile_rows) {
+    int64_t row_end = std::min(row_begin + tile_rows, height);
+    // conv2 reads the conv1 rows [row_begin - halo, row_end + halo), the
+    // conv1 buffer starts at row_begin - halo.
+    int64_t buffer_begin = row_begin - halo;
+    int64_t conv1_row_end = std::min(row_end + halo, height);
+    int64_t conv2_row_begin = std::max(buffer_begin, int64_t(0));
+
+    BottleneckTile tile;
+    tile.row_begin_ = row_begin;
+    tile.rows_ = row_end - row_begin;
+    // The conv1 rows between the boundaries of the tile.
+    int tile_id = static_cast<int>(plan->tiles_.size());
+    tile.top_boundary_ = halo > 0 && tile_id > 0 ? tile_id - 1 : -1;
+    tile.bottom_boundary_ = halo > 0 && tile_id < num_boundaries ? tile_id : -1;
+    tile.conv1_row_begin_ = row_begin == 0 ? 0 : row_begin + halo;
+    int64_t conv1_compute_end =
+        tile.bottom_boundary_ >= 0 ? row_end - halo : conv1_row_end;
+    tile.conv1_buffer_row_ = tile.conv1_row_begin_ - buffer_begin;
+    tile.conv1_ = -1;
+    if (conv1_compute_end > tile.conv1_row_begin_) {
+      tile.conv1_ = get_conv(
+          conv1, channels, conv1_compute_end - tile.conv1_row_begin_, 0, 0);
+      if (tile.conv1_ < 0) {
+        return nullptr;
+      }
+    }
+    tile.conv2_buffer_row_ = conv2_row_begin - buffer_begin;
+    tile.conv2_ = get_conv(
+        conv2,
+        conv1_channels,
+        conv1_row_end - conv2_row_begin,
+        conv2_row_begin - buffer_begin,
+        row_end + halo - conv1_row_end);
+    tile.conv3_ = get_conv(conv3, conv2_channels, tile.rows_, 0, 0);
+    tile.downsample_ =
+        downsample ? get_conv(*downsample, channels, tile.rows_, 0, 0) : -1;
+    if (tile.conv2_ < 0 || tile.conv3_ < 0 ||
+        (downsample && tile.downsample_ < 0)) {
+      return nullptr;
+    }
+    plan->tiles_.push_back(tile);
+  }
+
+  plan->scratchpad_desc_ = plan->convs_[0].pd_.scratchpad_desc();
+  for (const auto& conv : plan->convs_) {
+    if (conv.pd_.scratchpad_desc().get_size() >
+        plan->scratchpad_desc_.get_size()) {
+      plan->scratchpad_desc_ = conv.pd_.scratchpad_desc();
+    }
+  }
+  return plan;
+}
+
+// The packed weight read by a run, which holds the NUMA-local replica if any.
+struct LocalWeight {
+  std::shared_ptr<const WeightReplica> replica_;
+  const ideep::tensor* weight_ = nullptr;
+  const ideep::tensor* bias_ = nullptr;
+};
+
+LocalWeight get_local_weight(const ContextConvolution& context) {
+  LocalWeight local;
+  local.replica_ = context.weight_replicas_->get_local_replica(
+      context.weight_packed_, context.at_weight_);
+  local.weight_ =
+      local.replica_ ? &local.replica_->weight_ : &context.weight_packed_;
+  local.bias_ = &context.bias_;
+  return local;
+}
+
+void execute_tile_conv(
+    const TileConv& conv,
+    const LocalWeight& weight,
+    void* src,
+    void* dst,
+    const ideep::tensor& scratchpad) {
+  conv.primitive_.execute(
+      ideep::stream::default_stream(),
+      {{DNNL_ARG_SRC,
+        dnnl::memory(conv.pd_.src_desc(), ideep::engine::cpu_engine(), src)},
+       {DNNL_ARG_WEIGHTS, *weight.weight_},
+       {DNNL_ARG_BIAS, *weight.bias_},
+       {DNNL_ARG_DST,
+        dnnl::memory(conv.pd_.dst_desc(), ideep::engine::cpu_engine(), dst)},
+       {DNNL_ARG_SCRATCHPAD, scratchpad}});
+}
+} // namespace
+
+void set_bottleneck_tile_rows(int64_t tile_rows) {
+  bottleneck_tile_rows.store(tile_rows);
+}
+
+int64_t get_bottleneck_tile_rows() {
+  return bottleneck_tile_rows.load();
+}
+
+int64_t get_bottleneck_tiled_runs() {
+  return bottleneck_tiled_runs.load();
+}
+
+std::shared_ptr<const BottleneckTilingPlan> BottleneckTilingCache::get_plan(
+    const std::vector<int64_t>& input_sizes,
+    const ContextConvolution& conv1,
+    const ContextConvolution& conv2,
+    const ContextConvolution& conv3,
+    const ContextConvolution* downsample) {
+  int threads = omp_get_max_threads();
+  int64_t tile_rows = get_bottleneck_tile_rows();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (threads != threads_ || tile_rows != tile_rows_ ||
+      input_sizes != input_sizes_) {
+    plan_ =
+        create_plan(input_sizes, conv1, conv2, conv3, downsample, tile_rows);
+    input_sizes_ = input_sizes;
+    threads_ = threads;
+    tile_rows_ = tile_rows;
+  }
+  return plan_;
+}
+
+void run_tiled_bottleneck(
+    const BottleneckTilingPlan& plan,
+    const ContextConvolution& conv1,
+    const ContextConvolution& conv2,
+    const ContextConvolution& conv3,
+    const ContextConvolution* downsample,
+    const at::Tensor& input,
+    at::Tensor& output) {
+  auto weight1 = get_local_weight(conv1);
+  auto weight2 = get_local_weight(conv2);
+  auto weight3 = get_local_weight(conv3);
+  LocalWeight downsample_weight;
+  if (downsample) {
+    downsample_weight = get_local_weight(*downsample);
+  }
+
+  int64_t batch = input.size(0);
+  int64_t element_size = input.element_size();
+  int64_t input_row_bytes = plan.width_ * input.size(1) * element_size;
+  int64_t output_row_bytes = plan.width_ * output.size(1) * element_size;
+  int64_t conv1_row_bytes = plan.width_ * plan.conv1_channels_ * element_size;
+  int64_t conv2_row_bytes = plan.width_ * plan.conv2_channels_ * element_size;
+  auto input_data = static_cast<char*>(input.data_ptr());
+  auto output_data = static_cast<char*>(output.data_ptr());
+
+  // The boundary rows are computed before any tile overwrites the input rows
+  // of the in-place residual, then the tiles of all the images only read the
+  // input rows they overwrite and run in parallel.
+  int64_t num_boundaries = plan.boundaries_.size();
+  int64_t boundary_bytes = 2 * plan.halo_ * conv1_row_bytes;
+  auto boundary_buffer = at::empty(
+      {batch * num_boundaries * boundary_bytes},
+      input.options().dtype(at::kByte));
+  auto boundary_data = static_cast<char*>(boundary_buffer.data_ptr());
+  auto get_image_input = [&](int64_t n) {
+    return input_data + n * plan.height_ * input_row_bytes;
+  };
+  auto get_boundary = [&](int64_t n, int64_t b) {
+    return boundary_data + (n * num_boundaries + b) * boundary_bytes;
+  };
+
+  // The conv1 rows of a tile with its halo, the conv2 rows of a tile and the
+  // scratchpad of each thread.
+  int threads = at::get_num_threads();
+  int64_t conv1_buffer_bytes =
+      (plan.tile_rows_ + 2 * plan.halo_) * conv1_row_bytes;
+  int64_t conv2_buffer_bytes = plan.tile_rows_ * conv2_row_bytes;
+  auto tile_buffer = at::empty(
+      {threads * (conv1_buffer_bytes + conv2_buffer_bytes)},
+      input.options().dtype(at::kByte));
+  auto tile_data = static_cast<char*>(tile_buffer.data_ptr());
+  std::vector<ideep::tensor> scratchpads(threads);
+  for (auto& scratchpad : scratchpads) {
+    scratchpad = ideep::tensor::make_scratchpad(plan.scratchpad_desc_);
+  }
+
+  at::parallel_for(
+      0, batch * num_boundaries, 1, [&](int64_t begin, int64_t end) {
+        const auto& scratchpad = scratchpads[at::get_thread_num()];
+        for (int64_t i = begin; i < end; i++) {
+          int64_t n = i / num_boundaries;
+          const auto& boundary = plan.boundaries_[i % num_boundaries];
+          execute_tile_conv(
+              plan.convs_[boundary.conv1_],
+              weight1,
+              get_image_input(n) + boundary.row_begin_ * input_row_bytes,
+              get_boundary(n, i % num_boundaries),
+              scratchpad);
+        }
+      });
+
+  int64_t num_tiles = plan.tiles_.size();
+  at::parallel_for(0, batch * num_tiles, 1, [&](int64_t begin, int64_t end) {
+    int tid = at::get_thread_num();
+    const auto& scratchpad = scratchpads[tid];
+    auto conv1_data =
+        tile_data + tid * (conv1_buffer_bytes + conv2_buffer_bytes);
+    auto conv2_data = conv1_data + conv1_buffer_bytes;
+    for (int64_t i = begin; i < end; i++) {
+      int64_t n = i / num_tiles;
+      const auto& tile = plan.tiles_[i % num_tiles];
+      auto image_input = get_image_input(n);
+      if (tile.top_boundary_ >= 0) {
+        const auto& boundary = plan.boundaries_[tile.top_boundary_];
+        std::memcpy(
+            conv1_data,
+            get_boundary(n, tile.top_boundary_),
+            boundary.rows_ * conv1_row_bytes);
+      }
+      if (tile.conv1_ >= 0) {
+        execute_tile_conv(
+            plan.convs_[tile.conv1_],
+            weight1,
+            image_input + tile.conv1_row_begin_ * input_row_bytes,
+            conv1_data + tile.conv1_buffer_row_ * conv1_row_bytes,
+            scratchpad);
+      }
+      if (tile.bottom_boundary_ >= 0) {
+        // The boundary starts halo_ rows above the end of the tile, i.e. at
+        // the row rows_ of the conv1 buffer.
+        const auto& boundary = plan.boundaries_[tile.bottom_boundary_];
+        std::memcpy(
+            conv1_data + tile.rows_ * conv1_row_bytes,
+            get_boundary(n, tile.bottom_boundary_),
+            boundary.rows_ * conv1_row_bytes);
+      }
+      execute_tile_conv(
+          plan.convs_[tile.conv2_],
+          weight2,
+          conv1_data + tile.conv2_buffer_row_ * conv1_row_bytes,
+          conv2_data,
+          scratchpad);
+      auto tile_output = output_data +
+          (n * plan.height_ + tile.row_begin_) * output_row_bytes;
+      if (tile.downsample_ >= 0) {
+        execute_tile_conv(
+            plan.convs_[tile.downsample_],
+            downsample_weight,
+            image_input + tile.row_begin_ * input_row_bytes,
+            tile_output,
+            scratchpad);
+      }
+      execute_tile_conv(
+          plan.convs_[tile.conv3_],
+          weight3,
+          conv2_data,
+          tile_output,
+          scratchpad);
+    }
+  });
+  bottleneck_tiled_runs.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
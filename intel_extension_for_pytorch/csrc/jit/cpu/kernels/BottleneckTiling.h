@@ -0,0 +1,76 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+struct ContextConvolution;
+struct BottleneckTilingPlan;
+
+// The rows of the output tile of the depth-first bottleneck, -1 (the default)
+// chooses them from the intermediate sizes and the thread number, 0 disables
+// the tiling. The default value is read from the env
+// IPEX_CONV_BOTTLENECK_TILE_ROWS.
+void set_bottleneck_tile_rows(int64_t tile_rows);
+int64_t get_bottleneck_tile_rows();
+// The number of the bottleneck runs which ran tiled.
+int64_t get_bottleneck_tiled_runs();
+
+/*
+BottleneckTilingCache keeps the depth-first plan of a fused bottleneck, i.e.
+conv1 (1x1) -> conv2 (kxk) -> conv3 (1x1) + residual, with an optional 1x1
+downsample conv producing the residual. Instead of running every conv on the
+whole input, each image is split into the tiles of output rows, and each
+thread runs the three convs of its (image, tile) pairs with its own tile
+buffers, so that the intermediates of conv1 and conv2 stay in the cache
+before they are read.
+
+1. The conv1 rows are computed once. The halo rows around the first row of
+each tile, needed by the kxk conv2 of the tiles on both sides, are computed
+by a pass before the tiles. That keeps the in-place residual of v1 valid
+since a tile then only reads the input rows which it overwrites, and the
+tiles don't depend on each other.
+2. The plan is only created for the 2D chains whose convs are stride 1 and
+undilated, and whose tile primitives accept the packed weights, the other
+chains run untiled.
+3. The plan is keyed by (input sizes, omp_get_max_threads(), tile rows).
+*/
+class BottleneckTilingCache {
+ public:
+  // Return the plan for the input sizes, nullptr if the bottleneck should run
+  // untiled.
+  std::shared_ptr<const BottleneckTilingPlan> get_plan(
+      const std::vector<int64_t>& input_sizes,
+      const ContextConvolution& conv1,
+      const ContextConvolution& conv2,
+      const ContextConvolution& conv3,
+      const ContextConvolution* downsample);
+
+ private:
+  std::vector<int64_t> input_sizes_;
+  int threads_ = 0;
+  int64_t tile_rows_ = 0;
+  std::shared_ptr<const BottleneckTilingPlan> plan_;
+  std::mutex mutex_;
+};
+
+// Run the bottleneck with the plan. output may be input for the in-place
+// residual without downsample.
+void run_tiled_bottleneck(
+    const BottleneckTilingPlan& plan,
+    const ContextConvolution& conv1,
+    const ContextConvolution& conv2,
+    const ContextConvolution& conv3,
+    const ContextConvolution* downsample,
+    const at::Tensor& input,
+    at::Tensor& output);
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -2,6 +2,9 @@
 
 #include <ATen/Tensor.h>
 
+#include "BottleneckTiling.h"
+#include "ConvolutionParamsCache.h"
+#include "WeightReplica.h"
 #include "csrc/cpu/ideep/ideep.hpp"
 
 namespace torch_ipex {
@@ -28,6 +31,17 @@ struct ContextConvolution final {
   bool weight_is_channels_last_;
   ideep::convolution_forward_params conv_params_;
   ideep::convolution_forward::super conv_desc_;
+  // NUMA-local copies of weight_packed_ for the streams on the other numa
+  // nodes, only used when the numa weight replica is enabled.
+  std::shared_ptr<NumaWeightReplicas> weight_replicas_ =
+      std::make_shared<NumaWeightReplicas>();
+  // The primitives for the input shapes other than the one of conv_params_,
+  // which run with the same weight_packed_.
+  std::shared_ptr<ConvolutionParamsCache> params_cache_ =
+      std::make_shared<ConvolutionParamsCache>();
+  // The depth-first plan of the fused bottleneck whose first conv is this one.
+  std::shared_ptr<BottleneckTilingCache> bottleneck_tiling_ =
+      std::make_shared<BottleneckTilingCache>();
 
   ContextConvolution() = delete;
 
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+#include <memory>
+#include <vector>
+
+#include "csrc/cpu/ideep/ideep.hpp"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+// The weights of a layer and direction in the format of the oneDNN LSTM
+// primitive.
+struct ContextLSTMPackedWeights final {
+  // The sizes and the dtype of the input the weights are packed for. The INT8
+  // weights don't depend on the input, their input_sizes_ are empty.
+  std::vector<int64_t> input_sizes_;
+  at::ScalarType input_dtype_;
+  ideep::tensor weight_ih_;
+  ideep::tensor weight_hh_;
+  // The dense weights and bias in the dtype of the input, the weights are
+  // kept alive for the case that weight_ih_/weight_hh_ are views of them.
+  at::Tensor dense_weight_ih_;
+  at::Tensor dense_weight_hh_;
+  at::Tensor bias_;
+  // The oneDNN scales of the INT8 weights.
+  std::vector<float> weight_scales_;
+};
+
+struct ContextLSTMLayer final {
+  // w_ih and w_hh shuffled to the oneDNN gate order, and b_ih + b_hh.
+  at::Tensor weight_ih_;
+  at::Tensor weight_hh_;
+  at::Tensor bias_;
+  // The FP32/BF16 weights are packed at the first run and re-packed when the
+  // input sizes change. Accessed by std::atomic_load/std::atomic_store, so
+  // that the concurrent runs of a frozen module can share the context.
+  std::shared_ptr<const ContextLSTMPackedWeights> packed_;
+
+  ContextLSTMLayer() = delete;
+
+  ContextLSTMLayer(
+      at::Tensor&& weight_ih,
+      at::Tensor&& weight_hh,
+      at::Tensor&& bias,
+      std::shared_ptr<const ContextLSTMPackedWeights>&& packed)
+      : weight_ih_(std::move(weight_ih)),
+        weight_hh_(std::move(weight_hh)),
+        bias_(std::move(bias)),
+        packed_(std::move(packed)) {}
+
+  ContextLSTMLayer(ContextLSTMLayer&&) = default;
+  ContextLSTMLayer& operator=(ContextLSTMLayer&&) = default;
+};
+
+struct ContextLSTM final {
+  // num_layers * num_directions layers, indexed by
+  // layer * num_directions + direction as the weights of aten::lstm.
+  std::vector<ContextLSTMLayer> layers_;
+  int64_t num_layers_;
+  bool bidirectional_;
+
+  ContextLSTM() = delete;
+
+  ContextLSTM(
+      std::vector<ContextLSTMLayer>&& layers,
+      int64_t num_layers,
+      bool bidirectional)
+      : layers_(std::move(layers)),
+        num_layers_(num_layers),
+        bidirectional_(bidirectional) {}
+
+  ContextLSTM(ContextLSTM&&) = default;
+  ContextLSTM& operator=(ContextLSTM&&) = default;
+
+  ~ContextLSTM() {}
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
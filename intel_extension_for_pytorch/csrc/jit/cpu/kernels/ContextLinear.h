@@ -2,6 +2,7 @@
 
 #include <ATen/Tensor.h>
 
+#include "WeightReplica.h"
 #include "csrc/cpu/ideep/ideep.hpp"
 
 namespace torch_ipex {
@@ -14,6 +15,10 @@ struct ContextLinear final {
   // at_weight is used for autograd and optimizer update
   at::Tensor at_weight_;
   c10::optional<at::Tensor> bias_;
+  // NUMA-local copies of weight_packed_ for the streams on the other numa
+  // nodes, only used when the numa weight replica is enabled.
+  std::shared_ptr<NumaWeightReplicas> weight_replicas_ =
+      std::make_shared<NumaWeightReplicas>();
 
   ContextLinear() = delete;
 
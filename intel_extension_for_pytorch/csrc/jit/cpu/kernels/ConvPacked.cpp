@@ -7,6 +7,7 @@
 #include "csrc/cpu/ideep/IDeepConversions.h"
 #include "csrc/cpu/ideep/ideep.hpp"
 #include "csrc/cpu/ideep/ideep/utils.hpp"
+#include "csrc/cpu/runtime/StaticMemoryPlan.h"
 #include "csrc/utils/ipex_op_profile.h"
 
 namespace torch_ipex {
@@ -14,6 +15,104 @@ namespace cpu {
 namespace detail {
 namespace convolution {
 
+namespace {
+
+// Prepare the primitive for an input shape other than the prepacked one.
+// Return nullptr if the primitive wants another weight layout than the packed
+// weight, since reordering the weight at every run is what convolution_kernel
+// does anyway.
+std::shared_ptr<const ConvolutionParams> prepare_conv_params(
+    const ContextConvolution& context,
+    const at::Tensor& input,
+    const at::Tensor* accumu,
+    const ideep::attr_t& attr) {
+  const ideep::tensor mkldnn_input = itensor_view_from_dense(input);
+  std::vector<int64_t> output_sizes = calc_conv_output_size(
+      input.sizes(),
+      context.original_desc_.get_dims(),
+      context.padding_,
+      context.stride_,
+      context.dilation_);
+  // The dst desc is only read for the fused sum, whose dst is accumu.
+  ideep::tensor dst;
+  if (accumu) {
+    dst = itensor_view_from_dense(*accumu);
+  }
+
+  ideep::convolution_forward_params conv_params;
+  if (context.bias_.is_empty()) {
+    ideep::convolution_forward::prepare(
+        conv_params,
+        mkldnn_input,
+        context.weight_packed_,
+        {output_sizes.begin(), output_sizes.end()},
+        dst,
+        {context.stride_.begin(), context.stride_.end()},
+        {context.dilation_.begin(), context.dilation_.end()},
+        {context.padding_.begin(), context.padding_.end()},
+        {context.padding_.begin(), context.padding_.end()},
+        context.groups_,
+        ideep::scale_t(),
+        ideep::scale_t(),
+        ideep::scale_t(),
+        attr,
+        ideep::algorithm::convolution_direct,
+        ideep::prop_kind::forward_inference);
+  } else {
+    ideep::convolution_forward::prepare(
+        conv_params,
+        mkldnn_input,
+        context.weight_packed_,
+        context.bias_,
+        {output_sizes.begin(), output_sizes.end()},
+        dst,
+        {context.stride_.begin(), context.stride_.end()},
+        {context.dilation_.begin(), context.dilation_.end()},
+        {context.padding_.begin(), context.padding_.end()},
+        {context.padding_.begin(), context.padding_.end()},
+        context.groups_,
+        ideep::scale_t(),
+        ideep::scale_t(),
+        ideep::scale_t(),
+        attr,
+        ideep::algorithm::convolution_direct,
+        ideep::prop_kind::forward_inference);
+  }
+  if (conv_params.pd.weights_desc() !=
+      context.conv_params_.pd.weights_desc()) {
+    return nullptr;
+  }
+  auto conv_desc = ideep::convolution_forward::super(conv_params.pd);
+  return std::make_shared<const ConvolutionParams>(
+      ConvolutionParams{std::move(conv_params), std::move(conv_desc)});
+}
+
+// Get the cached primitive for the input, attr and the current thread number,
+// which is prepared at the first run of the key. Return nullptr if the input
+// should run convolution_kernel.
+std::shared_ptr<const ConvolutionParams> get_cached_conv_params(
+    const ContextConvolution& context,
+    const at::Tensor& input,
+    const at::Tensor* accumu,
+    const ideep::attr_t& attr) {
+  auto& cache = *context.params_cache_;
+  auto input_sizes = input.sizes().vec();
+  int threads = omp_get_max_threads();
+  std::shared_ptr<const ConvolutionParams> params;
+  if (!cache.lookup(input_sizes, attr, threads, params)) {
+    params = prepare_conv_params(context, input, accumu, attr);
+    cache.insert(std::move(input_sizes), attr, threads, params);
+  }
+  if (params) {
+    cache.record_hit();
+  } else {
+    cache.record_fallback();
+  }
+  return params;
+}
+
+} // namespace
+
 c10::intrusive_ptr<ConvolutionOpContext> createConvolutionPrePackOpContext(
     at::Tensor&& weight,
     c10::optional<at::Tensor>&& bias,
@@ -174,8 +273,29 @@ at::Tensor& convolution_bottleneck_run(
   auto& context1 = op_context1->get_conetxt();
   auto& context2 = op_context2->get_conetxt();
   auto& context3 = op_context3->get_conetxt();
+  // Run the row tiles depth-first if the intermediates don't fit in the cache.
+  auto tiling_plan = context1.bottleneck_tiling_->get_plan(
+      input.sizes().vec(), context1, context2, context3, nullptr);
+  if (tiling_plan) {
+    run_tiled_bottleneck(
+        *tiling_plan, context1, context2, context3, nullptr, input, input);
+    return input;
+  }
   if (input.sizes().vec() == context1.conv_params_.pd.src_desc().dims() &&
       omp_get_max_threads() == context1.conv_params_.pd_use_threads) {
+    // Read the NUMA-local replicas of the weights if any.
+    auto weight_replica1 = context1.weight_replicas_->get_local_replica(
+        context1.weight_packed_, context1.at_weight_);
+    const ideep::tensor& weight_packed1 =
+        weight_replica1 ? weight_replica1->weight_ : context1.weight_packed_;
+    auto weight_replica2 = context2.weight_replicas_->get_local_replica(
+        context2.weight_packed_, context2.at_weight_);
+    const ideep::tensor& weight_packed2 =
+        weight_replica2 ? weight_replica2->weight_ : context2.weight_packed_;
+    auto weight_replica3 = context3.weight_replicas_->get_local_replica(
+        context3.weight_packed_, context3.at_weight_);
+    const ideep::tensor& weight_packed3 =
+        weight_replica3 ? weight_replica3->weight_ : context3.weight_packed_;
     auto mkldnn_input = dnnl::memory(
         context1.conv_params_.pd.src_desc(),
         ideep::engine::cpu_engine(),
@@ -195,26 +315,26 @@ at::Tensor& convolution_bottleneck_run(
       desc = context3.conv_params_.pd.scratchpad_desc();
     }
 
-    auto scratchpad = dnnl::memory(desc, ideep::engine::cpu_engine());
+    auto scratchpad = ideep::tensor::make_scratchpad(desc);
 
     context1.conv_desc_.execute(
         ideep::stream::default_stream(),
         {{DNNL_ARG_SRC, mkldnn_input},
-         {DNNL_ARG_WEIGHTS, context1.weight_packed_},
+         {DNNL_ARG_WEIGHTS, weight_packed1},
          {DNNL_ARG_BIAS, context1.bias_},
          {DNNL_ARG_DST, ouput1},
          {DNNL_ARG_SCRATCHPAD, scratchpad}});
     context2.conv_desc_.execute(
         ideep::stream::default_stream(),
         {{DNNL_ARG_SRC, ouput1},
-         {DNNL_ARG_WEIGHTS, context2.weight_packed_},
+         {DNNL_ARG_WEIGHTS, weight_packed2},
          {DNNL_ARG_BIAS, context2.bias_},
          {DNNL_ARG_DST, ouput2},
          {DNNL_ARG_SCRATCHPAD, scratchpad}});
     context3.conv_desc_.execute(
         ideep::stream::default_stream(),
         {{DNNL_ARG_SRC, ouput2},
-         {DNNL_ARG_WEIGHTS, context3.weight_packed_},
+         {DNNL_ARG_WEIGHTS, weight_packed3},
          {DNNL_ARG_BIAS, context3.bias_},
          {DNNL_ARG_DST, mkldnn_input},
          {DNNL_ARG_SCRATCHPAD, scratchpad}});
@@ -245,8 +365,41 @@ at::Tensor convolution_bottleneck_run(
   auto& context4 = op_context4->get_conetxt();
   auto& context3 = op_context3->get_conetxt();
 
+  // Run the row tiles depth-first if the intermediates don't fit in the cache,
+  // context3 is the downsample conv of the residual.
+  auto tiling_plan = context1.bottleneck_tiling_->get_plan(
+      input_.sizes().vec(), context1, context2, context4, &context3);
+  if (tiling_plan) {
+    auto result = at::empty(
+        {input_.size(0),
+         context4.original_desc_.get_dims()[0],
+         input_.size(2),
+         input_.size(3)},
+        input_.options().memory_format(memory_format));
+    run_tiled_bottleneck(
+        *tiling_plan, context1, context2, context4, &context3, input_, result);
+    return result;
+  }
+
   if (input_.sizes().vec() == context1.conv_params_.pd.src_desc().dims() &&
       omp_get_max_threads() == context1.conv_params_.pd_use_threads) {
+    // Read the NUMA-local replicas of the weights if any.
+    auto weight_replica1 = context1.weight_replicas_->get_local_replica(
+        context1.weight_packed_, context1.at_weight_);
+    const ideep::tensor& weight_packed1 =
+        weight_replica1 ? weight_replica1->weight_ : context1.weight_packed_;
+    auto weight_replica2 = context2.weight_replicas_->get_local_replica(
+        context2.weight_packed_, context2.at_weight_);
+    const ideep::tensor& weight_packed2 =
+        weight_replica2 ? weight_replica2->weight_ : context2.weight_packed_;
+    auto weight_replica3 = context3.weight_replicas_->get_local_replica(
+        context3.weight_packed_, context3.at_weight_);
+    const ideep::tensor& weight_packed3 =
+        weight_replica3 ? weight_replica3->weight_ : context3.weight_packed_;
+    auto weight_replica4 = context4.weight_replicas_->get_local_replica(
+        context4.weight_packed_, context4.at_weight_);
+    const ideep::tensor& weight_packed4 =
+        weight_replica4 ? weight_replica4->weight_ : context4.weight_packed_;
     auto mkldnn_input = dnnl::memory(
         context1.conv_params_.pd.src_desc(),
         ideep::engine::cpu_engine(),
@@ -279,32 +432,32 @@ at::Tensor convolution_bottleneck_run(
         desc.get_size()) {
       desc = context4.conv_params_.pd.scratchpad_desc();
     }
-    auto scratchpad = dnnl::memory(desc, ideep::engine::cpu_engine());
+    auto scratchpad = ideep::tensor::make_scratchpad(desc);
     context1.conv_desc_.execute(
         ideep::stream::default_stream(),
         {{DNNL_ARG_SRC, mkldnn_input},
-         {DNNL_ARG_WEIGHTS, context1.weight_packed_},
+         {DNNL_ARG_WEIGHTS, weight_packed1},
          {DNNL_ARG_BIAS, context1.bias_},
          {DNNL_ARG_DST, ouput1},
          {DNNL_ARG_SCRATCHPAD, scratchpad}});
     context2.conv_desc_.execute(
         ideep::stream::default_stream(),
         {{DNNL_ARG_SRC, ouput1},
-         {DNNL_ARG_WEIGHTS, context2.weight_packed_},
+         {DNNL_ARG_WEIGHTS, weight_packed2},
          {DNNL_ARG_BIAS, context2.bias_},
          {DNNL_ARG_DST, ouput2},
          {DNNL_ARG_SCRATCHPAD, scratchpad}});
     context3.conv_desc_.execute(
         ideep::stream::default_stream(),
         {{DNNL_ARG_SRC, mkldnn_input},
-         {DNNL_ARG_WEIGHTS, context3.weight_packed_},
+         {DNNL_ARG_WEIGHTS, weight_packed3},
          {DNNL_ARG_BIAS, context3.bias_},
          {DNNL_ARG_DST, ouput3},
          {DNNL_ARG_SCRATCHPAD, scratchpad}});
     context4.conv_desc_.execute(
         ideep::stream::default_stream(),
         {{DNNL_ARG_SRC, ouput2},
-         {DNNL_ARG_WEIGHTS, context4.weight_packed_},
+         {DNNL_ARG_WEIGHTS, weight_packed4},
          {DNNL_ARG_BIAS, context4.bias_},
          {DNNL_ARG_DST, ouput3},
          {DNNL_ARG_SCRATCHPAD, scratchpad}});
@@ -487,34 +640,49 @@ at::Tensor run(
   if (!is_channels_last_1d(input)) {
     input_ = input.contiguous(memory_format);
   }
-  if (input_.sizes().vec() == context.conv_params_.pd.src_desc().dims() &&
+  // Read the NUMA-local replica of the weight if any.
+  auto weight_replica = context.weight_replicas_->get_local_replica(
+      context.weight_packed_, context.at_weight_);
+  const ideep::tensor& weight_packed =
+      weight_replica ? weight_replica->weight_ : context.weight_packed_;
+  bool use_prepacked =
+      input_.sizes().vec() == context.conv_params_.pd.src_desc().dims() &&
       attr == context.conv_params_.op_attr &&
-      omp_get_max_threads() == context.conv_params_.pd_use_threads) {
-    auto output_sizes = context.conv_params_.pd.dst_desc().dims();
-    auto output = at::empty(
-        output_sizes,
-        input_.options().memory_format(input_.suggest_memory_format()));
+      omp_get_max_threads() == context.conv_params_.pd_use_threads;
+  std::shared_ptr<const ConvolutionParams> cached_params;
+  if (use_prepacked) {
+    context.params_cache_->record_hit();
+  } else {
+    cached_params = get_cached_conv_params(context, input_, nullptr, attr);
+  }
+  if (use_prepacked || cached_params) {
+    const auto& conv_params =
+        use_prepacked ? context.conv_params_ : cached_params->conv_params_;
+    const auto& conv_desc =
+        use_prepacked ? context.conv_desc_ : cached_params->conv_desc_;
+    auto output_sizes = conv_params.pd.dst_desc().dims();
+    at::Tensor output;
     if (input.dim() == 3) {
       std::vector<int64_t> output_strides = {
           (output_sizes[1] * output_sizes[2]), 1, output_sizes[1]};
-      output =
-          at::empty_strided(output_sizes, output_strides, input_.options());
+      output = runtime::empty_strided_planned_output(
+          output_sizes, output_strides, input_.options());
+    } else {
+      output = runtime::empty_planned_output(
+          output_sizes,
+          input_.options().memory_format(input_.suggest_memory_format()));
     }
     const ideep::tensor mkldnn_input = itensor_view_from_dense(input_);
     ideep::tensor mkldnn_output = itensor_view_from_dense(output);
     if (context.bias_.is_empty()) {
       ideep::convolution_forward::compute(
-          context.conv_params_,
-          context.conv_desc_,
-          mkldnn_input,
-          context.weight_packed_,
-          mkldnn_output);
+          conv_params, conv_desc, mkldnn_input, weight_packed, mkldnn_output);
     } else {
       ideep::convolution_forward::compute(
-          context.conv_params_,
-          context.conv_desc_,
+          conv_params,
+          conv_desc,
           mkldnn_input,
-          context.weight_packed_,
+          weight_packed,
           context.bias_,
           mkldnn_output);
     }
@@ -522,7 +690,7 @@ at::Tensor run(
   }
   return convolution_kernel(
       input_,
-      context.weight_packed_,
+      weight_packed,
       context.bias_,
       context.stride_,
       context.padding_,
@@ -555,32 +723,45 @@ at::Tensor& run(
   }
   // always align accumu format with inputs' format.
   accumu = accumu.contiguous(memory_format);
-  if (input_.sizes().vec() == context.conv_params_.pd.src_desc().dims() &&
+  // Read the NUMA-local replica of the weight if any.
+  auto weight_replica = context.weight_replicas_->get_local_replica(
+      context.weight_packed_, context.at_weight_);
+  const ideep::tensor& weight_packed =
+      weight_replica ? weight_replica->weight_ : context.weight_packed_;
+  bool use_prepacked =
+      input_.sizes().vec() == context.conv_params_.pd.src_desc().dims() &&
       attr == context.conv_params_.op_attr &&
-      omp_get_max_threads() == context.conv_params_.pd_use_threads) {
+      omp_get_max_threads() == context.conv_params_.pd_use_threads;
+  std::shared_ptr<const ConvolutionParams> cached_params;
+  if (use_prepacked) {
+    context.params_cache_->record_hit();
+  } else {
+    cached_params = get_cached_conv_params(context, input_, &accumu, attr);
+  }
+  if (use_prepacked || cached_params) {
+    const auto& conv_params =
+        use_prepacked ? context.conv_params_ : cached_params->conv_params_;
+    const auto& conv_desc =
+        use_prepacked ? context.conv_desc_ : cached_params->conv_desc_;
     const ideep::tensor mkldnn_input = itensor_view_from_dense(input_);
     ideep::tensor mkldnn_output = itensor_view_from_dense(accumu);
 
     if (context.bias_.is_empty()) {
       ideep::convolution_forward::compute(
-          context.conv_params_,
-          context.conv_desc_,
-          mkldnn_input,
-          context.weight_packed_,
-          mkldnn_output);
+          conv_params, conv_desc, mkldnn_input, weight_packed, mkldnn_output);
     } else {
       ideep::convolution_forward::compute(
-          context.conv_params_,
-          context.conv_desc_,
+          conv_params,
+          conv_desc,
           mkldnn_input,
-          context.weight_packed_,
+          weight_packed,
           context.bias_,
           mkldnn_output);
     }
   } else {
     convolution_kernel_output(
         input_,
-        context.weight_packed_,
+        weight_packed,
         context.bias_,
         accumu,
         context.stride_,
@@ -0,0 +1,58 @@
+#include "ConvolutionParamsCache.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+bool ConvolutionParamsCache::lookup(
+    const std::vector<int64_t>& input_sizes,
+    const ideep::attr_t& attr,
+    int threads,
+    std::shared_ptr<const ConvolutionParams>& params) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->threads_ == threads && it->input_sizes_ == input_sizes &&
+        it->attr_ == attr) {
+      entries_.splice(entries_.begin(), entries_, it);
+      params = entries_.front().params_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ConvolutionParamsCache::insert(
+    std::vector<int64_t> input_sizes,
+    ideep::attr_t attr,
+    int threads,
+    std::shared_ptr<const ConvolutionParams> params) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Another thread may have prepared the same key meanwhile.
+  for (auto& entry : entries_) {
+    if (entry.threads_ == threads && entry.input_sizes_ == input_sizes &&
+        entry.attr_ == attr) {
+      return;
+    }
+  }
+  misses_++;
+  entries_.push_front(Entry{
+      std::move(input_sizes), std::move(attr), threads, std::move(params)});
+  while (entries_.size() > capacity_) {
+    entries_.pop_back();
+    evictions_++;
+  }
+}
+
+ConvolutionParamsCacheStats ConvolutionParamsCache::get_stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ConvolutionParamsCacheStats{
+      hits_.load(),
+      misses_.load(),
+      fallbacks_.load(),
+      evictions_,
+      static_cast<int64_t>(entries_.size())};
+}
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
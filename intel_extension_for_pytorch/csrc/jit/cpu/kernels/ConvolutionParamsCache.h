@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "csrc/cpu/ideep/ideep.hpp"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+// The primitive of a convolution prepared for an input shape other than the
+// one given at prepack time.
+struct ConvolutionParams {
+  ideep::convolution_forward_params conv_params_;
+  ideep::convolution_forward::super conv_desc_;
+};
+
+struct ConvolutionParamsCacheStats {
+  // runs served by the prepacked primitive or a cached one
+  int64_t hits;
+  // primitives prepared for a new (input sizes, attr, threads)
+  int64_t misses;
+  // runs which went to convolution_kernel since the primitive wants another
+  // weight layout than the packed weight
+  int64_t fallbacks;
+  int64_t evictions;
+  int64_t num_entries;
+};
+
+/*
+ConvolutionParamsCache keeps the primitives of a ConvolutionOpContext for the
+input shapes, fused attrs and thread numbers other than the prepacked one, so
+that the inputs with several resolutions still run the prepacked weight
+without creating the primitive at every run.
+
+1. The entries are keyed by (input sizes, attr, omp_get_max_threads()), and
+the least recently used one is evicted beyond the capacity.
+2. An entry with null params marks a key whose primitive wants another weight
+layout, which runs convolution_kernel instead of being prepared again.
+*/
+class ConvolutionParamsCache {
+ public:
+  static constexpr size_t kDefaultCapacity = 8;
+
+  explicit ConvolutionParamsCache(size_t capacity = kDefaultCapacity)
+      : capacity_(capacity) {}
+
+  // Return true if the key is cached, params is null if the key falls back.
+  bool lookup(
+      const std::vector<int64_t>& input_sizes,
+      const ideep::attr_t& attr,
+      int threads,
+      std::shared_ptr<const ConvolutionParams>& params);
+
+  void insert(
+      std::vector<int64_t> input_sizes,
+      ideep::attr_t attr,
+      int threads,
+      std::shared_ptr<const ConvolutionParams> params);
+
+  void record_hit() {
+    hits_++;
+  }
+
+  void record_fallback() {
+    fallbacks_++;
+  }
+
+  ConvolutionParamsCacheStats get_stats();
+
+ private:
+  struct Entry {
+    std::vector<int64_t> input_sizes_;
+    ideep::attr_t attr_;
+    int threads_;
+    std::shared_ptr<const ConvolutionParams> params_;
+  };
+
+  // The most recently used entry is at the front.
+  std::list<Entry> entries_;
+  size_t capacity_;
+  std::mutex mutex_;
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+  std::atomic<int64_t> fallbacks_{0};
+  int64_t evictions_ = 0;
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -142,7 +142,12 @@ at::Tensor run(
   c10::MaybeOwned<at::Tensor> bias_maybe_owned =
       at::borrow_from_optional_tensor(context.bias_);
   const at::Tensor& bias = *bias_maybe_owned;
-  return linear_kernel(input_, context.weight_packed_, bias, attr);
+  // Read the NUMA-local replica of the weight if any.
+  auto weight_replica = context.weight_replicas_->get_local_replica(
+      context.weight_packed_, context.at_weight_);
+  const ideep::tensor& weight_packed =
+      weight_replica ? weight_replica->weight_ : context.weight_packed_;
+  return linear_kernel(input_, weight_packed, bias, attr);
 }
 
 at::Tensor& run(
@@ -154,7 +159,12 @@ at::Tensor& run(
   c10::MaybeOwned<at::Tensor> bias_maybe_owned =
       at::borrow_from_optional_tensor(context.bias_);
   const at::Tensor& bias = *bias_maybe_owned;
-  linear_kernel_output(input_, context.weight_packed_, bias, accumu, attr);
+  // Read the NUMA-local replica of the weight if any.
+  auto weight_replica = context.weight_replicas_->get_local_replica(
+      context.weight_packed_, context.at_weight_);
+  const ideep::tensor& weight_packed =
+      weight_replica ? weight_replica->weight_ : context.weight_packed_;
+  linear_kernel_output(input_, weight_packed, bias, accumu, attr);
   return accumu;
 }
 
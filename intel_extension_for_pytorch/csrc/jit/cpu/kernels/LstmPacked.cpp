@@ -0,0 +1,143 @@
+#include "LstmPacked.h"
+#include <ATen/autocast_mode.h>
+#include "csrc/aten/cpu/RNN.h"
+#include "csrc/autocast/autocast_mode.h"
+#include "csrc/utils/ipex_op_profile.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace lstm {
+
+c10::intrusive_ptr<LstmOpContext> createLstmPrePackOpContext(
+    std::vector<at::Tensor>&& weights,
+    bool has_biases,
+    int64_t num_layers,
+    bool bidirectional) {
+  IPEX_RECORD_FUNCTION(
+      "ipex_prepack::createLstmPrePackOpContext", std::vector<c10::IValue>({}));
+
+  return IpexLstmOpContext::create_context(
+      std::move(weights), has_biases, num_layers, bidirectional);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> lstm_run(
+    const at::Tensor& input,
+    std::vector<at::Tensor> hx,
+    const c10::intrusive_ptr<LstmOpContext>& op_context,
+    bool batch_first) {
+  IPEX_RECORD_FUNCTION("ipex_prepack::lstm_run", std::vector<c10::IValue>({}));
+
+  // torch_ipex::ipex_lstm is casted at ipex_lstm_layer under autocast, do the
+  // same cast here since the prepacked run doesn't go through the dispatcher.
+  if (at::autocast::is_cpu_enabled() &&
+      torch_ipex::autocast::get_autocast_dtype() == at::kBFloat16) {
+    auto casted_input =
+        torch_ipex::autocast::cpu_cached_cast(at::kBFloat16, input);
+    for (auto& h : hx) {
+      h = torch_ipex::autocast::cpu_cached_cast(at::kBFloat16, h);
+    }
+    return op_context->run(
+        casted_input, hx, batch_first, /*scale*/ -1., /*zp*/ -1, /*dtype*/ -1);
+  }
+  return op_context->run(
+      input, hx, batch_first, /*scale*/ -1., /*zp*/ -1, /*dtype*/ -1);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> quantized_lstm_run(
+    const at::Tensor& input,
+    std::vector<at::Tensor> hx,
+    const c10::intrusive_ptr<LstmOpContext>& op_context,
+    bool batch_first,
+    double scale,
+    int64_t zp,
+    int64_t dtype) {
+  IPEX_RECORD_FUNCTION(
+      "ipex_prepack::quantized_lstm_run", std::vector<c10::IValue>({}));
+
+  return op_context->run(input, hx, batch_first, scale, zp, dtype);
+}
+
+ContextLSTM create(
+    const std::vector<at::Tensor>& weights,
+    bool has_biases,
+    int64_t num_layers,
+    bool bidirectional) {
+  int64_t num_directions = bidirectional ? 2 : 1;
+  int64_t weight_stride0 = has_biases ? 4 : 2;
+  TORCH_CHECK(
+      static_cast<int64_t>(weights.size()) ==
+          num_layers * num_directions * weight_stride0,
+      "ipex_prepack::lstm_prepack: expected ",
+      num_layers * num_directions * weight_stride0,
+      " weights but got ",
+      weights.size());
+
+  std::vector<ContextLSTMLayer> layers;
+  layers.reserve(num_layers * num_directions);
+  for (int64_t index = 0; index < num_layers * num_directions; index++) {
+    auto layer_weights = weights.begin() + index * weight_stride0;
+    layers.emplace_back(lstm_prepack_layer(
+        layer_weights[0],
+        layer_weights[1],
+        has_biases ? layer_weights[2] : at::Tensor(),
+        has_biases ? layer_weights[3] : at::Tensor(),
+        has_biases));
+  }
+  return ContextLSTM{std::move(layers), num_layers, bidirectional};
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> run(
+    ContextLSTM& context,
+    const at::Tensor& input,
+    const std::vector<at::Tensor>& hx,
+    bool batch_first,
+    double scale,
+    int64_t zp,
+    int64_t dtype) {
+  TORCH_CHECK(
+      hx.size() == 2,
+      "ipex_prepack::lstm_run: expected hx to be the list of the hidden and "
+      "cell states");
+  auto layer_input = batch_first ? input.transpose(0, 1) : input;
+  layer_input = layer_input.contiguous();
+  auto h = hx[0].contiguous();
+  auto c = hx[1].contiguous();
+
+  int64_t num_directions = context.bidirectional_ ? 2 : 1;
+  std::vector<at::Tensor> layer_output(num_directions);
+  std::vector<at::Tensor> layer_hy(context.num_layers_ * num_directions);
+  std::vector<at::Tensor> layer_cy(context.num_layers_ * num_directions);
+  for (int64_t layer = 0; layer < context.num_layers_; layer++) {
+    for (int64_t direction = 0; direction < num_directions; direction++) {
+      auto index = layer * num_directions + direction;
+      auto outputs = lstm_prepacked_layer_forward(
+          layer_input,
+          context.layers_[index],
+          h[index],
+          c[index],
+          /*reverse*/ direction > 0,
+          scale,
+          zp,
+          dtype);
+      layer_output[direction] = outputs[0];
+      layer_hy[index] = outputs[1];
+      layer_cy[index] = outputs[2];
+    }
+    layer_input = num_directions == 1
+        ? layer_output[0]
+        : at::cat(layer_output, /*output_channels*/ -1);
+  }
+  auto output = layer_input;
+  if (batch_first) {
+    output = output.transpose(0, 1);
+  }
+  auto hy = at::stack(layer_hy, 0);
+  auto cy = at::stack(layer_cy, 0);
+  return std::make_tuple(output, hy, cy);
+}
+
+} // namespace lstm
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
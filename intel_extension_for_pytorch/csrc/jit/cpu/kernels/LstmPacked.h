@@ -0,0 +1,51 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include "ContextLSTM.h"
+#include "OpContext.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace lstm {
+
+c10::intrusive_ptr<LstmOpContext> createLstmPrePackOpContext(
+    std::vector<at::Tensor>&& weights,
+    bool has_biases,
+    int64_t num_layers,
+    bool bidirectional);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> lstm_run(
+    const at::Tensor& input,
+    std::vector<at::Tensor> hx,
+    const c10::intrusive_ptr<LstmOpContext>& op_context,
+    bool batch_first);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> quantized_lstm_run(
+    const at::Tensor& input,
+    std::vector<at::Tensor> hx,
+    const c10::intrusive_ptr<LstmOpContext>& op_context,
+    bool batch_first,
+    double scale,
+    int64_t zp,
+    int64_t dtype);
+
+ContextLSTM create(
+    const std::vector<at::Tensor>& weights,
+    bool has_biases,
+    int64_t num_layers,
+    bool bidirectional);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> run(
+    ContextLSTM& context,
+    const at::Tensor& input,
+    const std::vector<at::Tensor>& hx,
+    bool batch_first,
+    double scale,
+    int64_t zp,
+    int64_t dtype);
+
+} // namespace lstm
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
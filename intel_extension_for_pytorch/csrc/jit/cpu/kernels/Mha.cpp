@@ -2,8 +2,10 @@
 #include "Softmax.h"
 #include "csrc/aten/cpu/AddSoftmax.h"
 #include "csrc/aten/cpu/DivSoftmax.h"
+#include "csrc/aten/cpu/FlashAttention.h"
 
 #include <ATen/Context.h>
+#include <ATen/ExpandUtils.h>
 #include <ATen/InferSize.h>
 #include <c10/util/Exception.h>
 #include <c10/util/Logging.h>
@@ -17,6 +19,40 @@
 namespace torch_ipex {
 namespace cpu {
 
+namespace {
+
+// The streaming attention kernel handles the 4D q [B, H, M, D], key
+// [B, H, N, D] and v [B, H, N, Dv] of the same floating dtype, with the
+// softmax on the last dim and a mask broadcastable to the scores.
+bool can_use_flash_attention(
+    const at::Tensor& q,
+    const at::Tensor& key,
+    const at::Tensor& v,
+    const at::Tensor& mask,
+    const int64_t& softmax_dim,
+    const at::IValue& dtype) {
+  if (q.dim() != 4 || key.dim() != 4 || v.dim() != 4) {
+    return false;
+  }
+  if (!(softmax_dim == -1 || softmax_dim == 3) || !dtype.isNone()) {
+    return false;
+  }
+  if (!(q.scalar_type() == at::kFloat || q.scalar_type() == at::kBFloat16) ||
+      key.scalar_type() != q.scalar_type() ||
+      v.scalar_type() != q.scalar_type()) {
+    return false;
+  }
+  if (key.size(0) != q.size(0) || key.size(1) != q.size(1) ||
+      key.size(3) != q.size(3) || v.size(0) != q.size(0) ||
+      v.size(1) != q.size(1) || v.size(2) != key.size(2)) {
+    return false;
+  }
+  return at::is_expandable_to(
+      mask.sizes(), {q.size(0), q.size(1), q.size(2), key.size(2)});
+}
+
+} // namespace
+
 /**
  * We tried to fuse Div+Matmul+Add+Softmax as a signel operator. But
  * the oneDNN matmul performance with binary postop is poor, then we splited
@@ -94,5 +130,83 @@ at::Tensor dil_distil_mha_scores_calc(
       qk, _mask_qk, mask_qk_reshp, _fill, _dim_per_head);
 }
 
+/**
+ * dil_mha_scores_calc followed by the matmul with v. The scores are computed
+ * block by block with an online softmax and multiplied with v right away, so
+ * the [B, H, M, N] scores are never written to memory.
+ **/
+at::Tensor dil_mha_attention(
+    const at::Tensor& q,
+    const at::Tensor& k,
+    const at::Tensor& rel_kv,
+    const at::Scalar& alpha,
+    const at::Scalar& dim_per_head,
+    const int64_t& softmax_dim,
+    const at::IValue& dtype,
+    const at::Tensor& v) {
+  IPEX_RECORD_FUNCTION("dil_mha_attention", std::vector<c10::IValue>({}));
+
+  // k is the transposed key [B, H, D, N]
+  if (k.dim() == 4 && rel_kv.scalar_type() == q.scalar_type()) {
+    auto key = k.transpose(-1, -2);
+    if (can_use_flash_attention(q, key, v, rel_kv, softmax_dim, dtype)) {
+      auto _alpha = alpha.to<float>();
+      auto mask = _alpha == 1.0f ? rel_kv : at::mul(rel_kv, alpha);
+      return FlashAttention(
+          q, key, v, mask, 1.0f / dim_per_head.to<float>(), false, 0.0f);
+    }
+  }
+  auto scores = dil_mha_scores_calc(
+      q, k, rel_kv, alpha, dim_per_head, softmax_dim, dtype);
+  return at::matmul(scores, v);
+}
+
+/**
+ * dil_distil_mha_scores_calc followed by the matmul with v, see
+ * dil_mha_attention.
+ **/
+at::Tensor dil_distil_mha_attention(
+    const at::Tensor& q,
+    const at::Tensor& k,
+    const at::Tensor& mask_qk,
+    const at::IntArrayRef& mask_qk_reshp,
+    const int64_t& transpose_dim_a,
+    const int64_t& transpose_dim_b,
+    const at::Scalar& fill,
+    const at::Scalar& dim_per_head,
+    const int64_t& softmax_dim,
+    const at::IValue& dtype,
+    const at::Tensor& v) {
+  IPEX_RECORD_FUNCTION(
+      "dil_distil_mha_attention", std::vector<c10::IValue>({}));
+
+  if (k.dim() == 4) {
+    auto key = k.transpose(transpose_dim_a, transpose_dim_b).transpose(-1, -2);
+    auto mask = mask_qk.view(mask_qk_reshp);
+    if (can_use_flash_attention(q, key, v, mask, softmax_dim, dtype)) {
+      return FlashAttention(
+          q,
+          key,
+          v,
+          mask,
+          1.0f / dim_per_head.to<float>(),
+          true,
+          fill.to<float>());
+    }
+  }
+  auto scores = dil_distil_mha_scores_calc(
+      q,
+      k,
+      mask_qk,
+      mask_qk_reshp,
+      transpose_dim_a,
+      transpose_dim_b,
+      fill,
+      dim_per_head,
+      softmax_dim,
+      dtype);
+  return at::matmul(scores, v);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
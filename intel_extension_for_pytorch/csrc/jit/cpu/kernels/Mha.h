@@ -31,5 +31,28 @@ at::Tensor dil_distil_mha_scores_calc(
     const int64_t& softmax_dim,
     const at::IValue& dtype);
 
+at::Tensor dil_mha_attention(
+    const at::Tensor& q,
+    const at::Tensor& k,
+    const at::Tensor& rel_kv,
+    const at::Scalar& alpha,
+    const at::Scalar& dim_per_head,
+    const int64_t& softmax_dim,
+    const at::IValue& dtype,
+    const at::Tensor& v);
+
+at::Tensor dil_distil_mha_attention(
+    const at::Tensor& q,
+    const at::Tensor& k,
+    const at::Tensor& mask_qk,
+    const at::IntArrayRef& mask_qk_reshp,
+    const int64_t& transpose_dim_a,
+    const int64_t& transpose_dim_b,
+    const at::Scalar& fill,
+    const at::Scalar& dim_per_head,
+    const int64_t& softmax_dim,
+    const at::IValue& dtype,
+    const at::Tensor& v);
+
 } // namespace cpu
 } // namespace torch_ipex
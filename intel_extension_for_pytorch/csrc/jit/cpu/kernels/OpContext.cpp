@@ -2,6 +2,7 @@
 #include "ConvPacked.h"
 #include "ConvTransposePacked.h"
 #include "LinearPacked.h"
+#include "LstmPacked.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -61,6 +62,17 @@ int64_t ConvolutionOpContext::get_groups() {
   return groups_;
 }
 
+c10::Dict<std::string, int64_t> ConvolutionOpContext::get_params_cache_stats() {
+  auto cache_stats = get_conetxt().params_cache_->get_stats();
+  c10::Dict<std::string, int64_t> stats;
+  stats.insert("hits", cache_stats.hits);
+  stats.insert("misses", cache_stats.misses);
+  stats.insert("fallbacks", cache_stats.fallbacks);
+  stats.insert("evictions", cache_stats.evictions);
+  stats.insert("num_entries", cache_stats.num_entries);
+  return stats;
+}
+
 at::Tensor IpexConvolutionOpContext::run(
     const at::Tensor& input,
     const ideep::attr_t& attr) {
@@ -258,5 +270,31 @@ void IpexConvTransposeOpContext::may_repack(std::vector<int64_t> input_size) {
   return;
 }
 
+c10::intrusive_ptr<LstmOpContext> IpexLstmOpContext::create_context(
+    std::vector<at::Tensor>&& weights,
+    bool has_biases,
+    int64_t num_layers,
+    bool bidirectional) {
+  auto op_context = torch_ipex::cpu::detail::lstm::create(
+      weights, has_biases, num_layers, bidirectional);
+  return c10::make_intrusive<IpexLstmOpContext>(
+      std::move(weights),
+      has_biases,
+      num_layers,
+      bidirectional,
+      std::move(op_context));
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> IpexLstmOpContext::run(
+    const at::Tensor& input,
+    const std::vector<at::Tensor>& hx,
+    bool batch_first,
+    double scale,
+    int64_t zp,
+    int64_t dtype) {
+  return torch_ipex::cpu::detail::lstm::run(
+      op_context_, input, hx, batch_first, scale, zp, dtype);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
@@ -6,6 +6,7 @@
 
 #include "ContextConvTranspose.h"
 #include "ContextConvolution.h"
+#include "ContextLSTM.h"
 #include "ContextLinear.h"
 #include "csrc/cpu/ideep/ideep.hpp"
 
@@ -86,6 +87,10 @@ class ConvolutionOpContext : public torch::jit::CustomClassHolder {
 
   int64_t get_groups();
 
+  // Counters of the runs with the prepacked primitive and the primitives
+  // cached for the other input shapes, see ConvolutionParamsCache.
+  c10::Dict<std::string, int64_t> get_params_cache_stats();
+
   virtual detail::ContextConvolution& get_conetxt() = 0;
 };
 
@@ -408,5 +413,67 @@ class IpexConvTransposeOpContext final : public ConvTransposeOpContext {
       std::vector<int64_t>&& input_size);
 };
 
+// lstm op
+using SerializationTypeLstmPrePack =
+    std::tuple<std::vector<at::Tensor>, bool, int64_t, bool>;
+
+class LstmOpContext : public torch::jit::CustomClassHolder {
+ protected:
+  // these origin parameters are used for serialization
+  std::vector<at::Tensor> orig_weights_;
+  bool has_biases_;
+  int64_t num_layers_;
+  bool bidirectional_;
+
+ public:
+  SerializationTypeLstmPrePack unpack() {
+    return std::make_tuple(
+        orig_weights_, has_biases_, num_layers_, bidirectional_);
+  }
+
+  // Inference of the LSTM with the weights stored in the context. The scale,
+  // zp and dtype of the output are only used by the INT8 LSTM.
+  virtual std::tuple<at::Tensor, at::Tensor, at::Tensor> run(
+      const at::Tensor& input,
+      const std::vector<at::Tensor>& hx,
+      bool batch_first,
+      double scale,
+      int64_t zp,
+      int64_t dtype) = 0;
+};
+
+class IpexLstmOpContext final : public LstmOpContext {
+ private:
+  detail::ContextLSTM op_context_;
+
+ public:
+  IpexLstmOpContext(
+      std::vector<at::Tensor>&& weights,
+      bool has_biases,
+      int64_t num_layers,
+      bool bidirectional,
+      detail::ContextLSTM&& op_context)
+      : op_context_(std::move(op_context)) {
+    orig_weights_ = std::move(weights);
+    has_biases_ = has_biases;
+    num_layers_ = num_layers;
+    bidirectional_ = bidirectional;
+  }
+
+  virtual std::tuple<at::Tensor, at::Tensor, at::Tensor> run(
+      const at::Tensor& input,
+      const std::vector<at::Tensor>& hx,
+      bool batch_first,
+      double scale,
+      int64_t zp,
+      int64_t dtype) override;
+
+  static c10::intrusive_ptr<LstmOpContext> create_context(
+      std::vector<at::Tensor>&& weights,
+      bool has_biases,
+      int64_t num_layers,
+      bool bidirectional);
+};
+
 } // namespace cpu
 } // namespace torch_ipex
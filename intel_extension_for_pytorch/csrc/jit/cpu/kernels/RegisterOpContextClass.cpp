@@ -4,6 +4,7 @@
 #include "ConvPacked.h"
 #include "ConvTransposePacked.h"
 #include "LinearPacked.h"
+#include "LstmPacked.h"
 #include "OpContext.h"
 
 namespace torch_ipex {
@@ -11,6 +12,7 @@ namespace cpu {
 using detail::conv_transpose2d::createConvTransposePrePackOpContext;
 using detail::convolution::createConvolutionPrePackOpContext;
 using detail::linear::createLinearPrePackOpContext;
+using detail::lstm::createLstmPrePackOpContext;
 
 TORCH_LIBRARY(ipex_prepack, m) {
   m.class_<ConvolutionOpContext>("ConvolutionOpContext")
@@ -37,7 +39,10 @@ TORCH_LIBRARY(ipex_prepack, m) {
           "get_weight",
           &torch_ipex::cpu::ConvolutionOpContext::get_at_packed_weight)
       .def("pack", &torch_ipex::cpu::ConvolutionOpContext::pack)
-      .def("to_public", &torch_ipex::cpu::ConvolutionOpContext::to_public);
+      .def("to_public", &torch_ipex::cpu::ConvolutionOpContext::to_public)
+      .def(
+          "get_params_cache_stats",
+          &torch_ipex::cpu::ConvolutionOpContext::get_params_cache_stats);
   m.class_<LinearOpContext>("LinearOpContext")
       .def_pickle(
           [](const c10::intrusive_ptr<LinearOpContext>& op_context)
@@ -83,6 +88,20 @@ TORCH_LIBRARY(ipex_prepack, m) {
           &torch_ipex::cpu::ConvTransposeOpContext::get_at_packed_weight)
       .def("pack", &torch_ipex::cpu::ConvTransposeOpContext::pack)
       .def("to_public", &torch_ipex::cpu::ConvTransposeOpContext::to_public);
+  m.class_<LstmOpContext>("LstmOpContext")
+      .def_pickle(
+          [](const c10::intrusive_ptr<LstmOpContext>& op_context)
+              -> SerializationTypeLstmPrePack { // __getstate__
+            return op_context->unpack();
+          },
+          [](SerializationTypeLstmPrePack state)
+              -> c10::intrusive_ptr<LstmOpContext> { // __setstate__
+            return createLstmPrePackOpContext(
+                std::move(std::get<0>(state)),
+                std::move(std::get<1>(state)),
+                std::move(std::get<2>(state)),
+                std::move(std::get<3>(state)));
+          });
   m.def(
       "convolution_prepack(Tensor W, Tensor? B, int[] stride, "
       "int[] padding, int[] dilation, int[] kernel_size, int groups, int "
@@ -99,6 +118,10 @@ TORCH_LIBRARY(ipex_prepack, m) {
       "int[2] kernel_size,  int output_channel, "
       "bool input_is_channels_last, int[4] input_sizes) "
       "-> __torch__.torch.classes.ipex_prepack.ConvTransposeOpContext");
+  m.def(
+      "lstm_prepack(Tensor[] weights, bool has_biases, int num_layers, "
+      "bool bidirectional) "
+      "-> __torch__.torch.classes.ipex_prepack.LstmOpContext");
 }
 
 TORCH_LIBRARY_IMPL(ipex_prepack, AutogradCPU, m) {
@@ -107,6 +130,12 @@ TORCH_LIBRARY_IMPL(ipex_prepack, AutogradCPU, m) {
   m.impl(
       "conv_transpose2d_prepack",
       TORCH_FN(createConvTransposePrePackOpContext));
+  m.impl("lstm_prepack", TORCH_FN(createLstmPrePackOpContext));
+}
+
+// The weights of INT8 LSTM are quantized tensors
+TORCH_LIBRARY_IMPL(ipex_prepack, QuantizedCPU, m) {
+  m.impl("lstm_prepack", TORCH_FN(createLstmPrePackOpContext));
 }
 
 } // namespace cpu
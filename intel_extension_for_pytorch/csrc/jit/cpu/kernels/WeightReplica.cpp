@@ -0,0 +1,126 @@
+#include "WeightReplica.h"
+
+#include <ATen/Parallel.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#include "csrc/cpu/runtime/CPUPool.h"
+#include "csrc/cpu/runtime/CPUTopology.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+namespace {
+// Grain size (in bytes) of the parallel copy from the master weight.
+constexpr int64_t kCopyGrainSize = 1 << 20;
+
+bool read_weight_replica_env() {
+  auto envar = std::getenv("IPEX_NUMA_WEIGHT_REPLICA");
+  return envar != nullptr && std::strcmp(envar, "1") == 0;
+}
+
+std::atomic<bool> numa_weight_replica_enabled{read_weight_replica_env()};
+
+int64_t get_version(const at::Tensor& tensor) {
+  // Inference tensors have no version counter and can't be updated in place.
+  return tensor.is_inference() ? 0 : tensor._version();
+}
+
+bool is_up_to_date(
+    const std::shared_ptr<const WeightReplica>& replica,
+    const ideep::tensor& weight_packed,
+    const at::Tensor& at_weight) {
+  // Also compare the desc, in case a repacked weight reuses the address of
+  // the released one.
+  return replica && replica->source_ == at_weight.data_ptr() &&
+      replica->source_version_ == get_version(at_weight) &&
+      replica->weight_.get_desc() == weight_packed.get_desc();
+}
+} // namespace
+
+void set_numa_weight_replica_enabled(bool enabled) {
+  numa_weight_replica_enabled.store(enabled);
+}
+
+bool is_numa_weight_replica_enabled() {
+  return numa_weight_replica_enabled.load();
+}
+
+NumaWeightReplicas::NumaWeightReplicas() {
+  const auto& numa_node_ids =
+      runtime::CPUTopology::get_instance().get_numa_node_ids();
+  // Single numa node system doesn't need any replica.
+  if (numa_node_ids.size() > 1) {
+    replicas_.resize(numa_node_ids.back() + 1);
+  }
+}
+
+std::shared_ptr<const WeightReplica> NumaWeightReplicas::get_local_replica(
+    const ideep::tensor& weight_packed,
+    const at::Tensor& at_weight) {
+  if (replicas_.empty() || !is_numa_weight_replica_enabled()) {
+    return nullptr;
+  }
+  auto numa_node_id = runtime::get_current_numa_node_id();
+  if (numa_node_id < 0 ||
+      numa_node_id >= static_cast<int32_t>(replicas_.size())) {
+    return nullptr;
+  }
+  auto& slot = replicas_[numa_node_id];
+  auto replica = std::atomic_load(&slot);
+  if (is_up_to_date(replica, weight_packed, at_weight)) {
+    return replica;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Another stream on the same numa node may have refreshed it.
+  replica = std::atomic_load(&slot);
+  if (!is_up_to_date(replica, weight_packed, at_weight)) {
+    replica = create_replica(weight_packed, at_weight, numa_node_id);
+    std::atomic_store(&slot, replica);
+  }
+  return replica;
+}
+
+std::shared_ptr<const WeightReplica> NumaWeightReplicas::create_replica(
+    const ideep::tensor& weight_packed,
+    const at::Tensor& at_weight,
+    int32_t numa_node_id) {
+  auto replica = std::make_shared<WeightReplica>();
+  replica->source_ = at_weight.data_ptr();
+  replica->source_version_ = get_version(at_weight);
+  if (runtime::get_numa_node_id_of_address(at_weight.data_ptr()) ==
+      numa_node_id) {
+    // The master is already local, share it instead of copying.
+    replica->buffer_ = at_weight;
+    replica->weight_ = weight_packed;
+    return replica;
+  }
+
+  // Allocate whole pages, so binding the replica doesn't move the other
+  // allocations which share its first or last page.
+  int64_t nbytes = weight_packed.get_desc().get_size();
+  int64_t page_size = sysconf(_SC_PAGESIZE);
+  int64_t aligned_nbytes = (nbytes + page_size - 1) / page_size * page_size;
+  replica->buffer_ = at::empty(
+      {aligned_nbytes + page_size}, at_weight.options().dtype(at::kByte));
+  auto base = reinterpret_cast<uintptr_t>(replica->buffer_.data_ptr());
+  auto data = reinterpret_cast<char*>(
+      (base + page_size - 1) / page_size * page_size);
+  runtime::bind_memory_to_numa_node(data, aligned_nbytes, numa_node_id);
+
+  auto source = static_cast<const char*>(weight_packed.get_data_handle());
+  at::parallel_for(
+      0, nbytes, kCopyGrainSize, [&](int64_t begin, int64_t end) {
+        std::memcpy(data + begin, source + begin, end - begin);
+      });
+  replica->weight_.init(weight_packed.get_desc(), data);
+  return replica;
+}
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
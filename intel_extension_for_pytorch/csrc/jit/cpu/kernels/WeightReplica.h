@@ -0,0 +1,67 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "csrc/cpu/ideep/ideep.hpp"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+
+// Opt-in switch of the NUMA-local weight replicas, the default value is read
+// from the env IPEX_NUMA_WEIGHT_REPLICA.
+void set_numa_weight_replica_enabled(bool enabled);
+bool is_numa_weight_replica_enabled();
+
+struct WeightReplica {
+  // Owns the memory of weight_. It's the master at_weight_ if the master is
+  // already on the numa node of the replica.
+  at::Tensor buffer_;
+  ideep::tensor weight_;
+  // The master weight this replica is copied from.
+  const void* source_;
+  int64_t source_version_;
+};
+
+/*
+NumaWeightReplicas keeps one copy of the packed weight per numa node, so that
+the streams of MultiStreamModule running on different sockets read their
+weights from the local memory.
+
+1. A replica is created lazily by the first thread of a CPUPool on a single
+numa node which runs the op, and its pages are bound to that numa node.
+2. A replica is stale once the master at_weight_ is replaced (repack) or
+updated in place (set_weight or optimizer step, the fused steps bump the
+version too), which is detected by its data_ptr and version counter. The stale
+replica is refreshed on the next read.
+3. The threads which aren't pinned by the runtime API always read the master.
+*/
+class NumaWeightReplicas {
+ public:
+  NumaWeightReplicas();
+
+  // Return the replica for the numa node of the calling thread, nullptr if
+  // the master weight_packed should be used.
+  std::shared_ptr<const WeightReplica> get_local_replica(
+      const ideep::tensor& weight_packed,
+      const at::Tensor& at_weight);
+
+ private:
+  std::shared_ptr<const WeightReplica> create_replica(
+      const ideep::tensor& weight_packed,
+      const at::Tensor& at_weight,
+      int32_t numa_node_id);
+
+  // Indexed by numa node id, read with std::atomic_load and only replaced
+  // under mutex_.
+  std::vector<std::shared_ptr<const WeightReplica>> replicas_;
+  std::mutex mutex_;
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
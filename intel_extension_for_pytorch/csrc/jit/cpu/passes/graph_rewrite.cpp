@@ -1,5 +1,6 @@
 
 #include "graph_rewrite.h"
+#include <torch/csrc/jit/ir/alias_analysis.h>
 #include <torch/csrc/jit/passes/remove_mutation.h>
 #include "utils.h"
 
@@ -300,6 +301,100 @@ void FuseMHAScoreCalc(std::shared_ptr<Graph>& graph) {
 
   mha_fusion.runOnGraph(graph);
   distil_mha_fusion.runOnGraph(graph, filter_distil_mha);
+
+  // Fuse the scores with the following matmul with v, so that the attention
+  // is computed by the streaming kernel without writing the scores. The
+  // scores can't have any other user.
+  std::string mha_scores_matmul = R"(
+      graph(%q: Tensor, %k: Tensor, %relative_qk: Tensor, %alpha:int, %dim_per_head:int, %softmax_dim:int, %dtype, %v: Tensor):
+        %scores = ipex::mha_scores_calc(%q, %k, %relative_qk, %alpha, %dim_per_head, %softmax_dim, %dtype)
+        %context = aten::matmul(%scores, %v)
+        return (%context) )";
+
+  std::string mha_attention_fusion = R"(
+      graph(%q: Tensor, %k: Tensor, %relative_qk: Tensor, %alpha:int, %dim_per_head:int, %softmax_dim:int, %dtype, %v: Tensor):
+        %context = ipex::mha_attention(%q, %k, %relative_qk, %alpha, %dim_per_head, %softmax_dim, %dtype, %v)
+        return (%context) )";
+
+  std::string distil_mha_scores_matmul = R"(
+      graph(%q: Tensor, %k: Tensor, %mask_qk: Tensor, %mask_qk_reshp: int[], %transpose_dim_a:int, %transpose_dim_b:int, %fill:float, %dim_per_head:float, %softmax_dim:int, %dtype, %v: Tensor):
+        %scores = ipex::distil_mha_scores_calc(%q, %k, %mask_qk, %mask_qk_reshp, %transpose_dim_a, %transpose_dim_b, %fill, %dim_per_head, %softmax_dim, %dtype)
+        %context = aten::matmul(%scores, %v)
+        return (%context) )";
+
+  std::string distil_mha_attention_fusion = R"(
+      graph(%q: Tensor, %k: Tensor, %mask_qk: Tensor, %mask_qk_reshp: int[], %transpose_dim_a:int, %transpose_dim_b:int, %fill:float, %dim_per_head:float, %softmax_dim:int, %dtype, %v: Tensor):
+        %context = ipex::distil_mha_attention(%q, %k, %mask_qk, %mask_qk_reshp, %transpose_dim_a, %transpose_dim_b, %fill, %dim_per_head, %softmax_dim, %dtype, %v)
+        return (%context) )";
+
+  SubgraphRewriter mha_attention_fusion_rewriter;
+  mha_attention_fusion_rewriter.RegisterRewritePattern(
+      mha_scores_matmul, mha_attention_fusion);
+  mha_attention_fusion_rewriter.RegisterRewritePattern(
+      distil_mha_scores_matmul, distil_mha_attention_fusion);
+  mha_attention_fusion_rewriter.runOnGraph(graph);
+}
+
+void FuseKVCacheDecodeAttention(std::shared_ptr<Graph>& graph) {
+  std::string append_attention = R"(
+      graph(%q: Tensor, %k: Tensor, %v: Tensor, %key_cache: Tensor, %value_cache: Tensor, %key_scale, %value_scale, %block_table: Tensor, %seq_lens: Tensor, %scale: float, %mask):
+        %context_lens = torch_ipex::kv_cache_append_(%k, %v, %key_cache, %value_cache, %key_scale, %value_scale, %block_table, %seq_lens)
+        %context = torch_ipex::kv_cache_attention(%q, %key_cache, %value_cache, %key_scale, %value_scale, %block_table, %context_lens, %scale, %mask)
+        return (%context) )";
+
+  std::string decode_attention_fusion = R"(
+      graph(%q: Tensor, %k: Tensor, %v: Tensor, %key_cache: Tensor, %value_cache: Tensor, %key_scale, %value_scale, %block_table: Tensor, %seq_lens: Tensor, %scale: float, %mask):
+        %context = torch_ipex::kv_cache_decode_attention(%q, %k, %v, %key_cache, %value_cache, %key_scale, %value_scale, %block_table, %seq_lens, %scale, %mask)
+        return (%context) )";
+
+  // The fused op is inserted at the attention, so the append is moved after
+  // the nodes between them. Those nodes must not touch the caches, nor write
+  // the new key and value, the block table or the sequence lengths.
+  // The AliasDb is built once for the graph, the only nodes it doesn't know
+  // are the fused ops inserted by the rewriter, which are rejected before it
+  // is queried.
+  AliasDb aliasDb(graph);
+  auto decode_attention_kind =
+      Symbol::fromQualString("torch_ipex::kv_cache_decode_attention");
+  auto filter_decode_attention =
+      [&aliasDb, decode_attention_kind](
+          const Match& match,
+          const std::unordered_map<std::string, Value*>& vmap) {
+        Node* attention_node = match.anchor;
+        Node* append_node = attention_node->input(6)->node();
+        if (append_node->owningBlock() != attention_node->owningBlock()) {
+          return false;
+        }
+        std::vector<Value*> caches(
+            append_node->inputs().begin() + 2,
+            append_node->inputs().begin() + 6);
+        ValueSet append_inputs{
+            append_node->input(0),
+            append_node->input(1),
+            append_node->input(6),
+            append_node->input(7)};
+        for (Node* node = append_node->next(); node != attention_node;
+             node = node->next()) {
+          if (node->kind() == decode_attention_kind ||
+              !node->blocks().empty() ||
+              aliasDb.writesToAlias(node, append_inputs)) {
+            return false;
+          }
+          for (auto input : node->inputs()) {
+            for (auto cache : caches) {
+              if (aliasDb.mayAlias(input, cache)) {
+                return false;
+              }
+            }
+          }
+        }
+        return true;
+      };
+
+  SubgraphRewriter rewriter_decode_attention;
+  rewriter_decode_attention.RegisterRewritePattern(
+      append_attention, decode_attention_fusion);
+  rewriter_decode_attention.runOnGraph(graph, filter_decode_attention);
 }
 
 void replaceAtenMaxPool2dWithIpexMaxPool2d(std::shared_ptr<Graph>& graph) {
@@ -25,6 +25,7 @@ c10::optional<IValue> getIValue(
 
 void FuseShuffle(std::shared_ptr<Graph>& graph);
 void FuseMHAScoreCalc(std::shared_ptr<Graph>& graph);
+void FuseKVCacheDecodeAttention(std::shared_ptr<Graph>& graph);
 void FuseLinearSwishCustomized(std::shared_ptr<Graph>& graph);
 void replaceAtenMaxPool2dWithIpexMaxPool2d(std::shared_ptr<Graph>& graph);
 void fuseBmmAdd(std::shared_ptr<Graph>& graph);
@@ -53,6 +54,8 @@ void FuseConcatBnRelu(std::shared_ptr<Graph>& graph);
 
 void insertPrePackedConvTranspose2dOp(std::shared_ptr<Graph>& graph);
 
+void insertPrePackedLstmOp(std::shared_ptr<Graph>& graph);
+
 void FusedEinsumPost(std::shared_ptr<Graph>& graph);
 } // namespace graph_rewrite
 } // namespace jit
@@ -0,0 +1,76 @@
+#include "csrc/jit/cpu/kernels/OpContext.h"
+#include "graph_rewrite.h"
+#include "graph_rewrite_utils.h"
+
+namespace torch {
+namespace jit {
+namespace graph_rewrite {
+
+using namespace at::jit;
+using namespace torch_ipex::cpu;
+
+// Replace the inference LSTM with the prepacked LSTM, whose weights are
+// shuffled (and packed for INT8) once in ipex_prepack::lstm_prepack instead of
+// at every run.
+//   torch_ipex::ipex_lstm(input, hx, params, has_biases, num_layers,
+//       dropout_p, train, bidirectional, batch_first)
+//   ipex::quantized_lstm(input, hx, weights, has_biases, num_layers,
+//       dropout_p, train, bidirectional, batch_first, scale, zp, dtype)
+void insertPrePackedLstmOpForIpexLstm(Block* b) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      insertPrePackedLstmOpForIpexLstm(block);
+    }
+    bool is_quantized =
+        n->kind() == Symbol::fromQualString("ipex::quantized_lstm");
+    if (!is_quantized &&
+        n->kind() != Symbol::fromQualString("torch_ipex::ipex_lstm"))
+      continue;
+    // The dropout and the backward of training are not supported by the
+    // prepacked LSTM
+    auto train = toIValue(n->inputs().at(6));
+    if (!(train.has_value() && !train.value().toBool()))
+      continue;
+
+    WithInsertPoint guard(n);
+    auto graph = n->owningGraph();
+    auto prepack_node = graph->create(
+        Symbol::fromQualString("ipex_prepack::lstm_prepack"), 1);
+    // weights, has_biases, num_layers, bidirectional
+    for (auto i : {2, 3, 4, 7}) {
+      prepack_node->addInput(n->inputs().at(i));
+    }
+    prepack_node->output()->setType(
+        getCustomClass("__torch__.torch.classes.ipex_prepack.LstmOpContext"));
+    graph->insertNode(prepack_node);
+
+    auto prepack_lstm = graph->insertNode(graph->create(
+        Symbol::fromQualString(
+            is_quantized ? "ipex_prepack::quantized_lstm_run"
+                         : "ipex_prepack::lstm_run"),
+        3));
+    prepack_lstm->addInput(n->inputs().at(0));
+    prepack_lstm->addInput(n->inputs().at(1));
+    prepack_lstm->addInput(prepack_node->output());
+    prepack_lstm->addInput(n->inputs().at(8));
+    if (is_quantized) {
+      // scale, zp, dtype
+      for (auto i : {9, 10, 11}) {
+        prepack_lstm->addInput(n->inputs().at(i));
+      }
+    }
+    for (size_t i = 0; i < n->outputs().size(); ++i) {
+      prepack_lstm->output(i)->setType(n->output(i)->type());
+      n->output(i)->replaceAllUsesWith(prepack_lstm->output(i));
+    }
+  }
+  EliminateDeadCode(b);
+}
+
+void insertPrePackedLstmOp(std::shared_ptr<Graph>& graph) {
+  insertPrePackedLstmOpForIpexLstm(graph->block());
+}
+
+} // namespace graph_rewrite
+} // namespace jit
+} // namespace torch
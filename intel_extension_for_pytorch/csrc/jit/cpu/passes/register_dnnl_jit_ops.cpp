@@ -5,6 +5,7 @@
 
 #include "csrc/aten/cpu/AddLayerNorm.h"
 #include "csrc/aten/cpu/ConcatBnRelu.h"
+#include "csrc/cpu/runtime/StaticMemoryPlan.h"
 #include "csrc/jit/cpu/kernels/ConvPacked.h"
 #include "csrc/jit/cpu/kernels/ConvTransposePacked.h"
 #include "csrc/jit/cpu/kernels/Einsum.h"
@@ -12,6 +13,7 @@
 #include "csrc/jit/cpu/kernels/Interaction.h"
 #include "csrc/jit/cpu/kernels/LinearPacked.h"
 #include "csrc/jit/cpu/kernels/LinearSwishCustomized.h"
+#include "csrc/jit/cpu/kernels/LstmPacked.h"
 #include "csrc/jit/cpu/kernels/Matmul.h"
 #include "csrc/jit/cpu/kernels/MaxPool2D.h"
 #include "csrc/jit/cpu/kernels/Mha.h"
@@ -27,6 +29,11 @@ c10::AliasAnalysisKind aliasAnalysisFromSchema() {
   return c10::AliasAnalysisKind::FROM_SCHEMA;
 }
 
+// The ops with side effects, which are neither removed nor reordered.
+c10::AliasAnalysisKind aliasAnalysisConservative() {
+  return c10::AliasAnalysisKind::CONSERVATIVE;
+}
+
 at::Tensor toOptionalTensor(const IValue& v) {
   return v.isNone() ? at::Tensor() : v.toTensor();
 }
@@ -35,6 +42,7 @@ using namespace torch_ipex::cpu;
 using namespace torch_ipex::cpu::detail::convolution;
 using namespace torch_ipex::cpu::detail::linear;
 using namespace torch_ipex::cpu::detail::conv_transpose2d;
+using namespace torch_ipex::cpu::detail::lstm;
 
 #define CONV_PREPACK_ARGS                                            \
   "Tensor W, Tensor? B, "                                            \
@@ -665,6 +673,48 @@ RegisterOperators op({
         },
         aliasAnalysisFromSchema()),
 
+    Operator(
+        "ipex::mha_attention(Tensor q, Tensor k, Tensor rel_qk, Scalar alpha, "
+        "Scalar dim_per_head, int softmax_dim, ScalarType ? dtype, Tensor v) "
+        "-> Tensor",
+        [](Stack& stack) {
+          auto result = dil_mha_attention(
+              peek(stack, 0, 8).toTensor(),
+              peek(stack, 1, 8).toTensor(),
+              peek(stack, 2, 8).toTensor(),
+              peek(stack, 3, 8).toScalar(),
+              peek(stack, 4, 8).toScalar(),
+              peek(stack, 5, 8).toInt(),
+              peek(stack, 6, 8),
+              peek(stack, 7, 8).toTensor());
+          drop(stack, 8);
+          pack(stack, std::move(result));
+        },
+        aliasAnalysisFromSchema()),
+
+    Operator(
+        "ipex::distil_mha_attention(Tensor q, Tensor k, Tensor mask_qk, "
+        "int[] mask_qk_reshp, int transpose_dim_a, int transpose_dim_b, "
+        "Scalar fill, Scalar dim_per_head, int softmax_dim, ScalarType ? dtype, "
+        "Tensor v) -> Tensor",
+        [](Stack& stack) {
+          auto result = dil_distil_mha_attention(
+              peek(stack, 0, 11).toTensor(),
+              peek(stack, 1, 11).toTensor(),
+              peek(stack, 2, 11).toTensor(),
+              peek(stack, 3, 11).toIntVector(),
+              peek(stack, 4, 11).toInt(),
+              peek(stack, 5, 11).toInt(),
+              peek(stack, 6, 11).toScalar(),
+              peek(stack, 7, 11).toScalar(),
+              peek(stack, 8, 11).toInt(),
+              peek(stack, 9, 11),
+              peek(stack, 10, 11).toTensor());
+          drop(stack, 11);
+          pack(stack, std::move(result));
+        },
+        aliasAnalysisFromSchema()),
+
     Operator(
         "ipex::linear_swish_customized(Tensor x, Tensor weight, Tensor ? bias) -> Tensor",
         [](Stack& stack) {
@@ -795,6 +845,53 @@ RegisterOperators op({
         },
         aliasAnalysisFromSchema()),
 
+    Operator(
+        "ipex_prepack::lstm_run(Tensor input, Tensor[] hx, "
+        "__torch__.torch.classes.ipex_prepack.LstmOpContext W_prepack, "
+        "bool batch_first) -> (Tensor, Tensor, Tensor)",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = lstm_run(
+                (std::move(peek(stack, 0, 4))).toTensor(),
+                (std::move(peek(stack, 1, 4))).toTensorVector(),
+                (std::move(peek(stack, 2, 4))).toCustomClass<LstmOpContext>(),
+                (std::move(peek(stack, 3, 4))).toBool());
+            drop(stack, 4);
+
+            pack(stack, std::move(std::get<0>(result)));
+            pack(stack, std::move(std::get<1>(result)));
+            pack(stack, std::move(std::get<2>(result)));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+
+    Operator(
+        "ipex_prepack::quantized_lstm_run(Tensor quantized_input, "
+        "Tensor[] hx, "
+        "__torch__.torch.classes.ipex_prepack.LstmOpContext W_prepack, "
+        "bool batch_first, float scale, int zp, int dtype) "
+        "-> (Tensor, Tensor, Tensor)",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = quantized_lstm_run(
+                (std::move(peek(stack, 0, 7))).toTensor(),
+                (std::move(peek(stack, 1, 7))).toTensorVector(),
+                (std::move(peek(stack, 2, 7))).toCustomClass<LstmOpContext>(),
+                (std::move(peek(stack, 3, 7))).toBool(),
+                (std::move(peek(stack, 4, 7))).toDouble(),
+                (std::move(peek(stack, 5, 7))).toInt(),
+                (std::move(peek(stack, 6, 7))).toInt());
+            drop(stack, 7);
+
+            pack(stack, std::move(std::get<0>(result)));
+            pack(stack, std::move(std::get<1>(result)));
+            pack(stack, std::move(std::get<2>(result)));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+
     Operator(
         "ipex::shuffle_2d("
         "  Tensor input,"
@@ -877,6 +974,39 @@ RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::memory_plan_begin(int plan_id) -> ()",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            torch_ipex::runtime::begin_static_memory_plan(
+                (std::move(peek(stack, 0, 1))).toInt());
+            drop(stack, 1);
+            return 0;
+          };
+        },
+        aliasAnalysisConservative()),
+    Operator(
+        "ipex::memory_plan_assign(int plan_id, int offset, int nbytes) -> ()",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            torch_ipex::runtime::assign_planned_buffer(
+                (std::move(peek(stack, 0, 3))).toInt(),
+                (std::move(peek(stack, 1, 3))).toInt(),
+                (std::move(peek(stack, 2, 3))).toInt());
+            drop(stack, 3);
+            return 0;
+          };
+        },
+        aliasAnalysisConservative()),
+    Operator(
+        "ipex::memory_plan_clear() -> ()",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            torch_ipex::runtime::clear_planned_buffer();
+            return 0;
+          };
+        },
+        aliasAnalysisConservative()),
 
 });
 } // namespace jit
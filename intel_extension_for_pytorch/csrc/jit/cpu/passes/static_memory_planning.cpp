@@ -0,0 +1,294 @@
+#include "static_memory_planning.h"
+
+#include <c10/core/ScalarType.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "csrc/cpu/runtime/StaticMemoryPlan.h"
+#include "csrc/jit/codegen/onednn/fusion_group_name.h"
+
+namespace torch {
+namespace jit {
+
+namespace {
+// The planned buffers are aligned to a cache line.
+constexpr int64_t kAlignment = 64;
+
+std::atomic<bool>& staticMemoryPlanningEnabled() {
+  static std::atomic<bool> enabled{[]() {
+    auto envar = std::getenv("IPEX_STATIC_MEMORY_PLANNING");
+    return envar != nullptr && std::strcmp(envar, "1") == 0;
+  }()};
+  return enabled;
+}
+
+// The ops which allocate their single output by
+// torch_ipex::runtime::empty_planned_output or get_planned_output_allocator.
+bool isPlannableNode(const Node* node) {
+  static const std::unordered_set<Symbol> kinds = {
+      Symbol::fromQualString("ipex_prepack::convolution_run"),
+      Symbol::fromQualString("ipex_prepack::convolution_relu_run"),
+      Symbol::fromQualString("ipex_prepack::convolution_sigmoid_run"),
+      Symbol::fromQualString("ipex_prepack::convolution_swish_run"),
+      Symbol::fromQualString("ipex_prepack::convolution_elu_run"),
+      Symbol::fromQualString("ipex_prepack::convolution_hardtanh_run"),
+      Symbol::fromQualString("ipex_prepack::convolution_leaky_relu_run"),
+      Symbol::fromQualString("ipex_prepack::convolution_gelu_run"),
+      Symbol::fromQualString("ipex_prepack::linear_run"),
+      Symbol::fromQualString("ipex_prepack::linear_relu_run"),
+      Symbol::fromQualString("ipex_prepack::linear_gelu_run"),
+      Symbol::fromQualString("ipex_prepack::linear_sigmoid_run"),
+      Symbol::fromQualString("ipex_prepack::linear_swish_run"),
+      Symbol::fromQualString(fuser::onednn::LlgaFusionGroupName()),
+  };
+  return node->outputs().size() == 1 && kinds.count(node->kind()) > 0;
+}
+
+// Bytes of the tensor of a specialized type, 0 if it's unknown.
+int64_t getTensorBytes(const Value* value) {
+  auto type = value->type()->cast<TensorType>();
+  if (!type) {
+    return 0;
+  }
+  auto sizes = type->sizes().concrete_sizes();
+  auto scalar_type = type->scalarType();
+  auto device = type->device();
+  if (!sizes || !scalar_type || (device && !device->is_cpu())) {
+    return 0;
+  }
+  int64_t numel = 1;
+  for (auto size : *sizes) {
+    numel *= size;
+  }
+  return numel * c10::elementSize(*scalar_type);
+}
+
+struct PlannedValue {
+  Node* node;
+  // Index of the node which defines the value and of the last node which
+  // uses the value or any of its aliases, in the top level block.
+  int64_t begin;
+  int64_t end;
+  int64_t nbytes;
+  int64_t aligned_nbytes;
+  int64_t offset;
+};
+
+class StaticMemoryPlanner {
+ public:
+  explicit StaticMemoryPlanner(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)), aliasDb_(graph_) {}
+
+  void run() {
+    indexNodes();
+    collectCandidates();
+    if (planned_.empty()) {
+      return;
+    }
+    auto arena_bytes = assignOffsets();
+    insertPlanOps(arena_bytes);
+  }
+
+ private:
+  void indexNodes() {
+    int64_t index = 0;
+    for (Node* node : graph_->block()->nodes()) {
+      indices_[node] = index++;
+    }
+    indices_[graph_->return_node()] = index;
+    // The values (including the block inputs) of the nested blocks are
+    // indexed by the top level node which owns them.
+    for (Node* node : graph_->block()->nodes()) {
+      collectValues(node, indices_[node]);
+    }
+  }
+
+  void collectValues(Node* node, int64_t index) {
+    for (Value* output : node->outputs()) {
+      values_.emplace_back(output, index);
+    }
+    for (Block* block : node->blocks()) {
+      for (Value* input : block->inputs()) {
+        values_.emplace_back(input, index);
+      }
+      for (Node* nested : block->nodes()) {
+        collectValues(nested, index);
+      }
+    }
+  }
+
+  int64_t getTopLevelIndex(Node* node) {
+    while (node->owningBlock() != graph_->block()) {
+      node = node->owningBlock()->owningNode();
+    }
+    return indices_.at(node);
+  }
+
+  void collectCandidates() {
+    auto llga_kind =
+        Symbol::fromQualString(fuser::onednn::LlgaFusionGroupName());
+    // The nodes with the same kind and inputs, which may be merged by the
+    // later CSE, so that the output of one is used after its planned end.
+    std::map<std::pair<Symbol, std::vector<Value*>>, int64_t> signatures;
+    for (Node* node : graph_->block()->nodes()) {
+      if (isPlannableNode(node)) {
+        signatures[{node->kind(), node->inputs().vec()}]++;
+      }
+    }
+
+    for (Node* node : graph_->block()->nodes()) {
+      if (!isPlannableNode(node) ||
+          signatures[{node->kind(), node->inputs().vec()}] > 1) {
+        continue;
+      }
+      Value* value = node->output();
+      auto nbytes = getTensorBytes(value);
+      if (nbytes == 0 || aliasDb_.mayContainAlias(value, node->inputs()) ||
+          aliasDb_.mayContainAlias(value, graph_->inputs()) ||
+          aliasDb_.mayContainAlias(value, graph_->outputs())) {
+        continue;
+      }
+
+      auto begin = indices_[node];
+      auto end = begin;
+      bool escaped = false;
+      // The containers defined before the node, e.g. a list which gets the
+      // value by aten::append, keep the value alive until their last use too.
+      for (const auto& item : values_) {
+        Value* alias = item.first;
+        if (alias != value && !aliasDb_.mayContainAlias(value, alias)) {
+          continue;
+        }
+        for (const Use& use : alias->uses()) {
+          // The LLGA kernels may write their outputs into the inputs, which
+          // isn't visible to the alias analysis.
+          if (use.user->kind() == prim::SetAttr ||
+              use.user->kind() == llga_kind || use.user->hasSideEffects()) {
+            escaped = true;
+            break;
+          }
+          end = std::max(end, getTopLevelIndex(use.user));
+        }
+        if (escaped) {
+          break;
+        }
+      }
+      if (escaped) {
+        GRAPH_DEBUG("Not planning the escaped ", value->debugName());
+        continue;
+      }
+      auto aligned_nbytes = (nbytes + kAlignment - 1) / kAlignment * kAlignment;
+      planned_.push_back({node, begin, end, nbytes, aligned_nbytes, 0});
+    }
+  }
+
+  // Greedy by size: the larger values take the lowest offset which doesn't
+  // overlap with the values placed before whose lifetimes overlap with it.
+  int64_t assignOffsets() {
+    std::vector<PlannedValue*> order;
+    for (auto& planned : planned_) {
+      order.push_back(&planned);
+    }
+    std::stable_sort(
+        order.begin(),
+        order.end(),
+        [](const PlannedValue* a, const PlannedValue* b) {
+          return a->aligned_nbytes > b->aligned_nbytes;
+        });
+
+    int64_t arena_bytes = 0;
+    std::vector<PlannedValue*> placed;
+    for (auto planned : order) {
+      std::vector<std::pair<int64_t, int64_t>> busy;
+      for (auto other : placed) {
+        if (other->begin <= planned->end && planned->begin <= other->end) {
+          busy.emplace_back(
+              other->offset, other->offset + other->aligned_nbytes);
+        }
+      }
+      std::sort(busy.begin(), busy.end());
+      int64_t offset = 0;
+      for (const auto& range : busy) {
+        if (offset + planned->aligned_nbytes <= range.first) {
+          break;
+        }
+        offset = std::max(offset, range.second);
+      }
+      planned->offset = offset;
+      arena_bytes = std::max(arena_bytes, offset + planned->aligned_nbytes);
+      placed.push_back(planned);
+    }
+    return arena_bytes;
+  }
+
+  void insertPlanOps(int64_t arena_bytes) {
+    int64_t planned_value_bytes = 0;
+    for (const auto& planned : planned_) {
+      planned_value_bytes += planned.aligned_nbytes;
+    }
+    auto plan_id = torch_ipex::runtime::register_static_memory_plan(
+        arena_bytes, planned_value_bytes);
+
+    Value* plan_id_value = nullptr;
+    {
+      WithInsertPoint guard(graph_->block()->nodes().front());
+      plan_id_value = graph_->insertConstant(plan_id);
+      graph_->insertNode(graph_->create(
+          Symbol::fromQualString("ipex::memory_plan_begin"),
+          {plan_id_value},
+          0));
+    }
+    for (const auto& planned : planned_) {
+      WithInsertPoint guard(planned.node);
+      auto offset = graph_->insertConstant(planned.offset);
+      auto nbytes = graph_->insertConstant(planned.nbytes);
+      graph_->insertNode(graph_->create(
+          Symbol::fromQualString("ipex::memory_plan_assign"),
+          {plan_id_value, offset, nbytes},
+          0));
+      graph_
+          ->create(Symbol::fromQualString("ipex::memory_plan_clear"), {}, 0)
+          ->insertAfter(planned.node);
+    }
+    GRAPH_DEBUG(
+        "Planned ",
+        planned_.size(),
+        " values of ",
+        planned_value_bytes,
+        " bytes in an arena of ",
+        arena_bytes,
+        " bytes");
+  }
+
+  std::shared_ptr<Graph> graph_;
+  AliasDb aliasDb_;
+  std::unordered_map<Node*, int64_t> indices_;
+  // (value, index of its top level node)
+  std::vector<std::pair<Value*, int64_t>> values_;
+  std::vector<PlannedValue> planned_;
+};
+} // namespace
+
+void setStaticMemoryPlanningEnabled(bool enabled) {
+  staticMemoryPlanningEnabled().store(enabled);
+}
+
+bool getStaticMemoryPlanningEnabled() {
+  return staticMemoryPlanningEnabled().load();
+}
+
+void PlanStaticMemory(std::shared_ptr<Graph>& graph) {
+  StaticMemoryPlanner(graph).run();
+  GRAPH_DUMP("After PlanStaticMemory", graph);
+}
+
+} // namespace jit
+} // namespace torch
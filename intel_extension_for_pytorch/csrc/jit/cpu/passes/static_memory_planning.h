@@ -0,0 +1,21 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Disabled by default, can be enabled by the env
+// IPEX_STATIC_MEMORY_PLANNING=1. It applies to the graphs optimized after it's
+// switched.
+void setStaticMemoryPlanningEnabled(bool enabled);
+bool getStaticMemoryPlanningEnabled();
+
+// Give the outputs of the IPEX ops in the top level block, whose shapes are
+// specialized, offsets in one arena per inference thread. The outputs whose
+// lifetimes don't overlap share the same bytes. It must run after the IPEX
+// fusion passes, while the tensor types are still specialized.
+void PlanStaticMemory(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
@@ -9,6 +9,7 @@
 #include "cpu/passes/concat_linear.h"
 #include "cpu/passes/frozen_conv_folding.h"
 #include "cpu/passes/frozen_linear_folding.h"
+#include "cpu/passes/static_memory_planning.h"
 
 #include <c10/util/hash.h>
 #include <torch/csrc/jit/frontend/error_report.h>
@@ -359,6 +360,10 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
   // Multi-Head-Attention
   graph_rewrite::FuseMHAScoreCalc(graph);
 
+  // Fuse the append of the new key/value into the paged kv cache with the
+  // attention over the cache for the decoding step
+  graph_rewrite::FuseKVCacheDecodeAttention(graph);
+
   // Fuse bmm + add for bmm_add
   graph_rewrite::fuseBmmAdd(graph);
 
@@ -395,6 +400,10 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
   // deconvolution fusion
   graph_rewrite::insertPrePackedConvTranspose2dOp(graph);
 
+  // Insert ipex_prepack::lstm_prepack for the inference LSTM (including the
+  // ipex::quantized_lstm from the LLGA fusion pass)
+  graph_rewrite::insertPrePackedLstmOp(graph);
+
   // fuse concat+bn+relu for the input float tensors with the same sizes
   // and channelslast format
   // hence the concat dim should be the channel
@@ -480,6 +489,12 @@ void FusionPass(std::shared_ptr<Graph>& graph) {
     FuseTensorExprs(graph, getFusionGroupInlining() ? 2 : 1);
   }
 
+  // Plan the buffers of the intermediate tensors while the shapes are still
+  // specialized, and after the fusions which may reorder the nodes.
+  if (getStaticMemoryPlanningEnabled()) {
+    PlanStaticMemory(graph);
+  }
+
   RemoveTensorTypeSpecializations(graph);
   GRAPH_DUMP(
       "After RemoveTensorTypeSpecializations. End of optimization pass", graph);
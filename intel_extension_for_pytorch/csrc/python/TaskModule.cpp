@@ -24,36 +24,48 @@ py::object FutureTensor::get() {
 TaskModule::TaskModule(
     const torch::jit::Module& script_module,
     const std::vector<int32_t>& cpu_core_list,
-    bool traced_module)
+    bool traced_module,
+    bool enable_work_stealing,
+    bool bind_memory)
     : script_module_(script_module) {
-  this->task_executor = std::make_shared<TaskExecutor>(cpu_core_list);
+  this->task_executor = std::make_shared<TaskExecutor>(
+      cpu_core_list, enable_work_stealing, bind_memory);
   this->script_module_initialized_ = true;
 }
 
 TaskModule::TaskModule(
     const py::object& module,
-    const std::vector<int32_t>& cpu_core_list)
+    const std::vector<int32_t>& cpu_core_list,
+    bool enable_work_stealing,
+    bool bind_memory)
     : module_(module) {
-  this->task_executor = std::make_shared<TaskExecutor>(cpu_core_list);
+  this->task_executor = std::make_shared<TaskExecutor>(
+      cpu_core_list, enable_work_stealing, bind_memory);
   this->module_initialized_ = true;
 }
 
 TaskModule::TaskModule(
     const torch::jit::Module& script_module,
     const torch_ipex::runtime::CPUPool& cpu_pool,
-    bool traced_module)
+    bool traced_module,
+    bool enable_work_stealing)
     : script_module_(script_module) {
-  this->task_executor =
-      std::make_shared<TaskExecutor>(cpu_pool.get_cpu_core_list());
+  this->task_executor = std::make_shared<TaskExecutor>(
+      cpu_pool.get_cpu_core_list(),
+      enable_work_stealing,
+      cpu_pool.is_memory_binding_enabled());
   this->script_module_initialized_ = true;
 }
 
 TaskModule::TaskModule(
     const py::object& module,
-    const torch_ipex::runtime::CPUPool& cpu_pool)
+    const torch_ipex::runtime::CPUPool& cpu_pool,
+    bool enable_work_stealing)
     : module_(module) {
-  this->task_executor =
-      std::make_shared<TaskExecutor>(cpu_pool.get_cpu_core_list());
+  this->task_executor = std::make_shared<TaskExecutor>(
+      cpu_pool.get_cpu_core_list(),
+      enable_work_stealing,
+      cpu_pool.is_memory_binding_enabled());
   this->module_initialized_ = true;
 }
 
@@ -97,21 +109,13 @@ std::unique_ptr<FutureTensor> TaskModule::run_async(
       future_tensor_result->script_module_initialized_ = true;
       future_tensor_result->future_script_tensor = task->get_future();
 
-      {
-        std::unique_lock<std::mutex> lock(this->task_executor->get_mutex());
-        // submit task to a stopping the pool is not allowed
-        if (this->task_executor->is_stop())
-          throw std::runtime_error(
-              "submit TaskModule(py::object) on stopped ThreadPool");
-        this->task_executor->get_tasks().emplace([task, grad_mode]() {
-          // set the thread local status, such as the grad mode before
-          // execuating the status
-          at::GradMode::set_enabled(grad_mode);
-          // execuate the task
-          (*task)();
-        });
-      }
-      this->task_executor->get_condition().notify_one();
+      this->task_executor->submit([task, grad_mode]() {
+        // set the thread local status, such as the grad mode before
+        // execuating the status
+        at::GradMode::set_enabled(grad_mode);
+        // execuate the task
+        (*task)();
+      });
     }
   } else {
     CHECK(this->module_initialized_);
@@ -131,25 +135,24 @@ std::unique_ptr<FutureTensor> TaskModule::run_async(
     future_tensor_result->module_initialized_ = true;
     future_tensor_result->future_tensor = task->get_future();
 
-    {
-      std::unique_lock<std::mutex> lock(this->task_executor->get_mutex());
-      // submit task to a stopping the pool is not allowed
-      if (this->task_executor->is_stop())
-        throw std::runtime_error(
-            "submit TaskModule(py::object) on stopped ThreadPool");
-      this->task_executor->get_tasks().emplace([task, grad_mode]() {
-        // set the thread local status, such as the grad mode before execuating
-        // the status
-        at::GradMode::set_enabled(grad_mode);
-        // execuate the task
-        (*task)();
-      });
-    }
-    this->task_executor->get_condition().notify_one();
+    // The queued tasks need the GIL to finish, so don't hold it while the
+    // submit waits for a free slot of the queue.
+    pybind11::gil_scoped_release no_gil_guard;
+    this->task_executor->submit([task, grad_mode]() {
+      // set the thread local status, such as the grad mode before execuating
+      // the status
+      at::GradMode::set_enabled(grad_mode);
+      // execuate the task
+      (*task)();
+    });
   }
   return future_tensor_result;
 }
 
+int64_t TaskModule::get_num_stolen_tasks() const {
+  return this->task_executor->get_num_stolen_tasks();
+}
+
 py::object TaskModule::run_sync(py::args&& args, py::kwargs&& kwargs) {
   // sync API to run application inside task
   std::unique_ptr<FutureTensor> future_tensor_result =
@@ -33,17 +33,23 @@ class TORCH_API TaskModule {
   explicit TaskModule(
       const torch::jit::Module& module,
       const std::vector<int32_t>& cpu_core_list,
-      bool traced_module);
+      bool traced_module,
+      bool enable_work_stealing = false,
+      bool bind_memory = false);
   explicit TaskModule(
       const py::object& module,
-      const std::vector<int32_t>& cpu_core_list);
+      const std::vector<int32_t>& cpu_core_list,
+      bool enable_work_stealing = false,
+      bool bind_memory = false);
   explicit TaskModule(
       const torch::jit::Module& module,
       const torch_ipex::runtime::CPUPool& cpu_pool,
-      bool traced_module);
+      bool traced_module,
+      bool enable_work_stealing = false);
   explicit TaskModule(
       const py::object& module,
-      const torch_ipex::runtime::CPUPool& cpu_pool);
+      const torch_ipex::runtime::CPUPool& cpu_pool,
+      bool enable_work_stealing = false);
   TaskModule(const TaskModule& task_module) = delete;
   TaskModule(TaskModule&& task_module) = delete;
   TaskModule& operator=(const TaskModule& task_module) = delete;
@@ -53,6 +59,9 @@ class TORCH_API TaskModule {
   std::unique_ptr<FutureTensor> run_async(
       py::args&& args,
       py::kwargs&& kwargs); /*async execution in threadpool*/
+  // Number of the tasks of other TaskModules stolen by the worker of this one.
+  int64_t get_num_stolen_tasks() const;
+
  private:
   // Script module input
   torch::jit::Module script_module_;
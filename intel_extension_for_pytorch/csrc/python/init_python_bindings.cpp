@@ -2,6 +2,7 @@
 
 #include "intel_extension_for_pytorch/csrc/aten/cpu/utils/isa_help.h"
 #include "intel_extension_for_pytorch/csrc/jit/codegen/onednn/interface.h"
+#include "intel_extension_for_pytorch/csrc/jit/codegen/onednn/persistent_cache.h"
 #include "intel_extension_for_pytorch/csrc/version.h"
 
 #include <ATen/native/quantized/cpu/quant_utils.h>
@@ -39,8 +40,17 @@
 
 #include "TaskModule.h"
 #include "intel_extension_for_pytorch/csrc/aten/cpu/EmbeddingBag.h"
+#include "intel_extension_for_pytorch/csrc/aten/cpu/WeightPack.h"
+#include "intel_extension_for_pytorch/csrc/cpu/ideep/ideep.hpp"
+#include "intel_extension_for_pytorch/csrc/cpu/runtime/BatchScheduler.h"
+#include "intel_extension_for_pytorch/csrc/cpu/runtime/CachingAllocator.h"
 #include "intel_extension_for_pytorch/csrc/cpu/runtime/CPUPool.h"
+#include "intel_extension_for_pytorch/csrc/cpu/runtime/CPUTopology.h"
+#include "intel_extension_for_pytorch/csrc/cpu/runtime/StaticMemoryPlan.h"
 #include "intel_extension_for_pytorch/csrc/cpu/runtime/TaskExecutor.h"
+#include "intel_extension_for_pytorch/csrc/jit/cpu/kernels/BottleneckTiling.h"
+#include "intel_extension_for_pytorch/csrc/jit/cpu/kernels/WeightReplica.h"
+#include "intel_extension_for_pytorch/csrc/jit/cpu/passes/static_memory_planning.h"
 
 namespace torch_ipex {
 namespace {
@@ -119,6 +129,162 @@ void InitIpexModuleBindings(py::module m) {
   m.def(
       "_jit_llga_weight_cache_enabled",
       &torch::jit::fuser::onednn::getLlgaWeightCacheEnabled);
+  m.def(
+      "_jit_set_llga_compilation_cache_capacity",
+      &torch::jit::fuser::onednn::setLlgaCompilationCacheCapacity);
+  m.def(
+      "_jit_get_llga_compilation_cache_capacity",
+      &torch::jit::fuser::onednn::getLlgaCompilationCacheCapacity);
+  m.def("_jit_get_llga_compilation_cache_stats", []() {
+    auto stats = torch::jit::fuser::onednn::getLlgaCompilationCacheStats();
+    auto py_dict = py::dict();
+    py_dict["hits"] = std::get<0>(stats);
+    py_dict["misses"] = std::get<1>(stats);
+    return py_dict;
+  });
+  m.def(
+      "_jit_set_llga_dynamic_shape_enabled",
+      &torch::jit::fuser::onednn::setLlgaDynamicShapeEnabled);
+  m.def(
+      "_jit_llga_dynamic_shape_enabled",
+      &torch::jit::fuser::onednn::getLlgaDynamicShapeEnabled);
+  m.def(
+      "_jit_set_llga_shape_buckets",
+      &torch::jit::fuser::onednn::setLlgaShapeBuckets);
+  m.def(
+      "_jit_get_llga_shape_buckets",
+      &torch::jit::fuser::onednn::getLlgaShapeBuckets);
+  m.def(
+      "_jit_set_llga_persistent_cache_dir",
+      &torch::jit::fuser::onednn::setLlgaPersistentCacheDir);
+  m.def(
+      "_jit_get_llga_persistent_cache_dir",
+      &torch::jit::fuser::onednn::getLlgaPersistentCacheDir);
+  m.def(
+      "_jit_flush_llga_persistent_cache",
+      &torch::jit::fuser::onednn::flushLlgaPersistentCache);
+  m.def("_jit_get_llga_persistent_cache_stats", []() {
+    auto stats = torch::jit::fuser::onednn::getLlgaPersistentCacheStats();
+    auto py_dict = py::dict();
+    py_dict["loaded"] = std::get<0>(stats);
+    py_dict["stored"] = std::get<1>(stats);
+    py_dict["hits"] = std::get<2>(stats);
+    py_dict["misses"] = std::get<3>(stats);
+    return py_dict;
+  });
+
+  // static memory planning of the frozen graphs
+  m.def(
+      "_jit_set_static_memory_planning_enabled",
+      &torch::jit::setStaticMemoryPlanningEnabled);
+  m.def(
+      "_jit_static_memory_planning_enabled",
+      &torch::jit::getStaticMemoryPlanningEnabled);
+  m.def("_jit_get_static_memory_plan_stats", []() {
+    auto stats = torch_ipex::runtime::get_static_memory_plan_stats();
+    auto py_dict = py::dict();
+    py_dict["num_plans"] = stats.num_plans;
+    py_dict["planned_arena_bytes"] = stats.planned_arena_bytes;
+    py_dict["planned_value_bytes"] = stats.planned_value_bytes;
+    py_dict["num_arenas"] = stats.num_arenas;
+    py_dict["num_planned_allocations"] = stats.num_planned_allocations;
+    py_dict["num_unplanned_allocations"] = stats.num_unplanned_allocations;
+    return py_dict;
+  });
+
+  // cache of the packed LSTM weights
+  m.def("_get_weight_cache_stats", []() {
+    auto stats = torch_ipex::cpu::get_weight_cache_stats();
+    auto py_dict = py::dict();
+    py_dict["hits"] = stats.hits;
+    py_dict["misses"] = stats.misses;
+    py_dict["evictions"] = stats.evictions;
+    py_dict["num_entries"] = stats.num_entries;
+    py_dict["num_bytes"] = stats.num_bytes;
+    return py_dict;
+  });
+  m.def(
+      "_set_weight_cache_capacity",
+      &torch_ipex::cpu::set_weight_cache_capacity);
+  m.def(
+      "_get_weight_cache_capacity",
+      &torch_ipex::cpu::get_weight_cache_capacity);
+  m.def("_clear_weight_cache", &torch_ipex::cpu::clear_weight_cache);
+
+  // process-wide cache of the oneDNN primitives shared by all the threads
+  m.def("_set_shared_primitive_cache_enabled", [](bool enabled) {
+    ideep::utils::shared_cache_registry::instance().set_enabled(enabled);
+  });
+  m.def("_is_shared_primitive_cache_enabled", []() {
+    return ideep::utils::shared_cache_registry::instance().enabled();
+  });
+  m.def("_set_shared_primitive_cache_capacity", [](int64_t capacity) {
+    TORCH_CHECK(capacity > 0, "The capacity should be positive");
+    ideep::utils::shared_cache_registry::instance().set_capacity(capacity);
+  });
+  m.def("_get_shared_primitive_cache_capacity", []() {
+    return ideep::utils::shared_cache_registry::instance().capacity();
+  });
+  m.def("_get_shared_primitive_cache_stats", []() {
+    auto py_dict = py::dict();
+    for (auto& stats :
+         ideep::utils::shared_cache_registry::instance().get_stats()) {
+      auto op_dict = py::dict();
+      op_dict["hits"] = stats.hits;
+      op_dict["misses"] = stats.misses;
+      op_dict["evictions"] = stats.evictions;
+      op_dict["num_entries"] = stats.size;
+      py_dict[stats.name.c_str()] = op_dict;
+    }
+    return py_dict;
+  });
+  m.def("_clear_shared_primitive_cache", []() {
+    ideep::utils::shared_cache_registry::instance().clear();
+  });
+
+  // scratchpad arenas of the oneDNN primitives
+  m.def("_get_scratchpad_arena_stats", []() {
+    auto py_dict = py::dict();
+    py_dict["peak_bytes"] = ideep::utils::scratchpad_arena::get_peak_bytes();
+    py_dict["total_bytes"] = ideep::utils::scratchpad_arena::get_total_bytes();
+    return py_dict;
+  });
+  m.def("_reset_scratchpad_arena_peak_bytes", []() {
+    ideep::utils::scratchpad_arena::reset_peak_bytes();
+  });
+
+  // caching allocator of the ideep tensors and IPEX outputs
+  m.def(
+      "_set_caching_allocator_enabled",
+      &torch_ipex::runtime::set_caching_allocator_enabled);
+  m.def(
+      "_is_caching_allocator_enabled",
+      &torch_ipex::runtime::is_caching_allocator_enabled);
+  m.def(
+      "_set_caching_allocator_huge_pages_enabled",
+      &torch_ipex::runtime::set_caching_allocator_huge_pages_enabled);
+  m.def(
+      "_is_caching_allocator_huge_pages_enabled",
+      &torch_ipex::runtime::is_caching_allocator_huge_pages_enabled);
+  m.def("_get_caching_allocator_stats", []() {
+    auto stats = torch_ipex::runtime::get_caching_allocator_stats();
+    auto py_dict = py::dict();
+    py_dict["requested_bytes"] = stats.requested_bytes;
+    py_dict["allocated_bytes"] = stats.allocated_bytes;
+    py_dict["cached_bytes"] = stats.cached_bytes;
+    py_dict["reserved_bytes"] = stats.reserved_bytes;
+    py_dict["peak_allocated_bytes"] = stats.peak_allocated_bytes;
+    py_dict["peak_reserved_bytes"] = stats.peak_reserved_bytes;
+    py_dict["num_os_allocations"] = stats.num_os_allocations;
+    py_dict["num_os_frees"] = stats.num_os_frees;
+    return py_dict;
+  });
+  m.def(
+      "_reset_caching_allocator_peak_stats",
+      &torch_ipex::runtime::reset_caching_allocator_peak_stats);
+  m.def(
+      "_empty_caching_allocator_cache",
+      &torch_ipex::runtime::empty_caching_allocator_cache);
 
   m.def("enable_jit_opt", []() {
     AutoOptConfig::singleton().set_jit_fuse(true);
@@ -281,27 +447,65 @@ void InitIpexModuleBindings(py::module m) {
   py::class_<
       torch_ipex::runtime::CPUPool,
       std::shared_ptr<torch_ipex::runtime::CPUPool>>(m, "CPUPool")
-      .def(py::init([](const py::list& core_list) {
-        return std::make_shared<torch_ipex::runtime::CPUPool>(
-            py::cast<std::vector<int32_t>>(core_list));
-      }))
-      .def("get_core_list", [](torch_ipex::runtime::CPUPool& self) {
-        return self.get_cpu_core_list();
-      });
+      .def(
+          py::init([](const py::list& core_list, bool bind_memory) {
+            return std::make_shared<torch_ipex::runtime::CPUPool>(
+                py::cast<std::vector<int32_t>>(core_list), bind_memory);
+          }),
+          py::arg("core_list"),
+          py::arg("bind_memory") = false)
+      .def(
+          "get_core_list",
+          [](torch_ipex::runtime::CPUPool& self) {
+            return self.get_cpu_core_list();
+          })
+      .def(
+          "get_numa_node_ids",
+          [](torch_ipex::runtime::CPUPool& self) {
+            return self.get_numa_node_ids();
+          })
+      .def(
+          "is_memory_binding_enabled",
+          &torch_ipex::runtime::CPUPool::is_memory_binding_enabled);
 
   py::class_<
       torch_ipex::runtime::TaskModule,
       std::shared_ptr<torch_ipex::runtime::TaskModule>>(m, "TaskModule")
-      .def(py::init([](const py::object& module, const py::list& core_list) {
-        return std::make_shared<torch_ipex::runtime::TaskModule>(
-            module, py::cast<std::vector<int32_t>>(core_list));
-      }))
-      .def(py::init([](const torch::jit::Module& module,
-                       const py::list& core_list,
-                       bool traced_module) {
-        return std::make_shared<torch_ipex::runtime::TaskModule>(
-            module, py::cast<std::vector<int32_t>>(core_list), traced_module);
-      }))
+      // Register the script module constructor first, otherwise the
+      // py::object overload will also match the script module input.
+      .def(
+          py::init([](const torch::jit::Module& module,
+                      const py::list& core_list,
+                      bool traced_module,
+                      bool work_stealing,
+                      bool bind_memory) {
+            return std::make_shared<torch_ipex::runtime::TaskModule>(
+                module,
+                py::cast<std::vector<int32_t>>(core_list),
+                traced_module,
+                work_stealing,
+                bind_memory);
+          }),
+          py::arg("module"),
+          py::arg("core_list"),
+          py::arg("traced_module"),
+          py::arg("work_stealing") = false,
+          py::arg("bind_memory") = false)
+      .def(
+          py::init([](const py::object& module,
+                      const py::list& core_list,
+                      bool work_stealing,
+                      bool bind_memory) {
+            return std::make_shared<torch_ipex::runtime::TaskModule>(
+                module,
+                py::cast<std::vector<int32_t>>(core_list),
+                work_stealing,
+                bind_memory);
+          }),
+          py::arg("module"),
+          py::arg("core_list"),
+          py::arg("work_stealing") = false,
+          py::arg("bind_memory") = false)
       .def(
           "run_sync",
           [](torch_ipex::runtime::TaskModule& self,
@@ -319,7 +523,65 @@ void InitIpexModuleBindings(py::module m) {
             // Depending on this being ScriptModule of nn.Module we will release
             // the GIL or not further down in the stack
             return self.run_async(std::move(args), std::move(kwargs));
-          });
+          })
+      .def(
+          "get_num_stolen_tasks",
+          &torch_ipex::runtime::TaskModule::get_num_stolen_tasks);
+
+  py::class_<
+      torch_ipex::runtime::BatchScheduler,
+      std::shared_ptr<torch_ipex::runtime::BatchScheduler>>(
+      m, "BatchScheduler")
+      .def(
+          py::init([](const torch::jit::Module& module,
+                      const py::list& stream_core_lists,
+                      int64_t max_batch_size,
+                      int64_t max_latency_us,
+                      bool bind_memory) {
+            return std::make_shared<torch_ipex::runtime::BatchScheduler>(
+                module,
+                py::cast<std::vector<std::vector<int32_t>>>(stream_core_lists),
+                max_batch_size,
+                max_latency_us,
+                bind_memory);
+          }),
+          py::arg("module"),
+          py::arg("stream_core_lists"),
+          py::arg("max_batch_size"),
+          py::arg("max_latency_us"),
+          py::arg("bind_memory") = false)
+      .def(
+          "run_async",
+          [](torch_ipex::runtime::BatchScheduler& self, py::args& args) {
+            std::vector<c10::IValue> inputs;
+            inputs.reserve(args.size());
+            for (const auto& arg : args) {
+              inputs.emplace_back(
+                  torch::jit::toIValue(arg, c10::TensorType::get()));
+            }
+            std::unique_ptr<torch_ipex::runtime::FutureTensor>
+                future_tensor_result =
+                    std::make_unique<torch_ipex::runtime::FutureTensor>();
+            future_tensor_result->script_module_initialized_ = true;
+            future_tensor_result->future_script_tensor =
+                self.submit(std::move(inputs));
+            return future_tensor_result;
+          })
+      .def(
+          "stop",
+          [](torch_ipex::runtime::BatchScheduler& self) {
+            pybind11::gil_scoped_release no_gil_guard;
+            self.stop_scheduler();
+          })
+      .def(
+          "get_num_streams",
+          &torch_ipex::runtime::BatchScheduler::get_num_streams)
+      .def(
+          "get_max_batch_size",
+          &torch_ipex::runtime::BatchScheduler::get_max_batch_size)
+      .def(
+          "get_max_latency_us",
+          &torch_ipex::runtime::BatchScheduler::get_max_latency_us);
 
   py::enum_<IPEXLowPrecisionMode>(m, "IPEXLowPrecisionMode")
       .value("BF32", IPEXLowPrecisionMode::BF32)
@@ -328,17 +590,65 @@ void InitIpexModuleBindings(py::module m) {
 
   m.def("is_runtime_ext_enabled", &torch_ipex::runtime::is_runtime_ext_enabled);
   m.def("init_runtime_ext", &torch_ipex::runtime::init_runtime_ext);
-  m.def("pin_cpu_cores", [](const py::list& core_list) {
-    torch_ipex::runtime::_pin_cpu_cores(
-        py::cast<std::vector<int32_t>>(core_list));
-    return;
-  });
+  m.def(
+      "pin_cpu_cores",
+      [](const py::list& core_list, bool bind_memory) {
+        torch_ipex::runtime::_pin_cpu_cores(
+            py::cast<std::vector<int32_t>>(core_list), bind_memory);
+        return;
+      },
+      py::arg("core_list"),
+      py::arg("bind_memory") = false);
   m.def("is_same_core_affinity_setting", [](const py::list& core_list) {
     return torch_ipex::runtime::is_same_core_affinity_setting(
         // Here converting py::list to std::vector<int32_t> will have the data
         // copy.
         py::cast<std::vector<int32_t>>(core_list));
   });
+  m.def("get_cpu_topology", []() {
+    const auto& topology = torch_ipex::runtime::CPUTopology::get_instance();
+    py::list cpus;
+    for (const auto& cpu : topology.get_cpus()) {
+      auto py_dict = py::dict();
+      py_dict["cpu_id"] = cpu.cpu_id;
+      py_dict["socket_id"] = cpu.socket_id;
+      py_dict["numa_node_id"] = cpu.numa_node_id;
+      py_dict["core_id"] = cpu.core_id;
+      py_dict["l3_cache_id"] = cpu.l3_cache_id;
+      py_dict["is_smt_sibling"] = cpu.is_smt_sibling;
+      cpus.append(py_dict);
+    }
+    return cpus;
+  });
+  m.def("get_numa_node_ids", []() {
+    return torch_ipex::runtime::CPUTopology::get_instance().get_numa_node_ids();
+  });
+  m.def("get_num_sockets", []() {
+    return torch_ipex::runtime::CPUTopology::get_instance().get_num_sockets();
+  });
+  m.def(
+      "get_core_list_of_node_id",
+      [](int32_t node_id, bool physical_core_only) {
+        return torch_ipex::runtime::CPUTopology::get_instance()
+            .get_cpu_list_of_numa_node(node_id, physical_core_only);
+      },
+      py::arg("node_id"),
+      py::arg("physical_core_only") = true);
+  m.def(
+      "set_numa_weight_replica_enabled",
+      &torch_ipex::cpu::detail::set_numa_weight_replica_enabled);
+  m.def(
+      "is_numa_weight_replica_enabled",
+      &torch_ipex::cpu::detail::is_numa_weight_replica_enabled);
+  m.def(
+      "set_conv_bottleneck_tile_rows",
+      &torch_ipex::cpu::detail::set_bottleneck_tile_rows);
+  m.def(
+      "get_conv_bottleneck_tile_rows",
+      &torch_ipex::cpu::detail::get_bottleneck_tile_rows);
+  m.def(
+      "get_conv_bottleneck_tiled_runs",
+      &torch_ipex::cpu::detail::get_bottleneck_tiled_runs);
   m.def("get_current_cpu_pool", []() {
     return std::make_shared<torch_ipex::runtime::CPUPool>(
         torch_ipex::runtime::get_cpu_pool_from_mask_affinity());
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/*
+
+ShardedCache is a read-mostly concurrent cache. The keys are spread over
+shards, each guarded by its own reader-writer mutex. Lookups share the
+mutex of one shard, so concurrent lookups only contend on the lock word of
+the same shard, and inserts and erases hold one shard exclusively.
+
+Usage:
+
+torch_ipex::ShardedCache<Key, Value> cache(
+    capacity_bytes, [](const Value& value) { return is_dead(value); });
+
+Value value;
+if (!cache.lookup(key, value)) {
+    value = create(key);
+    cache.insert(key, value, nbytes_of(value));
+}
+
+If capacity_bytes is not 0, the least recently used entries are evicted once
+the total size of the entries exceeds it. The expired entries (for which the
+predicate returns true) of a shard are reclaimed when a key is inserted into
+it, remove_expired() reclaims those of all the shards.
+*/
+
+namespace torch_ipex {
+
+struct ShardedCacheStats {
+  int64_t hits;
+  int64_t misses;
+  int64_t evictions;
+  int64_t num_entries;
+  int64_t num_bytes;
+};
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedCache {
+ public:
+  using ExpiredPredicate = std::function<bool(const Value&)>;
+
+  explicit ShardedCache(
+      size_t capacity_bytes = 0,
+      ExpiredPredicate is_expired = nullptr,
+      size_t num_shards = 64)
+      : shards_(num_shards),
+        capacity_bytes_(capacity_bytes),
+        is_expired_(std::move(is_expired)) {}
+
+  ShardedCache(const ShardedCache&) = delete;
+  ShardedCache& operator=(const ShardedCache&) = delete;
+
+  bool lookup(const Key& key, Value& value) {
+    return lookup(key, [&value](const Value& cached) { value = cached; });
+  }
+
+  // Call visitor(const Value&) on the cached value if any, under the shared
+  // lock of the shard. The value must not be retained by reference after the
+  // visitor returns.
+  template <typename Visitor>
+  bool lookup(const Key& key, Visitor&& visitor) {
+    auto& shard = get_shard(key);
+    std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+    auto it = shard.table.find(key);
+    bool hit = it != shard.table.end();
+    if (hit) {
+      auto& entry = it->second;
+      visitor(entry.value);
+      // Only write the shared cache line when the stamp changes.
+      auto now = clock_.load(std::memory_order_relaxed);
+      if (entry.last_access.load(std::memory_order_relaxed) != now) {
+        entry.last_access.store(now, std::memory_order_relaxed);
+      }
+    }
+    (hit ? shard.hits : shard.misses).fetch_add(1, std::memory_order_relaxed);
+    return hit;
+  }
+
+  // Insert or replace the entry of the key. nbytes is the size counted into
+  // the capacity.
+  void insert(const Key& key, Value value, size_t nbytes) {
+    auto now = clock_.fetch_add(1, std::memory_order_relaxed) + 1;
+    {
+      auto& shard = get_shard(key);
+      std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+      // Only sweep the shard of the key, so that an insert doesn't lock all
+      // the shards.
+      remove_expired_locked(shard);
+      erase_locked(shard, key);
+      shard.table.emplace(
+          std::piecewise_construct,
+          std::forward_as_tuple(key),
+          std::forward_as_tuple(std::move(value), nbytes, now));
+      num_bytes_.fetch_add(nbytes);
+    }
+    evict_lru(&key);
+  }
+
+  bool erase(const Key& key) {
+    auto& shard = get_shard(key);
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+    return erase_locked(shard, key);
+  }
+
+  // Remove the entries of all the shards for which the expired predicate
+  // returns true.
+  void remove_expired() {
+    for (auto& shard : shards_) {
+      std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+      remove_expired_locked(shard);
+    }
+  }
+
+  void clear() {
+    for (auto& shard : shards_) {
+      std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+      for (const auto& item : shard.table) {
+        num_bytes_.fetch_sub(item.second.nbytes);
+      }
+      shard.table.clear();
+    }
+  }
+
+  void set_capacity(size_t capacity_bytes) {
+    capacity_bytes_.store(capacity_bytes);
+    evict_lru(nullptr);
+  }
+
+  size_t get_capacity() const {
+    return capacity_bytes_.load();
+  }
+
+  ShardedCacheStats get_stats() const {
+    ShardedCacheStats stats{0, 0, evictions_.load(), 0, num_bytes_.load()};
+    for (const auto& shard : shards_) {
+      stats.hits += shard.hits.load(std::memory_order_relaxed);
+      stats.misses += shard.misses.load(std::memory_order_relaxed);
+      std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+      stats.num_entries += shard.table.size();
+    }
+    return stats;
+  }
+
+ private:
+  struct Entry {
+    Entry(Value&& value, size_t nbytes, uint64_t last_access)
+        : value(std::move(value)), nbytes(nbytes), last_access(last_access) {}
+    Value value;
+    size_t nbytes;
+    std::atomic<uint64_t> last_access;
+  };
+  // The entries are constructed in place, since last_access can't be moved.
+  using Table = std::unordered_map<Key, Entry, Hash>;
+
+  struct Shard {
+    Table table;
+    std::atomic<int64_t> hits{0};
+    std::atomic<int64_t> misses{0};
+    // Shared by the lookups of this shard, held exclusively by the writers.
+    mutable std::shared_timed_mutex mutex;
+    // Keep the counters of the neighbouring shards off the same cache line.
+    char padding[64];
+  };
+
+  Shard& get_shard(const Key& key) {
+    // Mix the hash, since the hash of a pointer is the address itself.
+    uint64_t h = static_cast<uint64_t>(Hash()(key));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return shards_[h % shards_.size()];
+  }
+
+  // Must hold shard.mutex exclusively.
+  bool erase_locked(Shard& shard, const Key& key) {
+    auto it = shard.table.find(key);
+    if (it == shard.table.end()) {
+      return false;
+    }
+    num_bytes_.fetch_sub(it->second.nbytes);
+    shard.table.erase(it);
+    return true;
+  }
+
+  // Must hold shard.mutex exclusively.
+  void remove_expired_locked(Shard& shard) {
+    if (!is_expired_) {
+      return;
+    }
+    for (auto it = shard.table.begin(); it != shard.table.end();) {
+      if (is_expired_(it->second.value)) {
+        num_bytes_.fetch_sub(it->second.nbytes);
+        it = shard.table.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Evict the least recently used entries until the total size fits in the
+  // capacity. The entry of keep (if not null) is never evicted.
+  void evict_lru(const Key* keep) {
+    auto capacity_bytes = capacity_bytes_.load();
+    if (capacity_bytes == 0 ||
+        static_cast<size_t>(num_bytes_.load()) <= capacity_bytes) {
+      return;
+    }
+    std::lock_guard<std::mutex> evict_lock(evict_mutex_);
+    // (last_access, shard index, key)
+    std::vector<std::tuple<uint64_t, size_t, Key>> candidates;
+    for (size_t i = 0; i < shards_.size(); i++) {
+      std::shared_lock<std::shared_timed_mutex> lock(shards_[i].mutex);
+      for (const auto& item : shards_[i].table) {
+        if (keep == nullptr || !(item.first == *keep)) {
+          candidates.emplace_back(
+              item.second.last_access.load(std::memory_order_relaxed),
+              i,
+              item.first);
+        }
+      }
+    }
+    std::sort(
+        candidates.begin(),
+        candidates.end(),
+        [](const std::tuple<uint64_t, size_t, Key>& a,
+           const std::tuple<uint64_t, size_t, Key>& b) {
+          return std::get<0>(a) < std::get<0>(b);
+        });
+    for (const auto& candidate : candidates) {
+      if (static_cast<size_t>(num_bytes_.load()) <= capacity_bytes) {
+        break;
+      }
+      auto& shard = shards_[std::get<1>(candidate)];
+      std::unique_lock<std::shared_timed_mutex> lock(shard.mutex);
+      if (erase_locked(shard, std::get<2>(candidate))) {
+        evictions_.fetch_add(1);
+      }
+    }
+  }
+
+  std::vector<Shard> shards_;
+  std::atomic<size_t> capacity_bytes_;
+  ExpiredPredicate is_expired_;
+  // Logical clock of the LRU, advanced by each insert.
+  std::atomic<uint64_t> clock_{0};
+  std::atomic<int64_t> num_bytes_{0};
+  std::atomic<int64_t> evictions_{0};
+  std::mutex evict_mutex_;
+};
+
+} // namespace torch_ipex
@@ -116,7 +116,7 @@ def optimize(
             Note: Data type conversion is only applied to ``nn.Conv2d``, ``nn.Linear``
             and ``nn.ConvTranspose2d`` for both training and inference cases. For
             inference mode, additional data type conversion is applied to the weights
-            of ``nn.Embedding`` and ``nn.LSTM``.
+            of ``nn.Embedding``, ``nn.LSTM`` and ``nn.GRU``.
         optimizer (torch.optim.Optimizer): User optimizer to apply optimizations
             on, such as SGD. The default value is ``None``, meaning inference case.
         level (string): ``"O0"`` or ``"O1"``. No optimizations are applied with
@@ -141,8 +141,9 @@ def optimize(
             on the graph. This only works for inference model. The default value
             is ``None``. Explicitly setting this knob overwrites the configuration
             set by ``level`` knob.
-        optimize_lstm (bool): Whether to replace ``nn.LSTM`` with ``IPEX LSTM``
-            which takes advantage of oneDNN kernels to get better performance.
+        optimize_lstm (bool): Whether to replace ``nn.LSTM`` and ``nn.GRU`` with
+            ``IPEX LSTM`` and ``IPEX GRU`` which take advantage of oneDNN
+            kernels to get better performance.
             The default value is ``None``. Explicitly setting this knob
             overwrites the configuration set by ``level`` knob.
         split_master_weight_for_bf16 (bool): Whether to split master weights
@@ -266,6 +267,7 @@ def optimize(
 
     if opt_properties.optimize_lstm:
         utils._model_convert.replace_lstm_with_ipex_lstm(optimized_model)
+        utils._model_convert.replace_gru_with_ipex_gru(optimized_model)
     if model.training and opt_properties.split_master_weight_for_bf16 and dtype is torch.bfloat16:
         if not opt_properties.fuse_update_step:
             opt_properties.split_master_weight_for_bf16 = False
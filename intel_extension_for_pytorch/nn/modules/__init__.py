@@ -1,4 +1,8 @@
 from .frozen_batch_norm import FrozenBatchNorm2d
 from . import _roi_align
-from .merged_embeddingbag import MergedEmbeddingBagWithSGD
+from .merged_embeddingbag import MergedEmbeddingBagWithSGD, MergedEmbeddingBagWithAdagrad, \
+    MergedEmbeddingBagWithAdam, MergedEmbeddingBagWithLamb
 from .linear_fuse_eltwise import IPEXLinearEltwise
+from .paged_kv_cache import PagedKVCache
+from .rowwise_quantized_embeddingbag import RowwiseQuantizedEmbeddingBag, MergedRowwiseQuantizedEmbeddingBag
+from .mmap_embeddingbag import MmapEmbeddingBag
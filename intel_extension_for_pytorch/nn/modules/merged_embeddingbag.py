@@ -1,7 +1,7 @@
 import torch
 from torch import Tensor, nn
 from torch.autograd import Function
-from typing import List, Optional, NamedTuple
+from typing import List, Optional, NamedTuple, Tuple
 from itertools import accumulate
 import enum
 
@@ -14,6 +14,26 @@ class SGDArgs(NamedTuple):
     weight_decay: float
     lr: float
 
+class AdagradArgs(NamedTuple):
+    bf16_trail: List[Optional[torch.Tensor]]
+    state_sum: List[torch.Tensor]
+    rowwise: bool
+    eps: float
+    weight_decay: float
+    lr: float
+
+class AdamArgs(NamedTuple):
+    bf16_trail: List[Optional[torch.Tensor]]
+    exp_avg: List[torch.Tensor]
+    exp_avg_sq: List[torch.Tensor]
+    step: int
+    beta1: float
+    beta2: float
+    eps: float
+    weight_decay: float
+    lr: float
+    use_lamb: bool
+
 class EmbeddingSpec(NamedTuple):
     num_of_features: int
     feature_size: int
@@ -75,6 +95,91 @@ class MergedEmbeddingBagSGDFunc(Function):
         output = [None for i in range(n_tables + 6)]
         return MergedEmbeddingBagSGDFunc.unpack(*output)
 
+def merged_embeddingbag_adagrad(
+    indices,
+    offsets,
+    indices_with_row_offsets,
+    row_offsets,
+    pooling_modes,
+    adagrad_args,
+    *weights
+):
+    if torch.is_grad_enabled():
+        return MergedEmbeddingBagAdagradFunc.apply(
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, adagrad_args, *weights
+        )
+    return torch.ops.torch_ipex.merged_embeddingbag_forward(indices, offsets, weights, pooling_modes)
+
+class MergedEmbeddingBagAdagradFunc(Function):
+    @staticmethod
+    def forward(ctx, indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, adagrad_args, *weights):
+        output = torch.ops.torch_ipex.merged_embeddingbag_forward(
+            indices, offsets, weights, pooling_modes
+        )
+        ctx.indices = indices
+        ctx.offsets = offsets
+        ctx.weights = weights
+        ctx.indices_with_row_offsets = indices_with_row_offsets
+        ctx.row_offsets = row_offsets
+        ctx.pooling_modes = pooling_modes
+        ctx.adagrad_args = adagrad_args
+        return MergedEmbeddingBagSGDFunc.unpack(*output)
+
+    @staticmethod
+    def backward(ctx, *grad_out):
+        adagrad_args = ctx.adagrad_args
+        torch.ops.torch_ipex.merged_embeddingbag_backward_adagrad(
+            grad_out, ctx.indices, ctx.offsets, ctx.weights, ctx.indices_with_row_offsets,
+            ctx.row_offsets, ctx.pooling_modes,
+            adagrad_args.bf16_trail, adagrad_args.state_sum, adagrad_args.rowwise,
+            adagrad_args.eps, adagrad_args.weight_decay, adagrad_args.lr)
+        n_tables = len(ctx.weights)
+        output = [None for i in range(n_tables + 6)]
+        return MergedEmbeddingBagSGDFunc.unpack(*output)
+
+def merged_embeddingbag_adam(
+    indices,
+    offsets,
+    indices_with_row_offsets,
+    row_offsets,
+    pooling_modes,
+    adam_args,
+    *weights
+):
+    if torch.is_grad_enabled():
+        return MergedEmbeddingBagAdamFunc.apply(
+            indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, adam_args, *weights
+        )
+    return torch.ops.torch_ipex.merged_embeddingbag_forward(indices, offsets, weights, pooling_modes)
+
+class MergedEmbeddingBagAdamFunc(Function):
+    @staticmethod
+    def forward(ctx, indices, offsets, indices_with_row_offsets, row_offsets, pooling_modes, adam_args, *weights):
+        output = torch.ops.torch_ipex.merged_embeddingbag_forward(
+            indices, offsets, weights, pooling_modes
+        )
+        ctx.indices = indices
+        ctx.offsets = offsets
+        ctx.weights = weights
+        ctx.indices_with_row_offsets = indices_with_row_offsets
+        ctx.row_offsets = row_offsets
+        ctx.pooling_modes = pooling_modes
+        ctx.adam_args = adam_args
+        return MergedEmbeddingBagSGDFunc.unpack(*output)
+
+    @staticmethod
+    def backward(ctx, *grad_out):
+        adam_args = ctx.adam_args
+        torch.ops.torch_ipex.merged_embeddingbag_backward_adam(
+            grad_out, ctx.indices, ctx.offsets, ctx.weights, ctx.indices_with_row_offsets,
+            ctx.row_offsets, ctx.pooling_modes,
+            adam_args.bf16_trail, adam_args.exp_avg, adam_args.exp_avg_sq, adam_args.step,
+            adam_args.beta1, adam_args.beta2, adam_args.eps, adam_args.weight_decay,
+            adam_args.lr, adam_args.use_lamb)
+        n_tables = len(ctx.weights)
+        output = [None for i in range(n_tables + 6)]
+        return MergedEmbeddingBagSGDFunc.unpack(*output)
+
 class MergedEmbeddingBag(nn.Module):
     r"""
     Merge multiple Pytorch EmbeddingBag (https://github.com/pytorch/pytorch/blob/master/torch/nn/modules/sparse.py#L221) 
@@ -95,8 +200,8 @@ class MergedEmbeddingBag(nn.Module):
     are usually the first layer of a model. So "linearize_indices_and_offsets" can be considered as "data prepocess" and
     can be done offline.
     This Module can not be used alone, we suggest to use MergedEmbeddingBagWith[Optimizer] instead.
-    Now we can only choose MergedEmbeddingBagWithSGD and we plan to add more optimizer support
-    in the future.
+    Now we can choose MergedEmbeddingBagWithSGD, MergedEmbeddingBagWithAdagrad,
+    MergedEmbeddingBagWithAdam and MergedEmbeddingBagWithLamb.
     For the introduction of MergedEmbeddingBagWith[Optimizer], please find the comments at
     MergedEmbeddingBagWithSGD.
     """
@@ -201,8 +306,57 @@ class MergedEmbeddingBag(nn.Module):
         merged_offsets[-1] = n_indices
         return (merged_indices, merged_offsets, merged_indices_with_row_offsets)
 
+    def init_bf16_trails(self):
+        bf16_trail = []
+        for weight in self.weights:
+            if weight.dtype == torch.bfloat16:
+                bf16_trail.append(torch.zeros_like(weight, dtype=torch.bfloat16))
+            else:
+                bf16_trail.append(torch.empty(0, dtype=torch.bfloat16))
+        return bf16_trail
+
+    def split_bfloat16_trails(self):
+        r"""
+        Cast weight to bf16 and return the trail parts, bf16 weight + trail is the fp32 master weight
+        """
+        trails = []
+        for i in range(len(self.weights)):
+            if self.weights[i].dtype == torch.float:
+                bf16_w, trail = torch.ops.torch_ipex.split_float_bfloat16(self.weights[i])
+            elif self.weights[i].dtype == torch.bfloat16:
+                bf16_w = self.weights[i]
+                trail = torch.zeros_like(bf16_w, dtype=torch.bfloat16)
+            elif self.weights[i].dtype == torch.double:
+                bf16_w, trail = torch.ops.torch_ipex.split_float_bfloat16(self.weights[i].float())
+            else:
+                assert False, r"MergedEmbeddingBag only support dtypes with bfloat, float and double"
+            trails.append(trail)
+            self.weights[i] = torch.nn.Parameter(bf16_w)
+        return trails
+
+    def linearize_input(self, input, need_linearize_indices_and_offsets):
+        if need_linearize_indices_and_offsets.item():
+            indices, offsets, include_last_offsets = input
+            return self.linearize_indices_and_offsets(indices, offsets, include_last_offsets)
+        return input
+
+    @staticmethod
+    def embedding_specs_from_list(tables: List[torch.nn.EmbeddingBag]):
+        embedding_specs = []
+        for emb in tables:
+            emb_shape = emb.weight.shape
+            embedding_specs.append(
+                EmbeddingSpec(
+                    num_of_features=emb_shape[0],
+                    feature_size=emb_shape[1],
+                    pooling_modes=emb.mode,
+                    dtype=emb.weight.dtype,
+                    weight=emb.weight.detach()
+                ))
+        return embedding_specs
+
     def forward(self, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
-        assert False, "Please use MergedEmbeddingBagWith[Optimizer]. We only support SGD now, so please create module MergedEmbeddingBagWithSGD instead"
+        assert False, "Please use MergedEmbeddingBagWith[Optimizer], e.g. MergedEmbeddingBagWithSGD"
 
 
 class MergedEmbeddingBagWithSGD(MergedEmbeddingBag):
@@ -273,19 +427,7 @@ class MergedEmbeddingBagWithSGD(MergedEmbeddingBag):
         r"""
         Cast weight to bf16 and it's trail part for training
         """
-        trails = []
-        for i in range(len(self.weights)):
-            if self.weights[i].dtype == torch.float:
-                bf16_w, trail = torch.ops.torch_ipex.split_float_bfloat16(self.weights[i])
-            elif self.weights[i].dtype == torch.bfloat16:
-                bf16_w = self.weights[i]
-                trail = torch.zeros_like(bf16_w, dtype=torch.bfloat16)
-            elif self.weights[i].dtype == torch.double:
-                bf16_w, trail = torch.ops.torch_ipex.split_float_bfloat16(self.weights[i].float())
-            else:
-                assert False, r"MergedEmbeddingBag only support dtypes with bfloat, float and double"
-            trails.append(trail)
-            self.weights[i] = torch.nn.Parameter(bf16_w)
+        trails = self.split_bfloat16_trails()
         self.sgd_args = self.sgd_args._replace(bf16_trail=trails)
 
     def forward(self, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
@@ -325,3 +467,169 @@ class MergedEmbeddingBagWithSGD(MergedEmbeddingBag):
                     weight=emb.weight.detach()
                 ))
         return cls(embedding_specs, lr, weight_decay)
+
+
+def state_dtype(weight):
+    # The states of the bfloat16 weights are kept in float as the master weights.
+    return torch.double if weight.dtype == torch.double else torch.float
+
+
+class MergedEmbeddingBagWithAdagrad(MergedEmbeddingBag):
+    r"""
+    MergedEmbeddingBag whose Adagrad step is fused with the backward, as MergedEmbeddingBagWithSGD.
+    The state_sum of a row is only updated when the row is used in the batch, i.e. the
+    same as torch.optim.Adagrad on the sparse grads.
+    With rowwise=True, there is one state per row, which accumulates the mean of the squared
+    grads of the row, so that the states take 1/feature_size memory of the weights.
+        >>> merged_emb = MergedEmbeddingBagWithAdagrad.from_embeddingbag_list(tables, lr=0.01, rowwise=True)
+        >>> outputs = merged_emb((indices, offsets, include_last_offsets))
+        >>> torch.autograd.backward(outputs, grads)
+    """
+    embedding_specs: List[EmbeddingSpec]
+
+    def __init__(
+        self,
+        embedding_specs: List[EmbeddingSpec],
+        lr: float = 0.01,
+        eps: float = 1e-10,
+        weight_decay: float = 0,
+        rowwise: bool = False
+    ):
+        super(MergedEmbeddingBagWithAdagrad, self).__init__(embedding_specs)
+        if lr < 0.0:
+            raise ValueError("Invalid learning rate: {}".format(lr))
+        if eps < 0.0:
+            raise ValueError("Invalid epsilon value: {}".format(eps))
+        if weight_decay < 0.0:
+            raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
+        state_sum = [self.new_state_sum(weight, rowwise) for weight in self.weights]
+        self.adagrad_args = AdagradArgs(
+            bf16_trail=self.init_bf16_trails(),
+            state_sum=state_sum,
+            rowwise=rowwise,
+            eps=eps,
+            weight_decay=weight_decay,
+            lr=lr
+        )
+
+    @staticmethod
+    def new_state_sum(weight, rowwise):
+        shape = weight.shape[:1] if rowwise else weight.shape
+        return torch.zeros(shape, dtype=state_dtype(weight))
+
+    def to_bfloat16_train(self):
+        r"""
+        Cast weight to bf16 and it's trail part for training
+        """
+        trails = self.split_bfloat16_trails()
+        state_sum = [s.float() for s in self.adagrad_args.state_sum]
+        self.adagrad_args = self.adagrad_args._replace(bf16_trail=trails, state_sum=state_sum)
+
+    def forward(self, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
+        r"""
+        Args are the same as MergedEmbeddingBagWithSGD.
+        """
+        indices, offsets, indices_with_row_offsets = self.linearize_input(input, need_linearize_indices_and_offsets)
+        return merged_embeddingbag_adagrad(
+            indices, offsets, indices_with_row_offsets, self.row_offsets,
+            self.pooling_modes, self.adagrad_args, *self.weights
+        )
+
+    @classmethod
+    def from_embeddingbag_list(
+        cls,
+        tables: List[torch.nn.EmbeddingBag],
+        lr: float = 0.01,
+        eps: float = 1e-10,
+        weight_decay: float = 0,
+        rowwise: bool = False
+    ):
+        return cls(cls.embedding_specs_from_list(tables), lr, eps, weight_decay, rowwise)
+
+
+class MergedEmbeddingBagWithAdam(MergedEmbeddingBag):
+    r"""
+    MergedEmbeddingBag whose Adam step is fused with the backward, as MergedEmbeddingBagWithSGD.
+    The moments of a row are only updated when the row is used in the batch (i.e. lazy Adam as
+    torch.optim.SparseAdam), the bias corrections follow the number of the training steps.
+        >>> merged_emb = MergedEmbeddingBagWithAdam.from_embeddingbag_list(tables, lr=0.001)
+        >>> outputs = merged_emb((indices, offsets, include_last_offsets))
+        >>> torch.autograd.backward(outputs, grads)
+    """
+    embedding_specs: List[EmbeddingSpec]
+    use_lamb = False
+
+    def __init__(
+        self,
+        embedding_specs: List[EmbeddingSpec],
+        lr: float = 0.001,
+        betas: Tuple[float, float] = (0.9, 0.999),
+        eps: float = 1e-8,
+        weight_decay: float = 0
+    ):
+        super(MergedEmbeddingBagWithAdam, self).__init__(embedding_specs)
+        if lr < 0.0:
+            raise ValueError("Invalid learning rate: {}".format(lr))
+        if eps < 0.0:
+            raise ValueError("Invalid epsilon value: {}".format(eps))
+        if not 0.0 <= betas[0] < 1.0:
+            raise ValueError("Invalid beta parameter at index 0: {}".format(betas[0]))
+        if not 0.0 <= betas[1] < 1.0:
+            raise ValueError("Invalid beta parameter at index 1: {}".format(betas[1]))
+        if weight_decay < 0.0:
+            raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
+        self.adam_args = AdamArgs(
+            bf16_trail=self.init_bf16_trails(),
+            exp_avg=[torch.zeros_like(w, dtype=state_dtype(w)) for w in self.weights],
+            exp_avg_sq=[torch.zeros_like(w, dtype=state_dtype(w)) for w in self.weights],
+            step=0,
+            beta1=betas[0],
+            beta2=betas[1],
+            eps=eps,
+            weight_decay=weight_decay,
+            lr=lr,
+            use_lamb=self.use_lamb
+        )
+
+    def to_bfloat16_train(self):
+        r"""
+        Cast weight to bf16 and it's trail part for training
+        """
+        trails = self.split_bfloat16_trails()
+        self.adam_args = self.adam_args._replace(
+            bf16_trail=trails,
+            exp_avg=[s.float() for s in self.adam_args.exp_avg],
+            exp_avg_sq=[s.float() for s in self.adam_args.exp_avg_sq])
+
+    def forward(self, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
+        r"""
+        Args are the same as MergedEmbeddingBagWithSGD. Each forward with grad enabled is
+        counted as a training step.
+        """
+        indices, offsets, indices_with_row_offsets = self.linearize_input(input, need_linearize_indices_and_offsets)
+        if torch.is_grad_enabled():
+            self.adam_args = self.adam_args._replace(step=self.adam_args.step + 1)
+        return merged_embeddingbag_adam(
+            indices, offsets, indices_with_row_offsets, self.row_offsets,
+            self.pooling_modes, self.adam_args, *self.weights
+        )
+
+    @classmethod
+    def from_embeddingbag_list(
+        cls,
+        tables: List[torch.nn.EmbeddingBag],
+        lr: float = 0.001,
+        betas: Tuple[float, float] = (0.9, 0.999),
+        eps: float = 1e-8,
+        weight_decay: float = 0
+    ):
+        return cls(cls.embedding_specs_from_list(tables), lr, betas, eps, weight_decay)
+
+
+class MergedEmbeddingBagWithLamb(MergedEmbeddingBagWithAdam):
+    r"""
+    MergedEmbeddingBag whose LAMB step is fused with the backward. The Adam update plus the
+    decoupled weight decay of a row is scaled by the trust ratio ||w|| / ||update|| of the row
+    (1 if either is 0), i.e. each row is a layer of LAMB.
+    """
+    use_lamb = True
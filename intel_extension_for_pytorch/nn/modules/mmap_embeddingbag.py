@@ -0,0 +1,105 @@
+import torch
+from torch import Tensor, nn
+from typing import Optional
+
+from .merged_embeddingbag import PoolingMode
+
+
+def save_embedding_table(weight: Tensor, path: str):
+    r"""
+    Write the float or bfloat16 table ``weight`` of
+    :math:`(num\_embeddings, embedding\_dim)` to ``path`` as the raw rows in
+    row-major order, which can be mapped by ``MmapEmbeddingBag``.
+    """
+    assert weight.dim() == 2 and weight.dtype in [torch.float, torch.bfloat16], \
+        "save_embedding_table only supports 2D float and bfloat16 tables"
+    weight = weight.detach().contiguous()
+    # numpy has no bfloat16, the bytes are the same.
+    if weight.dtype == torch.bfloat16:
+        weight = weight.view(torch.int16)
+    weight.numpy().tofile(path)
+
+
+class MmapEmbeddingBag(nn.Module):
+    r"""
+    Inference-only EmbeddingBag over a table which is larger than the DRAM.
+    The table is memory-mapped from a file (e.g. on a local NVMe or pmem)
+    written by ``save_embedding_table``, and its frequently accessed rows are
+    copied into an in-DRAM cache of ``cache_rows`` rows.
+
+    Args:
+        path (str): the file of the table.
+        num_embeddings (int): number of the rows of the table.
+        embedding_dim (int): size of each embedding vector.
+        mode (str): ``'sum'`` or ``'mean'``. Default: ``'mean'``.
+        include_last_offset (bool): same as ``torch.nn.EmbeddingBag``.
+            Default: ``False``.
+        dtype (torch.dtype): ``torch.float`` or ``torch.bfloat16``, dtype of
+            the table and the output. Default: ``torch.float``.
+        cache_rows (int): number of the rows cached in DRAM. Default: 0.
+
+    The input and offsets follow ``torch.nn.EmbeddingBag``. ``prefetch`` asks
+    the OS to read the rows of the next input in the background, e.g. while
+    the rest of the model runs on the current input.
+
+    Examples::
+
+        >>> ipex.nn.modules.mmap_embeddingbag.save_embedding_table(weight, '/nvme/table0.bin')
+        >>> emb = ipex.nn.modules.MmapEmbeddingBag('/nvme/table0.bin', 100000000, 128, mode='sum', cache_rows=1000000)
+        >>> for input, offsets in batches:
+        >>>     output = emb(input, offsets)
+        >>>     emb.prefetch(next_input)
+    """
+
+    def __init__(
+        self,
+        path: str,
+        num_embeddings: int,
+        embedding_dim: int,
+        mode: str = 'mean',
+        include_last_offset: bool = False,
+        dtype: torch.dtype = torch.float,
+        cache_rows: int = 0,
+    ):
+        super(MmapEmbeddingBag, self).__init__()
+        assert mode in ['sum', 'mean'], "MmapEmbeddingBag only support mode sum or mean"
+        self.path = path
+        self.num_embeddings = num_embeddings
+        self.embedding_dim = embedding_dim
+        self.mode = mode
+        self.pooling_mode = PoolingMode.SUM if mode == 'sum' else PoolingMode.MEAN
+        self.include_last_offset = include_last_offset
+        self.dtype = dtype
+        self.cache_rows = cache_rows
+        self.table = torch.classes.torch_ipex.MmapEmbeddingTable(
+            path, num_embeddings, embedding_dim, dtype, cache_rows)
+
+    @property
+    def weight(self) -> Tensor:
+        r"""
+        The whole mapped table, the writes to it are not saved to the file.
+        """
+        return self.table.get_weight()
+
+    def extra_repr(self) -> str:
+        return '{}, {}, {}, mode={}, cache_rows={}'.format(
+            self.path, self.num_embeddings, self.embedding_dim, self.mode, self.cache_rows)
+
+    def prefetch(self, input: Tensor):
+        self.table.prefetch(input.reshape(-1))
+
+    def stats(self):
+        r"""
+        The hits, misses, cached_rows, admissions and evictions of the cache.
+        """
+        return self.table.get_stats()
+
+    def forward(self, input: Tensor, offsets: Optional[Tensor] = None) -> Tensor:
+        include_last_offset = self.include_last_offset
+        if input.dim() == 2:
+            assert offsets is None, "offsets should be None if input is 2-D tensor"
+            offsets = torch.arange(0, input.numel(), input.shape[1], dtype=torch.int64)
+            include_last_offset = False
+            input = input.reshape(-1)
+        return torch.ops.torch_ipex.mmap_embedding_bag(
+            self.table, input, offsets, self.pooling_mode, include_last_offset)
@@ -0,0 +1,122 @@
+import torch
+from torch import nn
+from typing import Optional
+
+
+class PagedKVCache(nn.Module):
+    r"""
+    Key/value cache of one attention layer for the autoregressive decoding.
+
+    The keys and values of the tokens are stored in a pool of fixed-size blocks
+    and a sequence takes a free block each time it grows past its last block,
+    so appending a token never reallocates or concatenates the cache.
+
+    Each call of forward decodes one token for the first ``batch_size``
+    sequences: it appends the new key/value into the cache and returns the
+    attention of the query over all the cached tokens of each sequence.
+
+    Args:
+        num_heads (int): number of the attention heads.
+        head_dim (int): size of each head of the key and value.
+        max_batch_size (int): max number of the sequences cached at the same
+            time.
+        max_seq_len (int): max number of the tokens of a sequence.
+        block_size (int): number of the tokens of a block. Default: 16.
+        num_blocks (int, optional): number of the blocks in the pool. Default:
+            enough blocks for ``max_batch_size`` sequences of ``max_seq_len``.
+        dtype (torch.dtype): dtype of the cache, ``torch.float``,
+            ``torch.bfloat16`` or ``torch.int8``. An int8 cache is quantized
+            with a symmetric scale per token and head. Default:
+            ``torch.bfloat16``.
+
+    Shape:
+        - query, key, value: :math:`(B, num\_heads, 1, head\_dim)`
+        - attention_mask (optional): broadcastable to
+          :math:`(B, 1, 1, L)`, where :math:`L` is at least the length of the
+          longest sequence after the append.
+        - Output: :math:`(B, num\_heads, 1, head\_dim)`, same dtype as query.
+
+    Examples::
+
+        >>> cache = ipex.nn.modules.PagedKVCache(12, 64, 8, 1024)
+        >>> for _ in range(steps):
+        >>>     context = cache(query, key, value, 1 / math.sqrt(64))
+    """
+
+    def __init__(
+        self,
+        num_heads: int,
+        head_dim: int,
+        max_batch_size: int,
+        max_seq_len: int,
+        block_size: int = 16,
+        num_blocks: Optional[int] = None,
+        dtype: torch.dtype = torch.bfloat16,
+    ):
+        super(PagedKVCache, self).__init__()
+        assert dtype in [torch.float, torch.bfloat16, torch.int8], \
+            "PagedKVCache only supports float, bfloat16 and int8 caches"
+        self.block_size = block_size
+        self.max_seq_len = max_seq_len
+        max_blocks_per_seq = (max_seq_len + block_size - 1) // block_size
+        if num_blocks is None:
+            num_blocks = max_batch_size * max_blocks_per_seq
+        cache_size = [num_blocks, num_heads, block_size, head_dim]
+        self.register_buffer('key_cache', torch.zeros(cache_size, dtype=dtype))
+        self.register_buffer('value_cache', torch.zeros(cache_size, dtype=dtype))
+        if dtype == torch.int8:
+            self.register_buffer('key_scale', torch.zeros(cache_size[:3]))
+            self.register_buffer('value_scale', torch.zeros(cache_size[:3]))
+        else:
+            self.key_scale = None
+            self.value_scale = None
+        self.register_buffer(
+            'block_table',
+            torch.full([max_batch_size, max_blocks_per_seq], -1, dtype=torch.long))
+        self.register_buffer(
+            'seq_lens', torch.zeros(max_batch_size, dtype=torch.long))
+        self.free_blocks = list(range(num_blocks - 1, -1, -1))
+
+    def reset(self):
+        r"""Drop all the cached sequences."""
+        self.block_table.fill_(-1)
+        self.seq_lens.zero_()
+        self.free_blocks = list(range(self.key_cache.size(0) - 1, -1, -1))
+
+    def free(self, seq_id: int):
+        r"""Drop the sequence ``seq_id`` and return its blocks to the pool."""
+        blocks = self.block_table[seq_id]
+        self.free_blocks.extend(blocks[blocks >= 0].tolist())
+        blocks.fill_(-1)
+        self.seq_lens[seq_id] = 0
+
+    def _reserve(self, batch_size: int):
+        # Take a new block for the sequences whose last block is full.
+        for seq_id, seq_len in enumerate(self.seq_lens[:batch_size].tolist()):
+            if seq_len >= self.max_seq_len:
+                raise RuntimeError(
+                    "PagedKVCache: sequence {} exceeds max_seq_len {}".format(
+                        seq_id, self.max_seq_len))
+            if seq_len % self.block_size == 0:
+                if not self.free_blocks:
+                    raise RuntimeError("PagedKVCache: out of cache blocks")
+                self.block_table[seq_id, seq_len // self.block_size] = \
+                    self.free_blocks.pop()
+
+    def forward(self, query, key, value, scale: float, attention_mask=None):
+        batch_size = query.size(0)
+        self._reserve(batch_size)
+        context = torch.ops.torch_ipex.kv_cache_decode_attention(
+            query,
+            key,
+            value,
+            self.key_cache,
+            self.value_cache,
+            self.key_scale,
+            self.value_scale,
+            self.block_table[:batch_size],
+            self.seq_lens[:batch_size],
+            scale,
+            attention_mask)
+        self.seq_lens[:batch_size] += 1
+        return context
@@ -0,0 +1,188 @@
+import torch
+from torch import Tensor, nn
+from typing import List, Optional
+from itertools import accumulate
+
+from .merged_embeddingbag import MergedEmbeddingBag, PoolingMode
+
+
+def _get_pooling_mode(mode):
+    if mode == 'sum':
+        return PoolingMode.SUM
+    elif mode == 'mean':
+        return PoolingMode.MEAN
+    assert False, r"RowwiseQuantizedEmbeddingBag only support EmbeddingBag with mode sum or mean"
+
+
+def rowwise_quantize_embedding(weight: Tensor, bit_width: int = 8) -> Tensor:
+    r"""
+    Quantize each row of the float or bfloat16 table ``weight`` of
+    :math:`(num\_rows, embedding\_dim)` with its own scale and bias to
+    ``bit_width`` (8 or 4) bits. The row :math:`r` of the returned uint8 table
+    holds the quantized values, then the float scale and bias, and
+    :math:`weight[r] \approx q[r] * scale[r] + bias[r]`.
+    """
+    return torch.ops.torch_ipex.rowwise_quantize_embedding(weight.detach(), bit_width)
+
+
+def rowwise_dequantize_embedding(qweight: Tensor, bit_width: int, embedding_dim: int) -> Tensor:
+    r"""
+    The float table of a table quantized by ``rowwise_quantize_embedding``.
+    """
+    return torch.ops.torch_ipex.rowwise_dequantize_embedding(qweight, bit_width, embedding_dim)
+
+
+class RowwiseQuantizedEmbeddingBag(nn.Module):
+    r"""
+    Inference-only EmbeddingBag over a table quantized row-wise to INT8 or
+    INT4, which takes about 1/4 or 1/8 of the memory of the float table. The
+    rows are dequantized while they are pooled, so the float table is never
+    materialized.
+
+    Args:
+        qweight (Tensor): the uint8 table returned by ``rowwise_quantize_embedding``.
+        embedding_dim (int): size of each embedding vector.
+        bit_width (int): 8 or 4.
+        mode (str): ``'sum'`` or ``'mean'``. Default: ``'mean'``.
+        include_last_offset (bool): same as ``torch.nn.EmbeddingBag``.
+            Default: ``False``.
+
+    The input and offsets follow ``torch.nn.EmbeddingBag``, the output is
+    float.
+
+    Examples::
+
+        >>> emb = torch.nn.EmbeddingBag(1000, 128, mode='sum')
+        >>> qemb = ipex.nn.modules.RowwiseQuantizedEmbeddingBag.from_embeddingbag(emb, bit_width=4)
+        >>> output = qemb(indices, offsets)
+    """
+
+    def __init__(
+        self,
+        qweight: Tensor,
+        embedding_dim: int,
+        bit_width: int = 8,
+        mode: str = 'mean',
+        include_last_offset: bool = False,
+    ):
+        super(RowwiseQuantizedEmbeddingBag, self).__init__()
+        assert bit_width in [8, 4], "RowwiseQuantizedEmbeddingBag only supports 8 and 4 bits"
+        self.embedding_dim = embedding_dim
+        self.bit_width = bit_width
+        self.mode = mode
+        self.pooling_mode = _get_pooling_mode(mode)
+        self.include_last_offset = include_last_offset
+        self.register_buffer("qweight", qweight)
+
+    @classmethod
+    def from_embeddingbag(cls, emb: torch.nn.EmbeddingBag, bit_width: int = 8):
+        return cls(
+            rowwise_quantize_embedding(emb.weight, bit_width),
+            emb.embedding_dim,
+            bit_width,
+            emb.mode,
+            emb.include_last_offset,
+        )
+
+    def extra_repr(self) -> str:
+        return '{}, {}, bit_width={}, mode={}'.format(
+            self.qweight.shape[0], self.embedding_dim, self.bit_width, self.mode)
+
+    def dequantize(self) -> Tensor:
+        return rowwise_dequantize_embedding(self.qweight, self.bit_width, self.embedding_dim)
+
+    def forward(self, input: Tensor, offsets: Optional[Tensor] = None) -> Tensor:
+        include_last_offset = self.include_last_offset
+        if input.dim() == 2:
+            assert offsets is None, "offsets should be None if input is 2-D tensor"
+            offsets = torch.arange(0, input.numel(), input.shape[1], dtype=torch.int64)
+            include_last_offset = False
+            input = input.reshape(-1)
+        return torch.ops.torch_ipex.rowwise_quantized_embedding_bag(
+            self.qweight, input, offsets, self.bit_width, self.embedding_dim,
+            self.pooling_mode, include_last_offset)
+
+
+class MergedRowwiseQuantizedEmbeddingBag(nn.Module):
+    r"""
+    Inference-only MergedEmbeddingBag over tables quantized row-wise to INT8
+    or INT4. All the tables are pooled by one op, the rows are dequantized
+    while they are pooled.
+
+    Examples::
+
+        >>> qemb = ipex.nn.modules.MergedRowwiseQuantizedEmbeddingBag.from_embeddingbag_list(
+        >>>     [emb1, emb2, emb3], bit_width=4)
+        >>> outputs = qemb((indices, offsets, include_last_offsets))
+    """
+
+    # Only reads n_tables and row_offsets.
+    linearize_indices_and_offsets = MergedEmbeddingBag.linearize_indices_and_offsets
+
+    def __init__(
+        self,
+        qweights: List[Tensor],
+        embedding_dims: List[int],
+        bit_widths: List[int],
+        modes: List[str],
+    ):
+        super(MergedRowwiseQuantizedEmbeddingBag, self).__init__()
+        self.n_tables = len(qweights)
+        assert self.n_tables == len(embedding_dims) == len(bit_widths) == len(modes), \
+            "expect the embedding_dim, bit_width and mode of each table"
+        assert all(bit_width in [8, 4] for bit_width in bit_widths), \
+            "MergedRowwiseQuantizedEmbeddingBag only supports 8 and 4 bits"
+        self.embedding_dims = list(embedding_dims)
+        self.bit_widths = list(bit_widths)
+        self.pooling_modes = [_get_pooling_mode(mode) for mode in modes]
+        self.qweights = list(qweights)
+        for i, qweight in enumerate(self.qweights):
+            self.register_buffer("qweight{}".format(i), qweight)
+        self.register_buffer(
+            "row_offsets",
+            torch.tensor([0] + list(accumulate([q.shape[0] for q in qweights])), dtype=torch.int64),
+        )
+
+    @classmethod
+    def from_embeddingbag_list(
+        cls,
+        tables: List[torch.nn.EmbeddingBag],
+        bit_width: int = 8,
+    ):
+        return cls(
+            [rowwise_quantize_embedding(emb.weight, bit_width) for emb in tables],
+            [emb.embedding_dim for emb in tables],
+            [bit_width] * len(tables),
+            [emb.mode for emb in tables],
+        )
+
+    def _apply(self, fn):
+        super(MergedRowwiseQuantizedEmbeddingBag, self)._apply(fn)
+        self.qweights = [getattr(self, "qweight{}".format(i)) for i in range(self.n_tables)]
+        return self
+
+    def extra_repr(self) -> str:
+        s = 'number of tables={}\n'.format(self.n_tables)
+        for i in range(self.n_tables):
+            s += "table{}: {}, {}, bit_width={}, {}".format(
+                i, self.qweights[i].shape[0], self.embedding_dims[i], self.bit_widths[i], self.pooling_modes[i])
+            if i != self.n_tables - 1:
+                s += '\n'
+        return s
+
+    def forward(self, input, need_linearize_indices_and_offsets=torch.BoolTensor([True])):
+        r"""
+        Args:
+            input (Tuple[Tensor]): a tuple of (indices, offsets, include_last_offsets) if it needs to be
+                linearized, otherwise the linearized (indices, offsets, indices_with_row_offsets)
+            need_linearize_indices_and_offsets: indicate whether input need to be linearized
+        Returns:
+            List[Tensor] float output of shape `(batch_size, embedding_dim)` of each table.
+        """
+        if need_linearize_indices_and_offsets.item():
+            indices, offsets, include_last_offsets = input
+            indices, offsets, _ = self.linearize_indices_and_offsets(indices, offsets, include_last_offsets)
+        else:
+            indices, offsets, _ = input
+        return torch.ops.torch_ipex.merged_rowwise_quantized_embeddingbag_forward(
+            indices, offsets, self.qweights, self.bit_widths, self.embedding_dims, self.pooling_modes)
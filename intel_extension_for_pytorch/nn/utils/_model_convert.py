@@ -64,6 +64,57 @@ def replace_lstm_with_ipex_lstm(model):
         else:
             replace_lstm_with_ipex_lstm(child)
 
+class _GRU(torch.nn.GRU):
+    # Swap the gru module with the ipex counterpart, which is computed by the
+    # linear-before-reset GRU of oneDNN instead of the ATen fallback.
+    def __init__(self, *args, **kwargs):
+        super().__init__(*args, **kwargs)
+
+    # port from torch/nn/modules/rnn.py
+    # replace the _VF.gru with torch.ops.torch_ipex.ipex_gru when the input is not PackedSequence
+    def forward(self, input, hx=None):  # noqa: F811
+        orig_input = input
+        # xxx: isinstance check needs to be in conditional for TorchScript to compile
+        if isinstance(orig_input, PackedSequence):
+            # fallback to PyTorch GRU since PackedSequence unsupported in oneDNN
+            return super(_GRU, self).forward(input, hx)
+        else:
+            batch_sizes = None
+            max_batch_size = input.size(0) if self.batch_first else input.size(1)
+            sorted_indices = None
+            unsorted_indices = None
+
+        if hx is None:
+            num_directions = 2 if self.bidirectional else 1
+            hx = torch.zeros(self.num_layers * num_directions,
+                             max_batch_size, self.hidden_size,
+                             dtype=input.dtype, device=input.device)
+        else:
+            # Each batch of the hidden state should match the input sequence that
+            # the user believes he/she is passing in.
+            hx = self.permute_hidden(hx, sorted_indices)
+
+        self.check_forward_args(input, hx, batch_sizes)
+        output, hidden = torch.ops.torch_ipex.ipex_gru(input, hx, self._flat_weights, self.bias, self.num_layers,
+                        self.dropout, self.training, self.bidirectional, self.batch_first)
+
+        return output, self.permute_hidden(hidden, unsorted_indices)
+
+def replace_gru_with_ipex_gru(model):
+    # replace gru with ipex gru
+    # does not support the case where model itself is torch.nn.GRU
+    for child_name, child in model.named_children():
+        if isinstance(child, torch.nn.GRU):
+            assert hasattr(child, "weight_ih_l0"), "torch.nn.GRU should have weight_ih_l0"
+            ipex_gru = _GRU(child.input_size, child.hidden_size,
+                child.num_layers, child.bias, child.batch_first,
+                child.dropout, child.bidirectional,
+                device=child.weight_ih_l0.device, dtype=child.weight_ih_l0.dtype)
+            ipex_gru.__dict__ = copy.deepcopy(child.__dict__)
+            setattr(model, child_name, ipex_gru)
+        else:
+            replace_gru_with_ipex_gru(child)
+
 def replace_dropout_with_identity(model):
     # replace dropout with identity during inference, so that aten::dropout won't be on the JIT graph.
     # This optimization may provide more fusion opportunites on the graph.
@@ -83,10 +134,11 @@ def convert_module_data_type(module, dtype):
                            torch.nn.ConvTranspose2d,
                            torch.nn.Linear,
                            torch.nn.Embedding,
-                           torch.nn.LSTM]
+                           torch.nn.LSTM,
+                           torch.nn.GRU]
     for module_cls in module_convert_list:
         if isinstance(module, module_cls):
-            if module_cls is torch.nn.LSTM:
+            if module_cls is torch.nn.LSTM or module_cls is torch.nn.GRU:
                 for name, param in module.named_parameters():
                     ori_data = getattr(getattr(module, name), "data")
                     ori_data_dtype = ori_data.dtype
@@ -14,6 +14,26 @@ def get_bf16_grad(param, params_attr):
     assert is_master_weight(param, params_attr)
     return params_attr[param]['bf16_param'].grad
 
+def get_param2(param, attr):
+    param2 = torch.Tensor()
+    if param in attr:
+        if 'trail' in attr[param]:
+            assert param.dtype is torch.bfloat16
+            param2 = attr[param]['trail']
+        if 'bf16_param' in attr[param]:
+            assert param.dtype is torch.float
+            param2 = attr[param]['bf16_param']
+    return param2
+
+def group_by_dtype(params, grads):
+    r"""Group the indices of params by the dtype of (param, grad), the
+    multi-tensor fused steps update the params of a group in one kernel.
+    """
+    groups = {}
+    for i, (param, grad) in enumerate(zip(params, grads)):
+        groups.setdefault((param.dtype, grad.dtype), []).append(i)
+    return groups.values()
+
 def _make_sparse(grad, grad_indices, values):
     size = grad.size()
     if grad_indices.numel() == 0 or values.numel() == 0:
@@ -37,28 +57,25 @@ def _adagrad_impl(
     See :class:`~torch.optim.Adagrad` for details.
     """
 
-    for (param, grad, state_sum, step_t) in zip(params, grads, state_sums, state_steps):
-        step = int(step_t.item())
-        param2 = torch.Tensor()
-        if param in attr:
-            if 'trail' in attr[param]:
-                assert param.dtype is torch.bfloat16
-                param2 = attr[param]['trail']
-            if 'bf16_param' in attr[param]:
-                assert param.dtype is torch.float
-                param2 = attr[param]['bf16_param']
-        if fused and not grad.is_sparse:
-            torch.ops.torch_ipex.adagrad_fused_step(
-                param,
-                grad,
-                state_sum,
-                param2,
-                step,
+    if fused:
+        dense = [i for i, grad in enumerate(grads) if not grad.is_sparse]
+        for group in group_by_dtype([params[i] for i in dense], [grads[i] for i in dense]):
+            group = [dense[i] for i in group]
+            torch.ops.torch_ipex.adagrad_fused_step_multi_tensor(
+                [params[i] for i in group],
+                [grads[i] for i in group],
+                [state_sums[i] for i in group],
+                [get_param2(params[i], attr) for i in group],
+                [int(state_steps[i].item()) for i in group],
                 lr,
                 weight_decay,
                 lr_decay,
                 eps)
+
+    for (param, grad, state_sum, step_t) in zip(params, grads, state_sums, state_steps):
+        if fused and not grad.is_sparse:
             continue
+        step = int(step_t.item())
 
         if weight_decay != 0:
             if grad.is_sparse:
@@ -174,29 +191,29 @@ def _sgd_impl(
     See :class:`~torch.optim.SGD` for details.
     """
 
-    for i, param in enumerate(params):
-        d_p = d_p_list[i]
-        param2 = torch.Tensor()
-        if param in attr:
-            if 'trail' in attr[param]:
-                assert param.dtype is torch.bfloat16
-                param2 = attr[param]['trail']
-            if 'bf16_param' in attr[param]:
-                assert param.dtype is torch.float
-                param2 = attr[param]['bf16_param']
-
-        if fused and not d_p.is_sparse:
-            momentum_buffer_list[i] = torch.ops.torch_ipex.sgd_fused_step(
-                param,
-                d_p,
-                momentum_buffer_list[i],
-                param2,
+    if fused:
+        dense = [i for i, d_p in enumerate(d_p_list) if not d_p.is_sparse]
+        for group in group_by_dtype([params[i] for i in dense], [d_p_list[i] for i in dense]):
+            group = [dense[i] for i in group]
+            momentum_buffers = torch.ops.torch_ipex.sgd_fused_step_multi_tensor(
+                [params[i] for i in group],
+                [d_p_list[i] for i in group],
+                [torch.Tensor() if momentum_buffer_list[i] is None else momentum_buffer_list[i] for i in group],
+                [get_param2(params[i], attr) for i in group],
                 momentum,
                 lr,
                 weight_decay,
                 dampening,
                 nesterov)
+            if momentum != 0:
+                for i, momentum_buffer in zip(group, momentum_buffers):
+                    momentum_buffer_list[i] = momentum_buffer
+
+    for i, param in enumerate(params):
+        d_p = d_p_list[i]
+        if fused and not d_p.is_sparse:
             continue
+        param2 = get_param2(param, attr)
 
         if (
             d_p.is_sparse and
@@ -293,27 +310,14 @@ def _lamb_fused_impl(
     See :class:`~torch.optim.Lamb` for details.
     """
 
-    for i, param in enumerate(params):
-
-        grad = grads[i]
-        exp_avg = exp_avgs[i]
-        exp_avg_sq = exp_avg_sqs[i]
-        step = state_steps[i]
-        param2 = torch.Tensor()
-        if param in attr:
-            if 'trail' in attr[param]:
-                assert param.dtype is torch.bfloat16
-                param2 = attr[param]['trail']
-            if 'bf16_param' in attr[param]:
-                assert param.dtype is torch.float
-                param2 = attr[param]['bf16_param']
-        torch.ops.torch_ipex.lamb_fused_step(
-            param,
-            exp_avg,
-            exp_avg_sq,
-            grad,
-            param2,
-            step,
+    for group in group_by_dtype(params, grads):
+        torch.ops.torch_ipex.lamb_fused_step_multi_tensor(
+            [params[i] for i in group],
+            [exp_avgs[i] for i in group],
+            [exp_avg_sqs[i] for i in group],
+            [grads[i] for i in group],
+            [get_param2(params[i], attr) for i in group],
+            [state_steps[i] for i in group],
             beta1,
             beta2,
             lr,
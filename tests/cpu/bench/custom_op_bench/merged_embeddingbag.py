@@ -1,3 +1,6 @@
+import os
+# Record the ipex kernels (e.g. the csr2csc of the merged embedding backward) in the profiler.
+os.environ.setdefault("IPEX_PROFILE_OP", "1")
 import torch
 import intel_extension_for_pytorch as ipex
 import time
@@ -76,6 +79,28 @@ def run_bench(bench_name, module, input_data, optimizer=None, training=False):
     print("Took {} ms on average to run {} benchmark".format(avg_elapsed, bench_name))
 
 
+def csr2csc_bench(module, input_data, iters=100):
+    r"""
+    Report the time of the csr2csc (sort of the indices by rows) of the backward of MergedEmbeddingBag
+    separately, from the profiler events recorded by the ipex kernels.
+    """
+    for i in range(10):
+        loss = sum(out.sum() for out in module(*input_data))
+        loss.backward()
+    with torch.autograd.profiler.profile() as prof:
+        for i in range(iters):
+            loss = sum(out.sum() for out in module(*input_data))
+            loss.backward()
+    csr2csc_time = 0
+    backward_time = 0
+    for evt in prof.key_averages():
+        if evt.key == "sort_based_batched_csr2csc_opt_kernel_impl":
+            csr2csc_time += evt.cpu_time_total
+        elif evt.key.startswith("torch_ipex::merged_embeddingbag_backward"):
+            backward_time += evt.cpu_time_total
+    print("Took {} ms on average to run csr2csc, {} ms on average to run the fused backward".format(
+        csr2csc_time / iters / 1000, backward_time / iters / 1000))
+
 def inference_bench(dataset, emb_list, merged_emb):
     emblist_input, merged_emb_input = dataset
     run_bench("EmbedddingBag List Inference", emb_list, emblist_input)
@@ -85,6 +110,7 @@ def training_bench(dataset, emb_list, merged_emb, optimizer):
     emblist_input, merged_emb_input = dataset
     run_bench("EmbedddingBag List Training", emb_list, emblist_input, optimizer=optimizer, training=True)
     run_bench("Merged EmbedddingBag Training", merged_emb, merged_emb_input, training=True)
+    csr2csc_bench(merged_emb, merged_emb_input)
 
 def get_data(distribution, merged_emb, max_rows, batch_size):
     indices = []
@@ -116,10 +142,11 @@ def run():
     parser.add_argument("--inference", action="store_true", default=False)
     parser.add_argument("--batch-size", type=int, default=7168)
     parser.add_argument("--vector-size", type=int, default=128)
+    parser.add_argument("--num-tables", type=int, default=26)
 
     args = parser.parse_args()
 
-    max_rows = [args.batch_size for i in range(26)]
+    max_rows = [args.batch_size for i in range(args.num_tables)]
     emb_list = EmbeddingBagList(max_rows, args.vector_size)
     sgd = torch.optim.SGD(emb_list.parameters(), lr=0.01)
     emb_list, sgd = ipex.optimize(model=emb_list, optimizer=sgd, dtype=torch.float)
@@ -1,6 +1,7 @@
 #include <torch/torch.h>
 #include "gtest/gtest.h"
 #include "intel_extension_for_pytorch/csrc/cpu/runtime/CPUPool.h"
+#include "intel_extension_for_pytorch/csrc/cpu/runtime/CPUTopology.h"
 #include "intel_extension_for_pytorch/csrc/cpu/runtime/Task.h"
 #include "intel_extension_for_pytorch/csrc/cpu/runtime/TaskExecutor.h"
 
@@ -416,3 +417,58 @@ TEST(TestRuntimeTaskAPI, TestTaskAPISameTasksMultiTensorInputs) {
   ASSERT_VARIABLE_EQ(res, res_ref);
   ASSERT_VARIABLE_EQ(res2, res_ref2);
 }
+
+TEST(TestRuntimeTaskAPI, TestTaskAPIWorkStealing) {
+  if (!torch_ipex::runtime::is_runtime_ext_enabled()) {
+    GTEST_SKIP()
+        << "Skip TestRuntimeTaskAPI::TestTaskAPIWorkStealing. Didn't preload IOMP.";
+  }
+  // 2 work stealing executors on the same numa node. The tasks submitted to
+  // the busy executor can be stolen by the idle one.
+  std::vector<int32_t> cpu_core_list({0});
+  std::shared_ptr<torch_ipex::runtime::TaskExecutor> task_executor =
+      std::make_shared<torch_ipex::runtime::TaskExecutor>(cpu_core_list, true);
+  std::vector<int32_t> cpu_core_list2({1});
+  std::shared_ptr<torch_ipex::runtime::TaskExecutor> task_executor2 =
+      std::make_shared<torch_ipex::runtime::TaskExecutor>(cpu_core_list2, true);
+  ASSERT_TRUE(task_executor->is_work_stealing_enabled());
+
+  at::Tensor input_tensor = at::rand({100, 8276});
+  // Get the reference result
+  auto res_ref = at::softmax(input_tensor, -1);
+  // Create the task
+  torch_ipex::runtime::
+      Task<at::Tensor (*)(const at::Tensor&), const at::Tensor&>
+          task(taskfunction_const_lvalue_reference, task_executor);
+
+  std::vector<std::future<at::Tensor>> res_futures;
+  for (int i = 0; i < 16; i++) {
+    res_futures.emplace_back(task(input_tensor));
+  }
+  for (auto& res_future : res_futures) {
+    // Assert the result
+    ASSERT_VARIABLE_EQ(res_future.get(), res_ref);
+  }
+}
+
+TEST(TestRuntimeAPI, TestCPUPoolOfNumaNodeBindMemory) {
+  if (!torch_ipex::runtime::is_runtime_ext_enabled()) {
+    GTEST_SKIP()
+        << "Skip TestRuntimeAPI::TestCPUPoolOfNumaNodeBindMemory. Didn't preload IOMP.";
+  }
+  const auto& topology = torch_ipex::runtime::CPUTopology::get_instance();
+  ASSERT_GT(topology.get_num_numa_nodes(), 0);
+  int32_t numa_node_id = topology.get_numa_node_ids()[0];
+  torch_ipex::runtime::CPUPool cpu_pool =
+      torch_ipex::runtime::get_cpu_pool_of_numa_node(numa_node_id, true, true);
+  ASSERT_TRUE(cpu_pool.is_memory_binding_enabled());
+  ASSERT_EQ(cpu_pool.get_numa_node_ids(), std::vector<int32_t>({numa_node_id}));
+
+  at::Tensor input_tensor = at::rand({100, 8276});
+  auto res_ref = at::softmax(input_tensor, -1);
+  {
+    torch_ipex::runtime::WithCPUPool with_cpu_pool(std::move(cpu_pool));
+    auto res = at::softmax(input_tensor, -1);
+    ASSERT_VARIABLE_EQ(res, res_ref);
+  }
+}
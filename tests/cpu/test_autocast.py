@@ -487,6 +487,149 @@ class TestLSTM(TorchTestCase):
     def test_lstm_pack_padded_sequence(self):
         self._test_lstm_pack_padded_sequence()
 
+    # Without AVX512, oneDNN expects the rnn_packed LSTM weights, which aren't cached.
+    @unittest.skipIf(
+        ipex._C._get_highest_cpu_support_isa_level().lower() in ["default", "avx2"],
+        "The LSTM weights are only cached in the blocked format of AVX512")
+    def test_lstm_weight_cache(self):
+        input = torch.randn(3, 2, 16)
+        model = M(input_size=16, hidden_size=32, num_layers=2, bidirectional=True, bias=True, dropout=0, batch_first=False).eval()
+        y_ref, _ = model(input)
+        model_ipex = copy.deepcopy(model)
+        ipex.nn.utils._model_convert.replace_lstm_with_ipex_lstm(model_ipex)
+
+        capacity = ipex._C._get_weight_cache_capacity()
+        try:
+            # The packed weights are cached at the first run and hit later.
+            y_ipex, _ = model_ipex(input)
+            stats = ipex._C._get_weight_cache_stats()
+            for _ in range(3):
+                y_ipex, _ = model_ipex(input)
+                self.assertEqual(y_ref, y_ipex)
+            new_stats = ipex._C._get_weight_cache_stats()
+            self.assertGreater(stats['num_entries'], 0)
+            self.assertGreater(new_stats['hits'], stats['hits'])
+
+            # The weights are repacked after they are evicted by the byte budget.
+            ipex._C._set_weight_cache_capacity(1)
+            for _ in range(2):
+                y_ipex, _ = model_ipex(input)
+                self.assertEqual(y_ref, y_ipex)
+            self.assertLessEqual(ipex._C._get_weight_cache_stats()['num_entries'], 1)
+        finally:
+            ipex._C._set_weight_cache_capacity(capacity)
+            ipex._C._clear_weight_cache()
+        self.assertEqual(ipex._C._get_weight_cache_stats()['num_bytes'], 0)
+
+class GRUModel(nn.Module):
+    def __init__(self, input_size, hidden_size, num_layers, bidirectional, bias, dropout, batch_first):
+        super(GRUModel, self).__init__()
+        self.gru = nn.GRU(input_size=input_size, hidden_size=hidden_size, num_layers=num_layers, bidirectional=bidirectional, bias=bias, dropout=dropout, batch_first=batch_first)
+
+    def forward(self, x, h=None):
+        x, h = self.gru(x, h)
+        return x, h
+
+class TestGRU(TorchTestCase):
+    def _gru_params_list(self):
+        params_dict = {
+            "input_size": [1, 2],
+            "hidden_size": [5, 32],
+            "num_layers": [1, 3],
+            "bidirectional": [False, True],
+            "bias": [False, True],
+            "empty_state": [False, True],
+            "batch_first": [False, True],
+            "batch_size": [1, 2],
+            "seq_len": [1, 3]
+        }
+
+        params_list = []
+        for key, value in params_dict.items():
+            params_list.append(value)
+        return params_list
+
+    def _cast_dtype(self, input, bf16):
+        if bf16:
+            input = input.to(torch.bfloat16)
+        return input
+
+    def _test_gru(self, training, bf16, rtol=1.3e-6, atol=1e-5):
+        rand_seed = int(get_rand_seed())
+        print("{} rand sed: {}".format(sys._getframe().f_code.co_name, rand_seed))
+        torch.manual_seed(rand_seed)
+
+        params_list = self._gru_params_list()
+        for input_size, hidden_size, num_layers, bidirectional, bias, empty_state, batch_first, batch_size, seq_len in itertools.product(*params_list):
+            num_directions = 2 if bidirectional else 1
+
+            if batch_first:
+                input = torch.randn(batch_size, seq_len, input_size)
+            else:
+                input = torch.randn(seq_len, batch_size, input_size)
+            h = torch.randn(num_layers * num_directions, batch_size, hidden_size)
+
+            input_cpu = input.clone().requires_grad_(training)
+            h_cpu = h.clone().requires_grad_(training)
+
+            model_cpu = GRUModel(input_size=input_size, hidden_size=hidden_size, num_layers=num_layers, bidirectional=bidirectional, bias=bias, dropout=0, batch_first=batch_first)
+            model_cpu.train() if training else model_cpu.eval()
+
+            input_ipex = input.clone().requires_grad_(training)
+            h_ipex = h.clone().requires_grad_(training)
+            model_ipex = copy.deepcopy(model_cpu)
+            model_ipex.train() if training else model_ipex.eval()
+            ipex.nn.utils._model_convert.replace_gru_with_ipex_gru(model_ipex)
+
+            with torch.cpu.amp.autocast(enabled=bf16, dtype=torch.bfloat16):
+                if empty_state:
+                    y_cpu, hy_cpu = self._cast_dtype(model_cpu, bf16)(self._cast_dtype(input_cpu, bf16))
+                    y_ipex, hy_ipex = model_ipex(input_ipex)
+                else:
+                    y_cpu, hy_cpu = self._cast_dtype(model_cpu, bf16)(self._cast_dtype(input_cpu, bf16), self._cast_dtype(h_cpu, bf16))
+                    y_ipex, hy_ipex = model_ipex(input_ipex, h_ipex)
+                self.assertEqual(y_cpu, y_ipex, rtol=rtol, atol=atol)
+                self.assertEqual(hy_cpu, hy_ipex, rtol=rtol, atol=atol)
+
+                if training:
+                    y_cpu.sum().backward(retain_graph=True)
+                    y_ipex.sum().backward(retain_graph=True)
+                    self.assertEqual(input_ipex.grad, input_cpu.grad, rtol=rtol, atol=atol)
+                    self.assertEqual(self._cast_dtype(model_ipex.gru.weight_ih_l0.grad, bf16), model_cpu.gru.weight_ih_l0.grad, rtol=rtol, atol=atol)
+                    self.assertEqual(self._cast_dtype(model_ipex.gru.weight_hh_l0.grad, bf16), model_cpu.gru.weight_hh_l0.grad, rtol=rtol, atol=atol)
+                    if bias:
+                        self.assertEqual(self._cast_dtype(model_ipex.gru.bias_ih_l0.grad, bf16), model_cpu.gru.bias_ih_l0.grad, rtol=rtol, atol=atol)
+                        self.assertEqual(self._cast_dtype(model_ipex.gru.bias_hh_l0.grad, bf16), model_cpu.gru.bias_hh_l0.grad, rtol=rtol, atol=atol)
+                    if not empty_state:
+                        hy_cpu.sum().backward(retain_graph=True)
+                        hy_ipex.sum().backward(retain_graph=True)
+                        self.assertEqual(h_ipex.grad, h_cpu.grad, rtol=rtol, atol=atol)
+
+    def test_gru_op(self):
+        self._test_gru(training=False, bf16=False)
+
+        self._test_gru(training=False, bf16=True, rtol=0.02, atol=0.02)
+
+        self._test_gru(training=True, bf16=False)
+
+        self._test_gru(training=True, bf16=True, rtol=0.02, atol=0.03)
+
+    def test_gru_weight_cache(self):
+        # The packed GRU weights are cached with the original weights as the
+        # keys, the output must stay the same when they are hit.
+        input = torch.randn(3, 2, 16)
+        model = GRUModel(input_size=16, hidden_size=32, num_layers=2, bidirectional=True, bias=True, dropout=0, batch_first=False).eval()
+        y_ref, hy_ref = model(input)
+        model_ipex = copy.deepcopy(model)
+        ipex.nn.utils._model_convert.replace_gru_with_ipex_gru(model_ipex)
+        try:
+            for _ in range(3):
+                y_ipex, hy_ipex = model_ipex(input)
+                self.assertEqual(y_ref, y_ipex)
+                self.assertEqual(hy_ref, hy_ipex)
+        finally:
+            ipex._C._clear_weight_cache()
+
 class TestAutocastOperations(TestCase):
     def setUp(self):
         super(TestAutocastOperations, self).setUp()
@@ -1,5 +1,6 @@
 import unittest
 import os
+import subprocess
 
 import intel_extension_for_pytorch._C as core
 
@@ -64,5 +65,23 @@ class TestDynDisp(unittest.TestCase):
         self.assertTrue(expected_isa)
         return        
 
+    def test_fused_kernels_on_avx2(self):
+        # The fused kernels have AVX2 implementations beside the AVX512 ones,
+        # rerun their JIT tests with the kernels dispatched to AVX2.
+        max_cpu_isa = get_highest_cpu_support_isa_level()
+        if get_isa_val(max_cpu_isa) < get_isa_val("avx2"):
+            return
+
+        tests = ["test_jit.Tester.test_add_layernorm",
+                 "test_jit.Tester.test_concat_bn_relu",
+                 "test_jit.Tester.test_mha_scores_calculation",
+                 "test_jit.Tester.test_distil_mha_scores_calculation",
+                 "test_jit.Tester.test_linear_swish"]
+        loc = os.path.dirname(os.path.abspath(__file__))
+        cmd = 'ATEN_CPU_CAPABILITY=avx2 python -u -m unittest {}'.format(' '.join(tests))
+        with subprocess.Popen(cmd, shell=True, cwd=loc, stdout=subprocess.PIPE, stderr=subprocess.STDOUT) as p:
+            out = str(p.communicate()[0], 'utf-8')
+        self.assertEqual(p.returncode, 0, out)
+
 if __name__ == '__main__':
     unittest.main()
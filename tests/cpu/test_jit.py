@@ -55,6 +55,8 @@ import unittest
 from functools import reduce
 import warnings
 import itertools
+import threading
+from typing import List
 
 import torch
 import torch.nn as nn
@@ -594,6 +596,15 @@ class ConvTranspose2d(nn.Module):
         x = self.conv_transpose2d(x)
         return x
 
+class LSTM(nn.Module):
+    def __init__(self, input_size, hidden_size, num_layers, bidirectional, bias, batch_first):
+        super(LSTM, self).__init__()
+        self.lstm = nn.LSTM(input_size=input_size, hidden_size=hidden_size, num_layers=num_layers, bidirectional=bidirectional, bias=bias, batch_first=batch_first)
+
+    def forward(self, x):
+        x, h = self.lstm(x)
+        return x, h
+
 class ChannelShuffle(nn.Module):
     def __init__(self, batchsize, num_channels, height, width, groups):
         super(ChannelShuffle, self).__init__()
@@ -678,6 +689,33 @@ class DistilMHAScoresCalculation_v2(nn.Module):
         qk = qk.masked_fill(mask, -float("inf"))
         return nn.functional.softmax(qk, dim=-1)
 
+class MHAAttention(nn.Module):
+    def __init__(self, dim_per_head):
+        super(MHAAttention, self).__init__()
+        self.softmax = nn.Softmax(dim=-1)
+        self.dim_per_head = dim_per_head
+
+    def forward(self, mat1, mat2, bias, value):
+        mat1 = mat1 / math.sqrt(self.dim_per_head)
+        qk = torch.matmul(mat1, mat2.transpose(2, 3))
+        scores = qk + bias
+        return torch.matmul(self.softmax(scores), value)
+
+class DistilMHAAttention(nn.Module):
+    def __init__(self, dim_per_head):
+        super(DistilMHAAttention, self).__init__()
+        self.dim_per_head = dim_per_head
+
+    def forward(self, q, k, mask, v):
+        # the attention block of DistilBERT
+        mask_shape = [q.shape[0], 1, 1, k.shape[2]]
+        q = q / math.sqrt(self.dim_per_head)
+        scores = torch.matmul(q, k.transpose(2, 3))
+        mask = (mask == 0).view(mask_shape).expand_as(scores)
+        scores = scores.masked_fill(mask, -float("inf"))
+        weights = nn.functional.softmax(scores, dim=-1)
+        return torch.matmul(weights, v)
+
 class AtenSoftmaxRepalce(nn.Module):
     def __init__(self, dim=-1):
         super(AtenSoftmaxRepalce, self).__init__()
@@ -807,6 +845,34 @@ class EinsumAddInplaceV1(nn.Module):
     def forward(self, input1, input2, bias):
         return bias.add_(torch.einsum(self.equation, input1, input2))
 
+class ConvReluChain(nn.Module):
+    def __init__(self, channels, num_layers):
+        super(ConvReluChain, self).__init__()
+        self.convs = nn.ModuleList([nn.Conv2d(channels, channels, 3, padding=1) for _ in range(num_layers)])
+        self.linear = nn.Linear(channels, 10)
+
+    def forward(self, x):
+        for conv in self.convs:
+            x = F.relu(conv(x))
+        return self.linear(x.mean([2, 3]))
+
+class ConvReluListCat(nn.Module):
+    def __init__(self, channels):
+        super(ConvReluListCat, self).__init__()
+        self.conv1 = nn.Conv2d(channels, channels, 3, padding=1)
+        self.conv2 = nn.Conv2d(channels, channels, 3, padding=1)
+        self.conv3 = nn.Conv2d(channels, channels, 3, padding=1)
+
+    def forward(self, x):
+        outs: List[torch.Tensor] = []
+        x = F.relu(self.conv1(x))
+        outs.append(x)
+        x = F.relu(self.conv2(x))
+        outs.append(x)
+        x = F.relu(self.conv3(x))
+        outs.append(x)
+        return torch.cat(outs, 1)
+
 class Tester(TestCase):
 
     def _test_output(self, model, x, kind_in_graph=None, kind_not_in_graph=None, prec=None, levels=['O0','O1'], use_channels_last=[True, False]):
@@ -1167,6 +1233,75 @@ class Tester(TestCase):
                 _check_match_mha(mha_jit, mat1, mat2, bias)
                 _test_pure_bf16(mha, mha_jit, mat1, mat2, bias)
 
+    def test_mha_attention(self):
+        def _check_match_mha(trace_model, inputs, node="ipex::mha_attention"):
+            graph = trace_model.graph_for(*inputs)
+            self.assertTrue(any(n.kind() == node for n in graph.nodes()))
+
+        # (q, k, bias, v), covering the tails of the query and key blocks
+        # and the head dims of the AMX path
+        shapes = [
+            ((2, 3, 4, 10), (2, 3, 16, 10), (2, 1, 1, 16), (2, 3, 16, 10)),
+            ((1, 2, 33, 64), (1, 2, 33, 64), (1, 1, 1, 33), (1, 2, 33, 64)),
+            ((2, 4, 100, 64), (2, 4, 130, 64), (2, 1, 1, 130), (2, 4, 130, 64)),
+            ((1, 2, 70, 32), (1, 2, 200, 32), (1, 2, 70, 200), (1, 2, 200, 48)),
+            ((2, 3, 4, 10), (2, 3, 16, 10), (4, 16), (2, 3, 16, 7)),
+        ]
+        mha = MHAAttention(64)
+        with torch.no_grad():
+            inputs = [torch.randn(shape) for shape in shapes[0]]
+            mha_jit = torch.jit.trace(mha, inputs)
+            mha_jit.eval()
+            for shape in shapes:
+                inputs = [torch.randn(s) for s in shape]
+                res_ref = mha(*inputs)
+                res_jit = mha_jit(*inputs)
+                self.assertEqual(res_ref, res_jit)
+                _check_match_mha(mha_jit, inputs)
+
+                inputs_bf16 = [t.to(torch.bfloat16) for t in inputs]
+                res_ref = mha(*inputs_bf16)
+                res_jit = mha_jit(*inputs_bf16)
+                self.assertEqual(res_ref, res_jit, prec=3e-2)
+
+    def test_distil_mha_attention(self):
+        def _check_match_mha(trace_model, inputs, node="ipex::distil_mha_attention"):
+            graph = trace_model.graph_for(*inputs)
+            self.assertTrue(any(n.kind() == node for n in graph.nodes()))
+
+        def _get_inputs(q_shape, k_shape, v_shape):
+            q = torch.randn(q_shape)
+            k = torch.randn(k_shape)
+            v = torch.randn(v_shape)
+            # mask out some keys, but keep the first one of each batch so that
+            # no row of the scores is fully masked
+            mask = (torch.rand(k_shape[0], k_shape[2]) > 0.3).float()
+            mask[:, 0] = 1
+            return [q, k, mask, v]
+
+        # (q, k, v), the key length should be a multiple of 16 to be fused
+        shapes = [
+            ((2, 3, 4, 64), (2, 3, 16, 64), (2, 3, 16, 64)),
+            ((1, 2, 33, 64), (1, 2, 48, 64), (1, 2, 48, 64)),
+            ((2, 4, 100, 64), (2, 4, 128, 64), (2, 4, 128, 64)),
+            ((1, 2, 70, 32), (1, 2, 208, 32), (1, 2, 208, 48)),
+        ]
+        mha = DistilMHAAttention(64)
+        with torch.no_grad():
+            mha_jit = torch.jit.trace(mha, _get_inputs(*shapes[0]))
+            mha_jit.eval()
+            for shape in shapes:
+                inputs = _get_inputs(*shape)
+                res_ref = mha(*inputs)
+                res_jit = mha_jit(*inputs)
+                self.assertEqual(res_ref, res_jit)
+                _check_match_mha(mha_jit, inputs)
+
+                inputs_bf16 = [t.to(torch.bfloat16) for t in inputs]
+                res_ref = mha(*inputs_bf16)
+                res_jit = mha_jit(*inputs_bf16)
+                self.assertEqual(res_ref, res_jit, prec=3e-2)
+
     def test_linear_swish(self):
         mat1 = torch.randn(10000, 5)
 
@@ -2016,6 +2151,34 @@ class Tester(TestCase):
             use_channels_last=[True],
             levels=['O1'])
 
+    def test_bottleneck_fusion_tiled(self):
+        # 56 rows run as 11 tiles of 5 rows and a last tile of 1 row.
+        saved_tile_rows = ipex._C.get_conv_bottleneck_tile_rows()
+        ipex._C.set_conv_bottleneck_tile_rows(5)
+        try:
+            x = torch.randn(2, 64, 56, 56)
+            for model_class in [Bottleneck_v1, Bottleneck_v2]:
+                tiled_runs = ipex._C.get_conv_bottleneck_tiled_runs()
+                self._test_output(
+                    model_class(),
+                    x,
+                    kind_in_graph="ipex_prepack::convolution_bottleneck_run",
+                    use_channels_last=[True],
+                    levels=['O1'])
+                # The fused bottleneck ran the tiled plan rather than the whole input.
+                self.assertGreater(ipex._C.get_conv_bottleneck_tiled_runs(), tiled_runs)
+                tiled_runs = ipex._C.get_conv_bottleneck_tiled_runs()
+                self._test_output_bf16(
+                    model_class(),
+                    x,
+                    kind_in_graph="ipex_prepack::convolution_bottleneck_run",
+                    prec=0.03,
+                    use_channels_last=[True],
+                    levels=['O1'])
+                self.assertGreater(ipex._C.get_conv_bottleneck_tiled_runs(), tiled_runs)
+        finally:
+            ipex._C.set_conv_bottleneck_tile_rows(saved_tile_rows)
+
     def test_jit_conv_sum_in_diff_block(self):
         batch_size = 8
         out_channels = 32
@@ -2037,6 +2200,23 @@ class Tester(TestCase):
                 x,
                 kind_not_in_graph="ipex_prepack::convolution_add_run")
 
+    def test_conv_params_cache(self):
+        conv = torch.nn.Conv2d(3, 16, kernel_size=3, stride=1, padding=1)
+        op_context = torch.ops.ipex_prepack.convolution_prepack(
+            conv.weight, conv.bias, [1, 1], [1, 1], [1, 1], [3, 3], 1, 16, False, [1, 3, 32, 32])
+        # Two input shapes other than the prepacked one, each run repeatedly.
+        sizes = [48, 64, 48, 64, 48, 64]
+        with torch.no_grad():
+            for size in sizes:
+                x = torch.randn(1, 3, size, size)
+                self.assertEqual(torch.ops.ipex_prepack.convolution_run(x, op_context), conv(x))
+        stats = op_context.get_params_cache_stats()
+        self.assertEqual(stats['hits'] + stats['fallbacks'], len(sizes))
+        self.assertGreater(stats['hits'], 0)
+        # The primitive of each input shape is prepared only once.
+        self.assertEqual(stats['misses'], 2)
+        self.assertEqual(stats['num_entries'], 2)
+
     def test_output_conv_transpose2d(self):
         def _deconv_params_list():
             params_dict = {
@@ -2408,6 +2588,31 @@ class Tester(TestCase):
             kind_in_graph="ipex_prepack::linear_sigmoid_run",
             prec=5e-3)
 
+    def test_output_lstm(self):
+        for bidirectional, bias, batch_first in itertools.product([False, True], repeat=3):
+            model = LSTM(16, 32, 2, bidirectional, bias, batch_first).eval()
+            model_ipex = ipex.optimize(model, dtype=torch.float32)
+            x = torch.randn(4, 6, 16)
+            with torch.no_grad():
+                traced_model = torch.jit.trace(model_ipex, x)
+                traced_model = torch.jit.freeze(traced_model)
+                # the weights are packed at the first run
+                for _ in range(2):
+                    traced_model(x)
+                trace_graph = traced_model.graph_for(x)
+                self.assertTrue(any(n.kind() == "ipex_prepack::lstm_run" for n in trace_graph.nodes()))
+                # the weights are re-packed when the input sizes change
+                for x in [torch.randn(4, 6, 16), torch.randn(3, 5, 16), torch.randn(4, 6, 16)]:
+                    self.assertEqual(model(x), traced_model(x))
+
+                with torch.cpu.amp.autocast():
+                    y = model_ipex(x)
+                    traced_model = torch.jit.trace(model_ipex, x)
+                    traced_model = torch.jit.freeze(traced_model)
+                    for _ in range(2):
+                        traced_model(x)
+                    self.assertEqual(y, traced_model(x), prec=5e-3)
+
     def test_channel_shuffle(self):
         self._test_output(
             ChannelShuffle(10, 16, 50, 50, 4),
@@ -2731,6 +2936,61 @@ class Tester(TestCase):
             kind_not_in_graph="aten::mul",
             prec=0.1)
 
+    def test_static_memory_planning(self):
+        model = ipex.optimize(ConvReluChain(16, 4).eval(), dtype=torch.float32, level='O1')
+        x = torch.randn(2, 16, 14, 14)
+        with torch.no_grad():
+            ref = [model(x), model(x + 1)]
+        core._jit_set_static_memory_planning_enabled(True)
+        try:
+            with torch.no_grad():
+                traced_model = torch.jit.freeze(torch.jit.trace(model, x))
+                for _ in range(3):
+                    y = traced_model(x)
+                graph = traced_model.graph_for(x)
+        finally:
+            core._jit_set_static_memory_planning_enabled(False)
+        self.assertTrue(any(n.kind() == "ipex::memory_plan_assign" for n in graph.nodes()))
+        self.assertEqual(y, ref[0])
+        stats = core._jit_get_static_memory_plan_stats()
+        # the outputs of the chain only need 2 buffers of the arena
+        self.assertLess(stats['planned_arena_bytes'], stats['planned_value_bytes'])
+        self.assertGreater(stats['num_planned_allocations'], 0)
+
+        # each thread runs in its own arena
+        outputs = [None, None]
+        def run(i):
+            with torch.no_grad():
+                for _ in range(3):
+                    outputs[i] = traced_model(x + i)
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(2)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(outputs[0], ref[0])
+        self.assertEqual(outputs[1], ref[1])
+
+    def test_static_memory_planning_list_append(self):
+        # the conv outputs are appended to a list created before them, so they
+        # are all alive until the cat and mustn't share the buffers
+        model = ConvReluListCat(16).eval()
+        x = torch.randn(2, 16, 14, 14)
+        with torch.no_grad():
+            ref = model(x)
+        core._jit_set_static_memory_planning_enabled(True)
+        try:
+            with torch.no_grad():
+                scripted_model = torch.jit.freeze(torch.jit.script(model))
+                for _ in range(3):
+                    y = scripted_model(x)
+                graph = scripted_model.graph_for(x)
+        finally:
+            core._jit_set_static_memory_planning_enabled(False)
+        self.assertTrue(any(n.kind() == "aten::append" for n in graph.nodes()))
+        self.assertTrue(any(n.kind() == "ipex::memory_plan_assign" for n in graph.nodes()))
+        self.assertEqual(y, ref)
+
 if __name__ == '__main__':
     torch.manual_seed(2020)
     test = unittest.main()
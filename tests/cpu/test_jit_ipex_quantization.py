@@ -156,7 +156,7 @@ class TestIpexOps(JitLlgaTestCase):
             m = M(input_size=input_size, hidden_size=hidden_size, num_layers=num_layers, bidirectional=bidirectional, bias=bias, dropout=dropout, batch_first=batch_first)
 
             graph = self.checkQuantizeTrace(m, [x], atol=3e-2, rtol=1e-1, config_name="lstm")
-            self.assertGraphContainsExactly(graph, 'ipex::quantized_lstm', 1)
+            self.assertGraphContainsExactly(graph, 'ipex_prepack::quantized_lstm_run', 1)
 
 class TestIpexQuantizationConvertAPI(JitLlgaTestCase):
     def test_inplace_convert(self):
@@ -1,8 +1,11 @@
+import os
+import tempfile
 import unittest
 import itertools
 import torch
 import torch.nn as nn
 import torch.nn.functional as F
+import intel_extension_for_pytorch as ipex
 from test_jit_llga_utils import JitLlgaTestCase, run_tests, LLGA_FUSION_GROUP, llga_fp32_bf16_test_env
 from torch.testing._internal.common_utils import TEST_SCIPY
 
@@ -379,6 +382,111 @@ class TestOp(JitLlgaTestCase):
         x = torch.rand(5, 28)
         self.assertEqual(m(x), traced(x))
 
+    @llga_fp32_bf16_test_env
+    def test_dynamic_shape(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.linear = nn.Linear(28, 64)
+                self.layer_norm = nn.LayerNorm(64)
+
+            def forward(self, x):
+                return self.layer_norm(F.gelu(self.linear(x)))
+
+        m = M()
+        x = torch.rand(2, 16, 28)
+        ipex._C._jit_set_llga_dynamic_shape_enabled(True)
+        try:
+            for buckets in [[], [16, 32, 64]]:
+                ipex._C._jit_set_llga_shape_buckets(buckets)
+                graph, traced = self.checkTrace(m, [x])
+                self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 1)
+                misses = ipex._C._jit_get_llga_compilation_cache_stats()['misses']
+                # the new lengths run the partition instead of the fallback graph
+                for seq_len in [5, 30, 16, 17, 5]:
+                    x_var = torch.rand(2, seq_len, 28)
+                    with torch.no_grad():
+                        self.assertEqual(m(x_var), traced(x_var))
+                new_misses = ipex._C._jit_get_llga_compilation_cache_stats()['misses'] - misses
+                # one compilation for each new length, or each new bucket
+                self.assertEqual(new_misses, 1 if buckets else 3)
+        finally:
+            ipex._C._jit_set_llga_dynamic_shape_enabled(False)
+            ipex._C._jit_set_llga_shape_buckets([])
+
+    @llga_fp32_bf16_test_env
+    def test_persistent_cache(self):
+        m = torch.nn.Linear(in_features=28, out_features=64)
+        x = torch.rand(32, 28)
+        with tempfile.TemporaryDirectory() as cache_dir:
+            ipex._C._jit_set_llga_persistent_cache_dir(cache_dir)
+            try:
+                stats = ipex._C._jit_get_llga_persistent_cache_stats()
+                graph, _ = self.checkTrace(m, [x])
+                self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 1)
+                # the records are buffered until they are flushed
+                self.assertEqual(len(os.listdir(cache_dir)), 0)
+                ipex._C._jit_flush_llga_persistent_cache()
+                new_stats = ipex._C._jit_get_llga_persistent_cache_stats()
+                self.assertEqual(new_stats['stored'] - stats['stored'], 1)
+                self.assertEqual(len(os.listdir(cache_dir)), 1)
+
+                self.assertEqual(new_stats['misses'] - stats['misses'], 1)
+
+                # a new kernel of the same partition compiles the recorded
+                # key before its first run
+                misses = ipex._C._jit_get_llga_compilation_cache_stats()['misses']
+                graph, _ = self.checkTrace(m, [x])
+                ipex._C._jit_flush_llga_persistent_cache()
+                last_stats = ipex._C._jit_get_llga_persistent_cache_stats()
+                self.assertEqual(last_stats['loaded'] - new_stats['loaded'], 1)
+                self.assertEqual(last_stats['hits'] - new_stats['hits'], 1)
+                self.assertEqual(last_stats['misses'], new_stats['misses'])
+                self.assertEqual(last_stats['stored'], new_stats['stored'])
+                self.assertEqual(ipex._C._jit_get_llga_compilation_cache_stats()['misses'], misses)
+            finally:
+                ipex._C._jit_set_llga_persistent_cache_dir("")
+
+    @llga_fp32_bf16_test_env
+    def test_persistent_cache_records(self):
+        m = torch.nn.Linear(in_features=28, out_features=64)
+        x = torch.rand(2, 5, 28)
+        capacity = ipex._C._jit_get_llga_compilation_cache_capacity()
+        with tempfile.TemporaryDirectory() as cache_dir:
+            ipex._C._jit_set_llga_persistent_cache_dir(cache_dir)
+            ipex._C._jit_set_llga_dynamic_shape_enabled(True)
+            ipex._C._jit_set_llga_compilation_cache_capacity(2)
+            try:
+                graph, traced = self.checkTrace(m, [x])
+                self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 1)
+                # 5 is evicted by 7 and compiled again
+                for seq_len in [6, 7, 5]:
+                    with torch.no_grad():
+                        traced(torch.rand(2, seq_len, 28))
+                ipex._C._jit_flush_llga_persistent_cache()
+                cache_files = os.listdir(cache_dir)
+                self.assertEqual(len(cache_files), 1)
+                with open(os.path.join(cache_dir, cache_files[0])) as f:
+                    # the header and one record per length
+                    self.assertEqual(len(f.readlines()), 4)
+
+                # only the 2 most recent lengths (7, 5) are compiled
+                stats = ipex._C._jit_get_llga_persistent_cache_stats()
+                graph, traced = self.checkTrace(m, [x])
+                new_stats = ipex._C._jit_get_llga_persistent_cache_stats()
+                self.assertEqual(new_stats['loaded'] - stats['loaded'], 2)
+                for seq_len in [7, 6]:
+                    x_var = torch.rand(2, seq_len, 28)
+                    with torch.no_grad():
+                        self.assertEqual(m(x_var), traced(x_var))
+                last_stats = ipex._C._jit_get_llga_persistent_cache_stats()
+                self.assertEqual(last_stats['hits'] - stats['hits'], 2)
+                self.assertEqual(last_stats['misses'] - stats['misses'], 1)
+            finally:
+                ipex._C._jit_set_llga_compilation_cache_capacity(capacity)
+                ipex._C._jit_set_llga_dynamic_shape_enabled(False)
+                ipex._C._jit_set_llga_persistent_cache_dir("")
+
     @llga_fp32_bf16_test_env
     def test_unsupported_dtype(self):
         class M(nn.Module):
@@ -4,6 +4,8 @@ import unittest
 import copy
 from torch.testing._internal.common_utils import TestCase
 from intel_extension_for_pytorch.nn.modules import MergedEmbeddingBagWithSGD as MergedEmbeddingBagWithSGD
+from intel_extension_for_pytorch.nn.modules import MergedEmbeddingBagWithAdagrad, MergedEmbeddingBagWithAdam, \
+    MergedEmbeddingBagWithLamb
 
 class TestMergedEmbeddingBagWithSGD(TestCase):
 
@@ -65,6 +67,29 @@ class TestMergedEmbeddingBagWithSGD(TestCase):
             trace_model = torch.jit.trace(model, [self.expected_input, torch.BoolTensor([False])])
         self._test_inference_only(trace_model)
 
+    def test_inference_blocked(self):
+        # embedding dims with specialized kernels (64, 128, 256) and a generic
+        # one, with more bags than one block of a table, and empty bags
+        batch_size = 150
+        tables = [
+            nn.EmbeddingBag(1000, 64, mode='sum'),
+            nn.EmbeddingBag(1000, 128, mode='mean').double(),
+            nn.EmbeddingBag(1000, 256, mode='sum', _weight=torch.randn(1000, 256).bfloat16()),
+            nn.EmbeddingBag(1000, 24, mode='mean'),
+        ]
+        model = MergedEmbeddingBagWithSGD.from_embeddingbag_list(tables)
+        indices, offsets = [], []
+        for _ in tables:
+            lengths = torch.randint(0, 5, (batch_size,))
+            indices.append(torch.randint(0, 1000, (int(lengths.sum()),)))
+            offsets.append(torch.cat([torch.zeros(1, dtype=torch.long), lengths.cumsum(0)[:-1]]))
+        input = model.linearize_indices_and_offsets(indices, offsets, [False] * len(tables))
+        with torch.no_grad():
+            outputs = model(input, torch.BoolTensor([False]))
+            for i, table in enumerate(tables):
+                ref_out = table(indices[i], offsets[i])
+                self.assertEqual(outputs[i], ref_out)
+
     def get_local_indice(self, indice):
         table_id = 0
         while (indice >= self.merged.row_offsets[table_id + 1]):
@@ -118,6 +143,36 @@ class TestMergedEmbeddingBagWithSGD(TestCase):
             )
             self.assertEqual(updated_weights[table_id][logical_indice], ref_updated_weight, rtol=0.01, atol=0.01)
 
+    def test_training_large_and_sorted_tables(self):
+        # a table with more indices than the serial sort threshold of csr2csc, sorted
+        # in parallel, a table whose indices are already sorted, and a small table
+        torch.manual_seed(0)
+        batch_size = 40000
+        tables = [
+            nn.EmbeddingBag(5000, 8, mode='sum'),
+            nn.EmbeddingBag(batch_size * 2, 8, mode='mean'),
+            nn.EmbeddingBag(3, 8, mode='sum'),
+        ]
+        indices = [
+            torch.randint(0, 5000, (batch_size * 2,)),
+            torch.arange(batch_size * 2),
+            torch.randint(0, 3, (batch_size,)),
+        ]
+        offsets = [
+            torch.arange(0, batch_size * 2, 2),
+            torch.arange(0, batch_size * 2, 2),
+            torch.arange(batch_size),
+        ]
+        lr = 0.1
+        model = MergedEmbeddingBagWithSGD.from_embeddingbag_list(tables, lr=lr)
+        outputs = model((indices, offsets, [False, False, False]))
+        out_grads = [torch.randn_like(out) for out in outputs]
+        torch.autograd.backward(outputs, out_grads)
+        for i, table in enumerate(tables):
+            table(indices[i], offsets[i]).backward(out_grads[i])
+            ref_weight = table.weight.detach() - lr * table.weight.grad
+            self.assertEqual(model.weights[i], ref_weight, rtol=1e-5, atol=1e-5)
+
     def test_cast_bfloat16(self):
         model = copy.deepcopy(self.merged)
         model.to_bfloat16_train()
@@ -132,6 +187,134 @@ class TestMergedEmbeddingBagWithSGD(TestCase):
         self.assertEqual(torch.zeros_like(w2, dtype=torch.bfloat16), model.sgd_args.bf16_trail[2])
 
 
+class TestMergedEmbeddingBagWithFusedOptimizers(TestCase):
+
+    def _tables(self):
+        torch.manual_seed(0)
+        return [
+            nn.EmbeddingBag(40, 16, mode='sum'),
+            nn.EmbeddingBag(30, 24, mode='mean').double(),
+            nn.EmbeddingBag(20, 32, mode='sum', _weight=torch.randn(20, 32).bfloat16()),
+        ]
+
+    def _inputs(self, batch_size=8, bag_size=3):
+        indices = [torch.randint(0, n, (batch_size * bag_size,)) for n in [40, 30, 20]]
+        offsets = [torch.arange(0, batch_size * bag_size, bag_size) for _ in range(3)]
+        return indices, offsets
+
+    def _dense_grads(self, tables, indices, offsets, out_grads):
+        # grads of the rows of each table, and the rows used in the batch
+        grads, used = [], []
+        for table, indice, offset, out_grad in zip(tables, indices, offsets, out_grads):
+            ref = copy.deepcopy(table).float()
+            ref.weight.grad = None
+            ref(indice, offset).backward(out_grad.float())
+            grads.append(ref.weight.grad.double())
+            used.append(torch.unique(indice))
+        return grads, used
+
+    def _run(self, model, tables, steps=3):
+        masters = [t.weight.detach().double() for t in tables]
+        refs = []
+        for _ in range(steps):
+            indices, offsets = self._inputs()
+            outputs = model((indices, offsets, [False, False, False]))
+            out_grads = [torch.randn_like(o) for o in outputs]
+            grads, used = self._dense_grads(tables, indices, offsets, out_grads)
+            refs.append((grads, used))
+            torch.autograd.backward(outputs, out_grads)
+            for table, weight in zip(tables, model.weights):
+                table.weight.data.copy_(weight.detach())
+        return masters, refs
+
+    def _check(self, model, expected):
+        for weight, ref in zip(model.weights, expected):
+            tol = 1e-2 if weight.dtype == torch.bfloat16 else 1e-5
+            self.assertEqual(weight.detach().double(), ref.to(weight.dtype).double(), rtol=tol, atol=tol)
+
+    def test_adagrad(self):
+        for rowwise in [False, True]:
+            for weight_decay in [0, 0.1]:
+                tables = self._tables()
+                lr, eps = 0.1, 1e-10
+                model = MergedEmbeddingBagWithAdagrad.from_embeddingbag_list(
+                    tables, lr=lr, eps=eps, weight_decay=weight_decay, rowwise=rowwise)
+                weights, refs = self._run(model, tables)
+                states = [torch.zeros(w.shape[:1] if rowwise else w.shape, dtype=torch.double) for w in weights]
+                for grads, used in refs:
+                    for w, s, g, rows in zip(weights, states, grads, used):
+                        g = g[rows] + weight_decay * w[rows]
+                        if rowwise:
+                            s[rows] += g.pow(2).mean(1)
+                            w[rows] -= lr * g / (s[rows].sqrt() + eps).unsqueeze(1)
+                        else:
+                            s[rows] += g.pow(2)
+                            w[rows] -= lr * g / (s[rows].sqrt() + eps)
+                self._check(model, weights)
+
+    def test_adagrad_vs_torch_optim(self):
+        tables = self._tables()[:1]
+        ref_table = copy.deepcopy(tables[0])
+        adagrad = torch.optim.Adagrad(ref_table.parameters(), lr=0.1)
+        model = MergedEmbeddingBagWithAdagrad.from_embeddingbag_list(tables, lr=0.1)
+        for _ in range(3):
+            indices, offsets = self._inputs()
+            outputs = model(([indices[0]], [offsets[0]], [False]))
+            ref_out = ref_table(indices[0], offsets[0])
+            out_grad = torch.randn_like(ref_out)
+            torch.autograd.backward(outputs, [out_grad])
+            adagrad.zero_grad()
+            ref_out.backward(out_grad)
+            adagrad.step()
+            self.assertEqual(model.weights[0], ref_table.weight, rtol=1e-5, atol=1e-5)
+
+    def _test_adam(self, cls, use_lamb):
+        for weight_decay in [0, 0.1]:
+            tables = self._tables()
+            lr, beta1, beta2, eps = 0.01, 0.9, 0.999, 1e-8
+            model = cls.from_embeddingbag_list(tables, lr=lr, betas=(beta1, beta2), eps=eps, weight_decay=weight_decay)
+            weights, refs = self._run(model, tables)
+            exp_avgs = [torch.zeros_like(w) for w in weights]
+            exp_avg_sqs = [torch.zeros_like(w) for w in weights]
+            for step, (grads, used) in enumerate(refs, 1):
+                for w, m, v, g, rows in zip(weights, exp_avgs, exp_avg_sqs, grads, used):
+                    g = g[rows]
+                    if not use_lamb:
+                        g = g + weight_decay * w[rows]
+                    m[rows] = beta1 * m[rows] + (1 - beta1) * g
+                    v[rows] = beta2 * v[rows] + (1 - beta2) * g * g
+                    update = (m[rows] / (1 - beta1 ** step)) / ((v[rows] / (1 - beta2 ** step)).sqrt() + eps)
+                    if use_lamb:
+                        update = update + weight_decay * w[rows]
+                        w_norm = w[rows].norm(dim=1, keepdim=True)
+                        u_norm = update.norm(dim=1, keepdim=True)
+                        ratio = torch.where((w_norm > 0) & (u_norm > 0), w_norm / u_norm, torch.ones_like(w_norm))
+                        update = ratio * update
+                    w[rows] -= lr * update
+            self.assertEqual(model.adam_args.step, len(refs))
+            self._check(model, weights)
+
+    def test_adam(self):
+        self._test_adam(MergedEmbeddingBagWithAdam, False)
+
+    def test_lamb(self):
+        self._test_adam(MergedEmbeddingBagWithLamb, True)
+
+    def test_cast_bfloat16(self):
+        tables = self._tables()
+        model = MergedEmbeddingBagWithAdam.from_embeddingbag_list(tables)
+        model.to_bfloat16_train()
+        for i, table in enumerate(tables):
+            self.assertEqual(model.weights[i].dtype, torch.bfloat16)
+            self.assertEqual(model.adam_args.exp_avg[i].dtype, torch.float)
+        w0 = torch.ops.torch_ipex.cat_bfloat16_float(model.weights[0], model.adam_args.bf16_trail[0])
+        self.assertEqual(w0, tables[0].weight)
+        model = MergedEmbeddingBagWithAdagrad.from_embeddingbag_list(tables, rowwise=True)
+        model.to_bfloat16_train()
+        self.assertEqual(model.adagrad_args.state_sum[1].shape, torch.Size([30]))
+        self.assertEqual(model.adagrad_args.state_sum[1].dtype, torch.float)
+
+
 
 
 if __name__ == '__main__':
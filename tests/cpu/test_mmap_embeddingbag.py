@@ -0,0 +1,90 @@
+import os
+import tempfile
+import torch
+import torch.nn as nn
+import unittest
+from torch.testing._internal.common_utils import TestCase
+import intel_extension_for_pytorch as ipex
+from intel_extension_for_pytorch.nn.modules import MmapEmbeddingBag
+from intel_extension_for_pytorch.nn.modules.mmap_embeddingbag import save_embedding_table
+
+class TestMmapEmbeddingBag(TestCase):
+
+    def setUp(self):
+        self.dir = tempfile.TemporaryDirectory()
+
+    def tearDown(self):
+        self.dir.cleanup()
+
+    def _create(self, emb, dtype=torch.float, cache_rows=0):
+        path = os.path.join(self.dir.name, 'table.bin')
+        save_embedding_table(emb.weight.to(dtype), path)
+        return MmapEmbeddingBag(
+            path, emb.num_embeddings, emb.embedding_dim, emb.mode,
+            emb.include_last_offset, dtype, cache_rows)
+
+    def test_weight(self):
+        emb = nn.EmbeddingBag(100, 16)
+        for dtype in [torch.float, torch.bfloat16]:
+            mmap_emb = self._create(emb, dtype)
+            self.assertEqual(mmap_emb.weight, emb.weight.detach().to(dtype))
+            # the mapped table can be used by the other embedding bag ops
+            indices = torch.randint(0, 100, (20,))
+            offsets = torch.LongTensor([0, 7, 7, 12])
+            self.assertEqual(
+                torch.nn.functional.embedding_bag(indices, mmap_emb.weight, offsets),
+                torch.nn.functional.embedding_bag(indices, emb.weight.detach().to(dtype), offsets))
+
+    def test_embeddingbag(self):
+        for mode in ['sum', 'mean']:
+            for include_last_offset in [False, True]:
+                for cache_rows in [0, 10, 1000]:
+                    emb = nn.EmbeddingBag(500, 33, mode=mode, include_last_offset=include_last_offset)
+                    mmap_emb = self._create(emb, cache_rows=cache_rows)
+                    for _ in range(5):
+                        # the hot rows are accessed repeatedly, so they are cached
+                        indices = torch.cat([torch.randint(0, 500, (200,)), torch.randint(0, 8, (100,))])
+                        offsets = torch.LongTensor([0, 5, 5, 40, 100, 299])
+                        if include_last_offset:
+                            offsets = torch.cat([offsets, torch.LongTensor([300])])
+                        mmap_emb.prefetch(indices)
+                        self.assertEqual(mmap_emb(indices, offsets), emb(indices, offsets))
+                    stats = mmap_emb.stats()
+                    self.assertTrue(stats['cached_rows'] <= cache_rows)
+                    if cache_rows > 0:
+                        self.assertTrue(stats['hits'] > 0)
+                        self.assertEqual(stats['hits'] + stats['misses'], 5 * 300)
+
+    def test_bfloat16(self):
+        emb = nn.EmbeddingBag(100, 64, mode='sum')
+        mmap_emb = self._create(emb, torch.bfloat16, cache_rows=16)
+        ref = nn.EmbeddingBag(100, 64, mode='sum', _weight=emb.weight.detach().bfloat16())
+        input = torch.randint(0, 100, (32, 4))
+        for _ in range(3):
+            out = mmap_emb(input)
+            self.assertEqual(out.dtype, torch.bfloat16)
+            self.assertEqual(out, ref(input), rtol=1e-2, atol=1e-2)
+
+    def test_eviction(self):
+        emb = nn.EmbeddingBag(1000, 8, mode='sum')
+        mmap_emb = self._create(emb, cache_rows=4)
+        offsets = torch.LongTensor([0])
+        # rows 0-3 are hot first, then rows 100-103 become hotter
+        for rows, steps in [(torch.arange(0, 4), 10), (torch.arange(100, 104), 20)]:
+            for _ in range(steps):
+                self.assertEqual(mmap_emb(rows, offsets), emb(rows, offsets))
+        stats = mmap_emb.stats()
+        self.assertEqual(stats['cached_rows'], 4)
+        self.assertEqual(stats['evictions'], 4)
+
+    def test_invalid(self):
+        emb = nn.EmbeddingBag(10, 8, mode='sum')
+        mmap_emb = self._create(emb)
+        with self.assertRaises(RuntimeError):
+            mmap_emb(torch.LongTensor([1, 10]), torch.LongTensor([0]))
+        with self.assertRaises(RuntimeError):
+            # the file is smaller than the table
+            MmapEmbeddingBag(mmap_emb.path, 20, 8)
+
+if __name__ == '__main__':
+    test = unittest.main()
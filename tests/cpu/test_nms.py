@@ -249,6 +249,68 @@ class TestNMS(TestCase):
                 self.assertTrue(torch.allclose(bbox_keep, bbox_keep_ref2, rtol=1e-4, atol=1e-4))
                 self.assertTrue(torch.allclose(score_keep, score_keep_ref2, rtol=1e-4, atol=1e-4))
 
+    def greedy_nms(self, dets, scores, threshold):
+        # the boxes are suppressed one by one in the score order, with bias = 1
+        order = torch.sort(scores, descending=True)[1].tolist()
+        areas = (dets[:, 2] - dets[:, 0] + 1) * (dets[:, 3] - dets[:, 1] + 1)
+        suppressed = [False] * dets.size(0)
+        keep = []
+        for _i, i in enumerate(order):
+            if suppressed[i]:
+                continue
+            keep.append(i)
+            for j in order[_i + 1:]:
+                if suppressed[j]:
+                    continue
+                w = max(0, min(dets[i, 2], dets[j, 2]) - max(dets[i, 0], dets[j, 0]) + 1)
+                h = max(0, min(dets[i, 3], dets[j, 3]) - max(dets[i, 1], dets[j, 1]) + 1)
+                inter = w * h
+                if inter / (areas[i] + areas[j] - inter) >= threshold:
+                    suppressed[j] = True
+        return torch.tensor(sorted(keep), dtype=torch.long)
+
+    def test_nms_blocked_result(self):
+        # numbers of boxes around the blocks of 64 boxes
+        torch.manual_seed(0)
+        for dtype in [torch.float, torch.double]:
+            for number_boxes in [1, 63, 64, 65, 130, 300]:
+                xy = torch.rand(number_boxes, 2, dtype=dtype) * 100
+                wh = torch.rand(number_boxes, 2, dtype=dtype) * 30
+                dets = torch.cat([xy, xy + wh], dim=1)
+                scores = torch.rand(number_boxes, dtype=dtype)
+                result_ref = self.greedy_nms(dets, scores, 0.5)
+                self.assertEqual(nms(dets, scores, 0.5), result_ref)
+                scores_sorted, indices = torch.sort(scores, descending=True)
+                result = nms(dets[indices], scores_sorted, 0.5, True)
+                self.assertEqual(torch.sort(indices[result])[0], result_ref)
+        empty = torch.empty(0, 4)
+        self.assertEqual(nms(empty, torch.empty(0), 0.5).numel(), 0)
+
+    def test_nms_blocked_parallel_result(self):
+        # enough blocks for the later blocks to be suppressed in parallel
+        torch.manual_seed(0)
+        for dtype in [torch.float, torch.double]:
+            for number_boxes in [2000, 4097]:
+                xy = torch.rand(number_boxes, 2, dtype=dtype) * 1000
+                wh = torch.rand(number_boxes, 2, dtype=dtype) * 50
+                dets = torch.cat([xy, xy + wh], dim=1)
+                scores = torch.rand(number_boxes, dtype=dtype)
+                # the greedy NMS with the IoU of all the pairs, bias = 1
+                order = torch.sort(scores, descending=True)[1]
+                boxes = dets[order]
+                areas = (boxes[:, 2] - boxes[:, 0] + 1) * (boxes[:, 3] - boxes[:, 1] + 1)
+                lt = torch.max(boxes[:, None, :2], boxes[None, :, :2])
+                rb = torch.min(boxes[:, None, 2:], boxes[None, :, 2:])
+                wh_inter = (rb - lt + 1).clamp(min=0)
+                inter = wh_inter[:, :, 0] * wh_inter[:, :, 1]
+                iou = inter / (areas[:, None] + areas[None, :] - inter)
+                suppressed = torch.zeros(number_boxes, dtype=torch.bool)
+                for i in range(number_boxes):
+                    if not suppressed[i]:
+                        suppressed[i + 1:] |= iou[i, i + 1:] >= 0.5
+                result_ref = torch.sort(order[~suppressed])[0]
+                self.assertEqual(nms(dets, scores, 0.5), result_ref)
+
     def test_rpn_nms_result(self):
         image_shapes = [(800, 824), (800, 1199)]
         min_size = 0
@@ -253,6 +253,87 @@ class TestFusedSteps(TestCase):
         self.assertEqual(param, param5)
         self.assertEqual(momentum_buf, momentum_buf5)
 
+    def _multi_tensor_args(self, split):
+        # small bias/LayerNorm like params and params of several chunks
+        shapes = [(7,), (64,), (3, 5), (80, 100), (4099,)]
+        params = [torch.randn(shape) for shape in shapes]
+        grads = [torch.randn(shape) for shape in shapes]
+        if not split:
+            return params, grads, [torch.Tensor() for _ in shapes]
+        params, trails = zip(*[torch.ops.torch_ipex.split_float_bfloat16(p) for p in params])
+        return list(params), [g.bfloat16() for g in grads], list(trails)
+
+    def _multi_tensor_ref_args(self, params, grads, trails, split):
+        # the fp32 master weights and grads for the python reference update
+        if not split:
+            return [p.clone() for p in params], [g.clone() for g in grads]
+        masters = [torch.ops.torch_ipex.cat_bfloat16_float(p, t) for p, t in zip(params, trails)]
+        return masters, [g.float() for g in grads]
+
+    def _assert_multi_tensor_params(self, params, trails, ref_params, split):
+        for param, trail, ref_param in zip(params, trails, ref_params):
+            if split:
+                param = torch.ops.torch_ipex.cat_bfloat16_float(param, trail)
+            self.assertEqual(param, ref_param, rtol=1e-4, atol=1e-4)
+
+    def test_lamb_step_multi_tensor(self):
+        non_fused = bench.custom_op_bench.optimizer.non_fused_lamb
+        for split in [False, True]:
+            params, grads, trails = self._multi_tensor_args(split)
+            exp_avgs = [torch.randn(p.shape).abs() for p in params]
+            exp_avg_sqs = [torch.randn(p.shape).abs() for p in params]
+            steps = [i + 1 for i in range(len(params))]
+            ref_params, ref_grads = self._multi_tensor_ref_args(params, grads, trails, split)
+            ref_exp_avgs, ref_exp_avg_sqs = [[t.clone() for t in l] for l in (exp_avgs, exp_avg_sqs)]
+
+            torch.ops.torch_ipex.lamb_fused_step_multi_tensor(
+                params, exp_avgs, exp_avg_sqs, grads, trails, steps, 0.8, 0.9, 0.1, 0.3, 0.001)
+            for args in zip(ref_params, ref_exp_avgs, ref_exp_avg_sqs, ref_grads, steps):
+                non_fused(*args, 0.8, 0.9, 0.1, 0.3, 0.001)
+
+            self._assert_multi_tensor_params(params, trails, ref_params, split)
+            for l, ref_l in [(exp_avgs, ref_exp_avgs), (exp_avg_sqs, ref_exp_avg_sqs)]:
+                for t, ref_t in zip(l, ref_l):
+                    self.assertEqual(t, ref_t, rtol=1e-4, atol=1e-4)
+
+    def test_adagrad_step_multi_tensor(self):
+        non_fused = bench.custom_op_bench.optimizer.non_fused_adagrad
+        for split in [False, True]:
+            params, grads, trails = self._multi_tensor_args(split)
+            state_sums = [torch.randn(p.shape).abs() for p in params]
+            steps = [i + 1 for i in range(len(params))]
+            ref_params, ref_grads = self._multi_tensor_ref_args(params, grads, trails, split)
+            ref_state_sums = [t.clone() for t in state_sums]
+
+            torch.ops.torch_ipex.adagrad_fused_step_multi_tensor(
+                params, grads, state_sums, trails, steps, 0.1, 0.3, 0.01, 0.001)
+            for args in zip(ref_params, ref_grads, ref_state_sums, steps):
+                non_fused(*args, 0.1, 0.3, 0.01, 0.001)
+
+            self._assert_multi_tensor_params(params, trails, ref_params, split)
+            for t, ref_t in zip(state_sums, ref_state_sums):
+                self.assertEqual(t, ref_t, rtol=1e-4, atol=1e-4)
+
+    def test_sgd_step_multi_tensor(self):
+        non_fused = bench.custom_op_bench.optimizer.non_fused_sgd
+        for split, momentum_initialized in itertools.product([False, True], [False, True]):
+            params, grads, trails = self._multi_tensor_args(split)
+            momentum_bufs = [torch.randn(p.shape) if momentum_initialized else torch.Tensor() for p in params]
+            ref_params, ref_grads = self._multi_tensor_ref_args(params, grads, trails, split)
+            # the reference creates the momentum_buf of the first step as grad + weight_decay * param
+            ref_momentum_bufs = [
+                b.clone() if momentum_initialized else g.add(p, alpha=0.3)
+                for b, g, p in zip(momentum_bufs, ref_grads, ref_params)]
+
+            momentum_bufs = torch.ops.torch_ipex.sgd_fused_step_multi_tensor(
+                params, grads, momentum_bufs, trails, 0.5, 0.1, 0.3, 0.5, True)
+            for param, grad, momentum_buf in zip(ref_params, ref_grads, ref_momentum_bufs):
+                non_fused(param, grad, momentum_buf if momentum_initialized else None, 0.5, 0.1, 0.3, 0.5, True)
+
+            self._assert_multi_tensor_params(params, trails, ref_params, split)
+            for t, ref_t in zip(momentum_bufs, ref_momentum_bufs):
+                self.assertEqual(t, ref_t, rtol=1e-4, atol=1e-4)
+
     def _test_packed_add(self, param, grad, param2, trail, grad2):
         packed_add = torch.ops.torch_ipex.packed_add
         learning_rate = 0.1
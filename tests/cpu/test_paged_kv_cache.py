@@ -0,0 +1,142 @@
+import math
+import unittest
+
+import torch
+import intel_extension_for_pytorch as ipex
+from common_utils import TestCase
+
+
+class DecodeAttention(torch.nn.Module):
+    def forward(self, query, key, value, key_cache, value_cache, block_table, seq_lens, mask):
+        context_lens = torch.ops.torch_ipex.kv_cache_append_(
+            key, value, key_cache, value_cache, None, None, block_table, seq_lens)
+        return torch.ops.torch_ipex.kv_cache_attention(
+            query, key_cache, value_cache, None, None, block_table, context_lens, 0.125, mask)
+
+
+
+class DecodeAttentionUpdateSeqLens(torch.nn.Module):
+    def forward(self, query, key, value, key_cache, value_cache, block_table, seq_lens, mask):
+        context_lens = torch.ops.torch_ipex.kv_cache_append_(
+            key, value, key_cache, value_cache, None, None, block_table, seq_lens)
+        # written between the append and the attention
+        seq_lens.add_(1)
+        return torch.ops.torch_ipex.kv_cache_attention(
+            query, key_cache, value_cache, None, None, block_table, context_lens, 0.125, mask)
+
+class TestPagedKVCache(TestCase):
+    def _reference(self, query, keys, values, scale, mask):
+        # keys/values: list of [B, H, 1, D] for each step
+        key = torch.cat(keys, dim=2).float()
+        value = torch.cat(values, dim=2).float()
+        scores = torch.matmul(query.float(), key.transpose(-1, -2)) * scale
+        if mask is not None:
+            scores = scores + mask[..., :key.size(2)]
+        return torch.matmul(torch.softmax(scores, -1), value)
+
+    def test_decode_attention(self):
+        num_heads, head_dim, batch_size, steps = 3, 40, 2, 37
+        scale = 1 / math.sqrt(head_dim)
+        for cache_dtype, query_dtype, prec in [
+                (torch.float, torch.float, 1e-5),
+                (torch.bfloat16, torch.float, 2e-2),
+                (torch.bfloat16, torch.bfloat16, 3e-2),
+                (torch.int8, torch.float, 3e-2)]:
+            for use_mask in [False, True]:
+                cache = ipex.nn.modules.PagedKVCache(
+                    num_heads, head_dim, batch_size, 64, block_size=16, dtype=cache_dtype)
+                mask = torch.randn(batch_size, 1, 1, steps) if use_mask else None
+                keys, values = [], []
+                for _ in range(steps):
+                    query, key, value = [
+                        torch.randn(batch_size, num_heads, 1, head_dim).to(query_dtype) for _ in range(3)]
+                    keys.append(key)
+                    values.append(value)
+                    context = cache(query, key, value, scale, mask)
+                    self.assertEqual(context.dtype, query_dtype)
+                    ref = self._reference(query, keys, values, scale, mask)
+                    self.assertEqual(context.float(), ref, prec=prec)
+                self.assertEqual(cache.seq_lens, torch.full([batch_size], steps, dtype=torch.long))
+
+    def test_variable_lengths(self):
+        num_heads, head_dim = 2, 16
+        cache = ipex.nn.modules.PagedKVCache(
+            num_heads, head_dim, 2, 64, block_size=4, dtype=torch.float)
+        keys = [[], []]
+        values = [[], []]
+        # sequence 0 runs alone for 5 steps, then both sequences decode
+        for step in range(12):
+            batch_size = 1 if step < 5 else 2
+            query, key, value = [
+                torch.randn(batch_size, num_heads, 1, head_dim) for _ in range(3)]
+            context = cache(query, key, value, 1.0)
+            for b in range(batch_size):
+                keys[b].append(key[b:b + 1])
+                values[b].append(value[b:b + 1])
+                ref = self._reference(query[b:b + 1], keys[b], values[b], 1.0, None)
+                self.assertEqual(context[b:b + 1], ref)
+        # the blocks of a freed sequence are reused
+        cache.free(0)
+        self.assertEqual(len(cache.free_blocks), cache.key_cache.size(0) - 2)
+
+    def test_out_of_blocks(self):
+        cache = ipex.nn.modules.PagedKVCache(1, 16, 1, 64, block_size=4, num_blocks=1, dtype=torch.float)
+        inputs = [torch.randn(1, 1, 1, 16) for _ in range(3)]
+        for _ in range(4):
+            cache(*inputs, 1.0)
+        with self.assertRaises(RuntimeError):
+            cache(*inputs, 1.0)
+
+    def test_fuse_decode_attention(self):
+        num_heads, head_dim, block_size = 2, 32, 8
+        key_cache = torch.zeros(4, num_heads, block_size, head_dim)
+        value_cache = torch.zeros(4, num_heads, block_size, head_dim)
+        block_table = torch.tensor([[0, 1], [2, 3]])
+        seq_lens = torch.tensor([3, 10])
+        mask = torch.zeros(2, 1, 1, 11)
+        query, key, value = [torch.randn(2, num_heads, 1, head_dim) for _ in range(3)]
+        inputs = [query, key, value, key_cache, value_cache, block_table, seq_lens, mask]
+        model = DecodeAttention()
+        with torch.no_grad():
+            ref = model(*[t.clone() for t in inputs])
+            model_jit = torch.jit.trace(model, [t.clone() for t in inputs])
+            for _ in range(2):
+                model_jit(*[t.clone() for t in inputs])
+            jit_inputs = [t.clone() for t in inputs]
+            res = model_jit(*jit_inputs)
+            self.assertEqual(ref, res)
+            graph = model_jit.graph_for(*[t.clone() for t in inputs])
+            self.assertTrue(any(n.kind() == "torch_ipex::kv_cache_decode_attention" for n in graph.nodes()))
+            self.assertFalse(any(n.kind() == "torch_ipex::kv_cache_append_" for n in graph.nodes()))
+            # the new key is written at seq_lens of each sequence
+            self.assertEqual(jit_inputs[3][0, :, 3], key[0, :, 0])
+            self.assertEqual(jit_inputs[3][3, :, 2], key[1, :, 0])
+
+    def test_fuse_decode_attention_seq_lens_written(self):
+        num_heads, head_dim, block_size = 2, 32, 8
+        key_cache = torch.zeros(4, num_heads, block_size, head_dim)
+        value_cache = torch.zeros(4, num_heads, block_size, head_dim)
+        block_table = torch.tensor([[0, 1], [2, 3]])
+        seq_lens = torch.tensor([3, 10])
+        mask = torch.zeros(2, 1, 1, 12)
+        query, key, value = [torch.randn(2, num_heads, 1, head_dim) for _ in range(3)]
+        inputs = [query, key, value, key_cache, value_cache, block_table, seq_lens, mask]
+        model = DecodeAttentionUpdateSeqLens()
+        with torch.no_grad():
+            ref_inputs = [t.clone() for t in inputs]
+            ref = model(*ref_inputs)
+            model_jit = torch.jit.trace(model, [t.clone() for t in inputs])
+            for _ in range(2):
+                model_jit(*[t.clone() for t in inputs])
+            jit_inputs = [t.clone() for t in inputs]
+            res = model_jit(*jit_inputs)
+            self.assertEqual(ref, res)
+            self.assertEqual(ref_inputs[3], jit_inputs[3])
+            # moving the append after the write of seq_lens would append at
+            # the wrong slot, so they are not fused
+            graph = model_jit.graph_for(*[t.clone() for t in inputs])
+            self.assertFalse(any(n.kind() == "torch_ipex::kv_cache_decode_attention" for n in graph.nodes()))
+
+
+if __name__ == '__main__':
+    test = unittest.main()
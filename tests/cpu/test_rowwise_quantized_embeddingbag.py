@@ -0,0 +1,106 @@
+import torch
+import torch.nn as nn
+import unittest
+import copy
+from torch.testing._internal.common_utils import TestCase
+import intel_extension_for_pytorch as ipex
+from intel_extension_for_pytorch.nn.modules import RowwiseQuantizedEmbeddingBag, MergedRowwiseQuantizedEmbeddingBag
+from intel_extension_for_pytorch.nn.modules.rowwise_quantized_embeddingbag import rowwise_quantize_embedding, rowwise_dequantize_embedding
+
+class TestRowwiseQuantizedEmbeddingBag(TestCase):
+
+    def _dequantized_embeddingbag(self, emb, bit_width):
+        ref = copy.deepcopy(emb).float()
+        qweight = rowwise_quantize_embedding(emb.weight, bit_width)
+        ref.weight.data = rowwise_dequantize_embedding(qweight, bit_width, emb.embedding_dim)
+        return ref
+
+    def test_quantize(self):
+        for bit_width in [8, 4]:
+            # the odd dims leave the high nibble of the last byte unused
+            for dim in [1, 7, 16, 33, 64]:
+                for dtype in [torch.float, torch.bfloat16]:
+                    weight = torch.randn(100, dim).to(dtype)
+                    qweight = rowwise_quantize_embedding(weight, bit_width)
+                    data_bytes = dim if bit_width == 8 else (dim + 1) // 2
+                    self.assertEqual(qweight.dtype, torch.uint8)
+                    self.assertEqual(qweight.shape, (100, data_bytes + 8))
+                    # the error of each value is at most half of its row's scale
+                    dequantized = rowwise_dequantize_embedding(qweight, bit_width, dim)
+                    row_range = weight.float().max(dim=1, keepdim=True)[0] - weight.float().min(dim=1, keepdim=True)[0]
+                    scale = row_range / (2 ** bit_width - 1)
+                    self.assertTrue(((dequantized - weight.float()).abs() <= scale / 2 + 1e-5).all())
+
+    def test_constant_row(self):
+        weight = torch.ones(4, 10) * 0.25
+        for bit_width in [8, 4]:
+            qweight = rowwise_quantize_embedding(weight, bit_width)
+            self.assertEqual(rowwise_dequantize_embedding(qweight, bit_width, 10), weight)
+
+    def test_embeddingbag(self):
+        for bit_width in [8, 4]:
+            for mode in ['sum', 'mean']:
+                for dim in [13, 64, 100]:
+                    for include_last_offset in [False, True]:
+                        emb = nn.EmbeddingBag(1000, dim, mode=mode, include_last_offset=include_last_offset)
+                        qemb = RowwiseQuantizedEmbeddingBag.from_embeddingbag(emb, bit_width)
+                        ref = self._dequantized_embeddingbag(emb, bit_width)
+                        indices = torch.randint(0, 1000, (300,))
+                        # an empty bag in the middle
+                        offsets = torch.LongTensor([0, 5, 5, 40, 100, 299])
+                        if include_last_offset:
+                            offsets = torch.cat([offsets, torch.LongTensor([300])])
+                        self.assertEqual(qemb(indices, offsets), ref(indices, offsets), rtol=1e-4, atol=1e-4)
+
+    def test_embeddingbag_2d_input(self):
+        emb = nn.EmbeddingBag(50, 32, mode='sum')
+        for bit_width in [8, 4]:
+            qemb = RowwiseQuantizedEmbeddingBag.from_embeddingbag(emb, bit_width)
+            ref = self._dequantized_embeddingbag(emb, bit_width)
+            input = torch.randint(0, 50, (16, 3))
+            self.assertEqual(qemb(input), ref(input), rtol=1e-4, atol=1e-4)
+
+    def test_out_of_range_indices(self):
+        emb = nn.EmbeddingBag(10, 16, mode='sum')
+        qemb = RowwiseQuantizedEmbeddingBag.from_embeddingbag(emb, 4)
+        with self.assertRaises(RuntimeError):
+            qemb(torch.LongTensor([1, 10]), torch.LongTensor([0]))
+
+    def test_merged_embeddingbag(self):
+        tables = [
+            nn.EmbeddingBag(100, 16, mode='mean'),
+            nn.EmbeddingBag(50, 33, mode='sum'),
+            nn.EmbeddingBag(1000, 128, mode='sum', include_last_offset=True),
+        ]
+        input = [
+            [torch.LongTensor([10, 10, 15, 10, 20, 25]), torch.LongTensor([[0, 30], [21, 15], [30, 11]]), torch.LongTensor([10, 15, 999])],
+            [torch.LongTensor([0, 1, 3]), None, torch.LongTensor([0, 1, 2, 3])],
+            [tables[0].include_last_offset, tables[1].include_last_offset, tables[2].include_last_offset]
+        ]
+        for bit_width in [8, 4]:
+            merged = MergedRowwiseQuantizedEmbeddingBag.from_embeddingbag_list(tables, bit_width)
+            outputs = merged(input)
+            self.assertEqual(len(outputs), len(tables))
+            for i, emb in enumerate(tables):
+                ref = self._dequantized_embeddingbag(emb, bit_width)
+                self.assertEqual(outputs[i], ref(input[0][i], input[1][i]), rtol=1e-4, atol=1e-4)
+
+            linearized = merged.linearize_indices_and_offsets(*input)
+            outputs2 = merged(linearized, torch.BoolTensor([False]))
+            self.assertEqual(outputs, outputs2)
+
+    def test_merged_embeddingbag_blocked(self):
+        # batches over 1 bag block per table
+        tables = [nn.EmbeddingBag(1000, 64, mode='sum'), nn.EmbeddingBag(500, 24, mode='mean')]
+        batch_size = 200
+        indices = [torch.randint(0, 1000, (batch_size * 3,)), torch.randint(0, 500, (batch_size * 3,))]
+        offsets = [torch.arange(0, batch_size * 3, 3), torch.arange(0, batch_size * 3, 3)]
+        for bit_width in [8, 4]:
+            merged = MergedRowwiseQuantizedEmbeddingBag.from_embeddingbag_list(tables, bit_width)
+            outputs = merged((indices, offsets, [False, False]))
+            for i, emb in enumerate(tables):
+                ref = self._dequantized_embeddingbag(emb, bit_width)
+                self.assertEqual(outputs[i], ref(indices[i], offsets[i]), rtol=1e-4, atol=1e-4)
+
+if __name__ == '__main__':
+    test = unittest.main()
@@ -70,6 +70,31 @@ class TestCoreBinding(TestCase):
         y = model(x)
         self.assertEqual(y, y_runtime)
 
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_with_context_bind_memory(self):
+        model = SimpleNet()
+        model.eval()
+        x = torch.rand(64, 64, 3, 3)
+        cpu_pool = ipex.cpu.runtime.CPUPool(node_id=0, bind_memory=True)
+        with ipex.cpu.runtime.pin(cpu_pool):
+            y_runtime = model(x)
+        y = model(x)
+        self.assertEqual(y, y_runtime)
+
+class TestCPUTopology(TestCase):
+    def test_cpu_topology(self):
+        topology = ipex.cpu.runtime.get_cpu_topology()
+        self.assertTrue(topology.__len__() > 0)
+        node_ids = set([cpu["numa_node_id"] for cpu in topology])
+        for node_id in node_ids:
+            physical_cores = ipex.cpu.runtime.get_core_list_of_node_id(node_id)
+            self.assertTrue(physical_cores.__len__() > 0)
+            for cpu in topology:
+                if cpu["cpu_id"] in physical_cores:
+                    # Only the first hardware thread of each physical core is returned.
+                    self.assertFalse(cpu["is_smt_sibling"])
+                    self.assertEqual(cpu["numa_node_id"], node_id)
+
 class TestRuntimeAPI(TestCase):
     @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
     def test_task_async_api_imperative_model(self):
@@ -147,6 +172,38 @@ class TestRuntimeAPI(TestCase):
         self.assertEqual(y, y_runtime)
         self.assertEqual(y, y_runtime2)
 
+class TestTaskAPIWorkStealing(TestCase):
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_task_work_stealing(self):
+        def slow_add(x):
+            # sleep without the GIL, so the worker of task stays busy
+            time.sleep(0.05)
+            return x + 1
+
+        x = torch.rand(4, 4)
+        # The cpus of both tasks are on the same numa node.
+        task = ipex.cpu.runtime.Task(slow_add, ipex.cpu.runtime.CPUPool(core_ids=[0]), work_stealing=True)
+        idle_task = ipex.cpu.runtime.Task(slow_add, ipex.cpu.runtime.CPUPool(core_ids=[1]), work_stealing=True)
+
+        futures = [task(x) for _ in range(8)]
+        for future in futures:
+            self.assertEqual(x + 1, future.get())
+        # The pending executions of task are stolen by the idle worker.
+        self.assertGreater(idle_task.get_num_stolen_tasks(), 0)
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_task_submit_beyond_queue_capacity(self):
+        def add(x):
+            return x + 1
+
+        x = torch.rand(4, 4)
+        task = ipex.cpu.runtime.Task(add, ipex.cpu.runtime.CPUPool(core_ids=[0]), work_stealing=True)
+        # More executions than the slots of the task queue, the submit waits
+        # for the worker without holding the GIL it needs.
+        futures = [task(x) for _ in range(4096)]
+        for future in futures:
+            self.assertEqual(x + 1, future.get())
+
 class TestMultiStreamModule(TestCase):
     @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
     def test_multi_stream_module(self):
@@ -251,5 +308,176 @@ class TestMultiStreamModule(TestCase):
         self.assertEqual(y_runtime2[1].size(0), 1)
         self.assertEqual(y_runtime2[2].size(0), 1)
 
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_multi_stream_module_work_stealing(self):
+        model = SimpleNet()
+        model.eval()
+        num_streams = 2
+        batch_size = 4
+        x = torch.rand(batch_size, 64, 3, 3)
+        # Calculate the reference result
+        y = model(x)
+
+        # Create MultiStreamModule with work stealing between streams
+        cpu_pool = ipex.cpu.runtime.CPUPool(core_ids=[0, 1])
+        multi_stream_model = ipex.cpu.runtime.MultiStreamModule(model, num_streams=num_streams, cpu_pool=cpu_pool, work_stealing=True)
+        traced_model = torch.jit.trace(model, x)
+        multi_stream_model2 = ipex.cpu.runtime.MultiStreamModule(traced_model, num_streams=num_streams, cpu_pool=cpu_pool, work_stealing=True)
+
+        for _ in range(4):
+            y_runtime = multi_stream_model(x)
+            y_runtime2 = multi_stream_model2(x)
+            self.assertEqual(y, y_runtime)
+            self.assertEqual(y, y_runtime2)
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_multi_stream_module_numa_weight_replica(self):
+        model = SimpleNet()
+        model.eval()
+        batch_size = 4
+        x = torch.rand(batch_size, 64, 3, 3)
+        # Calculate the reference result
+        y = model(x)
+
+        # The prepacked conv weight is replicated to the numa node of each stream.
+        optimized_model = ipex.optimize(model)
+        ipex.cpu.runtime.set_numa_weight_replica_enabled(True)
+        try:
+            self.assertTrue(ipex.cpu.runtime.is_numa_weight_replica_enabled())
+            streams_per_node = 2
+            for node_id in ipex._C.get_numa_node_ids():
+                cpu_pool = ipex.cpu.runtime.CPUPool(node_id=node_id)
+                multi_stream_model = ipex.cpu.runtime.MultiStreamModule(optimized_model, num_streams=streams_per_node, cpu_pool=cpu_pool)
+                for _ in range(2):
+                    self.assertEqual(y, multi_stream_model(x))
+        finally:
+            ipex.cpu.runtime.set_numa_weight_replica_enabled(False)
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_multi_stream_module_numa_weight_replica_refresh(self):
+        model = SimpleNet()
+        sgd = torch.optim.SGD(model.parameters(), lr=0.1)
+        optimized_model, optimized_sgd = ipex.optimize(model.train(), optimizer=sgd)
+        batch_size = 4
+        x = torch.rand(batch_size, 64, 3, 3)
+
+        ipex.cpu.runtime.set_numa_weight_replica_enabled(True)
+        try:
+            streams_per_node = 2
+            for node_id in ipex._C.get_numa_node_ids():
+                cpu_pool = ipex.cpu.runtime.CPUPool(node_id=node_id)
+                multi_stream_model = ipex.cpu.runtime.MultiStreamModule(optimized_model, num_streams=streams_per_node, cpu_pool=cpu_pool)
+                for _ in range(2):
+                    # The replicas read by the streams must follow the prepacked weight
+                    # updated by the fused SGD step.
+                    weight = optimized_model.state_dict()['conv.weight']
+                    y = torch.flatten(torch.nn.functional.conv2d(x, weight, stride=(2, 2), padding=(1, 1)), start_dim=1)
+                    with torch.no_grad():
+                        self.assertEqual(y, multi_stream_model(x))
+                    version = optimized_model.conv.weight._version
+                    optimized_sgd.zero_grad()
+                    optimized_model(x).sum().backward()
+                    optimized_sgd.step()
+                    self.assertGreater(optimized_model.conv.weight._version, version)
+        finally:
+            ipex.cpu.runtime.set_numa_weight_replica_enabled(False)
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_multi_stream_module_shared_primitive_cache(self):
+        model = SimpleNet()
+        model.eval()
+        batch_size = 4
+        x = torch.rand(batch_size, 64, 3, 3)
+        # Calculate the reference result
+        y = model(x)
+
+        optimized_model = ipex.optimize(model)
+        num_streams = 2
+        cpu_pool = ipex.cpu.runtime.CPUPool(core_ids=[0, 1])
+        multi_stream_model = ipex.cpu.runtime.MultiStreamModule(optimized_model, num_streams=num_streams, cpu_pool=cpu_pool)
+        try:
+            # Each stream runs a sub-batch on 1 core.
+            ipex.cpu.runtime.warm_up_shared_primitive_cache(
+                optimized_model, x[:batch_size // num_streams], num_threads=1)
+            self.assertTrue(ipex.cpu.runtime.is_shared_primitive_cache_enabled())
+            misses = {name: stats['misses'] for name, stats in ipex.cpu.runtime.get_shared_primitive_cache_stats().items()}
+            for _ in range(2):
+                self.assertEqual(y, multi_stream_model(x))
+            # The streams reuse the primitives created by the warm-up.
+            for name, stats in ipex.cpu.runtime.get_shared_primitive_cache_stats().items():
+                self.assertEqual(stats['misses'], misses.get(name, 0))
+        finally:
+            ipex.cpu.runtime.set_shared_primitive_cache_enabled(False)
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_multi_stream_module_scratchpad_arena(self):
+        model = SimpleNet()
+        model.eval()
+        batch_size = 4
+        x = torch.rand(batch_size, 64, 3, 3)
+        # Calculate the reference result
+        y = model(x)
+
+        optimized_model = ipex.optimize(model)
+        cpu_pool = ipex.cpu.runtime.CPUPool(core_ids=[0, 1])
+        multi_stream_model = ipex.cpu.runtime.MultiStreamModule(optimized_model, num_streams=2, cpu_pool=cpu_pool)
+        ipex._C._reset_scratchpad_arena_peak_bytes()
+        self.assertEqual(y, multi_stream_model(x))
+        # The arena of each thread is at least as large as its largest scratchpad.
+        stats = ipex._C._get_scratchpad_arena_stats()
+        self.assertGreater(stats['peak_bytes'], 0)
+        self.assertGreaterEqual(stats['total_bytes'], stats['peak_bytes'])
+        # The second run reuses the arenas, without growing them.
+        self.assertEqual(y, multi_stream_model(x))
+        self.assertEqual(ipex._C._get_scratchpad_arena_stats()['total_bytes'], stats['total_bytes'])
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_multi_stream_module_caching_allocator(self):
+        model = SimpleNet()
+        model.eval()
+        batch_size = 4
+        x = torch.rand(batch_size, 64, 3, 3)
+        # Calculate the reference result
+        y = model(x)
+
+        ipex.cpu.runtime.set_caching_allocator_enabled(True)
+        try:
+            self.assertTrue(ipex.cpu.runtime.is_caching_allocator_enabled())
+            optimized_model = ipex.optimize(model)
+            cpu_pool = ipex.cpu.runtime.CPUPool(core_ids=[0, 1])
+            multi_stream_model = ipex.cpu.runtime.MultiStreamModule(optimized_model, num_streams=2, cpu_pool=cpu_pool)
+            for _ in range(2):
+                self.assertEqual(y, multi_stream_model(x))
+            # The steady state reuses the cached blocks.
+            num_os_allocations = ipex.cpu.runtime.get_caching_allocator_stats()['num_os_allocations']
+            self.assertEqual(y, multi_stream_model(x))
+            stats = ipex.cpu.runtime.get_caching_allocator_stats()
+            self.assertEqual(stats['num_os_allocations'], num_os_allocations)
+            self.assertGreaterEqual(stats['allocated_bytes'], stats['requested_bytes'])
+            self.assertGreaterEqual(stats['peak_reserved_bytes'], stats['reserved_bytes'])
+        finally:
+            ipex.cpu.runtime.set_caching_allocator_enabled(False)
+
+class TestDynamicBatchingModule(TestCase):
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    def test_dynamic_batching_module(self):
+        model = SimpleNet()
+        model.eval()
+        num_requests = 8
+        x = torch.rand(num_requests, 64, 3, 3)
+        traced_model = torch.jit.trace(model, x)
+        # Calculate the reference result
+        y = model(x)
+
+        cpu_pool = ipex.cpu.runtime.CPUPool(core_ids=[0, 1])
+        batching_model = ipex.cpu.runtime.DynamicBatchingModule(traced_model, num_streams=2, cpu_pool=cpu_pool, max_batch_size=4, max_latency_ms=10)
+        # Submit the batch size 1 requests concurrently, each request gets back its own output.
+        futures = [batching_model.run_async(x[i:i + 1]) for i in range(num_requests)]
+        y_runtime = [future.get() for future in futures]
+        for i in range(num_requests):
+            self.assertEqual(y_runtime[i].size(0), 1)
+            self.assertEqual(y[i:i + 1], y_runtime[i])
+        self.assertEqual(y[0:1], batching_model(x[0:1]))
+
 if __name__ == '__main__':
     test = unittest.main()